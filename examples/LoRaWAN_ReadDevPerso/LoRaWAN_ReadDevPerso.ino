@@ -118,22 +118,24 @@ void printTraces()
 
 void printParam()
 {
-  /* Read personnal parameters */
-  DevPerso_t *devPerso = nemeusLib.loraWan()->readDevPerso();
+  char hexValue[DEVPERSO_KEY_HEX_SIZE];
+
+  /* Read personnal parameters (values are cached by the library) */
+  nemeusLib.loraWan()->readDevPerso();
   SerialUSB.print(">>OTAA provisionning: ");
   SerialUSB.print("\n  devUID: ");
-  SerialUSB.println(devPerso->devUID);
+  SerialUSB.println(nemeusLib.loraWan()->readDevUID(hexValue));
   SerialUSB.print("  appUID: ");
-  SerialUSB.println(devPerso->appUID);
+  SerialUSB.println(nemeusLib.loraWan()->readAppUID(hexValue));
   SerialUSB.print("  appKey: ");
-  SerialUSB.println(devPerso->appKey);
+  SerialUSB.println(nemeusLib.loraWan()->readAppKey(hexValue));
   SerialUSB.print(">>ABP provisionning: ");
   SerialUSB.print("\n  devAddr: ");
-  SerialUSB.println(devPerso->devAddr);
+  SerialUSB.println(nemeusLib.loraWan()->readDevAddr(hexValue));
   SerialUSB.print("  appSKey: ");
-  SerialUSB.println(devPerso->appSKey);
+  SerialUSB.println(nemeusLib.loraWan()->readAppSKey(hexValue));
   SerialUSB.print("  nwkSKey: ");
-  SerialUSB.println(devPerso->nwkSKey);
+  SerialUSB.println(nemeusLib.loraWan()->readNwkSKey(hexValue));
   
 }
 
@@ -62,7 +62,8 @@ void setup()
   ret = nemeusLib.setVerbose(true);
 
   /* Get DevUID */
-  String devUID = nemeusLib.loraWan()->readDevUID();
+  char devUID[DEVPERSO_EUI_HEX_SIZE];
+  nemeusLib.loraWan()->readDevUID(devUID);
 
   /* Turn ON Radio */
   ret = nemeusLib.loraWan()->ON('A', false);
@@ -76,11 +77,12 @@ void setup()
     SerialUSB.println("LoRaWAN ON command error!!");
   }
 
-  /* Read personnal parameters */
-  DevPerso_t *devPerso = nemeusLib.loraWan()->readDevPerso();
+  /* Read device address */
+  char devAddr[DEVPERSO_DEVADDR_HEX_SIZE];
+  nemeusLib.loraWan()->readDevAddr(devAddr);
 
   /* Compare with value defined */
-  if (strcmp(devPerso->devAddr, (char*)DEVADDR)==0 )
+  if (strcasecmp(devAddr, (char*)DEVADDR)==0 )
   {
     SerialUSB.println("No changement for the device address");
   }
@@ -72,11 +72,12 @@ void setup()
   /* Turn off LoRaWAN if not */
   ret = nemeusLib.loraWan()->OFF();
 
-  /* Read personnal parameters */
-  DevPerso_t *devPerso = nemeusLib.loraWan()->readDevPerso();
+  /* Read App UID */
+  char appUID[DEVPERSO_EUI_HEX_SIZE];
+  nemeusLib.loraWan()->readAppUID(appUID);
 
   /* Compare with values defined */
-  if (strcmp(devPerso->appUID, (char*)APPUID) == 0) 
+  if (strcasecmp(appUID, (char*)APPUID) == 0) 
   {
     SerialUSB.println("No changement for the APPUID");
   }
@@ -149,11 +150,11 @@ void onReceiveDownlink(uint8_t port , boolean more, const char * hexaPayload, in
   SerialUSB.print("Pending frames:");
   if(more == 1)
   {
-    SerialUSB.println("False");
+    SerialUSB.println("True");
   }
   else
   {
-    SerialUSB.println("True");
+    SerialUSB.println("False");
   }
   SerialUSB.print("Payload:");
   SerialUSB.println(hexaPayload);
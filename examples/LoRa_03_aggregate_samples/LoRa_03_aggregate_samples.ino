@@ -0,0 +1,105 @@
+/* Example aggregating samples in LoRaWAN frames
+ *
+ *  Uses Nemeus Library
+ *  Reads an analog input every 10s and adds it as a timestamped record to
+ *  a sample aggregator. Frames are sent when no other record fits for the
+ *  current data rate, or when the first record is 15 minutes old.
+ *
+ */
+
+#include <NemeusLib.h>
+#include <Wire.h>
+
+#define SAMPLING_PERIOD 10000
+#define MAC_PORT 2
+#define RECORD_SIZE 2
+
+uint8_t ret;
+uint32_t lastSampleTime = 0;
+
+/* Fixed size records of 2 bytes, sent after 15 minutes at most */
+SampleAggregator aggregator(MAC_PORT, RECORD_SIZE, 900000);
+
+/* Reception callback for RF frames */
+void onReceive(const char *string);
+
+void setup()
+{
+  /* serial monitor */
+  SerialUSB.begin(115200);
+
+#ifdef CONSOLE_CHECK
+  while(!SerialUSB)
+  {
+    ;      /*SerialUSB not ready */
+  }
+  SerialUSB.println(">>Console Ready");
+#endif
+
+  SerialUSB.println(">>Sketch: Aggregating samples in LoRaWAN frames ");
+
+  /* Reset the modem */
+  if ( nemeusLib.resetModem() != NEMEUS_SUCCESS)
+  {
+    SerialUSB.print("Nemeus device is not responding!");
+    while(1)
+    {
+    }
+  }
+
+  /* Init nemeus library */
+  if(nemeusLib.init() != NEMEUS_SUCCESS)
+  {
+    SerialUSB.print("Nemeus device is not responding!");
+    while(1)
+    {
+    }
+  }
+
+  /* Register a callback for reception */
+  nemeusLib.register_at_response_callback(&onReceive);
+
+  /* Turn ON LoRaWAN */
+  ret = nemeusLib.loraWan()->ON('A', false);
+
+  if(ret == NEMEUS_SUCCESS)
+  {
+    SerialUSB.println("LoRaWAN ON - Class A - ABP!!!");
+  }
+  else
+  {
+    SerialUSB.println("LoRaWAN ON command error!!");
+  }
+}
+
+void loop()
+{
+  nemeusLib.pollDevice(1000);
+
+  if ((millis() - lastSampleTime) >= SAMPLING_PERIOD)
+  {
+    uint16_t sample = analogRead(A0);
+    uint8_t record[RECORD_SIZE] = { (uint8_t)(sample >> 8), (uint8_t)(sample & 0xFF) };
+
+    lastSampleTime = millis();
+
+    /* Add the sample, the frame is sent when full */
+    ret = aggregator.add(record, RECORD_SIZE);
+
+    SerialUSB.print("Sample added, pending records: ");
+    SerialUSB.println(aggregator.pendingRecords());
+  }
+
+  /* Send the frame when the first record is too old */
+  ret = aggregator.process();
+
+  nemeusLib.printTraces();
+}
+
+/* ---------------- Functions ---------------- */
+
+void onReceive(const char *string)
+{
+  SerialUSB.print("mm002 >> ");
+  SerialUSB.println(string);
+}
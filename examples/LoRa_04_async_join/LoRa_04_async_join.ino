@@ -0,0 +1,130 @@
+/* Example for LoRaWAN OTAA join without blocking
+ *
+ *  Uses Nemeus Library
+ *  The join runs from the main loop: the sketch keeps working while the
+ *  join request is sent, delayed by duty cycle or retried with backoff.
+ *  Once joined, sends a frame every minute.
+ *
+ */
+
+#include <NemeusLib.h>
+#include <Wire.h>
+
+#define SEND_PERIOD 60000
+
+uint8_t ret;
+boolean joined = false;
+uint32_t lastSendTime = 0;
+
+/* Reception callback for RF frames */
+void onReceive(const char *string);
+/* Join callbacks */
+void onJoinProgress(uint8_t state, uint8_t attempt, uint32_t delay);
+void onJoinDone(uint8_t errorCode, uint32_t duration);
+
+void setup()
+{
+  /* serial monitor */
+  SerialUSB.begin(115200);
+
+#ifdef CONSOLE_CHECK
+  while(!SerialUSB)
+  {
+    ;      /*SerialUSB not ready */
+  }
+  SerialUSB.println(">>Console Ready");
+#endif
+
+  SerialUSB.println(">>Sketch: LoRaWAN OTAA join from the main loop ");
+
+  /* Reset the modem */
+  if ( nemeusLib.resetModem() != NEMEUS_SUCCESS)
+  {
+    SerialUSB.print("Nemeus device is not responding!");
+    while(1)
+    {
+    }
+  }
+
+  /* Init nemeus library */
+  if(nemeusLib.init() != NEMEUS_SUCCESS)
+  {
+    SerialUSB.print("Nemeus device is not responding!");
+    while(1)
+    {
+    }
+  }
+
+  /* Register callbacks */
+  nemeusLib.register_at_response_callback(&onReceive);
+  nemeusLib.loraWan()->register_join_progress_callback(&onJoinProgress);
+  nemeusLib.loraWan()->register_join_callback(&onJoinDone);
+
+  /* Start the join, Class A */
+  ret = nemeusLib.loraWan()->startJoin('A');
+
+  if(ret != NEMEUS_SUCCESS)
+  {
+    SerialUSB.println("LoRaWAN join start error!!");
+  }
+}
+
+void loop()
+{
+  if (!joined)
+  {
+    /* Run the join, returns quickly */
+    nemeusLib.loraWan()->processJoin();
+  }
+  else if ((millis() - lastSendTime) >= SEND_PERIOD)
+  {
+    lastSendTime = millis();
+
+    /* Send a frame (BINARY mode, Repetition = 1, mac Port = 2, no ACK,  Encrypted) */
+    ret = nemeusLib.loraWan()->sendFrame(0, 1, 2, (char*)"CAFE", 0, 1);
+    nemeusLib.printTraces();
+  }
+
+  /* Other sketch work here */
+}
+
+/* ---------------- Functions ---------------- */
+
+void onReceive(const char *string)
+{
+  SerialUSB.print("mm002 >> ");
+  SerialUSB.println(string);
+}
+
+void onJoinProgress(uint8_t state, uint8_t attempt, uint32_t delay)
+{
+  if (state == JOIN_REQUESTED)
+  {
+    SerialUSB.print("Join request, attempt ");
+    SerialUSB.print(attempt + 1);
+  }
+  else
+  {
+    SerialUSB.print("Join retry in ");
+  }
+  SerialUSB.print(" delay (ms): ");
+  SerialUSB.println(delay);
+}
+
+void onJoinDone(uint8_t errorCode, uint32_t duration)
+{
+  char devAddr[DEVPERSO_DEVADDR_HEX_SIZE];
+
+  if (errorCode == NEMEUS_SUCCESS)
+  {
+    joined = true;
+    SerialUSB.print("Joined in (ms): ");
+    SerialUSB.println(duration);
+    SerialUSB.print("Device address: ");
+    SerialUSB.println(nemeusLib.loraWan()->readDevAddr(devAddr));
+  }
+  else
+  {
+    SerialUSB.println("Join failed!");
+  }
+}
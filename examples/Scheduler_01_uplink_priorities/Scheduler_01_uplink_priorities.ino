@@ -0,0 +1,132 @@
+/* Example for the uplink scheduler
+ *
+ *  Uses Nemeus Library
+ *  Enables LoRaWAN (ABP) and Sigfox, then queues a routine telemetry frame
+ *  every minute. Pressing the button queues an urgent alarm which is sent
+ *  before any pending telemetry, on the first technology available.
+ *  The scheduler applies the duty cycle of each technology, no delay()
+ *  pacing is needed in the main loop.
+ *
+ */
+
+#include <NemeusLib.h>
+#include <Wire.h>
+
+#define BUTTON 11
+#define TELEMETRY_PERIOD 60000
+
+uint8_t ret;
+uint16_t frameCounter = 0;
+uint32_t lastTelemetry = 0;
+volatile bool alarmRaised = false;
+
+/* Completion callback for uplink jobs */
+void onJobDone(uint8_t jobId, uint8_t technology, uint8_t errorCode);
+
+void isr_button();
+
+void setup()
+{
+  /* serial monitor */
+  SerialUSB.begin(115200);
+
+#ifdef CONSOLE_CHECK
+  while(!SerialUSB)
+  {
+    ;      /*SerialUSB not ready */
+  }
+  SerialUSB.println(">>Console Ready");
+#endif
+
+  SerialUSB.println(">>Sketch: Uplink scheduler ");
+
+  /* Init nemeus library */
+  if(nemeusLib.init() != NEMEUS_SUCCESS)
+  {
+    SerialUSB.print("Nemeus device is not responding!");
+    while(1)
+    {
+    }
+  }
+
+  /* Enable both technologies, the scheduler only uses enabled ones */
+  ret = nemeusLib.loraWan()->ON('A', false);
+  ret = nemeusLib.sigfox()->ON(NULL);
+
+  nemeusLib.scheduler()->register_job_callback(&onJobDone);
+
+  /* Button is in pull down */
+  pinMode(BUTTON, INPUT);
+  attachInterrupt(BUTTON, isr_button, RISING);
+}
+
+void loop()
+{
+  UplinkJob_t job;
+
+  if ((millis() - lastTelemetry) >= TELEMETRY_PERIOD)
+  {
+    lastTelemetry = millis();
+
+    /* Routine telemetry: LoRaWAN only, useless after 10 minutes */
+    job.technologies = UPLINK_LORAWAN;
+    job.priority = UPLINK_PRIORITY_LOW;
+    job.deadline = 600000;
+    job.macPort = 2;
+    job.ack = false;
+    job.encrypt = true;
+    job.size = 2;
+    job.payload[0] = frameCounter >> 8;
+    job.payload[1] = frameCounter & 0xFF;
+    frameCounter++;
+
+    ret = nemeusLib.scheduler()->submit(&job, NULL);
+  }
+
+  if (alarmRaised)
+  {
+    alarmRaised = false;
+
+    /* Alarm: any technology, acknowledged, must leave within 2 minutes */
+    job.technologies = UPLINK_LORAWAN | UPLINK_SIGFOX;
+    job.priority = UPLINK_PRIORITY_URGENT;
+    job.deadline = 120000;
+    job.macPort = 3;
+    job.ack = true;
+    job.encrypt = true;
+    job.size = 1;
+    job.payload[0] = 0xA1;
+
+    ret = nemeusLib.scheduler()->submit(&job, NULL);
+  }
+
+  /* Send what is ready, otherwise poll device until next dispatch */
+  nemeusLib.scheduler()->process();
+
+  uint32_t nextDispatch = nemeusLib.scheduler()->nextDispatchDelay();
+  nemeusLib.pollDevice(nextDispatch < 1000 ? nextDispatch : 1000);
+  nemeusLib.printTraces();
+}
+
+/* ---------------- Functions ---------------- */
+
+void onJobDone(uint8_t jobId, uint8_t technology, uint8_t errorCode)
+{
+  SerialUSB.print("Job ");
+  SerialUSB.print(jobId);
+  if (technology == UPLINK_LORAWAN)
+  {
+    SerialUSB.print(" LoRaWAN");
+  }
+  else if (technology == UPLINK_SIGFOX)
+  {
+    SerialUSB.print(" Sigfox");
+  }
+  SerialUSB.print(" done with code ");
+  SerialUSB.println(errorCode);
+}
+
+void isr_button()
+{
+  alarmRaised = true;
+}
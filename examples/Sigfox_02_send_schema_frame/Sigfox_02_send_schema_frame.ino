@@ -0,0 +1,111 @@
+/* Example for Sigfox using a payload schema
+ *
+ *  Uses Nemeus Library
+ *  The frame layout is declared once as a list of bit fields, its size is
+ *  checked against the 12 bytes of a Sigfox frame at compile time.
+ *  In main loop, sends a frame every 12 minutes composed of :
+ *     - Counter on 12 bits
+ *     - Analog input A0 (0..1023) on 10 bits
+ *     - Battery voltage (2.0..4.0 V by 20 mV) on 7 bits
+ *     - Button state on 1 bit
+ *
+ */
+
+#include <NemeusLib.h>
+#include <Wire.h>
+
+#define BUTTON 11
+#define PERIOD 720000
+
+/* Frame layout: 30 bits, 4 bytes */
+typedef PayloadSchema< PayloadField<12, 0, 4095>,
+                       PayloadField<10, 0, 1023>,
+                       PayloadField<7, 2, 4, 50>,
+                       PayloadField<1, 0, 1> > SensorFrame;
+
+static_assert(SensorFrame::SIZE <= MAXIMUM_SIGFOX_PAYLOAD, "Frame doesn't fit in Sigfox");
+
+uint16_t frameCounter = 0;
+uint8_t ret;
+
+/* Reception callback for RF frames */
+void onReceive(const char *string);
+
+void setup()
+{
+  /* serial monitor */
+  SerialUSB.begin(115200);
+
+#ifdef CONSOLE_CHECK
+  while(!SerialUSB)
+  {
+    ;      /*SerialUSB not ready */
+  }
+  SerialUSB.println(">>Console Ready");
+#endif
+
+  SerialUSB.println(">>Sketch: Sending schema frames using SIGFOX ");
+
+  /* Reset the modem */
+  if ( nemeusLib.resetModem() != NEMEUS_SUCCESS)
+  {
+    SerialUSB.print("Nemeus device is not responding!");
+    while(1)
+    {
+    }
+  }
+
+  /* Init nemeus library */
+  if(nemeusLib.init() != NEMEUS_SUCCESS)
+  {
+    SerialUSB.print("Nemeus device is not responding!");
+    while(1)
+    {
+    }
+  }
+
+  /* Register a callback for reception */
+  nemeusLib.register_at_response_callback(&onReceive);
+
+  /* Turn ON Sigfox */
+  ret = nemeusLib.sigfox()->ON(NULL);
+
+  if(ret == NEMEUS_SUCCESS)
+  {
+    SerialUSB.println("Sigfox ON !!!");
+  }
+  else
+  {
+    SerialUSB.println("Sigfox ON command error !!!");
+  }
+
+  /* Button is in pull down */
+  pinMode(BUTTON, INPUT);
+}
+
+void loop()
+{
+  uint8_t frame[MAXIMUM_SIGFOX_PAYLOAD];
+  char hexFrame[2*MAXIMUM_SIGFOX_PAYLOAD+1];
+  float battery = 3.3;
+
+  /* Pack the fields, values out of range are saturated */
+  SensorFrame::encode(frame, frameCounter++, analogRead(A0), battery, digitalRead(BUTTON));
+  payloadToHex(frame, SensorFrame::SIZE, hexFrame);
+
+  /* Send the frame in binary mode, no ACK */
+  ret = nemeusLib.sigfox()->sendFrame(0, hexFrame, 0);
+
+  nemeusLib.pollDevice(5000);
+  nemeusLib.printTraces();
+
+  delay(PERIOD);
+}
+
+/* ---------------- Functions ---------------- */
+
+void onReceive(const char *string)
+{
+  SerialUSB.print("mm002 >> ");
+  SerialUSB.println(string);
+}
@@ -0,0 +1,169 @@
+/* Benchmark of the library on the board
+ *
+ *  Uses Nemeus Library
+ *  Times AT round trips, LoRaWAN frames at each payload size, radio
+ *  bursts and the handling of the lines received with verbose traces on,
+ *  then prints the results as a table on SerialUSB.
+ *  Run it on the same board, network and radio conditions to compare
+ *  library versions (LoRaWAN times include the duty cycle waits).
+ *
+ */
+
+#include <NemeusLib.h>
+
+/* RF_STATUS round trips */
+#define NB_ROUND_TRIPS 50
+/* LoRaWAN frames per payload size (ABP, unconfirmed) */
+#define NB_LORAWAN_FRAMES 3
+/* Radio bursts, of frames sent back to back */
+#define NB_RADIO_BURSTS 5
+#define RADIO_BURST_LENGTH 5
+#define RADIO_PAYLOAD_SIZE 16
+/* Round trips with verbose traces on */
+#define NB_VERBOSE_ROUND_TRIPS 20
+
+/* LoRaWAN payload sizes in bytes, above the data rate maximum are skipped */
+const uint8_t payloadSizes[] = { 1, 11, 51, 115, 222 };
+#define NB_PAYLOAD_SIZES (sizeof(payloadSizes) / sizeof(payloadSizes[0]))
+
+Measurement roundTrip;
+Measurement loraWanFrames[NB_PAYLOAD_SIZES];
+Measurement radioBursts;
+Measurement parsing;
+uint16_t nbErrors = 0;
+
+/* Binary payload, 2 hexadecimal characters per byte */
+char payload[2*255 + 1];
+
+/* Fill the payload with size bytes */
+void fillPayload(uint16_t size)
+{
+  for (uint16_t i = 0; i < 2*size; i++)
+  {
+    payload[i] = "CAFE"[i % 4];
+  }
+  payload[2*size] = '\0';
+}
+
+/* Count the errors, a frame not acknowledged isn't one */
+void check(uint8_t ret)
+{
+  if ( (ret != NEMEUS_SUCCESS) && (ret != NEMEUS_ERROR_NOACK) )
+  {
+    nbErrors++;
+  }
+}
+
+/* Read the traces without printing them */
+void dropTraces()
+{
+  char line[128];
+
+  while (nemeusLib.availableTraces() > 0)
+  {
+    nemeusLib.readLine(line, sizeof(line));
+  }
+}
+
+void setup()
+{
+  uint8_t maxPayloadSize;
+  char name[24];
+
+  /* serial monitor */
+  SerialUSB.begin(115200);
+
+  while(!SerialUSB)
+  {
+    ;      /*SerialUSB not ready */
+  }
+
+  SerialUSB.println(">>Sketch: Benchmark of the Nemeus library");
+
+  /* Init nemeus library */
+  if(nemeusLib.init() != NEMEUS_SUCCESS)
+  {
+    SerialUSB.print("Nemeus device is not responding!");
+    while(1)
+    {
+    }
+  }
+  nemeusLib.setVerbose(false);
+
+  /* AT round trips */
+  for (uint16_t i = 0; i < NB_ROUND_TRIPS; i++)
+  {
+    roundTrip.start();
+    check(nemeusLib.ping());
+    roundTrip.stop();
+  }
+
+  /* LoRaWAN frames, bytes per second of each payload size */
+  check(nemeusLib.loraWan()->ON('A', false));
+  maxPayloadSize = nemeusLib.loraWan()->getMaximumPayloadSize();
+  for (uint8_t size = 0; size < NB_PAYLOAD_SIZES; size++)
+  {
+    if (payloadSizes[size] > maxPayloadSize)
+    {
+      continue;
+    }
+    fillPayload(payloadSizes[size]);
+    for (uint8_t i = 0; i < NB_LORAWAN_FRAMES; i++)
+    {
+      loraWanFrames[size].start();
+      check(nemeusLib.loraWan()->sendFrame(0, 1, 1, payload, false, true));
+      loraWanFrames[size].stop(payloadSizes[size]);
+    }
+    dropTraces();
+  }
+  check(nemeusLib.loraWan()->OFF());
+
+  /* Radio bursts, frames per second */
+  check(nemeusLib.radio()->ON());
+  fillPayload(RADIO_PAYLOAD_SIZE);
+  for (uint8_t burst = 0; burst < NB_RADIO_BURSTS; burst++)
+  {
+    radioBursts.start();
+    for (uint8_t i = 0; i < RADIO_BURST_LENGTH; i++)
+    {
+      check(nemeusLib.radio()->sendFrame(RADIO_BINARY_MODE, payload, 0));
+    }
+    radioBursts.stop(RADIO_BURST_LENGTH);
+  }
+  check(nemeusLib.radio()->OFF());
+
+  /* Lines received with verbose traces, bytes handled per second */
+  check(nemeusLib.setVerbose(true));
+  nemeusLib.measureLines(&parsing);
+  for (uint16_t i = 0; i < NB_VERBOSE_ROUND_TRIPS; i++)
+  {
+    check(nemeusLib.ping());
+    nemeusLib.pollDevice(100);
+    dropTraces();
+  }
+  nemeusLib.measureLines(NULL);
+  check(nemeusLib.setVerbose(false));
+
+  /* Results */
+  SerialUSB.println("");
+  Measurement::printHeader(SerialUSB);
+  roundTrip.printRow(SerialUSB, "RF_STATUS round trip");
+  for (uint8_t size = 0; size < NB_PAYLOAD_SIZES; size++)
+  {
+    if (loraWanFrames[size].getNbSamples() != 0)
+    {
+      sprintf(name, "LoRaWAN frame %u B", payloadSizes[size]);
+      loraWanFrames[size].printRow(SerialUSB, name);
+    }
+  }
+  radioBursts.printRow(SerialUSB, "Radio burst");
+  parsing.printRow(SerialUSB, "Verbose line handling");
+  SerialUSB.print("Errors: ");
+  SerialUSB.println(nbErrors);
+}
+
+void loop()
+{
+  nemeusLib.pollDevice(5000);
+  dropTraces();
+}
@@ -0,0 +1,85 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * Arduino.h - Thin Arduino core used to build the library on a Linux host
+ * 
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "WString.h"
+#include "Print.h"
+#include "Uart.h"
+
+#define NEMEUS_HOST_BUILD 1
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT           0x0
+#define OUTPUT          0x1
+#define INPUT_PULLUP    0x2
+
+#define CHANGE  2
+#define FALLING 3
+#define RISING  4
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield(void);
+
+void pinMode(uint32_t pin, uint32_t mode);
+void digitalWrite(uint32_t pin, uint32_t value);
+int digitalRead(uint32_t pin);
+int analogRead(uint32_t pin);
+void attachInterrupt(uint32_t pin, void (*callback)(void), uint32_t mode);
+
+static inline boolean isDigit(int c)
+{
+  return (c >= '0') && (c <= '9');
+}
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+/* SERCOM1 RX interrupt, defined by the library (NemeusUART.cpp) */
+void SERCOM1_Handler(void) __attribute__((weak));
+
+#endif /* HOST_ARDUINO_H */
@@ -0,0 +1,349 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * HostArduino.cpp - Thin Arduino core used to build the library on a Linux host
+ * 
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ */
+
+#include <time.h>
+#include <unistd.h>
+
+#include "Arduino.h"
+
+SERCOM sercom0;
+SERCOM sercom1;
+SERCOM sercom2;
+SERCOM sercom3;
+
+Serial_ SerialUSB;
+
+static HostTransport* hostTransport = NULL;
+static bool hostConsole = false;
+static bool inInterrupt = false;
+static uint64_t startTimeUs = 0;
+static bool simulatedTime = false;
+static uint32_t simulatedTimeMs = 0;
+/* RX deliveries, also counts the ones nested in a transport (millis() call) */
+static uint32_t nbInterrupts = 0;
+
+/**
+ * Deliver pending RX bytes through the SERCOM1 "interrupt"
+ */
+static void serviceInterrupts()
+{
+  if ( (inInterrupt == false) && (hostTransport != NULL) && (SERCOM1_Handler != NULL) )
+  {
+    if (hostTransport->available() > 0)
+    {
+      inInterrupt = true;
+      SERCOM1_Handler();
+      inInterrupt = false;
+      nbInterrupts++;
+    }
+  }
+}
+
+/**
+ * Move the simulated time forward, event by event of the transport
+ * @param ms  the time to run
+ * @param untilReceived  stop once bytes are delivered
+ */
+static void runSimulatedTime(uint32_t ms, bool untilReceived)
+{
+  uint32_t nbDelivered = nbInterrupts;
+
+  while (ms > 0)
+  {
+    uint32_t step = ms;
+
+    if (hostTransport != NULL)
+    {
+      step = hostTransport->nextEventDelay(simulatedTimeMs);
+      step = (step == 0) ? 1 : ((step > ms) ? ms : step);
+    }
+    simulatedTimeMs += step;
+    ms -= step;
+    serviceInterrupts();
+    if ( (untilReceived) && (nbInterrupts != nbDelivered) )
+    {
+      break;
+    }
+  }
+}
+
+static uint64_t monotonicUs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+void hostSetTransport(HostTransport* transport)
+{
+  hostTransport = transport;
+}
+
+HostTransport* hostGetTransport()
+{
+  return hostTransport;
+}
+
+void hostSetSimulatedTime(bool isOn)
+{
+  if (isOn != simulatedTime)
+  {
+    /* Continuous time: the simulated one starts from the real one, and back */
+    if (isOn)
+    {
+      simulatedTimeMs = millis();
+    }
+    else
+    {
+      startTimeUs = monotonicUs() - (uint64_t)simulatedTimeMs * 1000ull;
+    }
+    simulatedTime = isOn;
+  }
+}
+
+void hostIdle(uint32_t ms)
+{
+  if (simulatedTime)
+  {
+    runSimulatedTime(ms, true);
+  }
+}
+
+void hostSetConsole(bool isOn)
+{
+  hostConsole = isOn;
+}
+
+unsigned long micros(void)
+{
+  if (simulatedTime)
+  {
+    serviceInterrupts();
+    return (unsigned long)(uint32_t)(simulatedTimeMs * 1000ul);
+  }
+  if (startTimeUs == 0)
+  {
+    startTimeUs = monotonicUs();
+  }
+  serviceInterrupts();
+  return (unsigned long)(uint32_t)(monotonicUs() - startTimeUs);
+}
+
+unsigned long millis(void)
+{
+  if (simulatedTime)
+  {
+    serviceInterrupts();
+    return simulatedTimeMs;
+  }
+  if (startTimeUs == 0)
+  {
+    startTimeUs = monotonicUs();
+  }
+  serviceInterrupts();
+  return (unsigned long)(uint32_t)((monotonicUs() - startTimeUs) / 1000ull);
+}
+
+void delay(unsigned long ms)
+{
+  if (simulatedTime)
+  {
+    runSimulatedTime(ms, false);
+    return;
+  }
+  unsigned long start = millis();
+  while ((millis() - start) < ms)
+  {
+    usleep(100);
+  }
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  usleep(us);
+  serviceInterrupts();
+}
+
+void yield(void)
+{
+  serviceInterrupts();
+}
+
+void pinMode(uint32_t pin, uint32_t mode)
+{
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint32_t pin, uint32_t value)
+{
+  (void)pin;
+  (void)value;
+}
+
+int digitalRead(uint32_t pin)
+{
+  (void)pin;
+  return LOW;
+}
+
+int analogRead(uint32_t pin)
+{
+  (void)pin;
+  return 0;
+}
+
+void attachInterrupt(uint32_t pin, void (*callback)(void), uint32_t mode)
+{
+  (void)pin;
+  (void)callback;
+  (void)mode;
+}
+
+long random(long howbig)
+{
+  if (howbig == 0)
+  {
+    return 0;
+  }
+  return rand() % howbig;
+}
+
+long random(long howsmall, long howbig)
+{
+  if (howsmall >= howbig)
+  {
+    return howsmall;
+  }
+  return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed)
+{
+  if (seed != 0)
+  {
+    srand(seed);
+  }
+}
+
+/* ----- Print ----- */
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+  size_t n = 0;
+  while (size--)
+  {
+    n += write(*buffer++);
+  }
+  return n;
+}
+
+size_t Print::print(long value, int base)
+{
+  return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+  return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(double value, int digits)
+{
+  return print(String(value, (unsigned char)digits));
+}
+
+/* ----- Uart ----- */
+
+Uart::Uart(SERCOM* sercom, uint8_t pinRX, uint8_t pinTX, SercomRXPad padRX, SercomUartTXPad padTX) : isOpen_(false)
+{
+  (void)sercom;
+  (void)pinRX;
+  (void)pinTX;
+  (void)padRX;
+  (void)padTX;
+}
+
+void Uart::begin(unsigned long baudrate)
+{
+  isOpen_ = true;
+  if (hostTransport != NULL)
+  {
+    hostTransport->begin(baudrate);
+  }
+}
+
+void Uart::end()
+{
+  if ( (isOpen_ == true) && (hostTransport != NULL) )
+  {
+    hostTransport->end();
+  }
+  isOpen_ = false;
+}
+
+int Uart::available()
+{
+  return (hostTransport != NULL) ? hostTransport->available() : 0;
+}
+
+int Uart::read()
+{
+  return (hostTransport != NULL) ? hostTransport->read() : -1;
+}
+
+size_t Uart::write(uint8_t c)
+{
+  return write(&c, 1);
+}
+
+size_t Uart::write(const uint8_t* buffer, size_t size)
+{
+  if (hostTransport == NULL)
+  {
+    return size;
+  }
+  return hostTransport->write(buffer, size);
+}
+
+/* ----- SerialUSB ----- */
+
+size_t Serial_::write(uint8_t c)
+{
+  return write(&c, 1);
+}
+
+size_t Serial_::write(const uint8_t* buffer, size_t size)
+{
+  if (hostConsole)
+  {
+    fwrite(buffer, 1, size, stdout);
+  }
+  return size;
+}
+
+Serial_::operator bool()
+{
+  return hostConsole;
+}
@@ -0,0 +1,68 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * HostTransport.h - Pluggable byte transport behind the host Uart stand-in
+ * 
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ */
+
+#ifndef HOST_TRANSPORT_H
+#define HOST_TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* No byte expected before the next write (nextEventDelay) */
+#define HOST_TRANSPORT_NO_EVENT 0xFFFFFFFFul
+
+/**
+ * Byte transport plugged behind a host Uart (the MM002 side of Serial2).
+ * write() carries bytes from the library to the modem, read()/available()
+ * carry bytes from the modem to the library.
+ *
+ * With the simulated time, nextEventDelay() tells how far the time can jump
+ * without missing a byte (1 ms steps if not known).
+ */
+class HostTransport
+{
+  public:
+    virtual ~HostTransport() {}
+    virtual void begin(uint32_t baudrate) { (void)baudrate; }
+    virtual void end() {}
+    virtual size_t write(const uint8_t* buffer, size_t size) = 0;
+    virtual int available() = 0;
+    virtual int read() = 0;
+    /* Time in ms from now to the next byte available, HOST_TRANSPORT_NO_EVENT if none */
+    virtual uint32_t nextEventDelay(uint32_t now) { (void)now; return 1; }
+};
+
+/* Attach a transport to the host Serial2 (NULL to detach) */
+void hostSetTransport(HostTransport* transport);
+HostTransport* hostGetTransport();
+
+/* Simulated time: millis() only moves in delay() and hostIdle(), straight
+   to the next byte of the transport */
+void hostSetSimulatedTime(bool isOn);
+/* Let the (simulated) time run for up to ms, until bytes are received */
+void hostIdle(uint32_t ms);
+
+/* Enable/disable the SerialUSB console (stdout) of the host build */
+void hostSetConsole(bool isOn);
+
+#endif /* HOST_TRANSPORT_H */
@@ -0,0 +1,95 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * Uart.h - Host stand-in for the SAMD Uart/SERCOM and USB serial classes
+ * 
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ */
+
+#ifndef HOST_UART_H
+#define HOST_UART_H
+
+#include "Print.h"
+#include "HostTransport.h"
+
+enum SercomRXPad
+{
+  SERCOM_RX_PAD_0 = 0,
+  SERCOM_RX_PAD_1,
+  SERCOM_RX_PAD_2,
+  SERCOM_RX_PAD_3
+};
+
+enum SercomUartTXPad
+{
+  UART_TX_PAD_0 = 0,
+  UART_TX_PAD_2,
+  UART_TX_RTS_CTS_PAD_0_2_3
+};
+
+class SERCOM
+{
+};
+
+extern SERCOM sercom0;
+extern SERCOM sercom1;
+extern SERCOM sercom2;
+extern SERCOM sercom3;
+
+/**
+ * Hardware UART. Bytes go through the transport attached with
+ * hostSetTransport(); received bytes are delivered through IrqHandler()
+ * which the host core calls from millis()/delay() like a RX interrupt.
+ */
+class Uart : public Stream
+{
+  public:
+    Uart(SERCOM* sercom, uint8_t pinRX, uint8_t pinTX, SercomRXPad padRX, SercomUartTXPad padTX);
+    void begin(unsigned long baudrate);
+    void end();
+    int available();
+    int read();
+    void IrqHandler() {}
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buffer, size_t size);
+    using Print::write;
+    operator bool() { return true; }
+  private:
+    bool isOpen_;
+};
+
+/**
+ * USB CDC console, printed on stdout when enabled with hostSetConsole()
+ */
+class Serial_ : public Stream
+{
+  public:
+    void begin(unsigned long baudrate) { (void)baudrate; }
+    void end() {}
+    int available() { return 0; }
+    int read() { return -1; }
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buffer, size_t size);
+    using Print::write;
+    operator bool();
+};
+
+extern Serial_ SerialUSB;
+
+#endif /* HOST_UART_H */
@@ -0,0 +1,375 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * WString.cpp - Host stand-in for the Arduino String class
+ * 
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ */
+
+#include <stdio.h>
+
+#include "WString.h"
+
+static void formatInteger(char* out, unsigned long value, bool negative, unsigned char base)
+{
+  char digits[34];
+  int i = 0;
+
+  if (base < 2)
+  {
+    base = 10;
+  }
+
+  do
+  {
+    uint8_t digit = value % base;
+    digits[i++] = (digit < 10) ? ('0' + digit) : ('A' + digit - 10);
+    value /= base;
+  }
+  while (value != 0);
+
+  if (negative)
+  {
+    *out++ = '-';
+  }
+  while (i > 0)
+  {
+    *out++ = digits[--i];
+  }
+  *out = '\0';
+}
+
+String::String(const char* cstr) : buffer_(NULL), capacity_(0), len_(0)
+{
+  copy(cstr != NULL ? cstr : "", cstr != NULL ? strlen(cstr) : 0);
+}
+
+String::String(const String& str) : buffer_(NULL), capacity_(0), len_(0)
+{
+  copy(str.buffer_, str.len_);
+}
+
+String::String(char c) : buffer_(NULL), capacity_(0), len_(0)
+{
+  char buf[2] = { c, '\0' };
+  copy(buf, 1);
+}
+
+String::String(unsigned char value, unsigned char base) : buffer_(NULL), capacity_(0), len_(0)
+{
+  char buf[34];
+  formatInteger(buf, value, false, base);
+  copy(buf, strlen(buf));
+}
+
+String::String(int value, unsigned char base) : buffer_(NULL), capacity_(0), len_(0)
+{
+  char buf[34];
+  if ( (base == 10) && (value < 0) )
+  {
+    formatInteger(buf, -(long)value, true, base);
+  }
+  else
+  {
+    formatInteger(buf, (unsigned int)value, false, base);
+  }
+  copy(buf, strlen(buf));
+}
+
+String::String(unsigned int value, unsigned char base) : buffer_(NULL), capacity_(0), len_(0)
+{
+  char buf[34];
+  formatInteger(buf, value, false, base);
+  copy(buf, strlen(buf));
+}
+
+String::String(long value, unsigned char base) : buffer_(NULL), capacity_(0), len_(0)
+{
+  char buf[34];
+  if ( (base == 10) && (value < 0) )
+  {
+    formatInteger(buf, -(unsigned long)value, true, base);
+  }
+  else
+  {
+    formatInteger(buf, (uint32_t)value, false, base);
+  }
+  copy(buf, strlen(buf));
+}
+
+String::String(unsigned long value, unsigned char base) : buffer_(NULL), capacity_(0), len_(0)
+{
+  char buf[34];
+  formatInteger(buf, (uint32_t)value, false, base);
+  copy(buf, strlen(buf));
+}
+
+String::String(float value, unsigned char decimalPlaces) : buffer_(NULL), capacity_(0), len_(0)
+{
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, (double)value);
+  copy(buf, strlen(buf));
+}
+
+String::String(double value, unsigned char decimalPlaces) : buffer_(NULL), capacity_(0), len_(0)
+{
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+  copy(buf, strlen(buf));
+}
+
+String::~String()
+{
+  free(buffer_);
+}
+
+String& String::operator=(const String& rhs)
+{
+  if (this != &rhs)
+  {
+    copy(rhs.buffer_, rhs.len_);
+  }
+  return *this;
+}
+
+String& String::operator=(const char* cstr)
+{
+  copy(cstr != NULL ? cstr : "", cstr != NULL ? strlen(cstr) : 0);
+  return *this;
+}
+
+bool String::reserve(unsigned int size)
+{
+  if ( (buffer_ != NULL) && (capacity_ >= size) )
+  {
+    return true;
+  }
+
+  char* newBuffer = (char*)realloc(buffer_, size + 1);
+  if (newBuffer == NULL)
+  {
+    return false;
+  }
+  if (buffer_ == NULL)
+  {
+    newBuffer[0] = '\0';
+  }
+  buffer_ = newBuffer;
+  capacity_ = size;
+  return true;
+}
+
+void String::copy(const char* cstr, unsigned int length)
+{
+  if (!reserve(length))
+  {
+    len_ = 0;
+    return;
+  }
+  memmove(buffer_, cstr, length);
+  buffer_[length] = '\0';
+  len_ = length;
+}
+
+bool String::concat(const char* cstr)
+{
+  if (cstr == NULL)
+  {
+    return false;
+  }
+  unsigned int addLength = strlen(cstr);
+  if (!reserve(len_ + addLength))
+  {
+    return false;
+  }
+  memmove(buffer_ + len_, cstr, addLength + 1);
+  len_ += addLength;
+  return true;
+}
+
+bool String::concat(const String& str)
+{
+  return concat(str.buffer_);
+}
+
+bool String::concat(char c)
+{
+  char buf[2] = { c, '\0' };
+  return concat(buf);
+}
+
+bool String::equals(const String& str) const
+{
+  return (len_ == str.len_) && (strcmp(buffer_, str.buffer_) == 0);
+}
+
+bool String::equals(const char* cstr) const
+{
+  if (cstr == NULL)
+  {
+    return len_ == 0;
+  }
+  return strcmp(buffer_, cstr) == 0;
+}
+
+bool String::startsWith(const String& prefix) const
+{
+  if (prefix.len_ > len_)
+  {
+    return false;
+  }
+  return strncmp(buffer_, prefix.buffer_, prefix.len_) == 0;
+}
+
+bool String::endsWith(const String& suffix) const
+{
+  if (suffix.len_ > len_)
+  {
+    return false;
+  }
+  return strcmp(buffer_ + len_ - suffix.len_, suffix.buffer_) == 0;
+}
+
+char String::charAt(unsigned int index) const
+{
+  if (index >= len_)
+  {
+    return 0;
+  }
+  return buffer_[index];
+}
+
+void String::toCharArray(char* buf, unsigned int bufsize, unsigned int index) const
+{
+  if ( (bufsize == 0) || (buf == NULL) )
+  {
+    return;
+  }
+  if (index >= len_)
+  {
+    buf[0] = '\0';
+    return;
+  }
+  unsigned int n = bufsize - 1;
+  if (n > len_ - index)
+  {
+    n = len_ - index;
+  }
+  memcpy(buf, buffer_ + index, n);
+  buf[n] = '\0';
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const
+{
+  if (fromIndex >= len_)
+  {
+    return -1;
+  }
+  const char* found = strchr(buffer_ + fromIndex, ch);
+  return (found == NULL) ? -1 : (int)(found - buffer_);
+}
+
+int String::indexOf(const char* str, unsigned int fromIndex) const
+{
+  if (fromIndex >= len_)
+  {
+    return -1;
+  }
+  const char* found = strstr(buffer_ + fromIndex, str);
+  return (found == NULL) ? -1 : (int)(found - buffer_);
+}
+
+int String::indexOf(const String& str, unsigned int fromIndex) const
+{
+  return indexOf(str.buffer_, fromIndex);
+}
+
+int String::lastIndexOf(char ch) const
+{
+  const char* found = strrchr(buffer_, ch);
+  return (found == NULL) ? -1 : (int)(found - buffer_);
+}
+
+String String::substring(unsigned int beginIndex) const
+{
+  return substring(beginIndex, len_);
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const
+{
+  String out;
+  if (beginIndex > endIndex)
+  {
+    unsigned int temp = endIndex;
+    endIndex = beginIndex;
+    beginIndex = temp;
+  }
+  if (beginIndex >= len_)
+  {
+    return out;
+  }
+  if (endIndex > len_)
+  {
+    endIndex = len_;
+  }
+  out.copy(buffer_ + beginIndex, endIndex - beginIndex);
+  return out;
+}
+
+long String::toInt() const
+{
+  return atol(buffer_);
+}
+
+float String::toFloat() const
+{
+  return (float)atof(buffer_);
+}
+
+void String::trim()
+{
+  unsigned int begin = 0;
+  unsigned int end = len_;
+
+  while ( (begin < end) && ((buffer_[begin] == ' ') || (buffer_[begin] == '\t') || (buffer_[begin] == '\r') || (buffer_[begin] == '\n')) )
+  {
+    begin++;
+  }
+  while ( (end > begin) && ((buffer_[end-1] == ' ') || (buffer_[end-1] == '\t') || (buffer_[end-1] == '\r') || (buffer_[end-1] == '\n')) )
+  {
+    end--;
+  }
+  memmove(buffer_, buffer_ + begin, end - begin);
+  len_ = end - begin;
+  buffer_[len_] = '\0';
+}
+
+String operator+(const String& lhs, const String& rhs)
+{
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+
+String operator+(const String& lhs, const char* rhs)
+{
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
@@ -0,0 +1,157 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * ArgumentBenchmarks.cpp - AT command arguments: sendFrame(),
+ *                  getMaximumPayloadSize() and generateArguments()
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "NemeusBenchmark.h"
+
+/* 240 bytes, fits at SF7BW125 (242 bytes at most) */
+static const char PAYLOAD_HEX[] =
+  "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+  "202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+  "404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+  "606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+  "808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+  "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+  "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+  "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEF";
+
+/* Data rate known, as after the MAC startup */
+static void knowDataRate()
+{
+  receiveLines("+MAC: RDR,SF7BW125,14,00FF,0,1\r\n");
+}
+
+/* Frame formatted and sent, the modem answers at once */
+static void sendFrame(benchmark::State& state, uint8_t mode, const char* payload)
+{
+  ReplayTransport transport;
+  uint64_t start;
+
+  knowDataRate();
+  transport.load("OK\r\n");
+  hostSetTransport(&transport);
+  /* Encryption set once, then unchanged by the frames */
+  LoRaWAN::getInstance()->setEncryption(false);
+  NemeusUART::getInstance()->pollDevice(1);
+
+  start = benchmarkAllocations();
+  for (auto _ : state)
+  {
+    transport.rewind();
+    benchmark::DoNotOptimize(LoRaWAN::getInstance()->sendFrame(mode, 1, 3, payload, false, false));
+  }
+  reportAllocations(state, start);
+
+  hostSetTransport(NULL);
+}
+BENCHMARK_CAPTURE(sendFrame, Binary, BINARY_MODE, PAYLOAD_HEX);
+BENCHMARK_CAPTURE(sendFrame, Text, TEXT_MODE, "temperature=21.5;humidity=48");
+
+static void BM_GetMaximumPayloadSize(benchmark::State& state)
+{
+  uint64_t start;
+
+  knowDataRate();
+  start = benchmarkAllocations();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(LoRaWAN::getInstance()->getMaximumPayloadSize());
+  }
+  reportAllocations(state, start);
+}
+BENCHMARK(BM_GetMaximumPayloadSize);
+
+/* Arguments of a command, every value present */
+template <typename Param>
+static void generateArguments(benchmark::State& state, const Param& param)
+{
+  char buffer[NEMEUS_UART_TX_ARGUMENTS_SIZE];
+  ArgumentWriter arguments(buffer, sizeof(buffer));
+  uint64_t start = benchmarkAllocations();
+
+  for (auto _ : state)
+  {
+    arguments.clear();
+    benchmark::DoNotOptimize(param.generateArguments(arguments));
+  }
+  reportAllocations(state, start);
+}
+
+static MacDataRate fullMacDataRate()
+{
+  MacDataRate macDataRate;
+
+  macDataRate.setDataRate(MAC_DR_SF9BW125);
+  macDataRate.setTxPower(14);
+  macDataRate.setChannelMask(0x00FF);
+  macDataRate.setChannelMaskCtrl(0);
+  macDataRate.setNbRepetition(1);
+
+  return macDataRate;
+}
+
+static MacChannel fullMacChannel()
+{
+  MacChannel macChannel;
+
+  macChannel.setChannelNumber(3, 0);
+  macChannel.setFrequency(868300000);
+  macChannel.setMinDataRate(MAC_DR_SF12BW125);
+  macChannel.setMaxDataRate(MAC_DR_SF7BW125);
+  macChannel.setDutyCycle(1);
+
+  return macChannel;
+}
+
+static RadioTxParam fullRadioTxParam()
+{
+  RadioTxParam radioTxParam;
+
+  radioTxParam.setMode(RADIO_LORA_MODE);
+  radioTxParam.setFrequency(868100000);
+  radioTxParam.setBandwidth(125000);
+  radioTxParam.setDataRate(7);
+  radioTxParam.setCodeRate(1);
+  radioTxParam.setTxPower(14);
+
+  return radioTxParam;
+}
+
+static RadioRxParam fullRadioRxParam()
+{
+  RadioRxParam radioRxParam;
+
+  radioRxParam.setMode(RADIO_FSK_MODE);
+  radioRxParam.setFrequency(869525000);
+  radioRxParam.setBandwidth(50000);
+  radioRxParam.setDataRate(50);
+  radioRxParam.setCodeRate(0);
+
+  return radioRxParam;
+}
+
+BENCHMARK_CAPTURE(generateArguments, MacDataRate, fullMacDataRate());
+BENCHMARK_CAPTURE(generateArguments, MacChannel, fullMacChannel());
+BENCHMARK_CAPTURE(generateArguments, RadioTxParam, fullRadioTxParam());
+BENCHMARK_CAPTURE(generateArguments, RadioRxParam, fullRadioRxParam());
@@ -0,0 +1,109 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * AtResponseBenchmarks.cpp - Lines received from the modem: commands to
+ *                  their result, unsollicited lines to the callbacks
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "NemeusBenchmark.h"
+
+/* Recorded exchanges, from the first byte received to the result */
+static const char READ_DATA_RATE_LINES[] =
+  "+MAC: SF10BW125,14,00FF,0,1\r\n"
+  "OK\r\n";
+static const char SEND_LINES[] =
+  "+MAC: SND,1500\r\n"
+  "OK\r\n";
+static const char SEND_WITH_TRACES_LINES[] =
+  "[0001234] MAC: tx request port 3 size 16\r\n"
+  "+MAC: SND,1500\r\n"
+  "[0002734] RADIO: tx done ch 868100000 SF10BW125\r\n"
+  "[0003734] RADIO: rx1 timeout\r\n"
+  "[0004734] RADIO: rx2 timeout\r\n"
+  "OK\r\n";
+static const char DOWNLINK_LINES[] =
+  "+MAC: SND,0\r\n"
+  "+MAC: RCVBIN,2,false,CAFE0102030405060708,-85,7\r\n"
+  "OK\r\n";
+static const char READ_CHANNEL_LINES[] =
+  "+MAC: 3,868100000,SF12BW125,SF7BW125,1,0\r\n"
+  "OK\r\n";
+static const char MAC_STATUS_LINES[] =
+  "+MAC: ON,1.0.2,A,1,868,1\r\n"
+  "OK\r\n";
+static const char READ_ADR_LINES[] =
+  "+MAC: true,false\r\n"
+  "OK\r\n";
+
+/**
+ * Command sent, bytes of the answer delivered by the UART interrupt, split
+ * into lines, parsed by the callbacks until the result
+ */
+static void sendATCommand(benchmark::State& state, const AtCommand& command, const char* lines)
+{
+  ReplayTransport transport;
+  uint64_t start;
+
+  transport.load(lines);
+  hostSetTransport(&transport);
+
+  start = benchmarkAllocations();
+  for (auto _ : state)
+  {
+    transport.rewind();
+    benchmark::DoNotOptimize(NemeusUART::getInstance()->sendATCommand(command, NULL, 2000));
+    clearTraces();
+  }
+  reportAllocations(state, start);
+
+  hostSetTransport(NULL);
+}
+BENCHMARK_CAPTURE(sendATCommand, ReadDataRate, MAC_READ_DATA_RATE, READ_DATA_RATE_LINES);
+BENCHMARK_CAPTURE(sendATCommand, ReadChannel, MAC_READ_CHANNEL, READ_CHANNEL_LINES);
+BENCHMARK_CAPTURE(sendATCommand, MacStatus, MAC_STATUS, MAC_STATUS_LINES);
+BENCHMARK_CAPTURE(sendATCommand, ReadAdr, MAC_READ_ADR, READ_ADR_LINES);
+BENCHMARK_CAPTURE(sendATCommand, Send, MAC_SEND, SEND_LINES);
+BENCHMARK_CAPTURE(sendATCommand, SendWithTraces, MAC_SEND, SEND_WITH_TRACES_LINES);
+BENCHMARK_CAPTURE(sendATCommand, Downlink, MAC_SEND, DOWNLINK_LINES);
+
+/* Unsollicited line, no command in flight */
+static void unsollicitedResponse(benchmark::State& state, const char* line)
+{
+  ReplayTransport transport;
+  uint64_t start;
+
+  transport.load(line);
+  hostSetTransport(&transport);
+
+  start = benchmarkAllocations();
+  for (auto _ : state)
+  {
+    transport.rewind();
+    NemeusUART::getInstance()->pollDevice(1);
+  }
+  reportAllocations(state, start);
+
+  hostSetTransport(NULL);
+}
+BENCHMARK_CAPTURE(unsollicitedResponse, Send, "+MAC: SND,1500\r\n");
+BENCHMARK_CAPTURE(unsollicitedResponse, Downlink, "+MAC: RCVBIN,2,false,CAFE0102030405060708,-85,7\r\n");
+BENCHMARK_CAPTURE(unsollicitedResponse, DevAddr, "+MAC: RDEVADDR,0870C367,000013\r\n");
+BENCHMARK_CAPTURE(unsollicitedResponse, DataRate, "+MAC: RDR,SF7BW125,14,00FF,0,1\r\n");
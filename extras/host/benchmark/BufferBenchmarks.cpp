@@ -0,0 +1,79 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * BufferBenchmarks.cpp - CircBuffer write, read and readLine
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string.h>
+
+#include "NemeusBenchmark.h"
+
+/* Typical line of the modem, CRLF ended */
+static const char LINE[] = "+MAC: RCVBIN,2,false,CAFE0102030405060708090A0B0C0D0E0F,-85,7\r\n";
+
+/* Byte per byte, as the SERCOM1 interrupt writes and traces are read */
+static void BM_CircBufferWriteReadByte(benchmark::State& state)
+{
+  static CircBuffer buffer;
+  uint64_t start = benchmarkAllocations();
+
+  for (auto _ : state)
+  {
+    buffer.write('A');
+    benchmark::DoNotOptimize(buffer.read());
+  }
+  reportAllocations(state, start);
+}
+BENCHMARK(BM_CircBufferWriteReadByte);
+
+static void BM_CircBufferWriteRead(benchmark::State& state)
+{
+  static CircBuffer buffer;
+  char destination[CIRCULAR_BUFFER_SIZE];
+  int size = (int)state.range(0);
+  std::string source(size, 'A');
+  uint64_t start = benchmarkAllocations();
+
+  for (auto _ : state)
+  {
+    buffer.write(source.data(), size);
+    benchmark::DoNotOptimize(buffer.read(destination, size));
+  }
+  reportAllocations(state, start);
+  state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_CircBufferWriteRead)->Arg(16)->Arg(256)->Arg(2048);
+
+/* Line received then read until LF, as waitForAtResponse() does */
+static void BM_CircBufferReadLine(benchmark::State& state)
+{
+  static CircBuffer buffer;
+  char line[TRACE_BUF_SZ];
+  uint64_t start = benchmarkAllocations();
+
+  for (auto _ : state)
+  {
+    buffer.write(LINE, sizeof(LINE) - 1);
+    benchmark::DoNotOptimize(buffer.readLine(line, sizeof(line)));
+  }
+  reportAllocations(state, start);
+}
+BENCHMARK(BM_CircBufferReadLine);
@@ -0,0 +1,102 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * NemeusBenchmark.cpp - Allocation counting, modem lines and main of the
+ *                  benchmarks
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stddef.h>
+
+#include "NemeusBenchmark.h"
+#include "SimulatedClock.h"
+
+/* glibc allocator, wrapped to count the allocations of the whole program */
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* pointer, size_t size);
+
+static uint64_t nbAllocations = 0;
+
+extern "C" void* malloc(size_t size)
+{
+  nbAllocations++;
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+  nbAllocations++;
+  return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* pointer, size_t size)
+{
+  nbAllocations++;
+  return __libc_realloc(pointer, size);
+}
+
+uint64_t benchmarkAllocations()
+{
+  return nbAllocations;
+}
+
+void reportAllocations(benchmark::State& state, uint64_t start)
+{
+  state.counters["allocs/op"] = benchmark::Counter((double)(benchmarkAllocations() - start),
+                                                   benchmark::Counter::kAvgIterations);
+}
+
+void receiveLines(const char* lines)
+{
+  ReplayTransport transport;
+
+  transport.load(lines);
+  hostSetTransport(&transport);
+  NemeusUART::getInstance()->pollDevice(1);
+  hostSetTransport(NULL);
+}
+
+void clearTraces()
+{
+  char traces[TRACE_BUF_SZ];
+
+  while (NemeusUART::getInstance()->availableTraces() > 0)
+  {
+    NemeusUART::getInstance()->readTracesBuffer(traces, sizeof(traces));
+  }
+}
+
+int main(int argc, char** argv)
+{
+  SimulatedClock simulatedClock;
+
+  /* Wake up, TX pacing and AT timeouts take no host time, only the library is measured */
+  simulatedClock.start();
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+  {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+
+  return 0;
+}
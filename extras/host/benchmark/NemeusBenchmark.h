@@ -0,0 +1,75 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * NemeusBenchmark.h - Host microbenchmarks of the library hot paths
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef NEMEUS_BENCHMARK_H
+#define NEMEUS_BENCHMARK_H
+
+#include <stdint.h>
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "HostTransport.h"
+#include "NemeusLib.h"
+
+/**
+ * Number of heap allocations (malloc, calloc, realloc, new) since the start
+ */
+uint64_t benchmarkAllocations();
+
+/**
+ * Report the allocations made since start as allocs/op
+ */
+void reportAllocations(benchmark::State& state, uint64_t start);
+
+/**
+ * Modem side replaying recorded lines, rewound before each operation
+ */
+class ReplayTransport : public HostTransport
+{
+  public:
+    void load(const char* lines) { lines_ = lines; position_ = 0; }
+    void rewind() { position_ = 0; }
+    size_t write(const uint8_t* buffer, size_t size) { (void)buffer; return size; }
+    int available() { return (int)(lines_.size() - position_); }
+    int read() { return (position_ < lines_.size()) ? (unsigned char)lines_[position_++] : -1; }
+    /* Every line is already there, the simulated time jumps once they are read */
+    uint32_t nextEventDelay(uint32_t now) { (void)now; return (position_ < lines_.size()) ? 0 : HOST_TRANSPORT_NO_EVENT; }
+  private:
+    std::string lines_;
+    size_t position_;
+};
+
+/**
+ * Lines received outside a command, filtered by the callbacks (pollDevice())
+ */
+void receiveLines(const char* lines);
+
+/**
+ * Forget the traces received
+ */
+void clearTraces();
+
+#endif /* NEMEUS_BENCHMARK_H */
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+#       __         __         __
+#  |\ |  |_   |\/|  |_   |  |  (_
+#  | \|  |__  |  |  |__  |__|  __)
+#
+# compare.py - Compare a benchmark run with the baseline
+#
+#   nemeus_benchmark --benchmark_repetitions=5 --benchmark_report_aggregates_only=true \
+#                    --benchmark_out=run.json
+#   compare.py extras/host/benchmark/baseline.json run.json [--threshold 0.25]
+#
+# Exits with 1 when a benchmark is slower than the baseline by more than the
+# threshold or allocates more per operation.
+#
+# Copyright (C) 2017 Nemeus - All Rights Reserved
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    """Results by name, the median of the repetitions when there are some"""
+    with open(path) as f:
+        benchmarks = json.load(f)["benchmarks"]
+    medians = {b["run_name"]: b for b in benchmarks
+               if (b.get("run_type") == "aggregate") and (b.get("aggregate_name") == "median")}
+    if medians:
+        return medians
+    return {b["name"]: b for b in benchmarks if b.get("run_type", "iteration") == "iteration"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("baseline")
+    parser.add_argument("run")
+    parser.add_argument("--threshold", type=float, default=0.25,
+                        help="relative time increase reported as a regression (default 0.25)")
+    options = parser.parse_args()
+
+    baseline = load(options.baseline)
+    run = load(options.run)
+    regressions = 0
+
+    print("%-36s %10s %10s %8s %10s %10s" % ("Benchmark", "base ns", "run ns", "delta", "base alloc", "run alloc"))
+    for name, current in run.items():
+        reference = baseline.get(name)
+        if reference is None:
+            print("%-36s %10s %10.1f %8s %10s %10.1f" % (name, "-", current["cpu_time"], "new", "-",
+                                                      current.get("allocs/op", 0)))
+            continue
+
+        delta = current["cpu_time"] / reference["cpu_time"] - 1
+        allocations = (reference.get("allocs/op", 0), current.get("allocs/op", 0))
+        status = ""
+        if (delta > options.threshold) or (allocations[1] > allocations[0]):
+            status = "  REGRESSION"
+            regressions += 1
+        print("%-36s %10.1f %10.1f %+7.0f%% %10.1f %10.1f%s" % (name, reference["cpu_time"], current["cpu_time"],
+                                                             100 * delta, allocations[0], allocations[1], status))
+
+    for name in baseline:
+        if name not in run:
+            print("%-36s missing from the run" % name)
+
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
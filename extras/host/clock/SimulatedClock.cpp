@@ -0,0 +1,81 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * SimulatedClock.cpp - Library clock on the simulated time of the host core
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "Arduino.h"
+#include "HostTransport.h"
+#include "SimulatedClock.h"
+
+/**
+ * Switch to the simulated time (from the current time) in the library
+ */
+void SimulatedClock::start()
+{
+  hostSetSimulatedTime(true);
+  NemeusClock::set(this);
+}
+
+/**
+ * Back to the real time
+ */
+void SimulatedClock::stop()
+{
+  NemeusClock::set(NULL);
+  hostSetSimulatedTime(false);
+}
+
+/**
+ * Run the simulated time
+ * @param ms  the time in ms
+ */
+void SimulatedClock::advance(uint32_t ms)
+{
+  ::delay(ms);
+}
+
+/**
+ * Get the simulated time
+ * @return  the time in ms
+ */
+uint32_t SimulatedClock::now()
+{
+  return millis();
+}
+
+/**
+ * Wait, the time jumps from byte to byte of the transport
+ * @param ms  the delay in ms
+ */
+void SimulatedClock::delay(uint32_t ms)
+{
+  ::delay(ms);
+}
+
+/**
+ * Nothing to do, go to the next byte of the transport
+ * @param ms  the maximum time in ms
+ */
+void SimulatedClock::idle(uint32_t ms)
+{
+  hostIdle(ms);
+}
@@ -0,0 +1,60 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * SimulatedClock.h - Library clock on the simulated time of the host core
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef SIMULATED_CLOCK_H
+#define SIMULATED_CLOCK_H
+
+#include <stdint.h>
+
+#include "Utils/NemeusClock.h"
+
+/**
+ * Usage:
+ *   Mm002Simulator modem;
+ *   SimulatedClock clock;
+ *   hostSetTransport(&modem);
+ *   clock.start();
+ *   nemeusLib.init();       // answered at once, in simulated time
+ *
+ * Delays and AT timeouts jump to the next byte the transport announces
+ * (HostTransport::nextEventDelay()), so a join or a send takes the time of
+ * the scenario in millis() and almost none on the host.
+ */
+class SimulatedClock : public NemeusClock
+{
+  public:
+    /* Use the simulated time, in the library and in millis() */
+    void start();
+    /* Back to the real time and the default clock */
+    void stop();
+    /* Run the time (bytes due are delivered) */
+    void advance(uint32_t ms);
+
+    /* NemeusClock */
+    uint32_t now();
+    void delay(uint32_t ms);
+    void idle(uint32_t ms);
+};
+
+#endif /* SIMULATED_CLOCK_H */
@@ -0,0 +1,292 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * FaultTransport.cpp - Transport wrapper injecting UART faults: lost and
+ *                  flipped bits, duplicated lines, stalls and overruns.
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdlib.h>
+
+#include <sstream>
+#include <vector>
+
+#include "Arduino.h"
+#include "FaultTransport.h"
+
+FaultTransport::FaultTransport(HostTransport& transport)
+  : transport_(transport), pulling_(false), seed_(1),
+    dropRate_(0), flipRate_(0), duplicateRate_(0), stallRate_(0), stallTime_(0),
+    overrunRate_(0), overrunLength_(0), stalled_(false), stallEnd_(0),
+    nbLines_(0), nbDropped_(0), nbFlipped_(0), nbDuplicated_(0), nbStalls_(0), nbOverruns_(0),
+    faulty_(false), faultTime_(0), onLine_(NULL)
+{
+}
+
+size_t FaultTransport::write(const uint8_t* buffer, size_t size)
+{
+  return transport_.write(buffer, size);
+}
+
+int FaultTransport::available()
+{
+  pull();
+
+  return (stalled_) ? 0 : (int)output_.size();
+}
+
+int FaultTransport::read()
+{
+  int c;
+
+  if ( (stalled_) || (output_.empty()) )
+  {
+    return -1;
+  }
+  c = (unsigned char)output_.front();
+  output_.pop_front();
+
+  return c;
+}
+
+/**
+ * Time to the next byte: end of a stall or next byte of the wrapped transport
+ */
+uint32_t FaultTransport::nextEventDelay(uint32_t now)
+{
+  if (stalled_)
+  {
+    return ((int32_t)(stallEnd_ - now) > 0) ? stallEnd_ - now : 0;
+  }
+  if (!output_.empty())
+  {
+    return 0;
+  }
+
+  return transport_.nextEventDelay(now);
+}
+
+/**
+ * Configure a fault
+ *   drop <rate>              bytes lost
+ *   flip <rate>              bytes with a bit inverted
+ *   duplicate <rate>         lines received twice
+ *   stall <rate> <ms>        nothing received during ms after a line
+ *   overrun <rate> <bytes>   bytes lost in a row (RX overrun)
+ *   seed <n>                 generator seed
+ * @return  false if the key isn't a fault one (or wrong values)
+ */
+bool FaultTransport::configure(const std::string& line)
+{
+  std::istringstream stream(line.substr(0, line.find('#')));
+  std::string key;
+  std::vector<double> values;
+  double value;
+
+  if (!(stream >> key))
+  {
+    /* Empty or comment */
+    return true;
+  }
+  while (stream >> value)
+  {
+    values.push_back(value);
+  }
+
+  if ( (key == "drop") && (values.size() == 1) )
+  {
+    dropRate_ = values[0];
+  }
+  else if ( (key == "flip") && (values.size() == 1) )
+  {
+    flipRate_ = values[0];
+  }
+  else if ( (key == "duplicate") && (values.size() == 1) )
+  {
+    duplicateRate_ = values[0];
+  }
+  else if ( (key == "stall") && (values.size() == 2) )
+  {
+    stallRate_ = values[0];
+    stallTime_ = (uint32_t)values[1];
+  }
+  else if ( (key == "overrun") && (values.size() == 2) )
+  {
+    overrunRate_ = values[0];
+    overrunLength_ = (uint32_t)values[1];
+  }
+  else if ( (key == "seed") && (values.size() == 1) )
+  {
+    setSeed((uint32_t)values[0]);
+  }
+  else
+  {
+    return false;
+  }
+
+  return true;
+}
+
+void FaultTransport::setSeed(uint32_t seed)
+{
+  /* xorshift32 doesn't leave 0 */
+  seed_ = (seed != 0) ? seed : 1;
+}
+
+uint32_t FaultTransport::getNbFaults() const
+{
+  return nbDropped_ + nbFlipped_ + nbDuplicated_ + nbStalls_ + nbOverruns_;
+}
+
+bool FaultTransport::getFaultTime(uint32_t* time) const
+{
+  if (faulty_)
+  {
+    *time = faultTime_;
+  }
+
+  return faulty_;
+}
+
+/**
+ * Read the wrapped transport, alter each complete line
+ */
+void FaultTransport::pull()
+{
+  uint32_t now;
+
+  /* millis() of the host core polls available(), don't nest */
+  if (pulling_)
+  {
+    return;
+  }
+  pulling_ = true;
+  now = millis();
+
+  if ( (stalled_) && ((int32_t)(now - stallEnd_) >= 0) )
+  {
+    stalled_ = false;
+  }
+  while (transport_.available() > 0)
+  {
+    char c = (char)transport_.read();
+
+    line_ += c;
+    if (c == '\n')
+    {
+      alter(line_, now);
+      line_.clear();
+    }
+  }
+  pulling_ = false;
+}
+
+/**
+ * Apply the faults drawn to a line and queue it
+ */
+void FaultTransport::alter(const std::string& line, uint32_t now)
+{
+  std::string altered;
+  size_t overrunStart = line.size();
+  size_t overrunEnd = line.size();
+
+  nbLines_++;
+  if (onLine_ != NULL)
+  {
+    onLine_(line);
+  }
+
+  if (draw(overrunRate_))
+  {
+    overrunStart = random32() % line.size();
+    overrunEnd = overrunStart + overrunLength_;
+    nbOverruns_++;
+    fault(now);
+  }
+  for (size_t i = 0; i < line.size(); i++)
+  {
+    char c = line[i];
+
+    if ( (i >= overrunStart) && (i < overrunEnd) )
+    {
+      continue;
+    }
+    if (draw(dropRate_))
+    {
+      nbDropped_++;
+      fault(now);
+      continue;
+    }
+    if (draw(flipRate_))
+    {
+      c ^= (char)(1 << (random32() % 8));
+      nbFlipped_++;
+      fault(now);
+    }
+    altered += c;
+  }
+
+  output_.insert(output_.end(), altered.begin(), altered.end());
+  if (draw(duplicateRate_))
+  {
+    output_.insert(output_.end(), altered.begin(), altered.end());
+    nbDuplicated_++;
+    fault(now);
+  }
+  if ( (!stalled_) && (draw(stallRate_)) )
+  {
+    stalled_ = true;
+    stallEnd_ = now + stallTime_;
+    nbStalls_++;
+    fault(now);
+  }
+}
+
+/**
+ * Draw a fault
+ * @param ratePerThousand  the probability in thousandths
+ */
+bool FaultTransport::draw(double ratePerThousand)
+{
+  if (ratePerThousand <= 0)
+  {
+    return false;
+  }
+
+  return (random32() % 1000000) < (uint32_t)(ratePerThousand * 1000);
+}
+
+uint32_t FaultTransport::random32()
+{
+  seed_ ^= seed_ << 13;
+  seed_ ^= seed_ >> 17;
+  seed_ ^= seed_ << 5;
+
+  return seed_;
+}
+
+void FaultTransport::fault(uint32_t now)
+{
+  if (!faulty_)
+  {
+    faulty_ = true;
+    faultTime_ = now;
+  }
+}
@@ -0,0 +1,114 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * FaultTransport.h - Transport wrapper injecting UART faults
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef FAULT_TRANSPORT_H
+#define FAULT_TRANSPORT_H
+
+#include <stdint.h>
+
+#include <deque>
+#include <string>
+
+#include "HostTransport.h"
+
+/**
+ * Usage:
+ *   Mm002Simulator modem;
+ *   FaultTransport faults(modem);
+ *   faults.configure("drop 2");      // 2 bytes lost per thousand
+ *   hostSetTransport(&faults);
+ *
+ * Bytes from the wrapped transport are altered line by line before the
+ * library reads them, commands go through unchanged. Rates are per thousand
+ * (bytes for drop and flip, lines for the others), drawn from a seeded
+ * generator so a run can be reproduced.
+ */
+class FaultTransport : public HostTransport
+{
+  public:
+    explicit FaultTransport(HostTransport& transport);
+
+    /* HostTransport */
+    size_t write(const uint8_t* buffer, size_t size);
+    int available();
+    int read();
+    uint32_t nextEventDelay(uint32_t now);
+
+    /* "key value..." line, '#' starts a comment, false if not a fault key */
+    bool configure(const std::string& line);
+    void setSeed(uint32_t seed);
+
+    /* Statistics */
+    uint32_t getNbLines() const { return nbLines_; }
+    uint32_t getNbDropped() const { return nbDropped_; }
+    uint32_t getNbFlipped() const { return nbFlipped_; }
+    uint32_t getNbDuplicated() const { return nbDuplicated_; }
+    uint32_t getNbStalls() const { return nbStalls_; }
+    uint32_t getNbOverruns() const { return nbOverruns_; }
+    uint32_t getNbFaults() const;
+    /* Time of the first fault after clearFaultTime(), false if none */
+    bool getFaultTime(uint32_t* time) const;
+    void clearFaultTime() { faulty_ = false; }
+    /* Called with each line of the wrapped transport, before the faults */
+    void setLineCallback(void (*onLine)(const std::string& line)) { onLine_ = onLine; }
+
+  private:
+    HostTransport& transport_;
+    std::string line_;
+    std::deque<char> output_;
+    bool pulling_;
+    uint32_t seed_;
+
+    /* Rates per thousand */
+    double dropRate_;
+    double flipRate_;
+    double duplicateRate_;
+    double stallRate_;
+    uint32_t stallTime_;
+    double overrunRate_;
+    uint32_t overrunLength_;
+
+    /* Delivery held until this time */
+    bool stalled_;
+    uint32_t stallEnd_;
+
+    /* Statistics */
+    uint32_t nbLines_;
+    uint32_t nbDropped_;
+    uint32_t nbFlipped_;
+    uint32_t nbDuplicated_;
+    uint32_t nbStalls_;
+    uint32_t nbOverruns_;
+    bool faulty_;
+    uint32_t faultTime_;
+    void (*onLine_)(const std::string& line);
+
+    void pull();
+    void alter(const std::string& line, uint32_t now);
+    bool draw(double ratePerThousand);
+    uint32_t random32();
+    void fault(uint32_t now);
+};
+
+#endif /* FAULT_TRANSPORT_H */
@@ -0,0 +1,251 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * nemeus_faults.cpp - LoRaWAN join and send cycles through a faulty UART
+ *
+ *   nemeus_faults <scenario> [--cycles <n>] [--seed <n>]
+ *
+ * The scenario mixes MM002 simulator lines and FaultTransport ones. Runs in
+ * simulated time and reports the failed cycles, the time to recover from a
+ * fault (first fault after a good cycle to the end of the next good one) and
+ * the events lost per thousand lines received.
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "NemeusLib.h"
+#include "Mm002Simulator.h"
+#include "FaultTransport.h"
+#include "SimulatedClock.h"
+
+/* Time given to unsollicited lines after each send */
+#define FAULTS_CYCLE_PERIOD 5000
+
+/* Event published for each line of the module, before the faults */
+struct EventLine
+{
+  const char* prefix;
+  uint8_t type;
+};
+
+static const EventLine eventLines[] =
+{
+  { "+MAC: SND,",      EVENT_SEND_SCHEDULED },
+  { "+MAC: RCVBIN,",   EVENT_DOWNLINK_RECEIVED },
+  { "+MAC: RCVTXT,",   EVENT_DOWNLINK_RECEIVED },
+  { "+MAC: RDEVADDR,", EVENT_DEVADDR_ASSIGNED },
+};
+
+#define NB_EVENT_LINES (sizeof(eventLines) / sizeof(eventLines[0]))
+
+static uint32_t expectedEvents[NB_EVENT_LINES];
+static uint32_t receivedEvents[NB_EVENT_LINES];
+
+static void onLine(const std::string& line)
+{
+  for (size_t i = 0; i < NB_EVENT_LINES; i++)
+  {
+    if (line.compare(0, strlen(eventLines[i].prefix), eventLines[i].prefix) == 0)
+    {
+      expectedEvents[i]++;
+      break;
+    }
+  }
+}
+
+static void onEvent(const NemeusEvent_t* event)
+{
+  /* Counted once per type, downlinks on the binary line */
+  for (size_t i = 0; i < NB_EVENT_LINES; i++)
+  {
+    if (eventLines[i].type == event->type)
+    {
+      receivedEvents[i]++;
+      break;
+    }
+  }
+}
+
+static bool loadScenario(const char* path, Mm002Simulator& modem, FaultTransport& faults)
+{
+  std::ifstream file(path);
+  std::string line;
+  bool ok = true;
+
+  if (!file)
+  {
+    fprintf(stderr, "nemeus_faults: can't open %s\n", path);
+    return false;
+  }
+  while (std::getline(file, line))
+  {
+    if ( (!faults.configure(line)) && (!modem.configure(line)) )
+    {
+      fprintf(stderr, "nemeus_faults: %s: unknown line '%s'\n", path, line.c_str());
+      ok = false;
+    }
+  }
+
+  return ok;
+}
+
+static double wallSeconds()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[])
+{
+  Mm002Simulator modem;
+  FaultTransport faults(modem);
+  SimulatedClock clock;
+  LoRaWAN* loraWan = nemeusLib.loraWan();
+  const char* path = NULL;
+  uint32_t nbCycles = 1000;
+  uint32_t nbFailed = 0;
+  bool outage = false;
+  uint32_t outageStart = 0;
+  std::vector<uint32_t> recoveries;
+  uint32_t expected = 0;
+  uint32_t lost = 0;
+  uint32_t spurious = 0;
+  uint32_t startTime;
+  double start;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if ( (strcmp(argv[i], "--cycles") == 0) && (i + 1 < argc) )
+    {
+      nbCycles = strtoul(argv[++i], NULL, 0);
+    }
+    else if ( (strcmp(argv[i], "--seed") == 0) && (i + 1 < argc) )
+    {
+      faults.setSeed(strtoul(argv[++i], NULL, 0));
+    }
+    else
+    {
+      path = argv[i];
+    }
+  }
+  if ( (path == NULL) || (!loadScenario(path, modem, faults)) )
+  {
+    fprintf(stderr, "usage: nemeus_faults <scenario> [--cycles <n>] [--seed <n>]\n");
+    return 2;
+  }
+
+  faults.setLineCallback(onLine);
+  hostSetTransport(&faults);
+  clock.start();
+  nemeusLib.events()->subscribe(onEvent, EVENT_ALL);
+
+  start = wallSeconds();
+  startTime = millis();
+  nemeusLib.init();
+  for (uint32_t cycle = 0; cycle < nbCycles; cycle++)
+  {
+    uint8_t result = NEMEUS_ERROR;
+
+    if (loraWan->getJoinState() != JOIN_JOINED)
+    {
+      loraWan->startJoin('A');
+      while ( (loraWan->getJoinState() == JOIN_BACKOFF) || (loraWan->getJoinState() == JOIN_REQUESTED) )
+      {
+        loraWan->processJoin();
+      }
+    }
+    if (loraWan->getJoinState() == JOIN_JOINED)
+    {
+      result = loraWan->sendFrame(BINARY_MODE, 1, 3, "0011", (cycle % 2) == 0, true);
+    }
+    nemeusLib.pollDevice(FAULTS_CYCLE_PERIOD);
+    while (nemeusLib.availableTraces())
+    {
+      char trace[256];
+      nemeusLib.readLine(trace, sizeof(trace));
+    }
+
+    /* Not acknowledged is an answer of the network */
+    if ( (result == NEMEUS_SUCCESS) || (result == NEMEUS_ERROR_NOACK) )
+    {
+      if (outage)
+      {
+        recoveries.push_back(millis() - outageStart);
+        outage = false;
+      }
+      faults.clearFaultTime();
+    }
+    else
+    {
+      nbFailed++;
+      if (!outage)
+      {
+        outage = true;
+        if (!faults.getFaultTime(&outageStart))
+        {
+          outageStart = millis();
+        }
+      }
+    }
+  }
+
+  for (size_t i = 0; i < NB_EVENT_LINES; i++)
+  {
+    expected += expectedEvents[i];
+    lost += (receivedEvents[i] < expectedEvents[i]) ? expectedEvents[i] - receivedEvents[i] : 0;
+    spurious += (receivedEvents[i] > expectedEvents[i]) ? receivedEvents[i] - expectedEvents[i] : 0;
+  }
+
+  printf("cycles %u (failed %u), %.1f s simulated in %.3f s\n", nbCycles, nbFailed,
+         (millis() - startTime) / 1000.0, wallSeconds() - start);
+  printf("lines %u, faults %u (drop %u, flip %u, duplicate %u, stall %u, overrun %u)\n",
+         faults.getNbLines(), faults.getNbFaults(), faults.getNbDropped(), faults.getNbFlipped(),
+         faults.getNbDuplicated(), faults.getNbStalls(), faults.getNbOverruns());
+  printf("events expected %u, lost %u (%.2f per 1000 lines), spurious %u\n", expected, lost,
+         (faults.getNbLines() != 0) ? lost * 1000.0 / faults.getNbLines() : 0.0, spurious);
+  if (!recoveries.empty())
+  {
+    std::sort(recoveries.begin(), recoveries.end());
+    uint64_t total = 0;
+    for (size_t i = 0; i < recoveries.size(); i++)
+    {
+      total += recoveries[i];
+    }
+    printf("recovery %zu outages, mean %u ms, median %u ms, max %u ms\n", recoveries.size(),
+           (uint32_t)(total / recoveries.size()), recoveries[recoveries.size() / 2], recoveries.back());
+  }
+  else
+  {
+    printf("recovery %s\n", outage ? "none, still failing" : "no outage");
+  }
+
+  return 0;
+}
@@ -0,0 +1,119 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * UartLog.cpp - Reader of the logs written by UartRecorder
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <fstream>
+#include <iterator>
+
+#include "UartLog.h"
+#include "UartRecorder.h"
+
+/**
+ * Read a varint at an offset
+ * @return  false if it goes past the end
+ */
+static bool readVarint(const std::string& bytes, size_t* offset, uint32_t* value)
+{
+  *value = 0;
+
+  for (uint8_t shift = 0; (*offset < bytes.size()) && (shift < 35); shift += 7)
+  {
+    uint8_t byte = (uint8_t)bytes[(*offset)++];
+
+    *value |= (uint32_t)(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool readUartLog(const char* path, std::vector<UartLogRecord>& records, uint32_t* nbLost)
+{
+  std::ifstream file(path, std::ios::binary);
+  std::string log;
+  size_t position = 0;
+  uint32_t time = 0;
+
+  if (!file)
+  {
+    return false;
+  }
+  log.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  *nbLost = 0;
+
+  while ((position = log.find((char)UART_RECORD_MARKER, position)) != std::string::npos)
+  {
+    std::string bytes;
+    UartLogRecord record;
+    size_t offset = 1;
+    uint32_t delta;
+    uint32_t value;
+
+    /* Unescape until LF, a record cut by the end of the log is dropped */
+    for (position++; (position < log.size()) && (log[position] != '\n'); position++)
+    {
+      if ( (log[position] == (char)UART_RECORD_ESCAPE) && (position + 1 < log.size()) )
+      {
+        position++;
+        bytes += (char)(log[position] ^ 0x40);
+      }
+      else
+      {
+        bytes += log[position];
+      }
+    }
+    if ( (position >= log.size()) || (bytes.empty()) || (!readVarint(bytes, &offset, &delta)) )
+    {
+      continue;
+    }
+
+    time += delta;
+    record.type = bytes[0];
+    record.data = bytes.substr(offset);
+
+    if ( (record.type == UART_RECORD_START) && (record.data.size() > 1) )
+    {
+      /* Absolute time of the device */
+      offset = 1;
+      if (readVarint(record.data, &offset, &value))
+      {
+        time = value;
+      }
+    }
+    else if (record.type == UART_RECORD_LOST)
+    {
+      offset = 0;
+      if (readVarint(record.data, &offset, &value))
+      {
+        *nbLost += value;
+      }
+    }
+    record.time = time;
+    records.push_back(record);
+  }
+
+  return true;
+}
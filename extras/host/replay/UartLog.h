@@ -2,8 +2,8 @@
  * |\ |  |_   |\/|  |_   |  |  (_
  * | \|  |__  |  |  |__  |__|  __)
  *
- * DataContext.h - Data Context include for library
- * 
+ * UartLog.h - Reader of the logs written by UartRecorder
+ *
  * Copyright (C) 2017 Nemeus - All Rights Reserved
  *
  * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
@@ -19,24 +19,34 @@
  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
  * See the License for the specific language governing permissions and
  * limitations under the License.
- * 
+ *
  */
- 
-#ifndef DATACONTEXT_H
-#define DATACONTEXT_H
 
-#include "AtCommand.h"
+#ifndef UART_LOG_H
+#define UART_LOG_H
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
 
-class DataContext
+/**
+ * Record of a log, time in ms of the recording device
+ */
+struct UartLogRecord
 {
-  public:
-    DataContext();
-    void resetOngoingAtCommand();
-    void setOngoingAtCommand(AtCommand atCommandCode);
-    AtCommand getOngoingAtCommand();
-
-  private:
-    AtCommand ongoingAtCommand_;
+  char type;            // UART_RECORD_TYPE
+  uint32_t time;
+  std::string data;     // unescaped
 };
 
-#endif /* DATACONTEXT_H */
+/**
+ * Read the records of a log, text between records (traces) is skipped
+ * @param path  the log, as captured from SerialUSB or the trace ring
+ * @param records  filled with the records
+ * @param nbLost  the records dropped by the recorder
+ * @return  false if the file can't be read
+ */
+bool readUartLog(const char* path, std::vector<UartLogRecord>& records, uint32_t* nbLost);
+
+#endif /* UART_LOG_H */
@@ -0,0 +1,408 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * nemeus_replay.cpp - Replay a UartRecorder log into the library RX path
+ *
+ *   nemeus_replay <log> [--speed <factor>] [--simulated-time] [--verbose]
+ *
+ * Commands of the log are sent again by NemeusUART, the bytes received
+ * after each of them are delivered at their recorded time (divided by the
+ * speed factor, 0 for no wait), in simulated time if asked (SimulatedClock).
+ * The events published must be the recorded ones. Exits with 1 on a
+ * difference.
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <deque>
+#include <vector>
+
+#include "NemeusLib.h"
+#include "SimulatedClock.h"
+#include "UartLog.h"
+
+/* Lines received from the module, not yet read by the library (NemeusUART.cpp) */
+extern CircBuffer circularBuffer;
+
+/* Wait for a command without answer in the log, after the next command time
+   (the request deadline also covers the module wake up and the sending) */
+#define REPLAY_TIMEOUT_MARGIN 1000
+
+struct ReplayEvent
+{
+  uint8_t type;
+  uint32_t digest;
+};
+
+/**
+ * Module side of the replay: checks the commands sent, delivers the
+ * bytes received
+ */
+class UartReplay : public HostTransport
+{
+  public:
+    UartReplay(const std::vector<UartLogRecord>& records, double speed, bool verbose)
+      : records_(records), next_(0), speed_(speed), verbose_(verbose), pumping_(false),
+        segmentWall_(0), segmentTime_(0), nbCommands_(0), nbTxMismatches_(0), nbRxBytes_(0) {}
+
+    /* The next record, NULL at the end */
+    const UartLogRecord* current() const { return (next_ < records_.size()) ? &records_[next_] : NULL; }
+
+    /* Time to wait for the answer of the current command */
+    uint32_t timeout() const
+    {
+      uint32_t gap = 0;
+
+      for (size_t i = next_ + 1; i < records_.size(); i++)
+      {
+        if (records_[i].type == UART_RECORD_TX)
+        {
+          gap = records_[i].time - records_[next_].time;
+          break;
+        }
+      }
+
+      return ((speed_ > 0) ? (uint32_t)(gap / speed_) : 0) + REPLAY_TIMEOUT_MARGIN;
+    }
+
+    /* The current command can't be sent, go on as if it was */
+    void skip()
+    {
+      startSegment();
+    }
+
+    size_t write(const uint8_t* buffer, size_t size)
+    {
+      const UartLogRecord* record = current();
+
+      tx_.append((const char*)buffer, size);
+      if ( (record == NULL) || (record->type != UART_RECORD_TX) )
+      {
+        fprintf(stderr, "replay: unexpected command '%s'\n", tx_.c_str());
+        nbTxMismatches_++;
+        tx_.clear();
+      }
+      else if (tx_.size() >= record->data.size())
+      {
+        if (tx_ != record->data)
+        {
+          fprintf(stderr, "replay: command '%s' sent instead of '%s'\n", tx_.c_str(), record->data.c_str());
+          nbTxMismatches_++;
+        }
+        startSegment();
+      }
+
+      return size;
+    }
+
+    int available()
+    {
+      pump();
+      return (int)output_.size();
+    }
+
+    int read()
+    {
+      int c;
+
+      if (output_.empty())
+      {
+        return -1;
+      }
+      c = (unsigned char)output_.front();
+      output_.pop_front();
+
+      return c;
+    }
+
+    /* Time to the next record received, at the replay speed */
+    uint32_t nextEventDelay(uint32_t now)
+    {
+      size_t i = next_;
+
+      if (!output_.empty())
+      {
+        return 0;
+      }
+      while ( (i < records_.size()) && (records_[i].type != UART_RECORD_TX) && (records_[i].type != UART_RECORD_RX) )
+      {
+        i++;
+      }
+      if ( (i == records_.size()) || (records_[i].type == UART_RECORD_TX) )
+      {
+        return HOST_TRANSPORT_NO_EVENT;
+      }
+      if (speed_ <= 0)
+      {
+        return 0;
+      }
+      int32_t next = (int32_t)(segmentWall_ + (uint32_t)((records_[i].time - segmentTime_) / speed_) - now);
+
+      return (next < 0) ? 0 : (uint32_t)next;
+    }
+
+    const std::vector<ReplayEvent>& getExpectedEvents() const { return expectedEvents_; }
+    uint32_t getNbCommands() const { return nbCommands_; }
+    uint32_t getNbTxMismatches() const { return nbTxMismatches_; }
+    uint32_t getNbRxBytes() const { return nbRxBytes_; }
+
+  private:
+    const std::vector<UartLogRecord>& records_;
+    size_t next_;
+    double speed_;
+    bool verbose_;
+    bool pumping_;
+    std::string tx_;
+    std::deque<char> output_;
+    std::vector<ReplayEvent> expectedEvents_;
+    /* Wall time (millis()) and log time of the last command */
+    uint32_t segmentWall_;
+    uint32_t segmentTime_;
+    uint32_t nbCommands_;
+    uint32_t nbTxMismatches_;
+    uint32_t nbRxBytes_;
+
+    /* Bytes received after the current command are timed from now */
+    void startSegment()
+    {
+      if (verbose_)
+      {
+        printf("%10u T %s", records_[next_].time, records_[next_].data.c_str());
+      }
+      segmentWall_ = millis();
+      segmentTime_ = records_[next_].time;
+      nbCommands_++;
+      next_++;
+      tx_.clear();
+    }
+
+    /**
+     * Deliver the records received due, up to the next command
+     */
+    void pump()
+    {
+      /* millis() of the host core polls available(), don't nest */
+      if (pumping_)
+      {
+        return;
+      }
+      pumping_ = true;
+
+      while (next_ < records_.size())
+      {
+        const UartLogRecord& record = records_[next_];
+
+        if (record.type == UART_RECORD_TX)
+        {
+          break;
+        }
+        if (record.type == UART_RECORD_RX)
+        {
+          /* Not before its time, not faster than the library reads */
+          if ( ( (speed_ > 0) && ((millis() - segmentWall_) * speed_ < (double)(record.time - segmentTime_)) )
+              || ((size_t)circularBuffer.getSizeRemaining() < output_.size() + record.data.size()) )
+          {
+            break;
+          }
+          if (verbose_)
+          {
+            printf("%10u R %s", record.time, record.data.c_str());
+          }
+          output_.insert(output_.end(), record.data.begin(), record.data.end());
+          nbRxBytes_ += record.data.size();
+        }
+        else if ( (record.type == UART_RECORD_EVENT) && (record.data.size() == 5) )
+        {
+          ReplayEvent event;
+
+          event.type = (uint8_t)record.data[0];
+          event.digest = 0;
+          for (uint8_t i = 0; i < 4; i++)
+          {
+            event.digest |= (uint32_t)(uint8_t)record.data[1 + i] << (8*i);
+          }
+          if (verbose_)
+          {
+            printf("%10u E 0x%02X %08X\n", record.time, event.type, event.digest);
+          }
+          expectedEvents_.push_back(event);
+        }
+        next_++;
+      }
+
+      pumping_ = false;
+    }
+};
+
+static std::vector<ReplayEvent> replayedEvents;
+static bool verboseEvents = false;
+
+static void onEvent(const NemeusEvent_t* event)
+{
+  ReplayEvent replayed;
+
+  replayed.type = event->type;
+  replayed.digest = UartRecorder::eventDigest(*event);
+  if (verboseEvents)
+  {
+    printf("%10s e 0x%02X %08X\n", "replayed", replayed.type, replayed.digest);
+  }
+  replayedEvents.push_back(replayed);
+}
+
+/**
+ * Command of the table sent as the first bytes of a record
+ * @return  the command with the longest match, NULL if none
+ */
+static const AtCommand* findCommand(const std::string& data)
+{
+  const AtCommand* command = NULL;
+  size_t bestLength = 0;
+
+  for (uint8_t i = 0; i < AT_CMD_NB; i++)
+  {
+    const char* string = atCommands[i].getStringCommand();
+    size_t length = (string != NULL) ? strlen(string) : 0;
+
+    if ( (length > bestLength) && (data.compare(0, length, string) == 0) )
+    {
+      command = &atCommands[i];
+      bestLength = length;
+    }
+  }
+
+  return command;
+}
+
+static double wallSeconds()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<UartLogRecord> records;
+  const char* path = NULL;
+  double speed = 1;
+  bool verbose = false;
+  bool simulatedTime = false;
+  SimulatedClock clock;
+  uint32_t nbLost;
+  uint32_t nbSkipped = 0;
+  size_t nbMatching = 0;
+  double start;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if ( (strcmp(argv[i], "--speed") == 0) && (i + 1 < argc) )
+    {
+      speed = atof(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--simulated-time") == 0)
+    {
+      simulatedTime = true;
+    }
+    else if (strcmp(argv[i], "--verbose") == 0)
+    {
+      verbose = true;
+    }
+    else
+    {
+      path = argv[i];
+    }
+  }
+
+  if (path == NULL)
+  {
+    fprintf(stderr, "usage: nemeus_replay <log> [--speed <factor>] [--simulated-time] [--verbose]\n");
+    return 2;
+  }
+  if (!readUartLog(path, records, &nbLost))
+  {
+    fprintf(stderr, "replay: can't read %s\n", path);
+    return 2;
+  }
+  if (nbLost != 0)
+  {
+    fprintf(stderr, "replay: %u records were lost by the recorder\n", nbLost);
+  }
+
+  UartReplay replay(records, speed, verbose);
+  verboseEvents = verbose;
+  hostSetTransport(&replay);
+  if (simulatedTime)
+  {
+    clock.start();
+  }
+  nemeusLib.events()->subscribe(onEvent, EVENT_ALL);
+
+  start = wallSeconds();
+  while (replay.current() != NULL)
+  {
+    const UartLogRecord* record = replay.current();
+
+    if (record->type == UART_RECORD_TX)
+    {
+      const AtCommand* command = findCommand(record->data);
+
+      if (command == NULL)
+      {
+        fprintf(stderr, "replay: unknown command '%s'\n", record->data.c_str());
+        replay.skip();
+        nbSkipped++;
+        continue;
+      }
+      std::string arguments = record->data.substr(strlen(command->getStringCommand()));
+      NemeusUART::getInstance()->sendATCommand(*command, arguments.empty() ? NULL : arguments.c_str(), replay.timeout());
+    }
+    else
+    {
+      nemeusLib.pollDevice(1);
+    }
+  }
+  /* Lines left in the library buffers */
+  nemeusLib.pollDevice(REPLAY_TIMEOUT_MARGIN);
+
+  const std::vector<ReplayEvent>& expected = replay.getExpectedEvents();
+  while ( (nbMatching < expected.size()) && (nbMatching < replayedEvents.size())
+         && (expected[nbMatching].type == replayedEvents[nbMatching].type)
+         && (expected[nbMatching].digest == replayedEvents[nbMatching].digest) )
+  {
+    nbMatching++;
+  }
+
+  printf("records %zu, commands %u (%u unknown), rx bytes %u, %.3f s\n", records.size(),
+         replay.getNbCommands(), nbSkipped, replay.getNbRxBytes(), wallSeconds() - start);
+  printf("events recorded %zu, replayed %zu, matching %zu\n", expected.size(), replayedEvents.size(), nbMatching);
+  if (nbMatching < expected.size())
+  {
+    printf("first difference: event %zu, recorded type 0x%02X\n", nbMatching, expected[nbMatching].type);
+  }
+
+  return ( (nbMatching == expected.size()) && (nbMatching == replayedEvents.size())
+          && (replay.getNbTxMismatches() == 0) ) ? 0 : 1;
+}
@@ -0,0 +1,779 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * Mm002Simulator.cpp - Scriptable MM002 stand-in: answers the AT commands
+ *                  and produces unsollicited lines from a scenario.
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "Arduino.h"
+#include "Mm002Simulator.h"
+
+/* Default latency of a command */
+#define MM002_SIM_LATENCY 5
+/* Time from the end of the uplink to the downlink (RX1 window) */
+#define MM002_SIM_RX_DELAY 1000
+
+/**
+ * Split a string on a separator, empty fields are kept
+ */
+static std::vector<std::string> split(const std::string& text, char separator)
+{
+  std::vector<std::string> fields;
+  std::string::size_type begin = 0;
+  std::string::size_type end;
+
+  while ((end = text.find(separator, begin)) != std::string::npos)
+  {
+    fields.push_back(text.substr(begin, end - begin));
+    begin = end + 1;
+  }
+  fields.push_back(text.substr(begin));
+
+  return fields;
+}
+
+static uint32_t toNumber(const std::string& text)
+{
+  return (uint32_t)strtoul(text.c_str(), NULL, 0);
+}
+
+Mm002Simulator::Mm002Simulator()
+  : joinDelay_(6000), joinFailures_(0), sendDelay_(0), ackDelay_(2000), noAckEvery_(0),
+    downlinkEvery_(0), downlinkPort_(1), downlinkPayload_("00"),
+    traceRate_(0), traceLength_(60), rfFramePeriod_(0), rfFramePayload_("00"),
+    nextTraceTime_(0), nextRfFrameTime_(0), updating_(false),
+    nbCommands_(0), nbUplinks_(0), nbDownlinks_(0), nbTraces_(0)
+{
+  latencies_[""] = MM002_SIM_LATENCY;
+  reset();
+}
+
+/**
+ * Module state after a cold reset
+ */
+void Mm002Simulator::reset()
+{
+  macOn_ = false;
+  otaa_ = false;
+  macClass_ = 'A';
+  adr_ = true;
+  piggyback_ = false;
+  encryption_ = true;
+  dataRate_ = "SF12BW125";
+  txPower_ = 14;
+  channelMask_ = "0007";
+  channels_.clear();
+  channels_["0,0"] = "0,868100000,SF12BW125,SF7BW125,1,0";
+  channels_["1,0"] = "1,868300000,SF12BW125,SF7BW125,1,0";
+  channels_["2,0"] = "2,868500000,SF12BW125,SF7BW125,1,0";
+  devUID_ = "70B3D5E75F600001";
+  devAddr_ = "00000000";
+  appUID_ = "70B3D5E75F600000";
+  appKey_ = "000102030405060708090A0B0C0D0E0F";
+  sigfoxOn_ = false;
+  rfOn_ = false;
+  continuousRx_ = false;
+  joinAttempts_ = 0;
+}
+
+/* ----- HostTransport ----- */
+
+/**
+ * Bytes sent by the library, each line is a command
+ */
+size_t Mm002Simulator::write(const uint8_t* buffer, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+  {
+    char c = (char)buffer[i];
+
+    if (c == '\n')
+    {
+      if ( (!input_.empty()) && (input_[input_.size()-1] == '\r') )
+      {
+        input_.erase(input_.size()-1);
+      }
+      execute(input_);
+      input_.clear();
+    }
+    else
+    {
+      input_ += c;
+    }
+  }
+
+  return size;
+}
+
+int Mm002Simulator::available()
+{
+  update();
+
+  return (int)output_.size();
+}
+
+/**
+ * Time to the next line due (simulated time of the host core)
+ * @param now  the current time in ms
+ * @return  the delay in ms, 0 if bytes are waiting, HOST_TRANSPORT_NO_EVENT if none
+ */
+uint32_t Mm002Simulator::nextEventDelay(uint32_t now)
+{
+  int32_t next = INT32_MAX;
+
+  if (!output_.empty())
+  {
+    return 0;
+  }
+  if (!pending_.empty())
+  {
+    next = (int32_t)(pending_.begin()->first - now);
+  }
+  if (traceRate_ != 0)
+  {
+    next = std::min(next, (int32_t)(nextTraceTime_ - now));
+  }
+  if ( (continuousRx_) && (rfFramePeriod_ != 0) )
+  {
+    next = std::min(next, (int32_t)(nextRfFrameTime_ - now));
+  }
+  if (next == INT32_MAX)
+  {
+    return HOST_TRANSPORT_NO_EVENT;
+  }
+
+  /* Already due */
+  return (next < 0) ? 0 : (uint32_t)next;
+}
+
+int Mm002Simulator::read()
+{
+  int c;
+
+  update();
+  if (output_.empty())
+  {
+    return -1;
+  }
+  c = (unsigned char)output_.front();
+  output_.pop_front();
+
+  return c;
+}
+
+/**
+ * Move the lines due to the output, run the generators
+ */
+void Mm002Simulator::update()
+{
+  uint32_t now;
+
+  /* millis() of the host core polls available(), don't nest */
+  if (updating_)
+  {
+    return;
+  }
+  updating_ = true;
+  now = millis();
+
+  /* Verbose traces */
+  if (traceRate_ != 0)
+  {
+    uint32_t period = (1000 / traceRate_) ? (1000 / traceRate_) : 1;
+
+    while ((int32_t)(now - nextTraceTime_) >= 0)
+    {
+      char header[32];
+      std::string trace;
+
+      snprintf(header, sizeof(header), "[%010u] TRACE %06u ", nextTraceTime_, nbTraces_);
+      trace = header;
+      while (trace.size() < traceLength_)
+      {
+        trace += (char)('a' + (trace.size() % 26));
+      }
+      pending_.insert(std::make_pair(nextTraceTime_, trace));
+      nbTraces_++;
+      nextTraceTime_ += period;
+    }
+  }
+
+  /* Frames received in continuous Rx */
+  if ( (continuousRx_) && (rfFramePeriod_ != 0) )
+  {
+    while ((int32_t)(now - nextRfFrameTime_) >= 0)
+    {
+      pending_.insert(std::make_pair(nextRfFrameTime_, "+RFRX: RCVBIN," + rfFramePayload_ + ",-72,9"));
+      nextRfFrameTime_ += rfFramePeriod_;
+    }
+  }
+
+  while ( (!pending_.empty()) && ((int32_t)(now - pending_.begin()->first) >= 0) )
+  {
+    const std::string& line = pending_.begin()->second;
+
+    output_.insert(output_.end(), line.begin(), line.end());
+    output_.push_back('\r');
+    output_.push_back('\n');
+    pending_.erase(pending_.begin());
+  }
+  updating_ = false;
+}
+
+/**
+ * Queue a line to send delay ms from now
+ */
+void Mm002Simulator::queue(const std::string& line, uint32_t delay)
+{
+  pending_.insert(std::make_pair((uint32_t)(millis() + delay), line));
+}
+
+void Mm002Simulator::inject(const std::string& line, uint32_t delay)
+{
+  queue(line, delay);
+}
+
+/* ----- Scenario ----- */
+
+void Mm002Simulator::setLatency(const std::string& command, uint32_t latency)
+{
+  latencies_[command] = latency;
+}
+
+void Mm002Simulator::setJoin(uint32_t delay, uint32_t nbFailures)
+{
+  joinDelay_ = delay;
+  joinFailures_ = nbFailures;
+}
+
+void Mm002Simulator::setSendDelay(uint32_t delay)
+{
+  sendDelay_ = delay;
+}
+
+void Mm002Simulator::setDownlink(uint32_t everyUplinks, uint8_t port, const std::string& hexPayload)
+{
+  downlinkEvery_ = everyUplinks;
+  downlinkPort_ = port;
+  downlinkPayload_ = hexPayload;
+}
+
+void Mm002Simulator::setTraces(uint32_t linesPerSecond, uint32_t length)
+{
+  /* millis() runs the generators, start from now */
+  nextTraceTime_ = millis();
+  traceRate_ = linesPerSecond;
+  traceLength_ = length;
+}
+
+void Mm002Simulator::setRfFrames(uint32_t period, const std::string& hexPayload)
+{
+  rfFramePeriod_ = period;
+  rfFramePayload_ = hexPayload;
+}
+
+/**
+ * Apply a scenario line
+ *   latency <ms>                       default latency of the commands
+ *   latency <command> <ms>             i.e "latency MAC=SNDBIN 120"
+ *   join <delay ms> [failed attempts]
+ *   send_delay <ms>                    announced by +MAC: SND and +SF: SND
+ *   ack_delay <ms>                     acknowledgement after the send
+ *   noack_every <n>                    every n-th confirmed uplink is not acknowledged
+ *   downlink_every <k> [port] [hex]    downlink after every k uplinks
+ *   traces <lines/s> [length]
+ *   rf_frames <period ms> [hex]        frames received in continuous Rx
+ *   devaddr <hex>                      device address given by the join
+ * @return  false if the line is not understood
+ */
+bool Mm002Simulator::configure(const std::string& line)
+{
+  std::istringstream stream(line.substr(0, line.find('#')));
+  std::string key;
+  std::vector<std::string> values;
+  std::string value;
+
+  if (!(stream >> key))
+  {
+    /* Empty or comment */
+    return true;
+  }
+  while (stream >> value)
+  {
+    values.push_back(value);
+  }
+
+  if ( (key == "latency") && (values.size() == 1) )
+  {
+    setLatency("", toNumber(values[0]));
+  }
+  else if ( (key == "latency") && (values.size() == 2) )
+  {
+    setLatency(values[0], toNumber(values[1]));
+  }
+  else if ( (key == "join") && (values.size() >= 1) )
+  {
+    setJoin(toNumber(values[0]), (values.size() > 1) ? toNumber(values[1]) : 0);
+  }
+  else if ( (key == "send_delay") && (values.size() == 1) )
+  {
+    setSendDelay(toNumber(values[0]));
+  }
+  else if ( (key == "ack_delay") && (values.size() == 1) )
+  {
+    ackDelay_ = toNumber(values[0]);
+  }
+  else if ( (key == "noack_every") && (values.size() == 1) )
+  {
+    noAckEvery_ = toNumber(values[0]);
+  }
+  else if ( (key == "downlink_every") && (values.size() >= 1) )
+  {
+    setDownlink(toNumber(values[0]), (values.size() > 1) ? toNumber(values[1]) : downlinkPort_,
+                (values.size() > 2) ? values[2] : downlinkPayload_);
+  }
+  else if ( (key == "traces") && (values.size() >= 1) )
+  {
+    setTraces(toNumber(values[0]), (values.size() > 1) ? toNumber(values[1]) : traceLength_);
+  }
+  else if ( (key == "rf_frames") && (values.size() >= 1) )
+  {
+    setRfFrames(toNumber(values[0]), (values.size() > 1) ? values[1] : rfFramePayload_);
+  }
+  else if ( (key == "devaddr") && (values.size() == 1) )
+  {
+    devAddr_ = values[0];
+  }
+  else
+  {
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Load a scenario file
+ * @return  false if the file can't be read or a line is not understood
+ */
+bool Mm002Simulator::loadScenario(const char* path)
+{
+  std::ifstream file(path);
+  std::string line;
+  bool ok = true;
+
+  if (!file)
+  {
+    fprintf(stderr, "mm002sim: can't open %s\n", path);
+    return false;
+  }
+
+  while (std::getline(file, line))
+  {
+    if (!configure(line))
+    {
+      fprintf(stderr, "mm002sim: %s: unknown line '%s'\n", path, line.c_str());
+      ok = false;
+    }
+  }
+
+  return ok;
+}
+
+/**
+ * Latency of a command, the longest configured prefix wins
+ */
+uint32_t Mm002Simulator::latencyOf(const std::string& command) const
+{
+  uint32_t latency = latencies_.find("")->second;
+  size_t bestLength = 0;
+
+  for (std::map<std::string, uint32_t>::const_iterator it = latencies_.begin(); it != latencies_.end(); ++it)
+  {
+    if ( (it->first.size() > bestLength) && (command.compare(0, it->first.size(), it->first) == 0) )
+    {
+      bestLength = it->first.size();
+      latency = it->second;
+    }
+  }
+
+  return latency;
+}
+
+/* ----- Commands ----- */
+
+/**
+ * Execute a command line: AT+<module>=<keyword>,<arguments>
+ */
+void Mm002Simulator::execute(const std::string& line)
+{
+  std::string command;
+  std::string::size_type equal;
+  std::vector<std::string> fields;
+  std::string module;
+  std::string keyword;
+  uint32_t latency;
+
+  if (line.compare(0, 3, "AT+") != 0)
+  {
+    /* Wake up, break (~K) and empty lines */
+    return;
+  }
+
+  nbCommands_++;
+  lastCommand_ = line;
+  command = line.substr(3);
+  latency = latencyOf(command);
+
+  equal = command.find('=');
+  if (equal == std::string::npos)
+  {
+    queue("ERROR", latency);
+    return;
+  }
+  module = command.substr(0, equal);
+  fields = split(command.substr(equal + 1), ',');
+  keyword = fields[0];
+  fields.erase(fields.begin());
+
+  if (module == "MAC")
+  {
+    executeMac(keyword, fields, latency);
+  }
+  else if (module == "SF")
+  {
+    executeSigfox(keyword, fields, latency);
+  }
+  else if ( (module == "RF") || (module == "RFTX") || (module == "RFRX") )
+  {
+    executeRadio(module, keyword, fields, latency);
+  }
+  else if ( (module == "GA") && (keyword == "DIND") && (fields.size() >= 2) && (fields[1] == "8401") )
+  {
+    /* Cold reset */
+    reset();
+    queue("OK", latency);
+    queue("[BOOT] MM002 simulator", latency + 50);
+  }
+  else if (module == "GA")
+  {
+    queue("OK", latency);
+  }
+  else if ( (module == "DEBUG") && (keyword == "MVER") )
+  {
+    queue("+DEBUG: MVER,MM002-SIM,1.0.0", latency);
+    queue("OK", latency);
+  }
+  else if (module == "DEBUG")
+  {
+    /* MVON, MVOFF: traces of the module */
+    queue("OK", latency);
+  }
+  else
+  {
+    queue("ERROR", latency);
+  }
+}
+
+/**
+ * Uplink on the MAC: send delay, acknowledgement and downlink
+ */
+void Mm002Simulator::macUplink(bool ack, uint32_t latency)
+{
+  uint32_t sent = latency + sendDelay_;
+
+  nbUplinks_++;
+
+  if (sendDelay_ != 0)
+  {
+    queue("+MAC: SND," + std::to_string(sendDelay_), latency);
+  }
+
+  if (ack)
+  {
+    /* The result waits for the acknowledgement */
+    if ( (noAckEvery_ != 0) && ((nbUplinks_ % noAckEvery_) == 0) )
+    {
+      queue("ERROR NOACK", sent + ackDelay_);
+    }
+    else
+    {
+      queue("OK", sent + ackDelay_);
+    }
+  }
+  else
+  {
+    queue("OK", latency);
+  }
+
+  if ( (downlinkEvery_ != 0) && ((nbUplinks_ % downlinkEvery_) == 0) )
+  {
+    nbDownlinks_++;
+    queue("+MAC: RCVBIN," + std::to_string(downlinkPort_) + ",false," + downlinkPayload_ + ",-85,7",
+          sent + MM002_SIM_RX_DELAY + (ack ? ackDelay_ : 0));
+  }
+}
+
+void Mm002Simulator::executeMac(const std::string& keyword, const std::vector<std::string>& args, uint32_t latency)
+{
+  char buffer[96];
+
+  if (keyword == "ON")
+  {
+    /* ON,<band>,<class>,<otaa> */
+    macOn_ = true;
+    macClass_ = ( (args.size() > 1) && (!args[1].empty()) ) ? args[1][0] : 'A';
+    otaa_ = (args.size() > 2) && (args[2] == "1");
+    queue("OK", latency);
+    if (otaa_)
+    {
+      joinAttempts_++;
+      if (sendDelay_ != 0)
+      {
+        queue("+MAC: SND," + std::to_string(sendDelay_), latency);
+      }
+      if (joinAttempts_ > joinFailures_)
+      {
+        if (devAddr_ == "00000000")
+        {
+          devAddr_ = "26011F00";
+        }
+        queue("+MAC: RDEVADDR," + devAddr_ + ",000013", latency + sendDelay_ + joinDelay_);
+      }
+    }
+  }
+  else if (keyword == "OFF")
+  {
+    macOn_ = false;
+    queue("OK", latency);
+  }
+  else if (keyword == "?")
+  {
+    snprintf(buffer, sizeof(buffer), "+MAC: %s,1.0.2,%c,1,868,%u", macOn_ ? "ON" : "OFF", macClass_, otaa_ ? 1 : 0);
+    queue(buffer, latency);
+    queue("OK", latency);
+  }
+  else if ( (keyword == "SNDBIN") || (keyword == "SNDTXT") )
+  {
+    /* SNDBIN,<payload>,<repetition>,<port>,<ack> */
+    if ( (!macOn_) || (args.size() < 4) )
+    {
+      queue("ERROR", latency);
+      return;
+    }
+    macUplink(args[3] == "1", latency);
+  }
+  else if (keyword == "RDR")
+  {
+    snprintf(buffer, sizeof(buffer), "+MAC: %s,%u,%s,0,1", dataRate_.c_str(), txPower_, channelMask_.c_str());
+    queue(buffer, latency);
+    queue("OK", latency);
+  }
+  else if (keyword == "SDR")
+  {
+    /* SDR,<data rate>,<power>,<mask>,<mask ctrl>,<repetition> */
+    if ( (args.size() > 0) && (!args[0].empty()) )
+    {
+      dataRate_ = args[0];
+    }
+    if ( (args.size() > 1) && (!args[1].empty()) )
+    {
+      txPower_ = toNumber(args[1]);
+    }
+    if ( (args.size() > 2) && (!args[2].empty()) )
+    {
+      channelMask_ = args[2];
+    }
+    queue("OK", latency);
+  }
+  else if (keyword == "SCH")
+  {
+    /* SCH,<channel>,<frequency>,<min DR>,<max DR>,<duty cycle>,<page> */
+    if (args.size() < 6)
+    {
+      queue("ERROR", latency);
+      return;
+    }
+    channels_[args[0] + "," + args[5]] = args[0] + "," + args[1] + "," + args[2] + "," + args[3] + "," + args[4] + "," + args[5];
+    queue("OK", latency);
+  }
+  else if (keyword == "RCH")
+  {
+    /* RCH,<channel>,<page>,<unsollicited> */
+    if ( (args.size() >= 2) && (!args[0].empty()) )
+    {
+      std::map<std::string, std::string>::const_iterator channel = channels_.find(args[0] + "," + args[1]);
+
+      if (channel != channels_.end())
+      {
+        queue("+MAC: " + channel->second, latency);
+      }
+    }
+    queue("OK", latency);
+  }
+  else if (keyword == "RADR")
+  {
+    queue(std::string("+MAC: ") + (adr_ ? "true" : "false") + "," + (piggyback_ ? "true" : "false"), latency);
+    queue("OK", latency);
+  }
+  else if (keyword == "SADR")
+  {
+    adr_ = (args.size() > 0) && (args[0] == "true");
+    if (args.size() > 1)
+    {
+      piggyback_ = (args[1] == "true");
+    }
+    queue("OK", latency);
+  }
+  else if (keyword == "RVAR")
+  {
+    snprintf(buffer, sizeof(buffer), "+MAC: %u,%u,0,%u", nbUplinks_, nbDownlinks_, encryption_ ? 1 : 0);
+    queue(buffer, latency);
+    queue("OK", latency);
+  }
+  else if (keyword == "SVAR")
+  {
+    if ( (args.size() > 2) && (!args[2].empty()) )
+    {
+      encryption_ = (args[2] == "1");
+    }
+    queue("OK", latency);
+  }
+  else if (keyword == "RDEVUID")
+  {
+    queue("+MAC: " + devUID_, latency);
+    queue("OK", latency);
+  }
+  else if (keyword == "RDEVADDR")
+  {
+    queue("+MAC: " + devAddr_ + ",000013", latency);
+    queue("OK", latency);
+  }
+  else if ( (keyword == "SDEVADDR") && (args.size() > 0) )
+  {
+    devAddr_ = args[0];
+    queue("OK", latency);
+  }
+  else if (keyword == "RAPPUID")
+  {
+    queue("+MAC: " + appUID_, latency);
+    queue("OK", latency);
+  }
+  else if ( (keyword == "SAPPUID") && (args.size() > 0) )
+  {
+    appUID_ = args[0];
+    queue("OK", latency);
+  }
+  else if (keyword == "RAPPKEY")
+  {
+    queue("+MAC: " + appKey_, latency);
+    queue("OK", latency);
+  }
+  else if ( (keyword == "SAPPKEY") && (args.size() > 0) )
+  {
+    appKey_ = args[0];
+    queue("OK", latency);
+  }
+  else if ( (keyword == "RAPPSKEY") || (keyword == "RNSKEY") )
+  {
+    queue("+MAC: 2B7E151628AED2A6ABF7158809CF4F3C", latency);
+    queue("OK", latency);
+  }
+  else
+  {
+    queue("ERROR", latency);
+  }
+}
+
+void Mm002Simulator::executeSigfox(const std::string& keyword, const std::vector<std::string>& args, uint32_t latency)
+{
+  if (keyword == "ON")
+  {
+    sigfoxOn_ = true;
+    queue("OK", latency);
+  }
+  else if (keyword == "OFF")
+  {
+    sigfoxOn_ = false;
+    queue("OK", latency);
+  }
+  else if ( (keyword == "SNDBIN") || (keyword == "SNDBIT") || (keyword == "SNDOOB") )
+  {
+    /* Sent after the delay, the result comes after the transmission */
+    nbUplinks_++;
+    if (sendDelay_ != 0)
+    {
+      queue("+SF: SND," + std::to_string(sendDelay_), latency);
+    }
+    queue("OK", latency + sendDelay_);
+  }
+  else
+  {
+    queue("ERROR", latency);
+  }
+  (void)args;
+}
+
+void Mm002Simulator::executeRadio(const std::string& module, const std::string& keyword, const std::vector<std::string>& args, uint32_t latency)
+{
+  if (module == "RF")
+  {
+    if (keyword == "?")
+    {
+      queue(std::string("+RF: ") + (rfOn_ ? "ON" : "OFF"), latency);
+    }
+    else
+    {
+      rfOn_ = (keyword == "ON");
+    }
+    queue("OK", latency);
+  }
+  else if (module == "RFRX")
+  {
+    if (keyword == "CONTRX")
+    {
+      nextRfFrameTime_ = millis() + rfFramePeriod_;
+      continuousRx_ = true;
+    }
+    else if (keyword == "STOP")
+    {
+      continuousRx_ = false;
+    }
+    queue("OK", latency);
+  }
+  else
+  {
+    /* RFTX: SET, SNDBIN, SNDTXT, START, STOP */
+    if ( (keyword == "SNDBIN") || (keyword == "SNDTXT") )
+    {
+      nbUplinks_++;
+    }
+    queue("OK", latency);
+  }
+  (void)args;
+}
@@ -0,0 +1,154 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * Mm002Simulator.h - Scriptable MM002 stand-in for the host build
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef MM002_SIMULATOR_H
+#define MM002_SIMULATOR_H
+
+#include <stdint.h>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "HostTransport.h"
+
+/**
+ * Usage (in-process):
+ *   Mm002Simulator modem;
+ *   modem.loadScenario("scenarios/busy_network.txt");
+ *   hostSetTransport(&modem);
+ *   nemeusLib.init();
+ *
+ * or over a pseudo-terminal with the mm002sim tool.
+ *
+ * Commands of AtCommand.h (MAC, SF, RF, DEBUG, GA) are answered after their
+ * latency with the MM002 formats. Unsollicited lines (send delays, join
+ * accept, downlinks, RF frames, traces) are produced from the scenario.
+ * Time is given by millis(), simulated or not (SimulatedClock).
+ */
+class Mm002Simulator : public HostTransport
+{
+  public:
+    Mm002Simulator();
+
+    /* HostTransport: commands from the library, answers to the library */
+    size_t write(const uint8_t* buffer, size_t size);
+    int available();
+    int read();
+    uint32_t nextEventDelay(uint32_t now);
+
+    /* Scenario: one "key value..." per line, '#' starts a comment */
+    bool loadScenario(const char* path);
+    bool configure(const std::string& line);
+
+    /* Latency of a command ("" for the default, else i.e "MAC=SNDBIN", longest prefix wins) */
+    void setLatency(const std::string& command, uint32_t latency);
+    /* Time from MAC=ON (OTAA) to the join accept, failed attempts before it */
+    void setJoin(uint32_t delay, uint32_t nbFailures);
+    /* Delay announced by +MAC: SND / +SF: SND before sending (0: none) */
+    void setSendDelay(uint32_t delay);
+    /* Downlink after every k uplinks (0: none) */
+    void setDownlink(uint32_t everyUplinks, uint8_t port, const std::string& hexPayload);
+    /* Verbose traces (0: none) */
+    void setTraces(uint32_t linesPerSecond, uint32_t length);
+    /* RF frame received in continuous Rx every period ms (0: none) */
+    void setRfFrames(uint32_t period, const std::string& hexPayload);
+
+    /* Queue an unsollicited line (without CR LF) delay ms from now */
+    void inject(const std::string& line, uint32_t delay = 0);
+
+    /* Statistics */
+    uint32_t getNbCommands() const { return nbCommands_; }
+    uint32_t getNbUplinks() const { return nbUplinks_; }
+    uint32_t getNbDownlinks() const { return nbDownlinks_; }
+    uint32_t getNbTraces() const { return nbTraces_; }
+    const std::string& getLastCommand() const { return lastCommand_; }
+
+  private:
+    /* Lines not yet delivered, by due time (FIFO for a same time) */
+    std::multimap<uint32_t, std::string> pending_;
+    /* Bytes of the lines due, read by the library */
+    std::deque<char> output_;
+    std::string input_;
+    std::map<std::string, uint32_t> latencies_;
+
+    /* Scenario */
+    uint32_t joinDelay_;
+    uint32_t joinFailures_;
+    uint32_t sendDelay_;
+    uint32_t ackDelay_;
+    uint32_t noAckEvery_;
+    uint32_t downlinkEvery_;
+    uint8_t downlinkPort_;
+    std::string downlinkPayload_;
+    uint32_t traceRate_;
+    uint32_t traceLength_;
+    uint32_t rfFramePeriod_;
+    std::string rfFramePayload_;
+
+    /* Module state */
+    bool macOn_;
+    bool otaa_;
+    char macClass_;
+    bool adr_;
+    bool piggyback_;
+    bool encryption_;
+    std::string dataRate_;
+    uint8_t txPower_;
+    std::string channelMask_;
+    std::map<std::string, std::string> channels_;   // "<channel>,<page>" -> definition
+    std::string devUID_;
+    std::string devAddr_;
+    std::string appUID_;
+    std::string appKey_;
+    bool sigfoxOn_;
+    bool rfOn_;
+    bool continuousRx_;
+    uint32_t joinAttempts_;
+
+    /* Generators */
+    uint32_t nextTraceTime_;
+    uint32_t nextRfFrameTime_;
+    bool updating_;
+
+    /* Statistics */
+    uint32_t nbCommands_;
+    uint32_t nbUplinks_;
+    uint32_t nbDownlinks_;
+    uint32_t nbTraces_;
+    std::string lastCommand_;
+
+    void reset();
+    void update();
+    void queue(const std::string& line, uint32_t delay);
+    uint32_t latencyOf(const std::string& command) const;
+    void execute(const std::string& line);
+    void executeMac(const std::string& keyword, const std::vector<std::string>& args, uint32_t latency);
+    void executeSigfox(const std::string& keyword, const std::vector<std::string>& args, uint32_t latency);
+    void executeRadio(const std::string& module, const std::string& keyword, const std::vector<std::string>& args, uint32_t latency);
+    void macUplink(bool ack, uint32_t latency);
+};
+
+#endif /* MM002_SIMULATOR_H */
@@ -0,0 +1,94 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * mm002sim.cpp - MM002 simulator on a pseudo-terminal
+ *
+ *   mm002sim [scenario]
+ *
+ * Prints the slave device (i.e /dev/pts/5) and answers on it until killed.
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "Mm002Simulator.h"
+
+int main(int argc, char* argv[])
+{
+  Mm002Simulator modem;
+  struct termios attributes;
+  int master;
+
+  if ( (argc > 1) && (!modem.loadScenario(argv[1])) )
+  {
+    return 1;
+  }
+
+  master = posix_openpt(O_RDWR | O_NOCTTY);
+  if ( (master < 0) || (grantpt(master) != 0) || (unlockpt(master) != 0) )
+  {
+    perror("mm002sim: pseudo-terminal");
+    return 1;
+  }
+
+  /* Raw bytes, like the UART */
+  if (tcgetattr(master, &attributes) == 0)
+  {
+    cfmakeraw(&attributes);
+    tcsetattr(master, TCSANOW, &attributes);
+  }
+
+  printf("%s\n", ptsname(master));
+  fflush(stdout);
+
+  for (;;)
+  {
+    struct pollfd descriptor = { master, POLLIN, 0 };
+    uint8_t buffer[256];
+    ssize_t size;
+
+    /* Short timeout: delayed answers and traces are due without input */
+    if (poll(&descriptor, 1, 1) > 0)
+    {
+      size = read(master, buffer, sizeof(buffer));
+      if (size > 0)
+      {
+        modem.write(buffer, size);
+      }
+    }
+
+    size = 0;
+    while ( (size < (ssize_t)sizeof(buffer)) && (modem.available() > 0) )
+    {
+      buffer[size++] = (uint8_t)modem.read();
+    }
+    if ( (size > 0) && (write(master, buffer, size) != size) )
+    {
+      perror("mm002sim: write");
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,301 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * nemeus_soak.cpp - Endurance run: send and downlink cycles against the
+ *                  MM002 simulator, heap and latency drift as CSV
+ *
+ *   nemeus_soak <scenario> [--cycles <n>] [--window <n>] [--csv <file>]
+ *
+ * Runs in simulated time. Every window of cycles a CSV row gives the
+ * throughput, the cycle time percentiles (host CPU) and the send latency
+ * (simulated), the allocations per cycle and the heap: bytes in use, high
+ * water mark, free bytes and largest free block of the glibc heap.
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "NemeusLib.h"
+#include "Mm002Simulator.h"
+#include "SimulatedClock.h"
+
+/* Time given to the downlinks after each send */
+#define SOAK_CYCLE_PERIOD 3000
+
+/* glibc allocator, wrapped to follow the heap of the whole program */
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* pointer, size_t size);
+extern "C" void __libc_free(void* pointer);
+
+static uint64_t nbAllocations = 0;
+static size_t heapLive = 0;
+static size_t heapHighWater = 0;
+
+static void allocated(void* pointer)
+{
+  if (pointer != NULL)
+  {
+    heapLive += malloc_usable_size(pointer);
+    heapHighWater = std::max(heapHighWater, heapLive);
+  }
+}
+
+extern "C" void* malloc(size_t size)
+{
+  void* pointer = __libc_malloc(size);
+
+  nbAllocations++;
+  allocated(pointer);
+  return pointer;
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+  void* pointer = __libc_calloc(count, size);
+
+  nbAllocations++;
+  allocated(pointer);
+  return pointer;
+}
+
+extern "C" void* realloc(void* pointer, size_t size)
+{
+  if (pointer != NULL)
+  {
+    heapLive -= malloc_usable_size(pointer);
+  }
+  pointer = __libc_realloc(pointer, size);
+  nbAllocations++;
+  allocated(pointer);
+  return pointer;
+}
+
+extern "C" void free(void* pointer)
+{
+  if (pointer != NULL)
+  {
+    heapLive -= malloc_usable_size(pointer);
+  }
+  __libc_free(pointer);
+}
+
+/**
+ * Largest free block of the main arena: top chunk or largest bin in use
+ * (upper bound of its size class) from malloc_info()
+ */
+static size_t largestFreeBlock()
+{
+  char* text = NULL;
+  size_t length = 0;
+  size_t largest = mallinfo2().keepcost;
+  FILE* stream = open_memstream(&text, &length);
+  const char* line;
+
+  if (stream == NULL)
+  {
+    return largest;
+  }
+  malloc_info(0, stream);
+  fclose(stream);
+
+  /* Sizes of the first heap (main arena) only */
+  for (line = text; (line != NULL) && (strncmp(line, "</sizes>", 8) != 0); line = strchr(line, '\n'))
+  {
+    unsigned long from;
+    unsigned long to;
+    unsigned long total;
+    unsigned long count;
+
+    line += (*line == '\n') ? 1 : 0;
+    if ( (sscanf(line, "<size from=\"%lu\" to=\"%lu\" total=\"%lu\" count=\"%lu\"", &from, &to, &total, &count) == 4)
+        || (sscanf(line, "<unsorted from=\"%lu\" to=\"%lu\" total=\"%lu\" count=\"%lu\"", &from, &to, &total, &count) == 4) )
+    {
+      if (count != 0)
+      {
+        largest = std::max(largest, (size_t)std::min(to, total));
+      }
+    }
+  }
+  free(text);
+
+  return largest;
+}
+
+static uint32_t nbDownlinks = 0;
+
+static void onEvent(const NemeusEvent_t* event)
+{
+  if (event->type == EVENT_DOWNLINK_RECEIVED)
+  {
+    nbDownlinks++;
+  }
+}
+
+static double wallSeconds()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+template <typename T>
+static T percentile(std::vector<T>& values, double rank)
+{
+  size_t index = (size_t)(rank * (values.size() - 1));
+
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return values[index];
+}
+
+int main(int argc, char* argv[])
+{
+  Mm002Simulator modem;
+  SimulatedClock clock;
+  LoRaWAN* loraWan = nemeusLib.loraWan();
+  const char* scenario = NULL;
+  const char* csvPath = NULL;
+  FILE* csv = stdout;
+  uint32_t nbCycles = 1000000;
+  uint32_t window = 10000;
+  uint32_t nbFailed = 0;
+  std::vector<uint32_t> cycleTimes;
+  std::vector<uint32_t> sendTimes;
+  uint64_t windowAllocations;
+  uint32_t startTime;
+  double start;
+  double windowStart;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if ( (strcmp(argv[i], "--cycles") == 0) && (i + 1 < argc) )
+    {
+      nbCycles = strtoul(argv[++i], NULL, 0);
+    }
+    else if ( (strcmp(argv[i], "--window") == 0) && (i + 1 < argc) )
+    {
+      window = std::max(1ul, strtoul(argv[++i], NULL, 0));
+    }
+    else if ( (strcmp(argv[i], "--csv") == 0) && (i + 1 < argc) )
+    {
+      csvPath = argv[++i];
+    }
+    else
+    {
+      scenario = argv[i];
+    }
+  }
+  if ( (scenario == NULL) || (!modem.loadScenario(scenario)) )
+  {
+    fprintf(stderr, "usage: nemeus_soak <scenario> [--cycles <n>] [--window <n>] [--csv <file>]\n");
+    return 2;
+  }
+  if ( (csvPath != NULL) && ((csv = fopen(csvPath, "w")) == NULL) )
+  {
+    fprintf(stderr, "nemeus_soak: can't write %s\n", csvPath);
+    return 2;
+  }
+
+  hostSetTransport(&modem);
+  clock.start();
+  nemeusLib.events()->subscribe(onEvent, EVENT_DOWNLINK_RECEIVED);
+
+  if ( (nemeusLib.init() != NEMEUS_SUCCESS) || (loraWan->startJoin('A') != NEMEUS_SUCCESS) )
+  {
+    fprintf(stderr, "nemeus_soak: the simulator doesn't answer\n");
+    return 1;
+  }
+  while ( (loraWan->getJoinState() == JOIN_BACKOFF) || (loraWan->getJoinState() == JOIN_REQUESTED) )
+  {
+    loraWan->processJoin();
+  }
+  if (loraWan->getJoinState() != JOIN_JOINED)
+  {
+    fprintf(stderr, "nemeus_soak: join failed\n");
+    return 1;
+  }
+
+  fprintf(csv, "cycles,simulated_s,wall_s,cycles_per_s,cycle_p50_us,cycle_p99_us,cycle_max_us,"
+               "send_p50_ms,send_p99_ms,allocs_per_cycle,heap_in_use,heap_high_water,"
+               "heap_free,largest_free,fragmentation,failed,downlinks\n");
+  cycleTimes.reserve(window);
+  sendTimes.reserve(window);
+  start = wallSeconds();
+  windowStart = start;
+  startTime = millis();
+  windowAllocations = nbAllocations;
+
+  for (uint32_t cycle = 1; cycle <= nbCycles; cycle++)
+  {
+    double cycleStart = wallSeconds();
+    uint32_t sendStart = millis();
+    uint8_t result;
+
+    result = loraWan->sendFrame(BINARY_MODE, 1, 3, "0011223344", (cycle % 2) == 0, true);
+    if ( (result != NEMEUS_SUCCESS) && (result != NEMEUS_ERROR_NOACK) )
+    {
+      nbFailed++;
+    }
+    sendTimes.push_back(millis() - sendStart);
+    nemeusLib.pollDevice(SOAK_CYCLE_PERIOD);
+    while (nemeusLib.availableTraces())
+    {
+      char trace[256];
+      nemeusLib.readLine(trace, sizeof(trace));
+    }
+    cycleTimes.push_back((uint32_t)((wallSeconds() - cycleStart) * 1e6));
+
+    if ( (cycle % window == 0) || (cycle == nbCycles) )
+    {
+      double now = wallSeconds();
+      size_t heapFree = mallinfo2().fordblks;
+      size_t largest = largestFreeBlock();
+
+      fprintf(csv, "%u,%.0f,%.3f,%.0f,%u,%u,%u,%u,%u,%.2f,%zu,%zu,%zu,%zu,%.3f,%u,%u\n",
+              cycle, (millis() - startTime) / 1000.0, now - start, cycleTimes.size() / (now - windowStart),
+              percentile(cycleTimes, 0.5), percentile(cycleTimes, 0.99),
+              *std::max_element(cycleTimes.begin(), cycleTimes.end()),
+              percentile(sendTimes, 0.5), percentile(sendTimes, 0.99),
+              (double)(nbAllocations - windowAllocations) / cycleTimes.size(),
+              heapLive, heapHighWater, heapFree, largest,
+              (heapFree != 0) ? 1.0 - (double)largest / heapFree : 0.0, nbFailed, nbDownlinks);
+      fflush(csv);
+      cycleTimes.clear();
+      sendTimes.clear();
+      windowStart = now;
+      windowAllocations = nbAllocations;
+    }
+  }
+
+  if (csv != stdout)
+  {
+    fclose(csv);
+  }
+
+  return (nbFailed == 0) ? 0 : 1;
+}
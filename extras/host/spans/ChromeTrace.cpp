@@ -0,0 +1,108 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * ChromeTrace.cpp - Writer of the library spans as a Chrome trace (JSON)
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ChromeTrace.h"
+#include "SpanTracer.h"
+
+/**
+ * Create the trace file
+ * @param path  the file
+ * @return  false if it can't be written
+ */
+bool ChromeTrace::open(const char* path)
+{
+  close();
+  file_ = fopen(path, "w");
+  if (file_ == NULL)
+  {
+    return false;
+  }
+  nbEvents_ = 0;
+  fprintf(file_, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+
+  return true;
+}
+
+/**
+ * Write the events of the ring, times in us (library ms)
+ */
+void ChromeTrace::drain()
+{
+  SpanEvent_t event;
+
+  if (file_ == NULL)
+  {
+    return;
+  }
+  while (SpanTracer::getInstance()->read(event))
+  {
+    fprintf(file_, "%s\n{\"name\": ", (nbEvents_ == 0) ? "" : ",");
+    writeString(event.name);
+    fprintf(file_, ", \"cat\": \"nemeus\", \"ph\": \"%c\", \"ts\": %llu, \"pid\": 1, \"tid\": 1, \"args\": {\"id\": %u}}",
+            event.phase, (unsigned long long)event.time * 1000, event.id);
+    nbEvents_++;
+  }
+}
+
+/**
+ * Drain the ring and end the file, the events lost by the ring are given
+ * in otherData
+ * @return  false if the file couldn't be written
+ */
+bool ChromeTrace::close()
+{
+  bool isWritten;
+
+  if (file_ == NULL)
+  {
+    return false;
+  }
+  drain();
+  fprintf(file_, "\n], \"otherData\": {\"lost\": \"%u\"}}\n", SpanTracer::getInstance()->getNbLost());
+  isWritten = (ferror(file_) == 0);
+  isWritten = (fclose(file_) == 0) && isWritten;
+  file_ = NULL;
+
+  return isWritten;
+}
+
+/**
+ * Write a JSON string, without the control characters (line ends of the AT commands)
+ */
+void ChromeTrace::writeString(const char* string)
+{
+  fputc('"', file_);
+  for (; (string != NULL) && (*string != '\0'); string++)
+  {
+    if ( (*string == '"') || (*string == '\\') )
+    {
+      fprintf(file_, "\\%c", *string);
+    }
+    else if ((unsigned char)*string >= ' ')
+    {
+      fputc(*string, file_);
+    }
+  }
+  fputc('"', file_);
+}
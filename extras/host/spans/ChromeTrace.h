@@ -0,0 +1,63 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * ChromeTrace.h - Writer of the library spans as a Chrome trace (JSON)
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef CHROME_TRACE_H
+#define CHROME_TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Moves the events of the SpanTracer ring to a file in the Chrome trace
+ * event format, opened by chrome://tracing or Perfetto. Drain often enough
+ * for the ring not to overwrite events (SpanTracer::getNbLost()).
+ *
+ * Usage:
+ *   ChromeTrace trace;
+ *   trace.open("trace.json");
+ *   loraWan->ON('A', false);
+ *   trace.drain();
+ *   ...
+ *   trace.close();
+ */
+class ChromeTrace
+{
+  public:
+    ChromeTrace() : file_(NULL), nbEvents_(0) {}
+    ~ChromeTrace() { close(); }
+    /* Create the file, false if it can't be written */
+    bool open(const char* path);
+    /* Write the events of the ring */
+    void drain();
+    /* Drain and end the file */
+    bool close();
+    uint32_t getNbEvents() const { return nbEvents_; }
+  private:
+    FILE* file_;
+    uint32_t nbEvents_;
+
+    void writeString(const char* string);
+};
+
+#endif /* CHROME_TRACE_H */
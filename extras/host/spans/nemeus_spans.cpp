@@ -0,0 +1,98 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * nemeus_spans.cpp - Chrome trace of the library API calls against the
+ *                   MM002 simulator
+ *
+ *   nemeus_spans <scenario> <trace.json>
+ *
+ * Calls readDevPerso(), ON() in ABP, sendFrame() with and without
+ * acknowledgement, then ON() in OTAA, in simulated time. The spans of the
+ * library (NEMEUS_SPANS build) are written to the trace, to open with
+ * chrome://tracing or Perfetto.
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+
+#include "NemeusLib.h"
+#include "Mm002Simulator.h"
+#include "SimulatedClock.h"
+#include "ChromeTrace.h"
+
+static ChromeTrace trace;
+
+/**
+ * Print the result and duration of a call, move its spans to the trace
+ */
+static void called(const char* call, uint8_t result, uint32_t start)
+{
+  printf("%-28s result %3u  %6u ms\n", call, result, (unsigned)(millis() - start));
+  trace.drain();
+}
+
+int main(int argc, char* argv[])
+{
+  Mm002Simulator modem;
+  SimulatedClock clock;
+  LoRaWAN* loraWan = nemeusLib.loraWan();
+  uint32_t start;
+
+  if ( (argc != 3) || (!modem.loadScenario(argv[1])) )
+  {
+    fprintf(stderr, "usage: nemeus_spans <scenario> <trace.json>\n");
+    return 2;
+  }
+  if (!trace.open(argv[2]))
+  {
+    fprintf(stderr, "nemeus_spans: can't write %s\n", argv[2]);
+    return 2;
+  }
+
+  hostSetTransport(&modem);
+  clock.start();
+
+  start = millis();
+  called("init", nemeusLib.init(), start);
+
+  start = millis();
+  called("LoRaWAN::readDevPerso", (loraWan->readDevPerso() != NULL) ? NEMEUS_SUCCESS : NEMEUS_ERROR, start);
+
+  start = millis();
+  called("LoRaWAN::ON (ABP)", loraWan->ON('A', false), start);
+
+  start = millis();
+  called("LoRaWAN::sendFrame", loraWan->sendFrame(BINARY_MODE, 1, 3, "0011223344", false, true), start);
+
+  start = millis();
+  called("LoRaWAN::sendFrame (ack)", loraWan->sendFrame(BINARY_MODE, 1, 3, "0011223344", true, true), start);
+
+  start = millis();
+  called("LoRaWAN::ON (OTAA)", loraWan->ON('A', true), start);
+
+  if (!trace.close())
+  {
+    fprintf(stderr, "nemeus_spans: can't write %s\n", argv[2]);
+    return 1;
+  }
+  printf("%u events, %u lost by the ring\n", trace.getNbEvents(), nemeusLib.spans()->getNbLost());
+
+  return (nemeusLib.spans()->getNbLost() == 0) ? 0 : 1;
+}
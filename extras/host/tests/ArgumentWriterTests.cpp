@@ -0,0 +1,78 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * ArgumentWriterTests.cpp - ArgumentWriter formats and overflow
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "HostTest.h"
+#include "Utils/ArgumentWriter.h"
+
+static void testDecimalAndHexadecimal()
+{
+  char buffer[32];
+  ArgumentWriter writer(buffer, sizeof(buffer));
+
+  writer.appendDec(0).separator().appendDec(4294967295UL).separator().appendHex(0xBEEF, 8).endOfLine();
+  HOST_CHECK(!writer.hasOverflowed());
+  HOST_CHECK_STRING("0,4294967295,0000BEEF\r\n", writer.c_str());
+  HOST_CHECK_EQUAL(strlen(buffer), writer.length());
+}
+
+static void testOverflowKeepsArguments()
+{
+  char buffer[8];
+  ArgumentWriter writer(buffer, sizeof(buffer));
+
+  /* 7 characters and the NUL fit */
+  writer.append("1234567");
+  HOST_CHECK(!writer.hasOverflowed());
+  HOST_CHECK_EQUAL(7, writer.length());
+
+  writer.append('8');
+  HOST_CHECK(writer.hasOverflowed());
+  HOST_CHECK_STRING("1234567", writer.c_str());
+
+  /* Nothing is appended once in overflow, even what would fit */
+  writer.clear();
+  writer.append("12345").appendDec(123).append("A");
+  HOST_CHECK(writer.hasOverflowed());
+  HOST_CHECK_STRING("12345", writer.c_str());
+  HOST_CHECK_EQUAL(5, writer.length());
+
+  /* A string cut in the middle is not left in the buffer */
+  writer.clear();
+  writer.append("1234").append("ABCDEF");
+  HOST_CHECK(writer.hasOverflowed());
+  HOST_CHECK_STRING("1234", writer.c_str());
+
+  writer.clear();
+  HOST_CHECK(!writer.hasOverflowed());
+  HOST_CHECK_EQUAL(0, writer.length());
+  HOST_CHECK_STRING("", writer.c_str());
+}
+
+int main()
+{
+  HOST_RUN(testDecimalAndHexadecimal);
+  HOST_RUN(testOverflowKeepsArguments);
+
+  return hostTestResult();
+}
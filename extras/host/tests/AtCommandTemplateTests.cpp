@@ -0,0 +1,108 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * AtCommandTemplateTests.cpp - AtCommandTemplate formats and rejected values
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "HostTest.h"
+#include "AtCommandTemplate.h"
+#include "Utils/ArgumentWriter.h"
+
+static void testTemplateFormats()
+{
+  /* AT+MAC=ON,,<class>,<otaa> */
+  const AtCommandTemplate<AtEmpty, AtChar, AtFlag> macOn(MAC_ON);
+  /* AT+MAC=RCH,<channel>,<page>,<unsollicited> */
+  const AtCommandTemplate<AtDec<255>, AtDec<255>, AtFlag> readChannel(MAC_READ_CHANNEL);
+  /* AT+MAC=SND<BIN|TXT>,<payload>,<repetition>,<port>,<ack> */
+  const AtCommandTemplate<AtWord<3>, AtPayload<8>, AtDec<15>, AtDec<99>, AtFlag> send(MAC_SEND);
+  const AtCommandTemplate<AtHex<8> > devAddr(MAC_SET_DEVADDR);
+  char buffer[64];
+  ArgumentWriter writer(buffer, sizeof(buffer));
+  AtSpan payload = {"0102030405", 4};
+
+  HOST_CHECK(macOn.getCommand() == MAC_ON);
+  HOST_CHECK(macOn.format(writer, 'A', true));
+  HOST_CHECK_STRING(",A,1\r\n", writer.c_str());
+
+  writer.clear();
+  HOST_CHECK(readChannel.format(writer, 3, 0, false));
+  HOST_CHECK_STRING("3,0,0\r\n", writer.c_str());
+
+  /* Truncated payload: only its length is written */
+  writer.clear();
+  HOST_CHECK(send.format(writer, "BIN", payload, 1, 3, true));
+  HOST_CHECK_STRING("BIN,0102,1,3,1\r\n", writer.c_str());
+
+  writer.clear();
+  HOST_CHECK(devAddr.format(writer, "26011f00"));
+  HOST_CHECK_STRING("26011f00\r\n", writer.c_str());
+
+  /* Longest arguments, CRLF included */
+  HOST_CHECK_EQUAL(6, (AtCommandTemplate<AtEmpty, AtChar, AtFlag>::MAX_LENGTH));
+  HOST_CHECK_EQUAL(11, (AtCommandTemplate<AtDec<255>, AtDec<255>, AtFlag>::MAX_LENGTH));
+}
+
+static void testTemplateRejects()
+{
+  const AtCommandTemplate<AtEmpty, AtChar, AtFlag> macOn(MAC_ON);
+  const AtCommandTemplate<AtDec<255>, AtDec<255>, AtFlag> readChannel(MAC_READ_CHANNEL);
+  const AtCommandTemplate<AtWord<3>, AtPayload<8>, AtDec<15>, AtDec<99>, AtFlag> send(MAC_SEND);
+  const AtCommandTemplate<AtHex<8> > devAddr(MAC_SET_DEVADDR);
+  char buffer[64];
+  char small[6];
+  ArgumentWriter writer(buffer, sizeof(buffer));
+  ArgumentWriter smallWriter(small, sizeof(small));
+  AtSpan payload = {"0102030405", 10};
+
+  /* Out of range values */
+  HOST_CHECK(!readChannel.format(writer, 256, 0, false));
+  writer.clear();
+  HOST_CHECK(!macOn.format(writer, ',', true));
+  writer.clear();
+  HOST_CHECK(!macOn.format(writer, ' ', true));
+  writer.clear();
+  HOST_CHECK(!send.format(writer, "BINARY", payload, 1, 3, true));
+  writer.clear();
+  HOST_CHECK(!send.format(writer, "BIN", payload, 1, 3, true));
+
+  /* Hexadecimal strings of another length or with other characters */
+  writer.clear();
+  HOST_CHECK(!devAddr.format(writer, "26011F0"));
+  writer.clear();
+  HOST_CHECK(!devAddr.format(writer, "26011F000"));
+  writer.clear();
+  HOST_CHECK(!devAddr.format(writer, "26011G00"));
+  writer.clear();
+  HOST_CHECK(!devAddr.format(writer, (const char*)NULL));
+
+  /* Arguments longer than the buffer */
+  HOST_CHECK(!readChannel.format(smallWriter, 255, 255, true));
+  HOST_CHECK(smallWriter.hasOverflowed());
+}
+
+int main()
+{
+  HOST_RUN(testTemplateFormats);
+  HOST_RUN(testTemplateRejects);
+
+  return hostTestResult();
+}
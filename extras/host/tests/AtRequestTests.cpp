@@ -0,0 +1,115 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * AtRequestTests.cpp - Responses correlated with the ongoing request:
+ *                  unsollicited lines arriving during a command
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "HostTest.h"
+#include "NemeusLib.h"
+#include "Mm002Simulator.h"
+#include "SimulatedClock.h"
+
+static Mm002Simulator modem;
+static SimulatedClock simulatedClock;
+
+struct DataRateChanged
+{
+  uint8_t dataRate;
+  boolean isUnsollicited;
+};
+
+/* Last change, and the last one while MAC_ON was ongoing */
+static DataRateChanged lastChange;
+static DataRateChanged macOnChange;
+static uint8_t nbChanges;
+static uint8_t nbMacOnChanges;
+
+static void onEvent(const NemeusEvent_t* event)
+{
+  const AtRequest* request = NemeusUART::getInstance()->getRequest();
+
+  lastChange.dataRate = event->dataRateChanged.dataRate->getDataRate();
+  lastChange.isUnsollicited = (NemeusUART::getInstance()->getRespondedRequest() == NULL);
+  nbChanges++;
+
+  if ( (request != NULL) && (request->getCommand() == MAC_ON) )
+  {
+    macOnChange = lastChange;
+    nbMacOnChanges++;
+  }
+}
+
+static void testRdrDuringMacOn()
+{
+  LoRaWAN* loraWan = nemeusLib.loraWan();
+
+  /* MAC_ON answered after 1.7 s, the network changes the data rate meanwhile
+     (ON() reads the configuration first, ~1 s) */
+  modem.setLatency("MAC=ON", 1700);
+  modem.inject("+MAC: RDR,SF9BW125,14,0007,0,1", 1300);
+  nbMacOnChanges = 0;
+
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, loraWan->ON('A', false));
+
+  /* Handled as unsollicited, without ending the request */
+  HOST_CHECK_EQUAL(1, nbMacOnChanges);
+  HOST_CHECK_EQUAL(MAC_DR_SF9BW125, macOnChange.dataRate);
+  HOST_CHECK(macOnChange.isUnsollicited);
+  modem.setLatency("MAC=ON", 5);
+}
+
+static void testRdrDuringRead()
+{
+  LoRaWAN* loraWan = nemeusLib.loraWan();
+  char devUID[DEVPERSO_EUI_HEX_SIZE];
+
+  /* Same "+MAC: " prefix as the response expected */
+  modem.setLatency("MAC=RDEVUID", 1500);
+  modem.inject("+MAC: RDR,SF10BW125,14,0007,0,1", 500);
+  nbChanges = 0;
+
+  HOST_CHECK_STRING("70B3D5E75F600001", loraWan->readDevUID(devUID));
+  HOST_CHECK_EQUAL(1, nbChanges);
+  HOST_CHECK_EQUAL(MAC_DR_SF10BW125, lastChange.dataRate);
+  HOST_CHECK(lastChange.isUnsollicited);
+  modem.setLatency("MAC=RDEVUID", 5);
+}
+
+int main()
+{
+  /* Quiet network: every command answered in 5 ms */
+  modem.configure("latency 5");
+  hostSetTransport(&modem);
+  simulatedClock.start();
+
+  if (nemeusLib.init() != NEMEUS_SUCCESS)
+  {
+    printf("the simulator doesn't answer\n");
+    return 1;
+  }
+  EventBus::getInstance()->subscribe(onEvent, EVENT_DATA_RATE_CHANGED);
+
+  HOST_RUN(testRdrDuringMacOn);
+  HOST_RUN(testRdrDuringRead);
+
+  return hostTestResult();
+}
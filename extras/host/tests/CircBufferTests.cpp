@@ -0,0 +1,133 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * CircBufferTests.cpp - CircBuffer lines, CR resynchronization and wrapping
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "HostTest.h"
+#include "Utils/CircBuffer.h"
+
+static CircBuffer buffer;
+
+/* Read a line as a string */
+static int readLine(char* line, int size, bool crEndsLine)
+{
+  int length = buffer.readLine(line, size - 1, crEndsLine);
+
+  line[length] = '\0';
+  return length;
+}
+
+static void testCompleteLines()
+{
+  char line[64];
+
+  buffer.clear();
+  buffer.write("OK\r\n+MAC: RDR,SF12BW125\r\n", 25);
+  HOST_CHECK_EQUAL(4, readLine(line, sizeof(line), true));
+  HOST_CHECK_STRING("OK\r\n", line);
+  HOST_CHECK_EQUAL(21, readLine(line, sizeof(line), true));
+  HOST_CHECK_STRING("+MAC: RDR,SF12BW125\r\n", line);
+  HOST_CHECK_EQUAL(0, buffer.available());
+  HOST_CHECK_EQUAL(0, readLine(line, sizeof(line), true));
+}
+
+static void testPartialLine()
+{
+  char line[64];
+
+  /* Nothing is read until the LF, the bytes are kept */
+  buffer.clear();
+  buffer.write("ERR", 3);
+  HOST_CHECK_EQUAL(0, readLine(line, sizeof(line), true));
+  HOST_CHECK_EQUAL(3, buffer.available());
+
+  /* A CR at the end of the bytes received may be followed by its LF */
+  buffer.write("OR\r", 3);
+  HOST_CHECK_EQUAL(0, readLine(line, sizeof(line), true));
+  buffer.write('\n');
+  HOST_CHECK_EQUAL(7, readLine(line, sizeof(line), true));
+  HOST_CHECK_STRING("ERROR\r\n", line);
+}
+
+static void testCrResync()
+{
+  char line[64];
+
+  /* LF lost: the CR ends the line, returned as LF */
+  buffer.clear();
+  buffer.write("+MAC: SND,0\r+MAC: RCVBIN,1,0102\r\nOK\r\n", 37);
+  HOST_CHECK_EQUAL(12, readLine(line, sizeof(line), true));
+  HOST_CHECK_STRING("+MAC: SND,0\n", line);
+  HOST_CHECK_EQUAL(21, readLine(line, sizeof(line), true));
+  HOST_CHECK_STRING("+MAC: RCVBIN,1,0102\r\n", line);
+  HOST_CHECK_EQUAL(4, readLine(line, sizeof(line), true));
+  HOST_CHECK_STRING("OK\r\n", line);
+
+  /* Without resync both lines are merged */
+  buffer.clear();
+  buffer.write("+MAC: SND,0\r+MAC: RCVBIN,1,0102\r\n", 33);
+  HOST_CHECK_EQUAL(33, readLine(line, sizeof(line), false));
+  HOST_CHECK_STRING("+MAC: SND,0\r+MAC: RCVBIN,1,0102\r\n", line);
+}
+
+static void testLongLine()
+{
+  char line[9];
+
+  /* A line longer than the destination is returned in pieces */
+  buffer.clear();
+  buffer.write("0123456789AB\r\n", 14);
+  HOST_CHECK_EQUAL(8, readLine(line, sizeof(line), true));
+  HOST_CHECK_STRING("01234567", line);
+  HOST_CHECK_EQUAL(6, readLine(line, sizeof(line), true));
+  HOST_CHECK_STRING("89AB\r\n", line);
+}
+
+static void testWrapping()
+{
+  char line[64];
+  char filler[CIRCULAR_BUFFER_SIZE - 5];
+
+  /* Lines across the end of the buffer */
+  buffer.clear();
+  memset(filler, 'x', sizeof(filler));
+  HOST_CHECK_EQUAL(sizeof(filler), buffer.write(filler, sizeof(filler)));
+  HOST_CHECK_EQUAL(sizeof(filler), buffer.skip(sizeof(filler)));
+
+  buffer.write("+MAC: A\r+MAC: B\r\n", 17);
+  HOST_CHECK_EQUAL(8, readLine(line, sizeof(line), true));
+  HOST_CHECK_STRING("+MAC: A\n", line);
+  HOST_CHECK_EQUAL(9, readLine(line, sizeof(line), true));
+  HOST_CHECK_STRING("+MAC: B\r\n", line);
+  HOST_CHECK_EQUAL(0, buffer.available());
+}
+
+int main()
+{
+  HOST_RUN(testCompleteLines);
+  HOST_RUN(testPartialLine);
+  HOST_RUN(testCrResync);
+  HOST_RUN(testLongLine);
+  HOST_RUN(testWrapping);
+
+  return hostTestResult();
+}
@@ -0,0 +1,120 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * DevPersoTests.cpp - Cache of the device personalization: read once,
+ *                  updated by the setters, forgotten on OTAA join
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "HostTest.h"
+#include "NemeusLib.h"
+#include "Mm002Simulator.h"
+#include "SimulatedClock.h"
+
+static Mm002Simulator modem;
+static SimulatedClock simulatedClock;
+
+static void testCacheHit()
+{
+  LoRaWAN* loraWan = nemeusLib.loraWan();
+  char devUID[DEVPERSO_EUI_HEX_SIZE];
+  uint32_t nbCommands = modem.getNbCommands();
+
+  /* First read asks the module */
+  HOST_CHECK_STRING("70B3D5E75F600001", loraWan->readDevUID(devUID));
+  HOST_CHECK_EQUAL(nbCommands + 1, modem.getNbCommands());
+  HOST_CHECK_STRING("AT+MAC=RDEVUID", modem.getLastCommand().c_str());
+
+  /* Then no AT round trip */
+  nbCommands = modem.getNbCommands();
+  memset(devUID, 0, sizeof(devUID));
+  HOST_CHECK_STRING("70B3D5E75F600001", loraWan->readDevUID(devUID));
+  HOST_CHECK_EQUAL(nbCommands, modem.getNbCommands());
+}
+
+static void testSetUpdates()
+{
+  LoRaWAN* loraWan = nemeusLib.loraWan();
+  char newAppUID[] = "70B3D5E75F6000AA";
+  char newDevAddr[] = "26011F55";
+  char appUID[DEVPERSO_EUI_HEX_SIZE];
+  char devAddr[DEVPERSO_DEVADDR_HEX_SIZE];
+  uint32_t nbCommands;
+
+  HOST_CHECK_STRING("70B3D5E75F600000", loraWan->readAppUID(appUID));
+
+  /* The value set replaces the cached one, no read after it */
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, loraWan->setAppUID(newAppUID));
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, loraWan->setDevAddr(newDevAddr));
+  nbCommands = modem.getNbCommands();
+  HOST_CHECK_STRING("70B3D5E75F6000AA", loraWan->readAppUID(appUID));
+  HOST_CHECK_STRING("26011F55", loraWan->readDevAddr(devAddr));
+  HOST_CHECK_EQUAL(nbCommands, modem.getNbCommands());
+}
+
+static void testJoinInvalidates()
+{
+  LoRaWAN* loraWan = nemeusLib.loraWan();
+  char appSKey[DEVPERSO_KEY_HEX_SIZE];
+  char devAddr[DEVPERSO_DEVADDR_HEX_SIZE];
+  char devUID[DEVPERSO_EUI_HEX_SIZE];
+  uint32_t nbCommands;
+
+  /* Session key cached */
+  loraWan->readAppSKey(appSKey);
+  nbCommands = modem.getNbCommands();
+  loraWan->readAppSKey(appSKey);
+  HOST_CHECK_EQUAL(nbCommands, modem.getNbCommands());
+
+  /* The join gives new session keys: read again */
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, loraWan->ON('A', true));
+  nbCommands = modem.getNbCommands();
+  HOST_CHECK_STRING("2B7E151628AED2A6ABF7158809CF4F3C", loraWan->readAppSKey(appSKey));
+  HOST_CHECK_EQUAL(nbCommands + 1, modem.getNbCommands());
+  HOST_CHECK_STRING("AT+MAC=RAPPSKEY", modem.getLastCommand().c_str());
+
+  /* Device address from the join line, identity kept */
+  nbCommands = modem.getNbCommands();
+  HOST_CHECK_STRING("26011F55", loraWan->readDevAddr(devAddr));
+  HOST_CHECK_STRING("70B3D5E75F600001", loraWan->readDevUID(devUID));
+  HOST_CHECK_EQUAL(nbCommands, modem.getNbCommands());
+}
+
+int main()
+{
+  /* Quiet network: every command answered in 5 ms, join in 6 s */
+  modem.configure("latency 5");
+  modem.configure("join 6000");
+  modem.configure("send_delay 0");
+  hostSetTransport(&modem);
+  simulatedClock.start();
+
+  if (nemeusLib.init() != NEMEUS_SUCCESS)
+  {
+    printf("the simulator doesn't answer\n");
+    return 1;
+  }
+
+  HOST_RUN(testCacheHit);
+  HOST_RUN(testSetUpdates);
+  HOST_RUN(testJoinInvalidates);
+
+  return hostTestResult();
+}
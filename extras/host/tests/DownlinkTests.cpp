@@ -0,0 +1,135 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * DownlinkTests.cpp - LoRaWAN downlink frames given to the downlink
+ *                  callback and to the event subscribers
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include "HostTest.h"
+#include "NemeusLib.h"
+#include "Mm002Simulator.h"
+#include "SimulatedClock.h"
+
+static Mm002Simulator modem;
+static SimulatedClock simulatedClock;
+
+struct Downlink
+{
+  uint8_t port;
+  boolean more;
+  boolean binary;
+  std::string payload;
+  int rssi;
+  int snr;
+};
+
+static std::vector<Downlink> callbackDownlinks;
+static std::vector<Downlink> eventDownlinks;
+
+static void onReceiveDownlink(uint8_t port, boolean more, const char* hexaPayload, int rssi, int snr)
+{
+  Downlink downlink = {port, more, true, hexaPayload, rssi, snr};
+
+  callbackDownlinks.push_back(downlink);
+}
+
+static void onEvent(const NemeusEvent_t* event)
+{
+  Downlink downlink = {event->downlinkReceived.port, event->downlinkReceived.more,
+                       event->downlinkReceived.binary, event->downlinkReceived.payload,
+                       event->downlinkReceived.rssi, event->downlinkReceived.snr};
+
+  eventDownlinks.push_back(downlink);
+}
+
+static void testMoreFlag()
+{
+  callbackDownlinks.clear();
+  eventDownlinks.clear();
+
+  /* more is true when the network has more frames pending */
+  modem.inject("+MAC: RCVBIN,3,true,CAFE,-85,7", 10);
+  modem.inject("+MAC: RCVBIN,4,false,BEEF,-90,-5", 20);
+  nemeusLib.pollDevice(100);
+
+  HOST_CHECK_EQUAL(2, callbackDownlinks.size());
+  HOST_CHECK_EQUAL(2, eventDownlinks.size());
+  for (size_t i = 0; (i < callbackDownlinks.size()) && (i < eventDownlinks.size()); i++)
+  {
+    HOST_CHECK_EQUAL(i == 0, callbackDownlinks[i].more);
+    HOST_CHECK_EQUAL(callbackDownlinks[i].more, eventDownlinks[i].more);
+    HOST_CHECK_EQUAL(callbackDownlinks[i].port, eventDownlinks[i].port);
+    HOST_CHECK_STRING(callbackDownlinks[i].payload.c_str(), eventDownlinks[i].payload.c_str());
+  }
+  if (callbackDownlinks.size() == 2)
+  {
+    HOST_CHECK_EQUAL(3, callbackDownlinks[0].port);
+    HOST_CHECK_STRING("CAFE", callbackDownlinks[0].payload.c_str());
+    HOST_CHECK_EQUAL(-85, callbackDownlinks[0].rssi);
+    HOST_CHECK_EQUAL(7, callbackDownlinks[0].snr);
+    HOST_CHECK_EQUAL(4, callbackDownlinks[1].port);
+    HOST_CHECK_STRING("BEEF", callbackDownlinks[1].payload.c_str());
+    HOST_CHECK_EQUAL(-5, callbackDownlinks[1].snr);
+  }
+}
+
+static void testTextDownlink()
+{
+  callbackDownlinks.clear();
+  eventDownlinks.clear();
+
+  /* Text payload: subscribers only, the callback takes hexadecimal */
+  modem.inject("+MAC: RCVTXT,5,true,hello,-70,9", 10);
+  nemeusLib.pollDevice(100);
+
+  HOST_CHECK(callbackDownlinks.empty());
+  HOST_CHECK_EQUAL(1, eventDownlinks.size());
+  if (!eventDownlinks.empty())
+  {
+    HOST_CHECK(!eventDownlinks[0].binary);
+    HOST_CHECK(eventDownlinks[0].more);
+    HOST_CHECK_STRING("hello", eventDownlinks[0].payload.c_str());
+  }
+}
+
+int main()
+{
+  /* Quiet network: every command answered in 5 ms */
+  modem.configure("latency 5");
+  hostSetTransport(&modem);
+  simulatedClock.start();
+
+  if (nemeusLib.init() != NEMEUS_SUCCESS)
+  {
+    printf("the simulator doesn't answer\n");
+    return 1;
+  }
+  nemeusLib.loraWan()->register_downlink_callback(onReceiveDownlink);
+  EventBus::getInstance()->subscribe(onEvent, EVENT_DOWNLINK_RECEIVED);
+
+  HOST_RUN(testMoreFlag);
+  HOST_RUN(testTextDownlink);
+
+  return hostTestResult();
+}
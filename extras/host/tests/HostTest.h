@@ -0,0 +1,98 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * HostTest.h - Checks of the host unit tests (run by ctest)
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Usage (one test program per source file):
+ *   static void testOverflow()
+ *   {
+ *     HOST_CHECK(writer.hasOverflowed());
+ *     HOST_CHECK_EQUAL(7, writer.length());
+ *   }
+ *
+ *   int main()
+ *   {
+ *     HOST_RUN(testOverflow);
+ *     return hostTestResult();
+ *   }
+ *
+ * A failed check is printed and the test goes on, the program fails if any
+ * check failed.
+ */
+
+static unsigned hostTestFailures = 0;
+
+#define HOST_CHECK(condition) \
+  do \
+  { \
+    if (!(condition)) \
+    { \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+      hostTestFailures++; \
+    } \
+  } while (0)
+
+#define HOST_CHECK_EQUAL(expected, actual) \
+  do \
+  { \
+    long long expectedValue = (long long)(expected); \
+    long long actualValue = (long long)(actual); \
+    if (expectedValue != actualValue) \
+    { \
+      printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, actualValue, expectedValue); \
+      hostTestFailures++; \
+    } \
+  } while (0)
+
+#define HOST_CHECK_STRING(expected, actual) \
+  do \
+  { \
+    const char* actualString = (actual); \
+    if (strcmp((expected), actualString) != 0) \
+    { \
+      printf("%s:%d: %s is \"%s\", expected \"%s\"\n", __FILE__, __LINE__, #actual, actualString, (expected)); \
+      hostTestFailures++; \
+    } \
+  } while (0)
+
+#define HOST_RUN(test) \
+  do \
+  { \
+    unsigned failures = hostTestFailures; \
+    test(); \
+    printf("%-40s %s\n", #test, (hostTestFailures == failures) ? "ok" : "FAILED"); \
+  } while (0)
+
+/* Exit code of the test program */
+static inline int hostTestResult()
+{
+  return (hostTestFailures == 0) ? 0 : 1;
+}
+
+#endif /* HOST_TEST_H */
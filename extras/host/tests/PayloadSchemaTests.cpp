@@ -0,0 +1,83 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * PayloadSchemaTests.cpp - PayloadSchema bit fields, rounding and saturation
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdint.h>
+
+#include "HostTest.h"
+#include "Utils/PayloadSchema.h"
+
+/* Temperature -40..85 °C by 0.1 °C, pressure 300..1100 hPa by 0.5 hPa, battery flag */
+typedef PayloadSchema< PayloadField<11, -40, 85, 10>,
+                       PayloadField<11, 300, 1100, 2>,
+                       PayloadField<1, 0, 1> > SensorFrame;
+
+static void testSchemaEncoding()
+{
+  uint8_t frame[SensorFrame::SIZE];
+  char hex[2*SensorFrame::SIZE + 1];
+  float temperature;
+  float pressure;
+  int lowBattery;
+
+  HOST_CHECK_EQUAL(23, SensorFrame::BITS);
+  HOST_CHECK_EQUAL(3, SensorFrame::SIZE);
+
+  /* 615 (21.5 °C), 1426 (1013 hPa), 1: MSB first in declaration order */
+  SensorFrame::encode(frame, 21.5f, 1013.0, 1);
+  payloadToHex(frame, sizeof(frame), hex);
+  HOST_CHECK_STRING("4CF64A", hex);
+
+  HOST_CHECK(SensorFrame::decode(frame, sizeof(frame), &temperature, &pressure, &lowBattery));
+  HOST_CHECK(temperature == 21.5f);
+  HOST_CHECK(pressure == 1013.0f);
+  HOST_CHECK_EQUAL(1, lowBattery);
+
+  HOST_CHECK(!SensorFrame::decode(frame, sizeof(frame) - 1, &temperature, &pressure, &lowBattery));
+}
+
+static void testSchemaSaturation()
+{
+  uint8_t frame[SensorFrame::SIZE];
+  int temperature;
+  int pressure;
+  int lowBattery;
+
+  SensorFrame::encode(frame, -100, 2000, 5);
+  HOST_CHECK(SensorFrame::decode(frame, sizeof(frame), &temperature, &pressure, &lowBattery));
+  HOST_CHECK_EQUAL(-40, temperature);
+  HOST_CHECK_EQUAL(1100, pressure);
+  HOST_CHECK_EQUAL(1, lowBattery);
+
+  /* Rounded to the nearest step */
+  HOST_CHECK_EQUAL(1, (PayloadField<11, 300, 1100, 2>::toRaw(300.3f)));
+  HOST_CHECK_EQUAL(0, (PayloadField<11, 300, 1100, 2>::toRaw(300.2f)));
+}
+
+int main()
+{
+  HOST_RUN(testSchemaEncoding);
+  HOST_RUN(testSchemaSaturation);
+
+  return hostTestResult();
+}
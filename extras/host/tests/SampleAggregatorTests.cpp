@@ -0,0 +1,139 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * SampleAggregatorTests.cpp - SampleAggregator frames at the data rate,
+ *                  against the MM002 simulator in simulated time
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string>
+
+#include "HostTest.h"
+#include "NemeusLib.h"
+#include "Mm002Simulator.h"
+#include "SimulatedClock.h"
+
+static Mm002Simulator modem;
+static SimulatedClock simulatedClock;
+
+/* Payload of the last MAC=SNDBIN command */
+static std::string lastPayload()
+{
+  const std::string& command = modem.getLastCommand();
+  size_t start = command.find(',');
+  size_t end = command.find(',', start + 1);
+
+  if ( (command.compare(0, 14, "AT+MAC=SNDBIN,") != 0) || (end == std::string::npos) )
+  {
+    return "";
+  }
+  return command.substr(start + 1, end - start - 1);
+}
+
+static void setDataRate(MAC_DATA_RATE dataRate)
+{
+  MacDataRate macDataRate;
+
+  macDataRate.setDataRate(dataRate);
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, nemeusLib.loraWan()->setDataRate(macDataRate));
+}
+
+static void testAggregatorFullFrame()
+{
+  SampleAggregator aggregator(3, 10);
+  uint8_t record[10] = {0};
+  uint8_t large[47] = {0};
+  uint32_t nbUplinks = modem.getNbUplinks();
+
+  /* 51 bytes at SF12: header and 4 records of 12 bytes */
+  setDataRate(MAC_DR_SF12BW125);
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    record[0] = i;
+    HOST_CHECK_EQUAL(NEMEUS_SUCCESS, aggregator.add(record, sizeof(record)));
+    simulatedClock.advance(1000);
+  }
+  HOST_CHECK_EQUAL(nbUplinks, modem.getNbUplinks());
+  HOST_CHECK_EQUAL(3, aggregator.pendingRecords());
+  HOST_CHECK_EQUAL(2 + 3*12, aggregator.pendingSize());
+
+  /* No room for a fifth: sent with the fourth */
+  record[0] = 3;
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, aggregator.add(record, sizeof(record)));
+  HOST_CHECK_EQUAL(nbUplinks + 1, modem.getNbUplinks());
+  HOST_CHECK_EQUAL(0, aggregator.pendingRecords());
+  HOST_CHECK_EQUAL(2*50, lastPayload().size());
+  /* Age 3 s, second record 1 s after the first */
+  HOST_CHECK(lastPayload().compare(0, 4, "0003") == 0);
+  HOST_CHECK(lastPayload().compare(28, 6, "000101") == 0);
+
+  /* Larger than a frame with its headers */
+  HOST_CHECK_EQUAL(NEMEUS_ARGUMENT_ERROR, SampleAggregator(3).add(large, sizeof(large)));
+}
+
+static void testAggregatorSplit()
+{
+  SampleAggregator aggregator(3, 10);
+  uint8_t record[10] = {0};
+  uint32_t nbUplinks;
+
+  /* 10 records fit at SF7 (242 bytes) */
+  setDataRate(MAC_DR_SF7BW125);
+  for (uint8_t i = 0; i < 10; i++)
+  {
+    record[0] = i;
+    HOST_CHECK_EQUAL(NEMEUS_SUCCESS, aggregator.add(record, sizeof(record)));
+  }
+  HOST_CHECK_EQUAL(10, aggregator.pendingRecords());
+  HOST_CHECK_EQUAL(2 + 10*12, aggregator.pendingSize());
+
+  /* Back to SF12: 4, 4 and 2 records */
+  setDataRate(MAC_DR_SF12BW125);
+  nbUplinks = modem.getNbUplinks();
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, aggregator.flush());
+  HOST_CHECK_EQUAL(nbUplinks + 3, modem.getNbUplinks());
+  HOST_CHECK_EQUAL(0, aggregator.pendingRecords());
+  HOST_CHECK_EQUAL(2*(2 + 2*12), lastPayload().size());
+  /* Last frame starts with the ninth record */
+  HOST_CHECK(lastPayload().compare(4, 6, "000008") == 0);
+}
+
+int main()
+{
+  LoRaWAN* loraWan = nemeusLib.loraWan();
+
+  /* Quiet network: every command answered in 5 ms, join in 6 s */
+  modem.configure("latency 5");
+  modem.configure("join 6000");
+  modem.configure("send_delay 0");
+  hostSetTransport(&modem);
+  simulatedClock.start();
+
+  if ( (nemeusLib.init() != NEMEUS_SUCCESS) || (loraWan->ON('A', true) != NEMEUS_SUCCESS) )
+  {
+    printf("the simulator doesn't answer or join\n");
+    return 1;
+  }
+
+  HOST_RUN(testAggregatorFullFrame);
+  HOST_RUN(testAggregatorSplit);
+
+  return hostTestResult();
+}
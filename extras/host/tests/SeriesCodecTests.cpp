@@ -0,0 +1,115 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * SeriesCodecTests.cpp - SeriesCodec delta/zigzag encoding and decoding
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdint.h>
+
+#include "HostTest.h"
+#include "Utils/SeriesCodec.h"
+
+static const SeriesSample_t SERIES[] =
+{
+  {100, -3},
+  {160, -1},
+  {220, -1},
+  {280, 200}
+};
+
+static void testSeriesEncoding()
+{
+  /* Time and zigzag value, then zigzag delta of time delta and value delta */
+  static const uint8_t expected[] = {0x64, 0x05, 0x78, 0x04, 0x00, 0x00, 0x00, 0x92, 0x03};
+  uint8_t buffer[16];
+  SeriesEncoder encoder(buffer, sizeof(buffer));
+
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    HOST_CHECK_EQUAL(encoder.getSampleSize(SERIES[i].time, SERIES[i].value), (i == 3) ? 3 : 2);
+    HOST_CHECK(encoder.add(SERIES[i].time, SERIES[i].value));
+  }
+  HOST_CHECK_EQUAL(4, encoder.getCount());
+  HOST_CHECK_EQUAL(sizeof(expected), encoder.getSize());
+  HOST_CHECK(memcmp(buffer, expected, sizeof(expected)) == 0);
+}
+
+static void testSeriesBudget()
+{
+  uint8_t buffer[8];
+  SeriesEncoder encoder(buffer, sizeof(buffer));
+
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    HOST_CHECK(encoder.add(SERIES[i].time, SERIES[i].value));
+  }
+  /* 3 bytes don't fit in the 2 left, the encoder is unchanged */
+  HOST_CHECK(!encoder.add(SERIES[3].time, SERIES[3].value));
+  HOST_CHECK_EQUAL(3, encoder.getCount());
+  HOST_CHECK_EQUAL(6, encoder.getSize());
+
+  HOST_CHECK_EQUAL(3, seriesFittingSamples(SERIES, 4, 8));
+  HOST_CHECK_EQUAL(4, seriesFittingSamples(SERIES, 4, 9));
+  HOST_CHECK_EQUAL(0, seriesFittingSamples(SERIES, 4, 1));
+
+  encoder.reset(sizeof(buffer));
+  HOST_CHECK_EQUAL(0, encoder.getCount());
+  HOST_CHECK_EQUAL(0, encoder.getSize());
+}
+
+static void testSeriesRoundTrip()
+{
+  /* Wrapping time and extreme values */
+  static const SeriesSample_t samples[] =
+  {
+    {0xFFFFFFF0UL, INT32_MIN},
+    {5, INT32_MAX},
+    {6, 0},
+    {0x80000000UL, -1}
+  };
+  SeriesSample_t decoded[8];
+  uint8_t buffer[64];
+  SeriesEncoder encoder(buffer, sizeof(buffer));
+
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    HOST_CHECK(encoder.add(samples[i].time, samples[i].value));
+  }
+  HOST_CHECK_EQUAL(4, seriesDecode(buffer, encoder.getSize(), decoded, 8));
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    HOST_CHECK_EQUAL(samples[i].time, decoded[i].time);
+    HOST_CHECK_EQUAL(samples[i].value, decoded[i].value);
+  }
+
+  /* Decoding stops on a truncated sample and at the capacity */
+  HOST_CHECK_EQUAL(3, seriesDecode(buffer, encoder.getSize() - 1, decoded, 8));
+  HOST_CHECK_EQUAL(2, seriesDecode(buffer, encoder.getSize(), decoded, 2));
+}
+
+int main()
+{
+  HOST_RUN(testSeriesEncoding);
+  HOST_RUN(testSeriesBudget);
+  HOST_RUN(testSeriesRoundTrip);
+
+  return hostTestResult();
+}
@@ -0,0 +1,107 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * ShadowTests.cpp - MAC settings shadow: redundant setters send nothing,
+ *                  a module reset forgets the settings
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "HostTest.h"
+#include "NemeusLib.h"
+#include "Mm002Simulator.h"
+#include "SimulatedClock.h"
+
+static Mm002Simulator modem;
+static SimulatedClock simulatedClock;
+
+static MacDataRate dataRate(MAC_DATA_RATE value, uint8_t txPower)
+{
+  MacDataRate macDataRate;
+
+  macDataRate.setDataRate(value);
+  macDataRate.setTxPower(txPower);
+
+  return macDataRate;
+}
+
+static void testRedundantSetters()
+{
+  LoRaWAN* loraWan = nemeusLib.loraWan();
+  uint32_t nbCommands;
+
+  /* Values the module doesn't hold yet: sent */
+  nbCommands = modem.getNbCommands();
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, loraWan->setAdr(true, false));
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, loraWan->setEncryption(false));
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, loraWan->setDataRate(dataRate(MAC_DR_SF9BW125, 14)));
+  HOST_CHECK_EQUAL(nbCommands + 3, modem.getNbCommands());
+
+  /* Same values: no AT command */
+  nbCommands = modem.getNbCommands();
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, loraWan->setAdr(true, false));
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, loraWan->setAdr(true));
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, loraWan->setEncryption(false));
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, loraWan->setDataRate(dataRate(MAC_DR_SF9BW125, 14)));
+  HOST_CHECK_EQUAL(nbCommands, modem.getNbCommands());
+
+  /* A changed value is sent */
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, loraWan->setAdr(false));
+  HOST_CHECK_EQUAL(nbCommands + 1, modem.getNbCommands());
+  HOST_CHECK_STRING("AT+MAC=SADR,false", modem.getLastCommand().c_str());
+}
+
+static void testResetInvalidates()
+{
+  LoRaWAN* loraWan = nemeusLib.loraWan();
+  uint32_t nbCommands;
+
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, loraWan->setEncryption(true));
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, loraWan->setDataRate(dataRate(MAC_DR_SF7BW125, 14)));
+
+  /* The module is back to its defaults: the same values are sent again */
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, NemeusUART::getInstance()->reset());
+  HOST_CHECK_EQUAL(0, loraWan->getKnownMaximumPayloadSize());
+  nbCommands = modem.getNbCommands();
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, loraWan->setEncryption(true));
+  HOST_CHECK_EQUAL(nbCommands + 1, modem.getNbCommands());
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, loraWan->setDataRate(dataRate(MAC_DR_SF7BW125, 14)));
+  HOST_CHECK_EQUAL(nbCommands + 2, modem.getNbCommands());
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, loraWan->setAdr(false));
+  HOST_CHECK_EQUAL(nbCommands + 3, modem.getNbCommands());
+}
+
+int main()
+{
+  /* Quiet network: every command answered in 5 ms */
+  modem.configure("latency 5");
+  hostSetTransport(&modem);
+  simulatedClock.start();
+
+  if (nemeusLib.init() != NEMEUS_SUCCESS)
+  {
+    printf("the simulator doesn't answer\n");
+    return 1;
+  }
+
+  HOST_RUN(testRedundantSetters);
+  HOST_RUN(testResetInvalidates);
+
+  return hostTestResult();
+}
@@ -0,0 +1,190 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * SnapshotTests.cpp - ConfigSnapshot storage and CRC
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "HostTest.h"
+#include "NemeusUART.h"
+#include "Data/ConfigSnapshot.h"
+#include "Utils/NvmStorage.h"
+
+/* CRC-32 (IEEE 802.3), reflected, one byte at a time with its table */
+static uint32_t referenceCrc(const uint8_t* data, size_t size)
+{
+  static uint32_t table[256];
+  uint32_t crc = 0xFFFFFFFF;
+
+  if (table[1] == 0)
+  {
+    for (uint32_t i = 0; i < 256; i++)
+    {
+      uint32_t entry = i;
+
+      for (uint8_t bit = 0; bit < 8; bit++)
+      {
+        entry = (entry & 1) ? (entry >> 1) ^ 0xEDB88320UL : (entry >> 1);
+      }
+      table[i] = entry;
+    }
+  }
+  for (size_t i = 0; i < size; i++)
+  {
+    crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  }
+
+  return ~crc;
+}
+
+static void eraseStorage()
+{
+  uint8_t erased[NVM_STORAGE_SIZE];
+
+  memset(erased, 0xFF, sizeof(erased));
+  nvmStorageWrite(erased, sizeof(erased));
+}
+
+static void fill(ConfigSnapshot& snapshot)
+{
+  ConfigSnapshot_t* content = snapshot.getSnapshot();
+
+  strcpy(content->macStatus, "1,A,1,0,868");
+  content->encryption = 1;
+  content->adr = 1;
+  content->piggyback = 0;
+  content->txPower = 14;
+  strcpy(content->dataRate, "SF9BW125");
+}
+
+static void testSaveAndLoad()
+{
+  ConfigSnapshot saved;
+  ConfigSnapshot loaded;
+
+  eraseStorage();
+  HOST_CHECK(!loaded.load());
+  HOST_CHECK(!loaded.isStored());
+
+  fill(saved);
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, saved.save());
+  HOST_CHECK(saved.isStored());
+
+  HOST_CHECK(loaded.load());
+  HOST_CHECK(loaded.isStored());
+  HOST_CHECK(memcmp(saved.getSnapshot(), loaded.getSnapshot(), sizeof(ConfigSnapshot_t)) == 0);
+  HOST_CHECK_EQUAL(CONFIG_SNAPSHOT_VERSION, loaded.getSnapshot()->version);
+  HOST_CHECK_EQUAL(sizeof(ConfigSnapshot_t), loaded.getSnapshot()->size);
+  HOST_CHECK_STRING("SF9BW125", loaded.getSnapshot()->dataRate);
+}
+
+static void testCrc()
+{
+  ConfigSnapshot snapshot;
+  ConfigSnapshot_t stored;
+
+  /* Check value of the CRC-32 */
+  HOST_CHECK_EQUAL(0xCBF43926UL, referenceCrc((const uint8_t*)"123456789", 9));
+
+  eraseStorage();
+  fill(snapshot);
+  snapshot.save();
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, nvmStorageRead(&stored, sizeof(stored)));
+  HOST_CHECK_EQUAL(referenceCrc((const uint8_t*)&stored, offsetof(ConfigSnapshot_t, crc)), stored.crc);
+}
+
+static void testCorruptedSnapshot()
+{
+  ConfigSnapshot snapshot;
+  ConfigSnapshot_t stored;
+
+  eraseStorage();
+  fill(snapshot);
+  snapshot.save();
+  nvmStorageRead(&stored, sizeof(stored));
+
+  /* Any changed byte is detected */
+  for (size_t i = 0; i < sizeof(stored); i++)
+  {
+    ConfigSnapshot_t corrupted = stored;
+    ConfigSnapshot loaded;
+
+    ((uint8_t*)&corrupted)[i] ^= 0x10;
+    nvmStorageWrite(&corrupted, sizeof(corrupted));
+    HOST_CHECK(!loaded.load());
+  }
+
+  /* Another version, even with a valid CRC */
+  stored.version = CONFIG_SNAPSHOT_VERSION + 1;
+  stored.crc = referenceCrc((const uint8_t*)&stored, offsetof(ConfigSnapshot_t, crc));
+  nvmStorageWrite(&stored, sizeof(stored));
+  HOST_CHECK(!snapshot.load());
+}
+
+static void testInvalidate()
+{
+  ConfigSnapshot snapshot;
+  ConfigSnapshot_t stored;
+  ConfigSnapshot_t erased;
+
+  memset(&erased, 0xFF, sizeof(erased));
+  eraseStorage();
+  fill(snapshot);
+  snapshot.save();
+
+  /* Same configuration: the stored snapshot is kept */
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, snapshot.invalidate());
+  HOST_CHECK(snapshot.isStored());
+  nvmStorageRead(&stored, sizeof(stored));
+  HOST_CHECK(memcmp(&stored, snapshot.getSnapshot(), sizeof(stored)) == 0);
+
+  /* Changed: erased, and stays erased until saved */
+  snapshot.getSnapshot()->adr = 0;
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, snapshot.invalidate());
+  HOST_CHECK(!snapshot.isStored());
+  nvmStorageRead(&stored, sizeof(stored));
+  HOST_CHECK(memcmp(&stored, &erased, sizeof(stored)) == 0);
+
+  snapshot.getSnapshot()->txPower = 8;
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, snapshot.invalidate());
+  nvmStorageRead(&stored, sizeof(stored));
+  HOST_CHECK(memcmp(&stored, &erased, sizeof(stored)) == 0);
+
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, snapshot.save());
+  HOST_CHECK(snapshot.load());
+  HOST_CHECK_EQUAL(0, snapshot.getSnapshot()->adr);
+  HOST_CHECK_EQUAL(8, snapshot.getSnapshot()->txPower);
+}
+
+int main()
+{
+  /* Storage in memory, whatever the environment */
+  unsetenv(NVM_STORAGE_HOST_ENV);
+
+  HOST_RUN(testSaveAndLoad);
+  HOST_RUN(testCrc);
+  HOST_RUN(testCorruptedSnapshot);
+  HOST_RUN(testInvalidate);
+
+  return hostTestResult();
+}
@@ -0,0 +1,211 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * UplinkSchedulerTests.cpp - UplinkScheduler queue, priorities and deadlines,
+ *                  against the MM002 simulator in simulated time
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <vector>
+
+#include "HostTest.h"
+#include "NemeusLib.h"
+#include "Mm002Simulator.h"
+#include "SimulatedClock.h"
+
+static Mm002Simulator modem;
+static SimulatedClock simulatedClock;
+
+struct JobDone
+{
+  uint8_t jobId;
+  uint8_t technology;
+  uint8_t errorCode;
+};
+
+static std::vector<JobDone> jobsDone;
+
+static void onJobDone(uint8_t jobId, uint8_t technology, uint8_t errorCode)
+{
+  JobDone done = {jobId, technology, errorCode};
+
+  jobsDone.push_back(done);
+}
+
+static uint8_t submit(uint8_t priority, uint32_t deadline)
+{
+  UplinkJob_t job;
+  uint8_t jobId = 0;
+
+  memset(&job, 0, sizeof(job));
+  job.technologies = UPLINK_LORAWAN;
+  job.priority = priority;
+  job.deadline = deadline;
+  job.macPort = 2;
+  job.size = 4;
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, UplinkScheduler::getInstance()->submit(&job, &jobId));
+
+  return jobId;
+}
+
+static void testQueueFull()
+{
+  UplinkScheduler* scheduler = UplinkScheduler::getInstance();
+  uint8_t jobIds[UPLINK_QUEUE_SIZE];
+  UplinkJob_t job;
+
+  jobsDone.clear();
+  for (uint8_t i = 0; i < UPLINK_QUEUE_SIZE; i++)
+  {
+    jobIds[i] = submit(UPLINK_PRIORITY_NORMAL, 0);
+  }
+
+  /* Not more important than the queued jobs */
+  memset(&job, 0, sizeof(job));
+  job.technologies = UPLINK_LORAWAN;
+  job.priority = UPLINK_PRIORITY_NORMAL;
+  job.size = 4;
+  HOST_CHECK_EQUAL(NEMEUS_ERROR_QUEUE_FULL, scheduler->submit(&job, NULL));
+  HOST_CHECK(jobsDone.empty());
+
+  /* The last normal job to be dispatched is dropped */
+  submit(UPLINK_PRIORITY_HIGH, 0);
+  HOST_CHECK_EQUAL(UPLINK_QUEUE_SIZE, scheduler->pendingJobs());
+  HOST_CHECK_EQUAL(1, jobsDone.size());
+  if (!jobsDone.empty())
+  {
+    HOST_CHECK_EQUAL(jobIds[UPLINK_QUEUE_SIZE - 1], jobsDone[0].jobId);
+    HOST_CHECK_EQUAL(NEMEUS_ERROR_QUEUE_FULL, jobsDone[0].errorCode);
+  }
+  HOST_CHECK_EQUAL(NEMEUS_ARGUMENT_ERROR, scheduler->cancel(jobIds[UPLINK_QUEUE_SIZE - 1]));
+
+  /* Invalid jobs */
+  job.size = 0;
+  HOST_CHECK_EQUAL(NEMEUS_ARGUMENT_ERROR, scheduler->submit(&job, NULL));
+  job.size = UPLINK_MAX_PAYLOAD + 1;
+  HOST_CHECK_EQUAL(NEMEUS_ARGUMENT_ERROR, scheduler->submit(&job, NULL));
+
+  for (uint8_t id = 0; id != 0xFF; id++)
+  {
+    scheduler->cancel(id);
+  }
+  HOST_CHECK_EQUAL(0, scheduler->pendingJobs());
+}
+
+static void testPriorities()
+{
+  UplinkScheduler* scheduler = UplinkScheduler::getInstance();
+  uint8_t low = submit(UPLINK_PRIORITY_LOW, 0);
+  uint8_t normal = submit(UPLINK_PRIORITY_NORMAL, 0);
+  uint8_t urgent = submit(UPLINK_PRIORITY_URGENT, 0);
+  uint8_t normalDeadline = submit(UPLINK_PRIORITY_NORMAL, 3600000);
+  uint8_t normalLast = submit(UPLINK_PRIORITY_NORMAL, 0);
+  /* Priority, then a deadline first, then submission order */
+  const uint8_t expected[] = {urgent, normalDeadline, normal, normalLast, low};
+
+  jobsDone.clear();
+  while ( (scheduler->pendingJobs() != 0) && (jobsDone.size() < 10) )
+  {
+    simulatedClock.advance(scheduler->nextDispatchDelay());
+    scheduler->process();
+  }
+
+  HOST_CHECK_EQUAL(5, jobsDone.size());
+  for (size_t i = 0; (i < jobsDone.size()) && (i < 5); i++)
+  {
+    HOST_CHECK_EQUAL(expected[i], jobsDone[i].jobId);
+    HOST_CHECK_EQUAL(UPLINK_LORAWAN, jobsDone[i].technology);
+    HOST_CHECK_EQUAL(NEMEUS_SUCCESS, jobsDone[i].errorCode);
+  }
+}
+
+static void testDeadline()
+{
+  UplinkScheduler* scheduler = UplinkScheduler::getInstance();
+  uint8_t first = submit(UPLINK_PRIORITY_NORMAL, 0);
+  uint8_t expiring = submit(UPLINK_PRIORITY_NORMAL, 1000);
+
+  /* The first send waits for the duty cycle of the previous test */
+  jobsDone.clear();
+  simulatedClock.advance(scheduler->nextDispatchDelay());
+  scheduler->process();
+
+  HOST_CHECK_EQUAL(1, jobsDone.size());
+  if (!jobsDone.empty())
+  {
+    HOST_CHECK_EQUAL(expiring, jobsDone[0].jobId);
+    HOST_CHECK_EQUAL(NEMEUS_ERROR_EXPIRED, jobsDone[0].errorCode);
+  }
+  HOST_CHECK_EQUAL(NEMEUS_SUCCESS, scheduler->cancel(first));
+}
+
+static void testUnknownDataRate()
+{
+  UplinkScheduler* scheduler = UplinkScheduler::getInstance();
+  uint8_t jobId = submit(UPLINK_PRIORITY_NORMAL, 0);
+  uint32_t nbCommands;
+
+  /* Data rate forgotten (module reset): the queries don't ask the module */
+  nemeusLib.loraWan()->invalidateShadow();
+  nbCommands = modem.getNbCommands();
+  HOST_CHECK_EQUAL(0, scheduler->nextDispatchDelay());
+  HOST_CHECK_EQUAL(nbCommands, modem.getNbCommands());
+
+  /* process() reads it, then sends */
+  jobsDone.clear();
+  while ( (scheduler->pendingJobs() != 0) && (jobsDone.size() < 2) )
+  {
+    simulatedClock.advance(scheduler->nextDispatchDelay());
+    scheduler->process();
+  }
+  HOST_CHECK_EQUAL(1, jobsDone.size());
+  if (!jobsDone.empty())
+  {
+    HOST_CHECK_EQUAL(jobId, jobsDone[0].jobId);
+    HOST_CHECK_EQUAL(NEMEUS_SUCCESS, jobsDone[0].errorCode);
+  }
+  HOST_CHECK(nemeusLib.loraWan()->getKnownMaximumPayloadSize() != 0);
+}
+
+int main()
+{
+  LoRaWAN* loraWan = nemeusLib.loraWan();
+
+  /* Quiet network: every command answered in 5 ms, join in 6 s */
+  modem.configure("latency 5");
+  modem.configure("join 6000");
+  modem.configure("send_delay 0");
+  hostSetTransport(&modem);
+  simulatedClock.start();
+
+  if ( (nemeusLib.init() != NEMEUS_SUCCESS) || (loraWan->ON('A', true) != NEMEUS_SUCCESS) )
+  {
+    printf("the simulator doesn't answer or join\n");
+    return 1;
+  }
+  UplinkScheduler::getInstance()->register_job_callback(onJobDone);
+
+  HOST_RUN(testQueueFull);
+  HOST_RUN(testPriorities);
+  HOST_RUN(testDeadline);
+  HOST_RUN(testUnknownDataRate);
+
+  return hostTestResult();
+}
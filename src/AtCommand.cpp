@@ -24,39 +24,58 @@
 
 #include "AtCommand.h"
 
-
-AtCommand::AtCommand(int value, const char* stringCommand) : enumValue(value), stringCommand(stringCommand)
-{
-}
-AtCommand::AtCommand() : enumValue(0), stringCommand("")
-{
-
-}
-
-int AtCommand::getCode() const
+/* Every AT command, in AT_COMMAND_CODE order (constant initialized, kept in flash) */
+constexpr AtCommand atCommands[AT_CMD_NB + 1] =
 {
-  return this->enumValue;
-}
+  AtCommand(AT_CMD_MAC_ON, "AT+MAC=ON,"),
+  AtCommand(AT_CMD_MAC_OFF, "AT+MAC=OFF\r\n"),
+  AtCommand(AT_CMD_MAC_STATUS, "AT+MAC=?\r\n", RSP_MAC_PREFIX),
+  AtCommand(AT_CMD_RF_STATUS, "AT+RF=?\r\n", RSP_RF_PREFIX),
+  AtCommand(AT_CMD_RESET_COLD, "~K\nAT+GA=DIND,1,8401\r\n"),
+  AtCommand(AT_CMD_AT_TRACE, "AT+DEBUG=MV"),
+  AtCommand(AT_CMD_RF_TX_SNDBIN, "AT+RFTX=SNDBIN,"),
+  AtCommand(AT_CMD_RF_TX_SET_STATE, "AT+RF="),
+  AtCommand(AT_CMD_MAC_SEND, "AT+MAC=SND"),
+  AtCommand(AT_CMD_MAC_READ_DATA_RATE, "AT+MAC=RDR\r\n", RSP_MAC_PREFIX),
+  AtCommand(AT_CMD_MAC_SET_DATA_RATE, "AT+MAC=SDR,"),
+  AtCommand(AT_CMD_MAC_SET_CHANNEL, "AT+MAC=SCH,"),
+  AtCommand(AT_CMD_MAC_READ_CHANNEL, "AT+MAC=RCH,", RSP_MAC_PREFIX),
+  AtCommand(AT_CMD_MAC_READ_ADR, "AT+MAC=RADR\r\n", RSP_MAC_PREFIX),
+  AtCommand(AT_CMD_MAC_SET_ADR, "AT+MAC=SADR,"),
+  AtCommand(AT_CMD_MAC_READ_VAR, "AT+MAC=RVAR\r\n", RSP_MAC_PREFIX),
+  AtCommand(AT_CMD_MAC_SET_VAR, "AT+MAC=SVAR,"),
+  AtCommand(AT_CMD_MAC_READ_DEVUID, "AT+MAC=RDEVUID\r\n", RSP_MAC_PREFIX),
+  AtCommand(AT_CMD_MAC_READ_DEVADDR, "AT+MAC=RDEVADDR\r\n", RSP_MAC_PREFIX),
+  AtCommand(AT_CMD_MAC_SET_DEVADDR, "AT+MAC=SDEVADDR,"),
+  AtCommand(AT_CMD_AT_POWER_SET, "AT+GA=DIND,1,8802"),
+  AtCommand(AT_CMD_MAC_READ_APPKEY, "AT+MAC=RAPPKEY\r\n", RSP_MAC_PREFIX),
+  AtCommand(AT_CMD_MAC_SET_APPKEY, "AT+MAC=SAPPKEY,"),
+  AtCommand(AT_CMD_MAC_READ_APPUID, "AT+MAC=RAPPUID\r\n", RSP_MAC_PREFIX),
+  AtCommand(AT_CMD_MAC_SET_APPUID, "AT+MAC=SAPPUID,"),
+  AtCommand(AT_CMD_MAC_READ_APPSKEY, "AT+MAC=RAPPSKEY\r\n", RSP_MAC_PREFIX),
+  AtCommand(AT_CMD_MAC_READ_NWKSKEY, "AT+MAC=RNSKEY\r\n", RSP_MAC_PREFIX),
+  AtCommand(AT_CMD_SIGFOX_ON, "AT+SF=ON"),
+  AtCommand(AT_CMD_SIGFOX_OFF, "AT+SF=OFF\r\n"),
+  AtCommand(AT_CMD_SIGFOX_SEND_BINARY, "AT+SF=SND"),
+  AtCommand(AT_CMD_RADIO_ON, "AT+RF=ON\r\n"),
+  AtCommand(AT_CMD_RADIO_OFF, "AT+RF=OFF\r\n"),
+  AtCommand(AT_CMD_RADIO_SET_RX_PARAM, "AT+RFRX=SET,"),
+  AtCommand(AT_CMD_RADIO_SET_TX_PARAM, "AT+RFTX=SET,"),
+  AtCommand(AT_CMD_RADIO_SEND_FRAME, "AT+RFTX=SND"),
+  AtCommand(AT_CMD_RADIO_CONTINUOUS_RX, "AT+RFRX=CONTRX\r\n"),
+  AtCommand(AT_CMD_RADIO_STOP_RX, "AT+RFRX=STOP\r\n"),
+  AtCommand(AT_CMD_RADIO_CONTINUOUS_TX, "AT+RFTX=START\r\n"),
+  AtCommand(AT_CMD_RADIO_STOP_TX, "AT+RFTX=STOP\r\n"),
+  AtCommand(AT_CMD_DEBUG_MVER, "AT+DEBUG=MVER\r\n", RSP_DEBUG_PREFIX),
+  AtCommand(AT_CMD_NONE, NULL)
+};
 
-const char* AtCommand::getStringCommand()
-{
-  return this->stringCommand;
-}
-
-bool operator== (const AtCommand &atCmd1, const AtCommand &atCmd2)
-{
-  if ( (atCmd1.enumValue == atCmd2.enumValue) && (strcmp(atCmd1.stringCommand, atCmd2.stringCommand) == 0) )
-  {
-    return true;
-  }
-  else
-  {
-    return false;
-  }
-}
-
-bool operator!= (const AtCommand &atCmd1, const AtCommand &atCmd2)
+/**
+ * Check that each command is at the index of its code
+ */
+constexpr bool atCommandsOrdered(uint8_t code)
 {
-  return !(atCmd1 == atCmd2);
+  return (code > AT_CMD_NB) || ( (atCommands[code].getCode() == code) && atCommandsOrdered(code + 1) );
 }
 
+static_assert(atCommandsOrdered(0), "atCommands must follow the AT_COMMAND_CODE order");
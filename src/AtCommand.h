@@ -26,6 +26,7 @@
 #ifndef AT_COMMAND_H
 #define AT_COMMAND_H
 
+#include <stdint.h>
 #include <string.h>
 
 #define SEPARATOR ","
@@ -41,68 +42,131 @@
 /******************************************************************************
  * AT COMMANDS CONSTANTS
  ******************************************************************************/
-class AtCommand
-{
-  public:
-    int enumValue;
-    const char* stringCommand;
-    int getCode() const;
-    const char* getStringCommand();
-    friend bool operator== (const AtCommand &atCmd1, const AtCommand &atCmd2);
-    friend bool operator!= (const AtCommand &atCmd1, const AtCommand &atCmd2);
-    /* Constructor */
-    AtCommand(int value, const char* stringCommand);
-    AtCommand();
-};
 
 /**
- * AT Command list ( declare AtCommand(Unique ID, AT command string) )
+ * AT command codes, index of the command in atCommands
  */
-const static AtCommand NO_CMD = AtCommand(0xFF, NULL);
-const static AtCommand MAC_ON = AtCommand(0, "AT+MAC=ON,");
-const static AtCommand MAC_OFF = AtCommand(1, "AT+MAC=OFF\r\n");
-const static AtCommand MAC_STATUS = AtCommand(2, "AT+MAC=?\r\n");
-const static AtCommand RF_STATUS = AtCommand(3, "AT+RF=?\r\n");
-const static AtCommand RESET_COLD = AtCommand(4, "~K\nAT+GA=DIND,1,8401\r\n"); // ~K:  command to stop any on going process before doing the cold reset
-const static AtCommand AT_TRACE = AtCommand(5, "AT+DEBUG=MV");
-const static AtCommand RF_TX_SNDBIN = AtCommand(6, "AT+RFTX=SNDBIN,");
-const static AtCommand RF_TX_SET_STATE = AtCommand(7, "AT+RF=");
-const static AtCommand MAC_SEND = AtCommand(8, "AT+MAC=SND");
-const static AtCommand MAC_READ_DATA_RATE = AtCommand(9, "AT+MAC=RDR\r\n");
-const static AtCommand MAC_SET_DATA_RATE = AtCommand(10, "AT+MAC=SDR,");
-const static AtCommand MAC_SET_CHANNEL = AtCommand(11, "AT+MAC=SCH,");
-const static AtCommand MAC_READ_CHANNEL = AtCommand(12, "AT+MAC=RCH,");
-const static AtCommand MAC_READ_ADR = AtCommand(13, "AT+MAC=RADR\r\n");
-const static AtCommand MAC_SET_ADR = AtCommand(14, "AT+MAC=SADR,");
-const static AtCommand MAC_READ_VAR = AtCommand(15, "AT+MAC=RVAR\r\n");
-const static AtCommand MAC_SET_VAR = AtCommand(16, "AT+MAC=SVAR,");
-const static AtCommand MAC_READ_DEVUID = AtCommand(17, "AT+MAC=RDEVUID\r\n");
-const static AtCommand MAC_READ_DEVADDR = AtCommand(18, "AT+MAC=RDEVADDR\r\n");
-const static AtCommand MAC_SET_DEVADDR = AtCommand(19, "AT+MAC=SDEVADDR,");
-const static AtCommand AT_POWER_SET = AtCommand(20, "AT+GA=DIND,1,8802");
-const static AtCommand MAC_READ_APPKEY = AtCommand(21, "AT+MAC=RAPPKEY\r\n");
-const static AtCommand MAC_SET_APPKEY = AtCommand(22, "AT+MAC=SAPPKEY,");
-const static AtCommand MAC_READ_APPUID = AtCommand(23, "AT+MAC=RAPPUID\r\n");
-const static AtCommand MAC_SET_APPUID = AtCommand(24, "AT+MAC=SAPPUID,");
-const static AtCommand MAC_READ_APPSKEY = AtCommand(25, "AT+MAC=RAPPSKEY\r\n");
-const static AtCommand MAC_READ_NWKSKEY = AtCommand(26, "AT+MAC=RNSKEY\r\n");
+enum AT_COMMAND_CODE
+{
+  AT_CMD_MAC_ON = 0,
+  AT_CMD_MAC_OFF,
+  AT_CMD_MAC_STATUS,
+  AT_CMD_RF_STATUS,
+  AT_CMD_RESET_COLD,
+  AT_CMD_AT_TRACE,
+  AT_CMD_RF_TX_SNDBIN,
+  AT_CMD_RF_TX_SET_STATE,
+  AT_CMD_MAC_SEND,
+  AT_CMD_MAC_READ_DATA_RATE,
+  AT_CMD_MAC_SET_DATA_RATE,
+  AT_CMD_MAC_SET_CHANNEL,
+  AT_CMD_MAC_READ_CHANNEL,
+  AT_CMD_MAC_READ_ADR,
+  AT_CMD_MAC_SET_ADR,
+  AT_CMD_MAC_READ_VAR,
+  AT_CMD_MAC_SET_VAR,
+  AT_CMD_MAC_READ_DEVUID,
+  AT_CMD_MAC_READ_DEVADDR,
+  AT_CMD_MAC_SET_DEVADDR,
+  AT_CMD_AT_POWER_SET,
+  AT_CMD_MAC_READ_APPKEY,
+  AT_CMD_MAC_SET_APPKEY,
+  AT_CMD_MAC_READ_APPUID,
+  AT_CMD_MAC_SET_APPUID,
+  AT_CMD_MAC_READ_APPSKEY,
+  AT_CMD_MAC_READ_NWKSKEY,
+  AT_CMD_SIGFOX_ON,
+  AT_CMD_SIGFOX_OFF,
+  AT_CMD_SIGFOX_SEND_BINARY,
+  AT_CMD_RADIO_ON,
+  AT_CMD_RADIO_OFF,
+  AT_CMD_RADIO_SET_RX_PARAM,
+  AT_CMD_RADIO_SET_TX_PARAM,
+  AT_CMD_RADIO_SEND_FRAME,
+  AT_CMD_RADIO_CONTINUOUS_RX,
+  AT_CMD_RADIO_STOP_RX,
+  AT_CMD_RADIO_CONTINUOUS_TX,
+  AT_CMD_RADIO_STOP_TX,
+  AT_CMD_DEBUG_MVER,
+  AT_CMD_NB,
+  AT_CMD_NONE = AT_CMD_NB
+};
 
-const static AtCommand SIGFOX_ON = AtCommand(30, "AT+SF=ON");
-const static AtCommand SIGFOX_OFF = AtCommand(31, "AT+SF=OFF\r\n");
-const static AtCommand SIGFOX_SEND_BINARY = AtCommand(32, "AT+SF=SND");
+/* Prefix of the response lines of MAC and RF read commands */
+#define RSP_MAC_PREFIX          "+MAC: "
+#define RSP_RF_PREFIX           "+RF: "
+#define RSP_DEBUG_PREFIX        "+DEBUG: "
 
+/**
+ * AT command: its code, its string and the prefix of its response lines
+ * (flash resident literals, no response prefix if it only answers OK or ERROR)
+ */
+class AtCommand
+{
+  public:
+    constexpr AtCommand() : code_(AT_CMD_NONE), stringCommand_(NULL), responsePrefix_(NULL) {}
+    constexpr AtCommand(uint8_t code, const char* stringCommand, const char* responsePrefix = NULL)
+      : code_(code), stringCommand_(stringCommand), responsePrefix_(responsePrefix) {}
+    constexpr uint8_t getCode() const { return code_; }
+    constexpr const char* getStringCommand() const { return stringCommand_; }
+    constexpr const char* getResponsePrefix() const { return responsePrefix_; }
+    /* Commands are identified by their code only */
+    constexpr bool operator== (const AtCommand& atCommand) const { return code_ == atCommand.code_; }
+    constexpr bool operator!= (const AtCommand& atCommand) const { return code_ != atCommand.code_; }
+  private:
+    uint8_t code_;
+    const char* stringCommand_;
+    const char* responsePrefix_;
+};
 
-const static AtCommand RADIO_ON = AtCommand(50, "AT+RF=ON\r\n");
-const static AtCommand RADIO_OFF = AtCommand(51, "AT+RF=OFF\r\n");
-const static AtCommand RADIO_SET_RX_PARAM = AtCommand(52, "AT+RFRX=SET,");
-const static AtCommand RADIO_SET_TX_PARAM = AtCommand(53, "AT+RFTX=SET,");
-const static AtCommand RADIO_SEND_FRAME = AtCommand(54, "AT+RFTX=SND");
-const static AtCommand RADIO_CONTINUOUS_RX = AtCommand(55, "AT+RFRX=CONTRX\r\n");
-const static AtCommand RADIO_STOP_RX = AtCommand(56, "AT+RFRX=STOP\r\n");
-const static AtCommand RADIO_CONTINUOUS_TX = AtCommand(57, "AT+RFTX=START\r\n");
-const static AtCommand RADIO_STOP_TX = AtCommand(58, "AT+RFTX=STOP\r\n");
+/* Every AT command, indexed by code (AtCommand.cpp) */
+extern const AtCommand atCommands[AT_CMD_NB + 1];
 
-const static AtCommand DEBUG_MVER = AtCommand(59, "AT+DEBUG=MVER\r\n");
+/**
+ * AT Command list (references, not macros: a sketch can still use these
+ * names in its own scopes, i.e. for a local variable or a class member)
+ */
+static constexpr const AtCommand& NO_CMD              = atCommands[AT_CMD_NONE];
+static constexpr const AtCommand& MAC_ON              = atCommands[AT_CMD_MAC_ON];
+static constexpr const AtCommand& MAC_OFF             = atCommands[AT_CMD_MAC_OFF];
+static constexpr const AtCommand& MAC_STATUS          = atCommands[AT_CMD_MAC_STATUS];
+static constexpr const AtCommand& RF_STATUS           = atCommands[AT_CMD_RF_STATUS];
+static constexpr const AtCommand& RESET_COLD          = atCommands[AT_CMD_RESET_COLD];
+static constexpr const AtCommand& AT_TRACE            = atCommands[AT_CMD_AT_TRACE];
+static constexpr const AtCommand& RF_TX_SNDBIN        = atCommands[AT_CMD_RF_TX_SNDBIN];
+static constexpr const AtCommand& RF_TX_SET_STATE     = atCommands[AT_CMD_RF_TX_SET_STATE];
+static constexpr const AtCommand& MAC_SEND            = atCommands[AT_CMD_MAC_SEND];
+static constexpr const AtCommand& MAC_READ_DATA_RATE  = atCommands[AT_CMD_MAC_READ_DATA_RATE];
+static constexpr const AtCommand& MAC_SET_DATA_RATE   = atCommands[AT_CMD_MAC_SET_DATA_RATE];
+static constexpr const AtCommand& MAC_SET_CHANNEL     = atCommands[AT_CMD_MAC_SET_CHANNEL];
+static constexpr const AtCommand& MAC_READ_CHANNEL    = atCommands[AT_CMD_MAC_READ_CHANNEL];
+static constexpr const AtCommand& MAC_READ_ADR        = atCommands[AT_CMD_MAC_READ_ADR];
+static constexpr const AtCommand& MAC_SET_ADR         = atCommands[AT_CMD_MAC_SET_ADR];
+static constexpr const AtCommand& MAC_READ_VAR        = atCommands[AT_CMD_MAC_READ_VAR];
+static constexpr const AtCommand& MAC_SET_VAR         = atCommands[AT_CMD_MAC_SET_VAR];
+static constexpr const AtCommand& MAC_READ_DEVUID     = atCommands[AT_CMD_MAC_READ_DEVUID];
+static constexpr const AtCommand& MAC_READ_DEVADDR    = atCommands[AT_CMD_MAC_READ_DEVADDR];
+static constexpr const AtCommand& MAC_SET_DEVADDR     = atCommands[AT_CMD_MAC_SET_DEVADDR];
+static constexpr const AtCommand& AT_POWER_SET        = atCommands[AT_CMD_AT_POWER_SET];
+static constexpr const AtCommand& MAC_READ_APPKEY     = atCommands[AT_CMD_MAC_READ_APPKEY];
+static constexpr const AtCommand& MAC_SET_APPKEY      = atCommands[AT_CMD_MAC_SET_APPKEY];
+static constexpr const AtCommand& MAC_READ_APPUID     = atCommands[AT_CMD_MAC_READ_APPUID];
+static constexpr const AtCommand& MAC_SET_APPUID      = atCommands[AT_CMD_MAC_SET_APPUID];
+static constexpr const AtCommand& MAC_READ_APPSKEY    = atCommands[AT_CMD_MAC_READ_APPSKEY];
+static constexpr const AtCommand& MAC_READ_NWKSKEY    = atCommands[AT_CMD_MAC_READ_NWKSKEY];
+static constexpr const AtCommand& SIGFOX_ON           = atCommands[AT_CMD_SIGFOX_ON];
+static constexpr const AtCommand& SIGFOX_OFF          = atCommands[AT_CMD_SIGFOX_OFF];
+static constexpr const AtCommand& SIGFOX_SEND_BINARY  = atCommands[AT_CMD_SIGFOX_SEND_BINARY];
+static constexpr const AtCommand& RADIO_ON            = atCommands[AT_CMD_RADIO_ON];
+static constexpr const AtCommand& RADIO_OFF           = atCommands[AT_CMD_RADIO_OFF];
+static constexpr const AtCommand& RADIO_SET_RX_PARAM  = atCommands[AT_CMD_RADIO_SET_RX_PARAM];
+static constexpr const AtCommand& RADIO_SET_TX_PARAM  = atCommands[AT_CMD_RADIO_SET_TX_PARAM];
+static constexpr const AtCommand& RADIO_SEND_FRAME    = atCommands[AT_CMD_RADIO_SEND_FRAME];
+static constexpr const AtCommand& RADIO_CONTINUOUS_RX = atCommands[AT_CMD_RADIO_CONTINUOUS_RX];
+static constexpr const AtCommand& RADIO_STOP_RX       = atCommands[AT_CMD_RADIO_STOP_RX];
+static constexpr const AtCommand& RADIO_CONTINUOUS_TX = atCommands[AT_CMD_RADIO_CONTINUOUS_TX];
+static constexpr const AtCommand& RADIO_STOP_TX       = atCommands[AT_CMD_RADIO_STOP_TX];
+static constexpr const AtCommand& DEBUG_MVER          = atCommands[AT_CMD_DEBUG_MVER];
 
 /*
    RFRX(0, "\r\nAT+RFRX= ?\r\n"),
@@ -0,0 +1,306 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * AtCommandTemplate.h - AT commands with a typed argument list
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef AT_COMMAND_TEMPLATE_H
+#define AT_COMMAND_TEMPLATE_H
+
+#include <stdint.h>
+#include <string.h>
+#include "AtCommand.h"
+#include "Utils/ArgumentWriter.h"
+
+/**
+ * Usage:
+ *   // AT+MAC=RCH,<channel>,<page>,<unsollicited>
+ *   const static AtCommandTemplate<AtDec<255>, AtDec<255>, AtFlag> MAC_READ_CHANNEL_CMD(MAC_READ_CHANNEL);
+ *
+ *   NemeusUART::getInstance()->sendATCommand(MAC_READ_CHANNEL_CMD, 2000, channel, page, false);
+ *
+ * Arguments are separated by COMMAs and ended by CRLF. Values are converted
+ * to the argument types, one per argument (AtEmpty excepted), their count is
+ * checked at compile time. MAX_LENGTH is the longest arguments, CRLF included.
+ */
+
+/* Empty argument (no value, only its COMMA) */
+struct AtEmpty
+{
+  enum : uint16_t { MAX_LENGTH = 0 };
+};
+
+/* Number of digits of a decimal value */
+constexpr uint16_t atDecLength(uint32_t value)
+{
+  return (value < 10) ? 1 : 1 + atDecLength(value / 10);
+}
+
+/**
+ * Unsigned integer in decimal, from 0 to Max
+ */
+template <uint32_t Max>
+struct AtDec
+{
+  typedef uint32_t Type;
+  enum : uint16_t { MAX_LENGTH = atDecLength(Max) };
+
+  static bool write(ArgumentWriter& arguments, uint32_t value)
+  {
+    if (value > Max)
+    {
+      return false;
+    }
+    arguments.appendDec(value);
+    return true;
+  }
+};
+
+/**
+ * Boolean as 1 or 0
+ */
+struct AtFlag
+{
+  typedef bool Type;
+  enum : uint16_t { MAX_LENGTH = 1 };
+
+  static bool write(ArgumentWriter& arguments, bool value)
+  {
+    arguments.append(value ? '1' : '0');
+    return true;
+  }
+};
+
+/**
+ * One character (i.e LoRaWAN class)
+ */
+struct AtChar
+{
+  typedef char Type;
+  enum : uint16_t { MAX_LENGTH = 1 };
+
+  static bool write(ArgumentWriter& arguments, char value)
+  {
+    if ( (value <= ' ') || (value == ',') )
+    {
+      return false;
+    }
+    arguments.append(value);
+    return true;
+  }
+};
+
+/**
+ * Word of at most MaxLength characters (i.e "BIN")
+ */
+template <uint16_t MaxLength>
+struct AtWord
+{
+  typedef const char* Type;
+  enum : uint16_t { MAX_LENGTH = MaxLength };
+
+  static bool write(ArgumentWriter& arguments, const char* value)
+  {
+    if ( (value == NULL) || (strlen(value) > MaxLength) )
+    {
+      return false;
+    }
+    arguments.append(value);
+    return true;
+  }
+};
+
+/**
+ * Hexadecimal string of exactly Length digits (i.e DevAddr, keys)
+ */
+template <uint16_t Length>
+struct AtHex
+{
+  typedef const char* Type;
+  enum : uint16_t { MAX_LENGTH = Length };
+
+  static bool write(ArgumentWriter& arguments, const char* value)
+  {
+    if (value == NULL)
+    {
+      return false;
+    }
+    for (uint16_t i = 0; i < Length; i++)
+    {
+      char digit = value[i];
+
+      if ( !( ((digit >= '0') && (digit <= '9')) || ((digit >= 'A') && (digit <= 'F'))
+            || ((digit >= 'a') && (digit <= 'f')) ) )
+      {
+        return false;
+      }
+    }
+    if (value[Length] != '\0')
+    {
+      return false;
+    }
+    arguments.append(value, Length);
+    return true;
+  }
+};
+
+/**
+ * Characters of a payload, its length is known (truncated payload)
+ */
+struct AtSpan
+{
+  const char* data;
+  uint16_t length;
+};
+
+/**
+ * Payload of at most MaxLength characters
+ */
+template <uint16_t MaxLength>
+struct AtPayload
+{
+  typedef AtSpan Type;
+  enum : uint16_t { MAX_LENGTH = MaxLength };
+
+  static bool write(ArgumentWriter& arguments, AtSpan value)
+  {
+    if ( (value.data == NULL) || (value.length > MaxLength) )
+    {
+      return false;
+    }
+    arguments.append(value.data, value.length);
+    return true;
+  }
+};
+
+template <typename... Args>
+struct AtArguments;
+
+template <>
+struct AtArguments<>
+{
+  enum : uint16_t
+  {
+    MAX_LENGTH = 0,
+    NB_VALUES = 0
+  };
+
+  static bool write(ArgumentWriter& arguments, bool first)
+  {
+    (void)arguments;
+    (void)first;
+    return true;
+  }
+};
+
+template <typename Arg, typename... Args>
+struct AtArguments<Arg, Args...>
+{
+  typedef AtArguments<Args...> Next;
+
+  enum : uint16_t
+  {
+    MAX_LENGTH = Arg::MAX_LENGTH + ((sizeof...(Args) != 0) ? 1 : 0) + Next::MAX_LENGTH,
+    NB_VALUES = 1 + Next::NB_VALUES
+  };
+
+  template <typename... Values>
+  static bool write(ArgumentWriter& arguments, bool first, typename Arg::Type value, Values... values)
+  {
+    if (!first)
+    {
+      arguments.separator();
+    }
+    if (!Arg::write(arguments, value))
+    {
+      return false;
+    }
+    return Next::write(arguments, false, values...);
+  }
+};
+
+template <typename... Args>
+struct AtArguments<AtEmpty, Args...>
+{
+  typedef AtArguments<Args...> Next;
+
+  enum : uint16_t
+  {
+    MAX_LENGTH = ((sizeof...(Args) != 0) ? 1 : 0) + Next::MAX_LENGTH,
+    NB_VALUES = Next::NB_VALUES
+  };
+
+  template <typename... Values>
+  static bool write(ArgumentWriter& arguments, bool first, Values... values)
+  {
+    if (!first)
+    {
+      arguments.separator();
+    }
+    return Next::write(arguments, false, values...);
+  }
+};
+
+/**
+ * AT command (prefix) and the types of its arguments
+ */
+template <typename... Args>
+class AtCommandTemplate
+{
+  public:
+    typedef AtArguments<Args...> Arguments;
+
+    enum : uint16_t
+    {
+      /* Longest arguments with CRLF */
+      MAX_LENGTH = Arguments::MAX_LENGTH + 2
+    };
+
+    constexpr AtCommandTemplate(const AtCommand& command) : command_(command) {}
+
+    const AtCommand& getCommand() const
+    {
+      return command_;
+    }
+
+    /**
+     * Format the arguments
+     * @param arguments  the writer to append to
+     * @return  false if a value is out of its argument range or doesn't fit
+     */
+    template <typename... Values>
+    bool format(ArgumentWriter& arguments, Values... values) const
+    {
+      static_assert(sizeof...(Values) == Arguments::NB_VALUES, "One value per argument is expected");
+
+      if (!Arguments::write(arguments, true, values...))
+      {
+        return false;
+      }
+      arguments.endOfLine();
+
+      return !arguments.hasOverflowed();
+    }
+  private:
+    const AtCommand& command_;
+};
+
+#endif /* AT_COMMAND_TEMPLATE_H */
@@ -0,0 +1,201 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * AtStats.cpp - Counters and latency histograms of the AT commands
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "AtStats.h"
+#include "Utils/ArgumentWriter.h"
+#include "Utils/CircBuffer.h"
+
+/* Traces received from the module (NemeusUART.cpp) */
+extern CircBuffer circularTraceBuffer;
+
+/* Unique instance */
+template <> AtStats Singleton<AtStats>::_singleton {};
+
+/* Longest line of report() */
+#define AT_STATS_LINE_SIZE 160
+
+#ifdef NEMEUS_AT_STATS
+/* Histogram names, in AT_STATS_PHASE order */
+static const char* const phaseNames[AT_STATS_NB_PHASES] = { " wake ", " tx ", " first ", " response " };
+
+/**
+ * Write a line of the report in the trace buffer
+ * @param writer  the line
+ * @return  false if it doesn't fit
+ */
+static boolean writeLine(const ArgumentWriter& writer)
+{
+  if ( (writer.hasOverflowed()) || (circularTraceBuffer.getSizeRemaining() < writer.length()) )
+  {
+    return false;
+  }
+  circularTraceBuffer.write(writer.c_str(), writer.length());
+
+  return true;
+}
+#endif
+
+/**
+ * Get a counter of a command
+ * @param code  the command code
+ * @param counter  AT_STATS_COUNTER
+ * @return  the count, 0 if out of range or compiled out
+ */
+uint16_t AtStats::getCount(uint8_t code, uint8_t counter) const
+{
+#ifdef NEMEUS_AT_STATS
+  if ( (code < AT_CMD_NB) && (counter < AT_STATS_NB_COUNTERS) )
+  {
+    return table_[code].counts[counter];
+  }
+#else
+  (void)code;
+  (void)counter;
+#endif
+
+  return 0;
+}
+
+/**
+ * Get a bucket of the latency histogram of a command phase
+ * @param code  the command code
+ * @param phase  AT_STATS_PHASE
+ * @param bucket  from 0 to AT_STATS_NB_BUCKETS-1
+ * @return  the number of commands, 0 if out of range or compiled out
+ */
+uint16_t AtStats::getBucket(uint8_t code, uint8_t phase, uint8_t bucket) const
+{
+#ifdef NEMEUS_AT_STATS
+  if ( (code < AT_CMD_NB) && (phase < AT_STATS_NB_PHASES) && (bucket < AT_STATS_NB_BUCKETS) )
+  {
+    return table_[code].buckets[phase][bucket];
+  }
+#else
+  (void)code;
+  (void)phase;
+  (void)bucket;
+#endif
+
+  return 0;
+}
+
+/**
+ * Get the upper limit of a bucket
+ * @param bucket  from 0 to AT_STATS_NB_BUCKETS-1
+ * @return  the first duration in ms above the bucket, 0 for the last one
+ */
+uint32_t AtStats::getBucketLimit(uint8_t bucket)
+{
+  if (bucket >= AT_STATS_NB_BUCKETS - 1)
+  {
+    return 0;
+  }
+
+  return 1ul << (2*bucket);
+}
+
+/**
+ * Clear the counters and histograms
+ */
+void AtStats::reset()
+{
+#ifdef NEMEUS_AT_STATS
+  memset(table_, 0, sizeof(table_));
+#endif
+}
+
+/**
+ * Write the commands sent in the trace buffer, two lines each:
+ *   atstats <code> <command> sent <n> ok <n> error <n> timeout <n>
+ *   atstats <code> wake <buckets> tx <buckets> first <buckets> response <buckets>
+ * after a line giving the bucket limits. Stops if the buffer is full.
+ */
+void AtStats::report()
+{
+#ifdef NEMEUS_AT_STATS
+  char line[AT_STATS_LINE_SIZE];
+  ArgumentWriter writer(line, sizeof(line));
+
+  writer.append("atstats buckets (ms) 0");
+  for (uint8_t bucket = 0; bucket < AT_STATS_NB_BUCKETS - 1; bucket++)
+  {
+    writer.separator().appendDec(getBucketLimit(bucket));
+  }
+  writer.append('\n');
+  if (!writeLine(writer))
+  {
+    return;
+  }
+
+  for (uint8_t code = 0; code < AT_CMD_NB; code++)
+  {
+    const Entry& entry = table_[code];
+    const char* command = atCommands[code].getStringCommand();
+
+    if (entry.counts[AT_STATS_SENT] == 0)
+    {
+      continue;
+    }
+
+    writer.clear();
+    writer.append("atstats ").appendDec(code).append(' ');
+    /* Command without its line ends */
+    for (; *command != '\0'; command++)
+    {
+      if (*command >= ' ')
+      {
+        writer.append(*command);
+      }
+    }
+    writer.append(" sent ").appendDec(entry.counts[AT_STATS_SENT]);
+    writer.append(" ok ").appendDec(entry.counts[AT_STATS_OK]);
+    writer.append(" error ").appendDec(entry.counts[AT_STATS_ERROR]);
+    writer.append(" timeout ").appendDec(entry.counts[AT_STATS_TIMEOUT]).append('\n');
+    if (!writeLine(writer))
+    {
+      return;
+    }
+
+    writer.clear();
+    writer.append("atstats ").appendDec(code);
+    for (uint8_t phase = 0; phase < AT_STATS_NB_PHASES; phase++)
+    {
+      writer.append(phaseNames[phase]);
+      for (uint8_t bucket = 0; bucket < AT_STATS_NB_BUCKETS; bucket++)
+      {
+        if (bucket != 0)
+        {
+          writer.separator();
+        }
+        writer.appendDec(entry.buckets[phase][bucket]);
+      }
+    }
+    writer.append('\n');
+    if (!writeLine(writer))
+    {
+      return;
+    }
+  }
+#endif
+}
@@ -0,0 +1,223 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * AtStats.h - AT command statistics class definition
+ *             Counters and latency histograms per command code
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef AT_STATS_H
+#define AT_STATS_H
+
+#include <stdint.h>
+
+#include "Arduino.h"
+#include "Singleton.h"
+#include "AtCommand.h"
+#include "NemeusUART.h"
+#include "Utils/NemeusClock.h"
+
+/*
+ * Compiled out unless NEMEUS_AT_STATS is defined (build flag): the hooks of
+ * NemeusUART are then empty and the table doesn't exist. Enabled, the table
+ * takes AT_CMD_NB * 72 bytes of RAM.
+ */
+
+/* Histogram buckets, powers of 4 ms: 0, 1-3, 4-15, ..., 1024-4095, 4096 and more */
+#define AT_STATS_NB_BUCKETS 8
+
+/**
+ * Counters of a command
+ */
+enum AT_STATS_COUNTER
+{
+  AT_STATS_SENT = 0,      // commands sent
+  AT_STATS_OK,            // answered OK
+  AT_STATS_ERROR,         // answered ERROR (or ERROR NOACK)
+  AT_STATS_TIMEOUT,       // not answered before the deadline
+  AT_STATS_NB_COUNTERS
+};
+
+/**
+ * Phases of a command, each with its latency histogram
+ */
+enum AT_STATS_PHASE
+{
+  AT_STATS_WAKE = 0,      // wake up pulse
+  AT_STATS_TX,            // command written on the UART
+  AT_STATS_FIRST_BYTE,    // from the end of TX to the first byte received
+  AT_STATS_RESPONSE,      // from the end of TX to OK or ERROR
+  AT_STATS_NB_PHASES
+};
+
+class AtStats : public Singleton<AtStats>
+{
+  friend class Singleton<AtStats>;
+
+  public:
+    /* True if built with NEMEUS_AT_STATS */
+    static constexpr boolean isEnabled()
+    {
+#ifdef NEMEUS_AT_STATS
+      return true;
+#else
+      return false;
+#endif
+    }
+    /* Counter of a command code (AT_STATS_COUNTER), saturates at 65535 */
+    uint16_t getCount(uint8_t code, uint8_t counter) const;
+    /* Commands of a code whose phase (AT_STATS_PHASE) lasted within a bucket */
+    uint16_t getBucket(uint8_t code, uint8_t phase, uint8_t bucket) const;
+    /* First ms not in a bucket (0 for the last one, unbounded) */
+    static uint32_t getBucketLimit(uint8_t bucket);
+    /* Clear the table */
+    void reset();
+    /* Write the table in the trace buffer, printed by printTraces() */
+    void report();
+
+    /* Hooks of NemeusUART::sendATCommand() */
+    inline void commandStarted(uint8_t code);
+    inline void phaseEnded(uint8_t phase);
+    inline void byteReceived();
+    inline void commandEnded(uint8_t result);
+  private:
+#ifdef NEMEUS_AT_STATS
+    constexpr AtStats() : table_(), code_(AT_CMD_NONE), stamp_(0), firstByte_(false) {}
+
+    struct Entry
+    {
+      uint16_t counts[AT_STATS_NB_COUNTERS];
+      uint16_t buckets[AT_STATS_NB_PHASES][AT_STATS_NB_BUCKETS];
+    };
+
+    Entry table_[AT_CMD_NB];
+    uint8_t code_;          // command in flight, AT_CMD_NONE if none
+    uint32_t stamp_;        // end of the previous phase
+    boolean firstByte_;     // first byte of the answer received
+
+    /* Methods */
+    static inline void increment(uint16_t& count)
+    {
+      if (count != UINT16_MAX)
+      {
+        count++;
+      }
+    }
+    static inline uint8_t bucketOf(uint32_t ms)
+    {
+      uint8_t bucket = (ms == 0) ? 0 : (uint8_t)((31 - __builtin_clz(ms)) / 2 + 1);
+
+      return (bucket < AT_STATS_NB_BUCKETS) ? bucket : AT_STATS_NB_BUCKETS - 1;
+    }
+#else
+    constexpr AtStats() {}
+#endif
+};
+
+template <> AtStats Singleton<AtStats>::_singleton;
+
+/**
+ * A command is sent: counted, its phases are timed from now
+ * @param code  the command code
+ */
+inline void AtStats::commandStarted(uint8_t code)
+{
+#ifdef NEMEUS_AT_STATS
+  code_ = (code < AT_CMD_NB) ? code : (uint8_t)AT_CMD_NONE;
+  if (code_ != AT_CMD_NONE)
+  {
+    increment(table_[code_].counts[AT_STATS_SENT]);
+    stamp_ = NemeusClock::get()->now();
+    firstByte_ = false;
+  }
+#else
+  (void)code;
+#endif
+}
+
+/**
+ * End of the wake up or of the TX phase, timed since the previous one
+ * @param phase  AT_STATS_WAKE or AT_STATS_TX
+ */
+inline void AtStats::phaseEnded(uint8_t phase)
+{
+#ifdef NEMEUS_AT_STATS
+  if (code_ != AT_CMD_NONE)
+  {
+    uint32_t now = NemeusClock::get()->now();
+
+    increment(table_[code_].buckets[phase][bucketOf(now - stamp_)]);
+    stamp_ = now;
+  }
+#else
+  (void)phase;
+#endif
+}
+
+/**
+ * Bytes available in the RX buffer while waiting for the answer, the first
+ * ones are timed (before their line is complete)
+ */
+inline void AtStats::byteReceived()
+{
+#ifdef NEMEUS_AT_STATS
+  if ( (code_ != AT_CMD_NONE) && (!firstByte_) )
+  {
+    increment(table_[code_].buckets[AT_STATS_FIRST_BYTE][bucketOf(NemeusClock::get()->now() - stamp_)]);
+    firstByte_ = true;
+  }
+#endif
+}
+
+/**
+ * End of the wait for the answer
+ * @param result  the result of the command (NEMEUS_NO_ANSWER on timeout)
+ */
+inline void AtStats::commandEnded(uint8_t result)
+{
+#ifdef NEMEUS_AT_STATS
+  if (code_ != AT_CMD_NONE)
+  {
+    Entry& entry = table_[code_];
+
+    if (result == NEMEUS_SUCCESS)
+    {
+      increment(entry.counts[AT_STATS_OK]);
+    }
+    else if (result == NEMEUS_NO_ANSWER)
+    {
+      increment(entry.counts[AT_STATS_TIMEOUT]);
+    }
+    else
+    {
+      increment(entry.counts[AT_STATS_ERROR]);
+    }
+    if (result != NEMEUS_NO_ANSWER)
+    {
+      increment(entry.buckets[AT_STATS_RESPONSE][bucketOf(NemeusClock::get()->now() - stamp_)]);
+    }
+    code_ = AT_CMD_NONE;
+  }
+#else
+  (void)result;
+#endif
+}
+
+#endif /* AT_STATS_H */
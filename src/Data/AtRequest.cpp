@@ -0,0 +1,158 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * AtRequest.cpp - Context of an AT command sent: identity, expected responses,
+ *                  deadline and result.
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "AtRequest.h"
+
+/**
+ * Constructor, the request expects the response prefix of its command
+ * @param atCommand  the command sent (from atCommands, not copied)
+ * @param id  identity of the request
+ * @param timeout  time in ms given to the module to answer
+ */
+AtRequest::AtRequest(const AtCommand& atCommand, uint16_t id, uint32_t timeout)
+  : atCommand_(atCommand), id_(id), nbPrefixes_(0), complete_(false), result_(0), nbResponses_(0)
+{
+  expect(atCommand.getResponsePrefix());
+  setDeadline(timeout);
+}
+
+/**
+ * Get the identity of the request
+ * @return  the id given by the sender
+ */
+uint16_t AtRequest::getId() const
+{
+  return id_;
+}
+
+/**
+ * Get the command of the request
+ * @return  the AT command sent
+ */
+const AtCommand& AtRequest::getCommand() const
+{
+  return atCommand_;
+}
+
+/**
+ * Add an expected response prefix
+ * @param prefix  beginning of the response lines (literal, not copied)
+ * @return  false if NULL or AT_REQUEST_MAX_PREFIXES are already expected
+ */
+boolean AtRequest::expect(const char* prefix)
+{
+  if ( (prefix == NULL) || (nbPrefixes_ >= AT_REQUEST_MAX_PREFIXES) )
+  {
+    return false;
+  }
+  prefixes_[nbPrefixes_++] = prefix;
+
+  return true;
+}
+
+/**
+ * Check if a line is a response to this request
+ * @param line  the line received (without CR LF)
+ * @return  true if the line begins with an expected prefix
+ */
+boolean AtRequest::isResponse(const char* line) const
+{
+  for (uint8_t i = 0; i < nbPrefixes_; i++)
+  {
+    if (strncmp(line, prefixes_[i], strlen(prefixes_[i])) == 0)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Set the deadline (i.e when the module announces a delayed send)
+ * @param timeout  time in ms from now
+ */
+void AtRequest::setDeadline(uint32_t timeout)
+{
+  deadline_.setTimeout(timeout);
+}
+
+/**
+ * Check if the deadline is over
+ * @return  true if the module didn't answer in time
+ */
+boolean AtRequest::isExpired()
+{
+  return deadline_.isTimeout();
+}
+
+/**
+ * Get the time left to answer
+ * @return  the time in ms before the deadline, 0 if over
+ */
+uint32_t AtRequest::getRemaining()
+{
+  return deadline_.getRemaining();
+}
+
+/**
+ * Store the result, the request is complete
+ * @param result  the error code (NEMEUS_SUCCESS, NEMEUS_ERROR...)
+ */
+void AtRequest::complete(uint8_t result)
+{
+  complete_ = true;
+  result_ = result;
+}
+
+boolean AtRequest::isComplete() const
+{
+  return complete_;
+}
+
+/**
+ * Get the result
+ * @return  the error code, meaningful once complete
+ */
+uint8_t AtRequest::getResult() const
+{
+  return result_;
+}
+
+/**
+ * Count a response line
+ */
+void AtRequest::addResponse()
+{
+  if (nbResponses_ < 0xFF)
+  {
+    nbResponses_++;
+  }
+}
+
+uint8_t AtRequest::getNbResponses() const
+{
+  return nbResponses_;
+}
@@ -0,0 +1,80 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * AtRequest.h - AtRequest class definition
+ *                  Context of an AT command sent, waiting for its response
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef ATREQUEST_H
+#define ATREQUEST_H
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "AtCommand.h"
+#include "Utils/NemeusTimer.h"
+
+/* Response prefixes a request can expect (the one of the command and added ones) */
+#define AT_REQUEST_MAX_PREFIXES 3
+
+/**
+ * Usage (NemeusUART):
+ *   AtRequest request(MAC_READ_ADR, nextRequestId_++, 2000);   // expects "+MAC: "
+ *   ... send the command ...
+ *   while (!request.isComplete() && !request.isExpired())
+ *   {
+ *     if (request.isResponse(line))   // explicit match, otherwise unsolicited
+ *     ...
+ *     request.complete(NEMEUS_SUCCESS);   // on OK
+ *   }
+ */
+class AtRequest
+{
+  public:
+    AtRequest(const AtCommand& atCommand, uint16_t id, uint32_t timeout);
+    /* Identity */
+    uint16_t getId() const;
+    const AtCommand& getCommand() const;
+    /* Expected response lines (OK and ERROR end every request) */
+    boolean expect(const char* prefix);
+    boolean isResponse(const char* line) const;
+    /* Deadline, from now */
+    void setDeadline(uint32_t timeout);
+    boolean isExpired();
+    uint32_t getRemaining();
+    /* Result slot */
+    void complete(uint8_t result);
+    boolean isComplete() const;
+    uint8_t getResult() const;
+    /* Response lines received */
+    void addResponse();
+    uint8_t getNbResponses() const;
+  private:
+    const AtCommand& atCommand_;
+    uint16_t id_;
+    const char* prefixes_[AT_REQUEST_MAX_PREFIXES];
+    uint8_t nbPrefixes_;
+    NemeusTimer deadline_;
+    boolean complete_;
+    uint8_t result_;
+    uint8_t nbResponses_;
+};
+
+#endif /* ATREQUEST_H */
@@ -0,0 +1,153 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * ConfigSnapshot.cpp - Snapshot of the module and MAC configuration kept in
+ *                  non volatile storage for warm startup
+ * 
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ */
+
+#include "ConfigSnapshot.h"
+#include "NemeusUART.h"
+#include "Utils/NvmStorage.h"
+
+/**
+ * Load the snapshot from non volatile storage
+ * @return  true if a snapshot of this version with a valid CRC is stored
+ */
+boolean ConfigSnapshot::load()
+{
+  ConfigSnapshot_t stored;
+
+  isStored_ = false;
+
+  if (readStored(stored))
+  {
+    memcpy(&snapshot_, &stored, sizeof(snapshot_));
+    isStored_ = true;
+  }
+
+  return isStored_;
+}
+
+/**
+ * Store the snapshot
+ * @return  the error code
+ *               NEMEUS_SUCCESS if stored (or already stored)
+ *               NEMEUS_ERROR if storage is not available
+ */
+uint8_t ConfigSnapshot::save()
+{
+  ConfigSnapshot_t stored;
+  uint8_t ErrorCode;
+
+  seal();
+
+  /* Flash endurance is limited, skip identical writes */
+  if ( (readStored(stored)) && (memcmp(&stored, &snapshot_, sizeof(stored)) == 0) )
+  {
+    isStored_ = true;
+    return NEMEUS_SUCCESS;
+  }
+
+  ErrorCode = nvmStorageWrite(&snapshot_, sizeof(snapshot_));
+  isStored_ = (ErrorCode == NEMEUS_SUCCESS);
+
+  return ErrorCode;
+}
+
+/**
+ * The configuration changed (snapshot updated in RAM). The stored snapshot
+ * would restore the previous one at the next startup: it is erased if it
+ * differs. Once erased nothing is written until the next save(), so one
+ * erase per ON() at most, however many settings change.
+ * @return  the error code
+ *               NEMEUS_SUCCESS if erased (or nothing to erase)
+ *               NEMEUS_ERROR if storage is not available
+ */
+uint8_t ConfigSnapshot::invalidate()
+{
+  ConfigSnapshot_t stored;
+  ConfigSnapshot_t erased;
+  uint8_t ErrorCode = NEMEUS_SUCCESS;
+
+  seal();
+
+  if ( (readStored(stored)) && (memcmp(&stored, &snapshot_, sizeof(stored)) != 0) )
+  {
+    memset(&erased, 0xFF, sizeof(erased));
+    ErrorCode = nvmStorageWrite(&erased, sizeof(erased));
+    isStored_ = false;
+  }
+
+  return ErrorCode;
+}
+
+boolean ConfigSnapshot::isStored()
+{
+  return isStored_;
+}
+
+ConfigSnapshot_t* ConfigSnapshot::getSnapshot()
+{
+  return &snapshot_;
+}
+
+/**
+ * Read the stored snapshot
+ * @param stored  filled with the snapshot
+ * @return  true if a snapshot of this version with a valid CRC is stored
+ */
+boolean ConfigSnapshot::readStored(ConfigSnapshot_t& stored)
+{
+  return (nvmStorageRead(&stored, sizeof(stored)) == NEMEUS_SUCCESS)
+         && (stored.version == CONFIG_SNAPSHOT_VERSION)
+         && (stored.size == sizeof(stored))
+         && (stored.crc == computeCrc(&stored));
+}
+
+/**
+ * Set the version, size and CRC of the snapshot in RAM
+ */
+void ConfigSnapshot::seal()
+{
+  snapshot_.version = CONFIG_SNAPSHOT_VERSION;
+  snapshot_.size = sizeof(snapshot_);
+  snapshot_.crc = computeCrc(&snapshot_);
+}
+
+/**
+ * CRC-32 (IEEE 802.3) of the snapshot, crc field excluded
+ */
+uint32_t ConfigSnapshot::computeCrc(const ConfigSnapshot_t* snapshot)
+{
+  const uint8_t* data = (const uint8_t*)snapshot;
+  uint32_t crc = 0xFFFFFFFF;
+
+  for (uint16_t i = 0; i < offsetof(ConfigSnapshot_t, crc); i++)
+  {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++)
+    {
+      crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320UL : 0);
+    }
+  }
+
+  return ~crc;
+}
@@ -0,0 +1,74 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * ConfigSnapshot.h - Snapshot of the module and MAC configuration kept in
+ *                  non volatile storage for warm startup
+ * 
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ */
+
+#ifndef CONFIG_SNAPSHOT_H
+#define CONFIG_SNAPSHOT_H
+
+#include <stdint.h>
+#include <Arduino.h>
+
+/* Increment when ConfigSnapshot_t changes */
+#define CONFIG_SNAPSHOT_VERSION 1
+
+#define CONFIG_SNAPSHOT_STATUS_SIZE 32
+#define CONFIG_SNAPSHOT_DATA_RATE_SIZE 12
+
+typedef struct
+{
+  uint16_t version;
+  uint16_t size;
+  /* MAC status without state and OTAA fields (version, class, pages, ISM band) */
+  char macStatus[CONFIG_SNAPSHOT_STATUS_SIZE];
+  uint8_t encryption;
+  uint8_t adr;
+  uint8_t piggyback;
+  uint8_t txPower;
+  char dataRate[CONFIG_SNAPSHOT_DATA_RATE_SIZE];
+  uint32_t crc;
+}ConfigSnapshot_t;
+
+class ConfigSnapshot
+{
+  public:
+    constexpr ConfigSnapshot() : snapshot_(), isStored_(false) {}
+    /* Load the stored snapshot, false if none or corrupted */
+    boolean load();
+    /* Store the snapshot, flash is only written if it changed */
+    uint8_t save();
+    /* Configuration changed in RAM: erase the stored snapshot if it differs */
+    uint8_t invalidate();
+    /* True if a valid snapshot is stored */
+    boolean isStored();
+    ConfigSnapshot_t* getSnapshot();
+  private:
+    ConfigSnapshot_t snapshot_;
+    boolean isStored_;
+
+    boolean readStored(ConfigSnapshot_t& stored);
+    void seal();
+    static uint32_t computeCrc(const ConfigSnapshot_t* snapshot);
+};
+
+#endif /* CONFIG_SNAPSHOT_H */
@@ -24,40 +24,137 @@
 
 #include "DevPerso.h"
 
-DevPerso::DevPerso()
+static int8_t hexToNibble(char digit)
 {
-  devPerso_.devUID = (char*)"";
-  devPerso_.appUID = (char*)"";
-  devPerso_.appKey = (char*)"";
-  devPerso_.devAddr = (char*)"";
-  devPerso_.nwkSKey = (char*)"";
-  devPerso_.appSKey = (char*)"";
+  if ( (digit >= '0') && (digit <= '9') )
+  {
+    return digit - '0';
+  }
+  if ( (digit >= 'A') && (digit <= 'F') )
+  {
+    return digit - 'A' + 10;
+  }
+  if ( (digit >= 'a') && (digit <= 'f') )
+  {
+    return digit - 'a' + 10;
+  }
+  return -1;
 }
 
 /**
- * Set the device UID as a string
- * @param devUID  the device UID
+ * Store a field from its hexadecimal value
+ * @param field  the field (DEVPERSO_FIELD)
+ * @param hexValue  the hexadecimal value, 2 digits per byte
+ * @return  true if the value is stored, false if malformed (field is invalidated)
  */
-void DevPerso::setOtaaPerso(char devUID[16], char appUID[16], char appKey[32])
+boolean DevPerso::setField(uint8_t field, const char* hexValue)
 {
-  this->devPerso_.devUID  = devUID;
-  this->devPerso_.appUID = appUID;
-  this->devPerso_.appKey = appKey;
+  uint8_t size;
+  uint8_t* value = getField(field, &size);
+
+  invalidate(field);
+
+  if ( (value == NULL) || (hexValue == NULL) || (strlen(hexValue) != 2*size) )
+  {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < size; i++)
+  {
+    int8_t high = hexToNibble(hexValue[2*i]);
+    int8_t low = hexToNibble(hexValue[2*i+1]);
+
+    if ( (high < 0) || (low < 0) )
+    {
+      return false;
+    }
+    value[i] = (high << 4) | low;
+  }
+
+  cachedFields_ |= field;
+
+  return true;
+}
+
+/**
+ * Get a field as a hexadecimal string
+ * @param field  the field (DEVPERSO_FIELD)
+ * @param hexValue  filled with the value in upper case hexadecimal, at least
+ *                  twice the field size plus the terminating NUL
+ * @return  hexValue, empty if the field is not cached
+ */
+char* DevPerso::getFieldAsHex(uint8_t field, char* hexValue)
+{
+  static const char hexDigits[] = "0123456789ABCDEF";
+  uint8_t size;
+  uint8_t* value = getField(field, &size);
+
+  hexValue[0] = '\0';
+  if ( (value != NULL) && isCached(field) )
+  {
+    for (uint8_t i = 0; i < size; i++)
+    {
+      hexValue[2*i] = hexDigits[value[i] >> 4];
+      hexValue[2*i+1] = hexDigits[value[i] & 0x0F];
+    }
+    hexValue[2*size] = '\0';
+  }
+
+  return hexValue;
 }
 
-void DevPerso::setAbpPerso(char devAddr[8], char nwkSKey[32], char appSKey[32])
+/**
+ * Check if fields are cached
+ * @param fields  bitmask of DEVPERSO_FIELD
+ * @return  true if all the fields are cached
+ */
+boolean DevPerso::isCached(uint8_t fields)
 {
-  this->devPerso_.devAddr = devAddr;
-  this->devPerso_.nwkSKey = nwkSKey;
-  this->devPerso_.appSKey= appSKey;
+  return ((cachedFields_ & fields) == fields);
 }
 
 /**
- * Get ABP perso as a string
- * @return abpPerso  the structure containing strings of ABP perso
+ * Invalidate fields, next reads are done from the module
+ * @param fields  bitmask of DEVPERSO_FIELD
+ */
+void DevPerso::invalidate(uint8_t fields)
+{
+  cachedFields_ &= ~fields;
+}
+
+/**
+ * Get the binary personalization
+ * @return  the structure containing the binary values (valid if cached)
  */
 DevPerso_t* DevPerso::getDevPerso()
 {
   return &this->devPerso_;
 }
 
+uint8_t* DevPerso::getField(uint8_t field, uint8_t* size)
+{
+  switch (field)
+  {
+    case DEVPERSO_DEVUID:
+      *size = sizeof(devPerso_.devUID);
+      return devPerso_.devUID;
+    case DEVPERSO_APPUID:
+      *size = sizeof(devPerso_.appUID);
+      return devPerso_.appUID;
+    case DEVPERSO_APPKEY:
+      *size = sizeof(devPerso_.appKey);
+      return devPerso_.appKey;
+    case DEVPERSO_DEVADDR:
+      *size = sizeof(devPerso_.devAddr);
+      return devPerso_.devAddr;
+    case DEVPERSO_APPSKEY:
+      *size = sizeof(devPerso_.appSKey);
+      return devPerso_.appSKey;
+    case DEVPERSO_NWKSKEY:
+      *size = sizeof(devPerso_.nwkSKey);
+      return devPerso_.nwkSKey;
+    default:
+      *size = 0;
+      return NULL;
+  }
+}
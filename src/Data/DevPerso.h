@@ -28,27 +28,63 @@
 #include <stdint.h>
 #include <Arduino.h>
 
+/* Binary sizes of personalization fields */
+#define DEVPERSO_EUI_SIZE 8
+#define DEVPERSO_KEY_SIZE 16
+#define DEVPERSO_DEVADDR_SIZE 4
+/* Hexadecimal values with terminating NUL */
+#define DEVPERSO_EUI_HEX_SIZE (2*DEVPERSO_EUI_SIZE+1)
+#define DEVPERSO_KEY_HEX_SIZE (2*DEVPERSO_KEY_SIZE+1)
+#define DEVPERSO_DEVADDR_HEX_SIZE (2*DEVPERSO_DEVADDR_SIZE+1)
+
+/**
+ * Personalization fields (bitmask)
+ */
+enum DEVPERSO_FIELD
+{
+  DEVPERSO_DEVUID  = 0x01,
+  DEVPERSO_APPUID  = 0x02,
+  DEVPERSO_APPKEY  = 0x04,
+  DEVPERSO_DEVADDR = 0x08,
+  DEVPERSO_APPSKEY = 0x10,
+  DEVPERSO_NWKSKEY = 0x20,
+  DEVPERSO_OTAA_FIELDS = 0x07,
+  DEVPERSO_ABP_FIELDS  = 0x38
+};
+
+/**
+ * Personalization values, binary in the order of their hexadecimal string
+ */
 typedef struct
 {
-  char* devUID;
-  char* appUID;
-  char* appKey;
-  char* devAddr;
-  char* appSKey;
-  char* nwkSKey;
+  uint8_t devUID[DEVPERSO_EUI_SIZE];
+  uint8_t appUID[DEVPERSO_EUI_SIZE];
+  uint8_t appKey[DEVPERSO_KEY_SIZE];
+  uint8_t devAddr[DEVPERSO_DEVADDR_SIZE];
+  uint8_t appSKey[DEVPERSO_KEY_SIZE];
+  uint8_t nwkSKey[DEVPERSO_KEY_SIZE];
 }DevPerso_t;
 
 class DevPerso
 {
 	
   public:
-    DevPerso();
-    void setOtaaPerso(char devUID[16], char appUID[16], char AppKey[32]);
-    void setAbpPerso(char devAddr[8], char nwkSKey[32], char appSKey[32]);
+    constexpr DevPerso() : devPerso_(), cachedFields_(0) {}
+    /* Store a field from its hexadecimal value, invalidates it if malformed */
+    boolean setField(uint8_t field, const char* hexValue);
+    /* Hexadecimal value of a field (DEVPERSO_*_HEX_SIZE), empty if not cached */
+    char* getFieldAsHex(uint8_t field, char* hexValue);
+    /* True if all the fields are cached */
+    boolean isCached(uint8_t fields);
+    /* Forget fields changed in the module */
+    void invalidate(uint8_t fields);
     DevPerso_t* getDevPerso(void);
   protected:
   private:
     DevPerso_t devPerso_;
+    uint8_t cachedFields_;
+
+    uint8_t* getField(uint8_t field, uint8_t* size);
 };
 
 #endif // DEVPERSO_H
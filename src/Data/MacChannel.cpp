@@ -25,16 +25,6 @@
 #include "MacChannel.h"
 #include "Arduino.h"
 
-
-MacChannel::MacChannel()
-{
-  isFrequencyPresent_ = false;
-  isMinDrPresent_ = false;
-  isMaxDrPresent_ = false;
-  isDutyCyclePresent_ = false;
-  isChannelNumberPresent_ = false;
-}
-
 /**
  * Set the channel and number for the modified channel
  * @param channelNumber  Channel number of the page to modify
@@ -42,8 +32,7 @@ MacChannel::MacChannel()
  */
 void MacChannel::setChannelNumber(uint8_t channelNumber, uint8_t pageNumber)
 {
-  isChannelNumberPresent_ = true;
-
+  this->fields_ |= MAC_CHANNEL_NUMBER;
   this->channelNumber_ = channelNumber;
   this->pageNumber_ = pageNumber;
 }
@@ -54,86 +43,232 @@ void MacChannel::setChannelNumber(uint8_t channelNumber, uint8_t pageNumber)
  */
 void MacChannel::setFrequency(uint32_t frequency)
 {
-  isFrequencyPresent_ = true;
+  this->fields_ |= MAC_CHANNEL_FREQUENCY;
   this->frequency_ = frequency;
 }
 
 /**
- * Set the Min Data Rate as a string
- * @param minDataRate  minimum Data Rate
+ * Set the Min Data Rate
+ * @param minDataRate  minimum Data Rate (i.e MAC_DR_SF12BW125)
+ */
+void MacChannel::setMinDataRate(MAC_DATA_RATE minDataRate)
+{
+  if (minDataRate < MAC_DR_NB_DATA_RATES)
+  {
+    this->fields_ |= MAC_CHANNEL_MIN_DR;
+    this->minDr_ = minDataRate;
+  }
+}
+
+/**
+ * Set the Min Data Rate from its name
+ * @param minDataRate  minimum Data Rate (i.e "SF12BW125")
+ * @return  false if the name is unknown (data rate is not set)
  */
-void MacChannel::setMinDataRate(String minDataRate)
+boolean MacChannel::setMinDataRate(const char* minDataRate)
 {
-  isMinDrPresent_ = true;
-  this->minDr_ = minDataRate;
+  uint8_t value = macDataRateFromName(minDataRate);
+
+  if (value == MAC_DR_UNKNOWN)
+  {
+    return false;
+  }
+  setMinDataRate((MAC_DATA_RATE)value);
+
+  return true;
+}
+
+/**
+ * Set the Max Data Rate
+ * @param maxDataRate  maximum Data Rate (i.e MAC_DR_SF7BW125)
+ */
+void MacChannel::setMaxDataRate(MAC_DATA_RATE maxDataRate)
+{
+  if (maxDataRate < MAC_DR_NB_DATA_RATES)
+  {
+    this->fields_ |= MAC_CHANNEL_MAX_DR;
+    this->maxDr_ = maxDataRate;
+  }
 }
 
 /**
- * Set the Max Data Rate as a string
- * @param maxDataRate  minimum Data Rate
+ * Set the Max Data Rate from its name
+ * @param maxDataRate  maximum Data Rate (i.e "SF7BW125")
+ * @return  false if the name is unknown (data rate is not set)
  */
-void MacChannel::setMaxDataRate(String maxDataRate)
+boolean MacChannel::setMaxDataRate(const char* maxDataRate)
 {
-  isMaxDrPresent_ = true;
-  this->maxDr_ = maxDataRate;
+  uint8_t value = macDataRateFromName(maxDataRate);
+
+  if (value == MAC_DR_UNKNOWN)
+  {
+    return false;
+  }
+  setMaxDataRate((MAC_DATA_RATE)value);
+
+  return true;
 }
 
 /**
  * Set the duty cycle = 100%/(parameter in argument)
- * @param maxDataRate  minimum Data Rate
+ * @param dutyCycle  duty cycle divider
  */
 void MacChannel::setDutyCycle(uint8_t dutyCycle)
 {
-  isDutyCyclePresent_ = true;
+  this->fields_ |= MAC_CHANNEL_DUTY_CYCLE;
   this->dutyCycle_ = dutyCycle;
 }
 
 /**
- * Generate the argument for AT command in string representation
- * @return  the formatted argument with COMMAs & CRLF end of line
+ * Check if the channel and page numbers are set
+ */
+boolean MacChannel::hasChannelNumber() const
+{
+  return (fields_ & MAC_CHANNEL_NUMBER) != 0;
+}
+
+uint8_t MacChannel::getChannelNumber() const
+{
+  return channelNumber_;
+}
+
+uint8_t MacChannel::getPageNumber() const
+{
+  return pageNumber_;
+}
+
+/**
+ * Get the channel values present
+ * @return  the MAC_CHANNEL_FIELD bitmask (without MAC_CHANNEL_NUMBER)
+ */
+uint8_t MacChannel::getFields() const
+{
+  return fields_ & MAC_CHANNEL_VALUES;
+}
+
+uint32_t MacChannel::getFrequency() const
+{
+  return frequency_;
+}
+
+/**
+ * Get the Min Data Rate
+ * @return  the data rate (MAC_DATA_RATE), MAC_DR_UNKNOWN if not present
+ */
+uint8_t MacChannel::getMinDataRate() const
+{
+  return minDr_;
+}
+
+/**
+ * Get the Max Data Rate
+ * @return  the data rate (MAC_DATA_RATE), MAC_DR_UNKNOWN if not present
+ */
+uint8_t MacChannel::getMaxDataRate() const
+{
+  return maxDr_;
+}
+
+uint8_t MacChannel::getDutyCycle() const
+{
+  return dutyCycle_;
+}
+
+/**
+ * Check if a channel already holds the values of this one
+ * @param current  the channel to compare with (same channel and page)
+ * @return  true if every value present here is present and equal in current
  */
-char* MacChannel::generateArguments(char* arguments)
+boolean MacChannel::isIncludedIn(const MacChannel& current) const
 {
+  uint8_t fields = getFields();
 
-  if (isChannelNumberPresent_ != true)
+  if ((current.fields_ & fields) != fields)
   {
-    strncat(arguments, (char*)"\r\n", 2);
-    goto error;
+    return false;
   }
 
-  strncat(arguments, (char*)String(channelNumber_, DEC).c_str(),3) ;
-  strncat(arguments, SEPARATOR, 1);
-
-  if (isFrequencyPresent_)
+  if ( ((fields & MAC_CHANNEL_FREQUENCY) && (current.frequency_ != frequency_))
+      || ((fields & MAC_CHANNEL_MIN_DR) && (current.minDr_ != minDr_))
+      || ((fields & MAC_CHANNEL_MAX_DR) && (current.maxDr_ != maxDr_))
+      || ((fields & MAC_CHANNEL_DUTY_CYCLE) && (current.dutyCycle_ != dutyCycle_)) )
   {
-    strncat(arguments, (char*)String(frequency_, DEC).c_str(), 10);
+    return false;
   }
-  strncat(arguments, SEPARATOR, 1);
 
-  if(isMinDrPresent_)
+  return true;
+}
+
+/**
+ * Update with the values present in another channel, others are kept
+ * @param changes  the channel set or read
+ */
+void MacChannel::update(const MacChannel& changes)
+{
+  if (changes.fields_ & MAC_CHANNEL_NUMBER)
   {
-    strncat(arguments, (char*)minDr_.c_str(), minDr_.length());
+    channelNumber_ = changes.channelNumber_;
+    pageNumber_ = changes.pageNumber_;
   }
-  strncat(arguments, SEPARATOR, 1);
+  if (changes.fields_ & MAC_CHANNEL_FREQUENCY)
+  {
+    frequency_ = changes.frequency_;
+  }
+  if (changes.fields_ & MAC_CHANNEL_MIN_DR)
+  {
+    minDr_ = changes.minDr_;
+  }
+  if (changes.fields_ & MAC_CHANNEL_MAX_DR)
+  {
+    maxDr_ = changes.maxDr_;
+  }
+  if (changes.fields_ & MAC_CHANNEL_DUTY_CYCLE)
+  {
+    dutyCycle_ = changes.dutyCycle_;
+  }
+  fields_ |= changes.fields_;
+}
 
-  if (isMaxDrPresent_)
+/**
+ * Generate the argument for AT command in string representation
+ * @param arguments  the writer to append to
+ * @return  false if the arguments don't fit
+ */
+boolean MacChannel::generateArguments(ArgumentWriter& arguments) const
+{
+  if (!hasChannelNumber())
   {
-    strncat(arguments, (char*)maxDr_.c_str(), maxDr_.length());
+    arguments.endOfLine();
+    return !arguments.hasOverflowed();
   }
-  strncat(arguments, SEPARATOR, 1);
 
-  if (isDutyCyclePresent_)
+  arguments.appendDec(channelNumber_).separator();
+
+  if (fields_ & MAC_CHANNEL_FREQUENCY)
   {
-    strncat(arguments, (char*)String(dutyCycle_, DEC).c_str(), 3);
+    arguments.appendDec(frequency_);
   }
-  strncat(arguments, SEPARATOR, 1);
+  arguments.separator();
 
-  strncat(arguments, (char*)String(pageNumber_, DEC).c_str(), 3);
-  strncat(arguments, (char*)"\r\n", 2);
+  if (fields_ & MAC_CHANNEL_MIN_DR)
+  {
+    arguments.append(macDataRateName(minDr_));
+  }
+  arguments.separator();
 
-error:
+  if (fields_ & MAC_CHANNEL_MAX_DR)
+  {
+    arguments.append(macDataRateName(maxDr_));
+  }
+  arguments.separator();
 
-  return arguments;
-}
+  if (fields_ & MAC_CHANNEL_DUTY_CYCLE)
+  {
+    arguments.appendDec(dutyCycle_);
+  }
+  arguments.separator();
 
+  arguments.appendDec(pageNumber_).endOfLine();
 
+  return !arguments.hasOverflowed();
+}
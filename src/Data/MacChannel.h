@@ -29,32 +29,61 @@
 #include <stdint.h>
 #include <Arduino.h>
 #include "AtCommand.h"
+#include "Utils/ArgumentWriter.h"
+#include "MacDataRate.h"
+
+/**
+ * Channel values present in a MacChannel (bitmask)
+ */
+enum MAC_CHANNEL_FIELD
+{
+  MAC_CHANNEL_FREQUENCY  = 0x01,
+  MAC_CHANNEL_MIN_DR     = 0x02,
+  MAC_CHANNEL_MAX_DR     = 0x04,
+  MAC_CHANNEL_DUTY_CYCLE = 0x08,
+  MAC_CHANNEL_VALUES     = 0x0F,  // all the channel values
+  MAC_CHANNEL_NUMBER     = 0x10
+};
 
 /**
  * Mac Channel class to format Mac Channel command with the parameters
+ * (trivially copyable, pass it by reference)
  */
 class MacChannel
 {
   public:
-    MacChannel();
+    constexpr MacChannel() : frequency_(0), fields_(0), channelNumber_(0), pageNumber_(0),
+                             minDr_(MAC_DR_UNKNOWN), maxDr_(MAC_DR_UNKNOWN), dutyCycle_(0) {}
     void setChannelNumber(uint8_t channelNumber, uint8_t pageNumber);
     void setFrequency(uint32_t frequency);
-    void setMinDataRate(String minDataRate);
-    void setMaxDataRate(String maxDataRate);
+    void setMinDataRate(MAC_DATA_RATE minDataRate);
+    boolean setMinDataRate(const char* minDataRate);
+    void setMaxDataRate(MAC_DATA_RATE maxDataRate);
+    boolean setMaxDataRate(const char* maxDataRate);
     void setDutyCycle(uint8_t dutyCycle);
-    char* generateArguments(char* argumennts);
+    boolean hasChannelNumber() const;
+    uint8_t getChannelNumber() const;
+    uint8_t getPageNumber() const;
+    /* MAC_CHANNEL_FIELD bitmask of the channel values present */
+    uint8_t getFields() const;
+    uint32_t getFrequency() const;
+    uint8_t getMinDataRate() const;
+    uint8_t getMaxDataRate() const;
+    uint8_t getDutyCycle() const;
+    /* True if current holds every value present here */
+    boolean isIncludedIn(const MacChannel& current) const;
+    /* Take the values present in changes */
+    void update(const MacChannel& changes);
+    /* Append the AT command arguments, false if they don't fit */
+    boolean generateArguments(ArgumentWriter& arguments) const;
   private:
-    bool isChannelNumberPresent_;
-    uint8_t channelNumber_;
-    bool isFrequencyPresent_;
     uint32_t frequency_;
-    bool isMinDrPresent_;
-    String minDr_;
-    bool isMaxDrPresent_;
-    String maxDr_;
-    bool isDutyCyclePresent_;
-    uint8_t dutyCycle_;
+    uint8_t fields_;          // MAC_CHANNEL_FIELD bitmask
+    uint8_t channelNumber_;
     uint8_t pageNumber_;
+    uint8_t minDr_;           // MAC_DATA_RATE
+    uint8_t maxDr_;           // MAC_DATA_RATE
+    uint8_t dutyCycle_;
 };
 
 #endif /* MACCHANNEL_H */
@@ -0,0 +1,103 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * MacChannelShadow.cpp - Shadow of the module channel definitions, avoids
+ *                  sending channels the module already holds.
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "MacChannelShadow.h"
+
+/**
+ * Check if the module already holds a channel definition
+ * @param macChannel  the channel to set
+ * @return  true if every value present in macChannel is known and equal
+ */
+boolean MacChannelShadow::matches(const MacChannel& macChannel)
+{
+  MacChannel* entry;
+
+  if (!macChannel.hasChannelNumber())
+  {
+    return false;
+  }
+
+  entry = find(macChannel.getChannelNumber(), macChannel.getPageNumber());
+  if (entry == NULL)
+  {
+    return false;
+  }
+
+  return macChannel.isIncludedIn(*entry);
+}
+
+/**
+ * Store the values present in a channel definition, others are kept
+ * @param macChannel  the channel set in or read from the module
+ */
+void MacChannelShadow::update(const MacChannel& macChannel)
+{
+  MacChannel* entry;
+
+  if ( (!macChannel.hasChannelNumber()) || (macChannel.getFields() == 0) )
+  {
+    return;
+  }
+
+  entry = find(macChannel.getChannelNumber(), macChannel.getPageNumber());
+  if (entry == NULL)
+  {
+    entry = &channels_[nextEntry_];
+    nextEntry_ = (nextEntry_ + 1) % MAC_SHADOW_NB_CHANNELS;
+    *entry = MacChannel();
+  }
+
+  entry->update(macChannel);
+}
+
+/**
+ * Forget all channel definitions (module reset or reconfigured)
+ */
+void MacChannelShadow::invalidate()
+{
+  for (uint8_t i = 0; i < MAC_SHADOW_NB_CHANNELS; i++)
+  {
+    channels_[i] = MacChannel();
+  }
+  nextEntry_ = 0;
+}
+
+/**
+ * Find the definition of a channel
+ * @return  the entry, NULL if the channel is unknown
+ */
+MacChannel* MacChannelShadow::find(uint8_t channelNumber, uint8_t pageNumber)
+{
+  for (uint8_t i = 0; i < MAC_SHADOW_NB_CHANNELS; i++)
+  {
+    if ( (channels_[i].getFields() != 0)
+        && (channels_[i].getChannelNumber() == channelNumber) && (channels_[i].getPageNumber() == pageNumber) )
+    {
+      return &channels_[i];
+    }
+  }
+
+  return NULL;
+}
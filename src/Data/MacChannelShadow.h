@@ -0,0 +1,55 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * MacChannelShadow.h - MacChannelShadow class definition
+ *                  Channel definitions known to be held by the module
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef MACCHANNELSHADOW_H
+#define MACCHANNELSHADOW_H
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "MacChannel.h"
+
+/* Channel definitions kept, any page (the oldest one is replaced) */
+#ifndef MAC_SHADOW_NB_CHANNELS
+#define MAC_SHADOW_NB_CHANNELS 16
+#endif
+
+class MacChannelShadow
+{
+  public:
+    constexpr MacChannelShadow() : channels_(), nextEntry_(0) {}
+    /* True if the module already holds every value of the channel */
+    boolean matches(const MacChannel& macChannel);
+    /* Store the values of a channel set or read */
+    void update(const MacChannel& macChannel);
+    /* Forget all channels */
+    void invalidate();
+  private:
+    MacChannel channels_[MAC_SHADOW_NB_CHANNELS];  // only values of fields are known, free if none
+    uint8_t nextEntry_;
+
+    MacChannel* find(uint8_t channelNumber, uint8_t pageNumber);
+};
+
+#endif /* MACCHANNELSHADOW_H */
@@ -24,39 +24,113 @@
 
 #include "MacDataRate.h"
 
+/* Names of MAC_DATA_RATE values */
+static const char* const dataRateNames[MAC_DR_NB_DATA_RATES] =
+{
+  "SF12BW125",
+  "SF11BW125",
+  "SF10BW125",
+  "SF9BW125",
+  "SF8BW125",
+  "SF7BW125",
+  "SF7BW250",
+  "FSK50KBPS"
+};
+
 /**
- * Constructor. Init boolean to false
+ * Get the name of a data rate
+ * @param dataRate  the data rate (MAC_DATA_RATE)
+ * @return  the name (i.e "SF7BW125"), NULL if unknown
  */
-MacDataRate::MacDataRate() {
-  isDataRatePresent_ = false;
-  isTxPowerPresent_ = false;
-  isChannelMaskPresent_ = false;
-  isChannelMaskCtrlPresent_ = false;
-  isNbRepetitionPresent_ = false;
+const char* macDataRateName(uint8_t dataRate)
+{
+  if (dataRate >= MAC_DR_NB_DATA_RATES)
+  {
+    return NULL;
+  }
+
+  return dataRateNames[dataRate];
 }
 
 /**
- * Set the data rate as a string
- * @param dataRate  the string of data rate to set (i.e "SF7BW125")
+ * Get the data rate of a name
+ * @param name  the name (i.e "SF7BW125")
+ * @return  the data rate (MAC_DATA_RATE), MAC_DR_UNKNOWN if unknown
  */
-void MacDataRate::setDataRate(String dataRate)
+uint8_t macDataRateFromName(const char* name)
 {
-  this->isDataRatePresent_ = true;
-  this->dataRate_ = dataRate;
+  if (name != NULL)
+  {
+    for (uint8_t i = 0; i < MAC_DR_NB_DATA_RATES; i++)
+    {
+      if (strcmp(name, dataRateNames[i]) == 0)
+      {
+        return i;
+      }
+    }
+  }
 
+  return MAC_DR_UNKNOWN;
 }
 
 /**
- * Get the data rate as a string
- * @param dataRate  the string of data rate to set (i.e "SF7BW125")
+ * Set the data rate
+ * @param dataRate  the data rate to set (i.e MAC_DR_SF7BW125)
+ */
+void MacDataRate::setDataRate(MAC_DATA_RATE dataRate)
+{
+  if (dataRate < MAC_DR_NB_DATA_RATES)
+  {
+    this->fields_ |= MAC_DATA_RATE_DR;
+    this->dataRate_ = dataRate;
+  }
+}
+
+/**
+ * Set the data rate from its name
+ * @param dataRate  the name of data rate to set (i.e "SF7BW125")
+ * @return  false if the name is unknown (data rate is not set)
  */
-String MacDataRate::getDataRate()
+boolean MacDataRate::setDataRate(const char* dataRate)
 {
-  if (isDataRatePresent_)
+  uint8_t value = macDataRateFromName(dataRate);
+
+  if (value == MAC_DR_UNKNOWN)
+  {
+    return false;
+  }
+  setDataRate((MAC_DATA_RATE)value);
+
+  return true;
+}
+
+/**
+ * Get the data rate
+ * @return  the data rate (MAC_DATA_RATE), MAC_DR_UNKNOWN if not present
+ */
+uint8_t MacDataRate::getDataRate() const
+{
+  if (fields_ & MAC_DATA_RATE_DR)
   {
     return dataRate_;
   }
   else
+  {
+    return MAC_DR_UNKNOWN;
+  }
+}
+
+/**
+ * Get the data rate as a string
+ * @return  the name of data rate (i.e "SF7BW125"), empty if not present
+ */
+const char* MacDataRate::getDataRateName() const
+{
+  if (fields_ & MAC_DATA_RATE_DR)
+  {
+    return macDataRateName(dataRate_);
+  }
+  else
   {
     return "";
   }
@@ -68,91 +142,177 @@ String MacDataRate::getDataRate()
  */
 void MacDataRate::setTxPower(uint8_t txPower)
 {
-  this->isTxPowerPresent_ = true;
+  this->fields_ |= MAC_DATA_RATE_TX_POWER;
   this->txPower_ = txPower;
+}
 
+/**
+ * Get the Tx Power
+ * @return  the Tx Power, 0 if not present
+ */
+uint8_t MacDataRate::getTxPower() const
+{
+  if (fields_ & MAC_DATA_RATE_TX_POWER)
+  {
+    return txPower_;
+  }
+  else
+  {
+    return 0;
+  }
 }
 
 /**
  * Set the channel mask
- * @param channelMask  Channel Mask to set
+ * @param channelMask  Channel Mask to set (one bit per channel of the page)
  */
-void MacDataRate::setChannelMask(String channelMask)
+void MacDataRate::setChannelMask(uint16_t channelMask)
 {
-  this->isChannelMaskPresent_ = true;
+  this->fields_ |= MAC_DATA_RATE_CHANNEL_MASK;
   this->channelMask_ = channelMask;
 }
 
+uint16_t MacDataRate::getChannelMask() const
+{
+  return channelMask_;
+}
+
 /**
  * Set the channel mask control
  * @param channelMaskCtrl  Channel Mask control to set
  */
-void MacDataRate::setChannelMaskCtrl(String channelMaskCtrl)
+void MacDataRate::setChannelMaskCtrl(uint8_t channelMaskCtrl)
 {
-  this->isChannelMaskCtrlPresent_ = true;
+  this->fields_ |= MAC_DATA_RATE_CHANNEL_MASK_CTRL;
   this->channelMaskCtrl_ = channelMaskCtrl;
 }
 
+uint8_t MacDataRate::getChannelMaskCtrl() const
+{
+  return channelMaskCtrl_;
+}
+
 /**
  * Set the number of repetition
  * @param  nbRepetition  Number of repetition
  */
 void MacDataRate::setNbRepetition(uint8_t nbRepetition)
 {
-  this->isNbRepetitionPresent_ = true;
+  this->fields_ |= MAC_DATA_RATE_NB_REPETITION;
   this->nbRepetition_ = nbRepetition;
 }
 
+uint8_t MacDataRate::getNbRepetition() const
+{
+  return nbRepetition_;
+}
+
 /**
- * Generate the argument for AT command in string representation
- * @return  the formatted argument with COMMAs & CRLF end of line
+ * Get the values present
+ * @return  the MAC_DATA_RATE_FIELD bitmask
  */
-char* MacDataRate::generateArguments(char* arguments)
+uint8_t MacDataRate::getFields() const
 {
-  if (isDataRatePresent_)
+  return fields_;
+}
+
+/**
+ * Remove all values
+ */
+void MacDataRate::clear()
+{
+  *this = MacDataRate();
+}
+
+/**
+ * Check if a data rate already holds the values of this one
+ * @param current  the data rate to compare with
+ * @return  true if every value present here is present and equal in current
+ */
+boolean MacDataRate::isIncludedIn(const MacDataRate& current) const
+{
+  if ((current.fields_ & fields_) != fields_)
   {
-    strncat(arguments, (char*)dataRate_.c_str(), dataRate_.length());
+    return false;
   }
-  strncat(arguments, SEPARATOR, 1);
 
-  if(isTxPowerPresent_)
+  if ( ((fields_ & MAC_DATA_RATE_DR) && (current.dataRate_ != dataRate_))
+      || ((fields_ & MAC_DATA_RATE_TX_POWER) && (current.txPower_ != txPower_))
+      || ((fields_ & MAC_DATA_RATE_CHANNEL_MASK) && (current.channelMask_ != channelMask_))
+      || ((fields_ & MAC_DATA_RATE_CHANNEL_MASK_CTRL) && (current.channelMaskCtrl_ != channelMaskCtrl_))
+      || ((fields_ & MAC_DATA_RATE_NB_REPETITION) && (current.nbRepetition_ != nbRepetition_)) )
   {
-    strncat(arguments, (char*)String(txPower_, DEC).c_str(), 3);
+    return false;
   }
-  strncat(arguments, SEPARATOR, 1);
 
-  if (isChannelMaskPresent_)
+  return true;
+}
+
+/**
+ * Update with the values present in another data rate, others are kept
+ * @param changes  the data rate set
+ */
+void MacDataRate::update(const MacDataRate& changes)
+{
+  if (changes.fields_ & MAC_DATA_RATE_DR)
   {
-    strncat(arguments, (char*)channelMask_.c_str(), channelMask_.length());
+    dataRate_ = changes.dataRate_;
   }
-  strncat(arguments, SEPARATOR, 1);
+  if (changes.fields_ & MAC_DATA_RATE_TX_POWER)
+  {
+    txPower_ = changes.txPower_;
+  }
+  if (changes.fields_ & MAC_DATA_RATE_CHANNEL_MASK)
+  {
+    channelMask_ = changes.channelMask_;
+  }
+  if (changes.fields_ & MAC_DATA_RATE_CHANNEL_MASK_CTRL)
+  {
+    channelMaskCtrl_ = changes.channelMaskCtrl_;
+  }
+  if (changes.fields_ & MAC_DATA_RATE_NB_REPETITION)
+  {
+    nbRepetition_ = changes.nbRepetition_;
+  }
+  fields_ |= changes.fields_;
+}
 
-  if (isChannelMaskCtrlPresent_)
+/**
+ * Generate the argument for AT command in string representation
+ * @param arguments  the writer to append to
+ * @return  false if the arguments don't fit
+ */
+boolean MacDataRate::generateArguments(ArgumentWriter& arguments) const
+{
+  if (fields_ & MAC_DATA_RATE_DR)
   {
-    strncat(arguments, (char*)channelMaskCtrl_.c_str(), channelMaskCtrl_.length());
+    arguments.append(macDataRateName(dataRate_));
   }
-  strncat(arguments, SEPARATOR, 1);
+  arguments.separator();
 
-  if (isNbRepetitionPresent_)
+  if (fields_ & MAC_DATA_RATE_TX_POWER)
   {
-    strncat(arguments, (char*)String(nbRepetition_, DEC).c_str(), 3);
+    arguments.appendDec(txPower_);
   }
-  strncat(arguments, (char*)"\r\n", 2);
+  arguments.separator();
 
-  return arguments;
-}
+  if (fields_ & MAC_DATA_RATE_CHANNEL_MASK)
+  {
+    arguments.appendHex(channelMask_, 4);
+  }
+  arguments.separator();
 
+  if (fields_ & MAC_DATA_RATE_CHANNEL_MASK_CTRL)
+  {
+    arguments.appendDec(channelMaskCtrl_);
+  }
+  arguments.separator();
 
-void MacDataRate::setMacDataRate(bool isDataRatePresent, bool isTxPowerPresent, bool isChannelMaskPresent, bool isChannelMaskCtrlPresent, bool isNbRepetitionPresent)
-{
-  this->isDataRatePresent_ = isDataRatePresent;
-  this->isTxPowerPresent_= isTxPowerPresent;
-  this->isChannelMaskPresent_= isChannelMaskPresent;
-  this->isChannelMaskCtrlPresent_= isChannelMaskCtrlPresent;
-  this->isNbRepetitionPresent_= isNbRepetitionPresent;
-}
+  if (fields_ & MAC_DATA_RATE_NB_REPETITION)
+  {
+    arguments.appendDec(nbRepetition_);
+  }
+  arguments.endOfLine();
 
-MacDataRate_t* MacDataRate::getMacDataRate()
-{
-  return &this->macDataRate_;
+  return !arguments.hasOverflowed();
 }
@@ -30,42 +30,82 @@
 #include <stdint.h>
 #include <Arduino.h>
 #include "AtCommand.h"
+#include "Utils/ArgumentWriter.h"
 
-typedef struct
+/**
+ * LoRaWAN data rates (DR0 to DR7 of EU868), named as in AT+MAC= RDR and SDR
+ */
+enum MAC_DATA_RATE
+{
+  MAC_DR_SF12BW125 = 0,
+  MAC_DR_SF11BW125 = 1,
+  MAC_DR_SF10BW125 = 2,
+  MAC_DR_SF9BW125  = 3,
+  MAC_DR_SF8BW125  = 4,
+  MAC_DR_SF7BW125  = 5,
+  MAC_DR_SF7BW250  = 6,
+  MAC_DR_FSK50KBPS = 7,
+  MAC_DR_NB_DATA_RATES = 8,
+  MAC_DR_UNKNOWN   = 0xFF
+};
+
+/**
+ * Values present in a MacDataRate (bitmask)
+ */
+enum MAC_DATA_RATE_FIELD
 {
-  bool isDataRatePresent;
-  bool isTxPowerPresent;
-  bool isChannelMaskPresent;
-  bool isChannelMaskCtrlPresent;
-  bool isNbRepetitionPresent;
-}MacDataRate_t;
+  MAC_DATA_RATE_DR                = 0x01,
+  MAC_DATA_RATE_TX_POWER          = 0x02,
+  MAC_DATA_RATE_CHANNEL_MASK      = 0x04,
+  MAC_DATA_RATE_CHANNEL_MASK_CTRL = 0x08,
+  MAC_DATA_RATE_NB_REPETITION     = 0x10
+};
 
+/* Name of a data rate, NULL if unknown */
+const char* macDataRateName(uint8_t dataRate);
+/* Data rate of a name, MAC_DR_UNKNOWN if unknown */
+uint8_t macDataRateFromName(const char* name);
+
+/**
+ * Mac Data Rate (trivially copyable, pass by const reference)
+ */
 class MacDataRate
 {
   public:
-    MacDataRate();
-    //~MacDataRate();
-    void setDataRate(String dataRate);
-    void setTxPower(uint8_t txPOwer);
-    void setChannelMask(String channelMask);
-    void setChannelMaskCtrl(String channelMaskCtrl);
+    constexpr MacDataRate() : channelMask_(0), fields_(0), dataRate_(MAC_DR_UNKNOWN),
+      txPower_(0), channelMaskCtrl_(0), nbRepetition_(0) {}
+    void setDataRate(MAC_DATA_RATE dataRate);
+    /* Set the data rate from its name, false if unknown */
+    boolean setDataRate(const char* dataRate);
+    void setTxPower(uint8_t txPower);
+    void setChannelMask(uint16_t channelMask);
+    void setChannelMaskCtrl(uint8_t channelMaskCtrl);
     void setNbRepetition(uint8_t nbRepetition);
-    String getDataRate();
-    char* generateArguments(char* arguments);
-    void setMacDataRate(bool isDataRatePresent, bool isTxPowerPresent, bool isChannelMaskPresent, bool isChannelMaskCtrlPresent, bool isNbRepetitionPresent);
-    MacDataRate_t* getMacDataRate();
+    /* MAC_DATA_RATE, MAC_DR_UNKNOWN if not present */
+    uint8_t getDataRate() const;
+    /* Name of the data rate, empty if not present */
+    const char* getDataRateName() const;
+    uint8_t getTxPower() const;
+    uint16_t getChannelMask() const;
+    uint8_t getChannelMaskCtrl() const;
+    uint8_t getNbRepetition() const;
+    /* MAC_DATA_RATE_FIELD bitmask of the values present */
+    uint8_t getFields() const;
+    /* Remove all values */
+    void clear();
+    /* True if current holds every value present in this data rate */
+    boolean isIncludedIn(const MacDataRate& current) const;
+    /* Copy the values present in changes */
+    void update(const MacDataRate& changes);
+    /* Append the AT command arguments, false if they don't fit */
+    boolean generateArguments(ArgumentWriter& arguments) const;
   private:
-    bool isDataRatePresent_;
-    String dataRate_;
-    bool isTxPowerPresent_;
+    uint16_t channelMask_;
+    uint8_t fields_;
+    uint8_t dataRate_;
     uint8_t txPower_;
-    bool isChannelMaskPresent_;
-    String channelMask_;
-    bool isChannelMaskCtrlPresent_;
-    String channelMaskCtrl_;
-    bool isNbRepetitionPresent_;
+    uint8_t channelMaskCtrl_;
     uint8_t nbRepetition_;
-    MacDataRate_t  macDataRate_;
 };
 
 #endif /* MACDATARATE_H */
@@ -25,30 +25,12 @@
 #include "RadioParam.h"
 
 /**
- * Constructor. Init boolean to false
+ * Set the radio mode
+ * @param  the radio mode (RADIO_LORA_MODE or RADIO_FSK_MODE)
  */
-RadioParam::RadioParam() {
-  isModePresent_ = false;
-  isFreqPresent_ = false;
-  isBandwidthPresent_ = false;
-  isDataRatePresent_ = false;
-  isCodeRatePresent_ = false;
-}
-
-/**
- * Destructor
- */
-RadioParam::~RadioParam() {
-
-}
-
-/**
- * Set the radio mode (LORA or FSK)
- * @param  the radio mode
- */
-void RadioParam::setMode(String mode)
+void RadioParam::setMode(RADIO_MODE mode)
 {
-  this->isModePresent_ = true;
+  this->fields_ |= RADIO_PARAM_MODE;
   this->mode_ = mode;
 }
 
@@ -58,7 +40,7 @@ void RadioParam::setMode(String mode)
  */
 void RadioParam::setFrequency(uint32_t frequency)
 {
-  this->isFreqPresent_ = true;
+  this->fields_ |= RADIO_PARAM_FREQUENCY;
   this->frequency_ = frequency;
 }
 
@@ -68,7 +50,7 @@ void RadioParam::setFrequency(uint32_t frequency)
  */
 void RadioParam::setBandwidth(uint32_t bandwidth)
 {
-  this->isBandwidthPresent_ = true;
+  this->fields_ |= RADIO_PARAM_BANDWIDTH;
   this->bandwidth_ = bandwidth;
 }
 
@@ -78,7 +60,7 @@ void RadioParam::setBandwidth(uint32_t bandwidth)
  */
 void RadioParam::setDataRate(uint8_t dataRate)
 {
-  this->isDataRatePresent_ = true;
+  this->fields_ |= RADIO_PARAM_DATA_RATE;
   this->dataRate_ = dataRate;
 }
 
@@ -88,9 +70,26 @@ void RadioParam::setDataRate(uint8_t dataRate)
  */
 void RadioParam::setCodeRate(uint8_t codeRate)
 {
-  this->isCodeRatePresent_ = true;
+  this->fields_ |= RADIO_PARAM_CODE_RATE;
   this->codeRate_ = codeRate;
 }
 
+/**
+ * Get the values present
+ * @return  the RADIO_PARAM_FIELD bitmask
+ */
+uint8_t RadioParam::getFields() const
+{
+  return fields_;
+}
 
-
+/**
+ * Append the radio mode as expected by the module ("LORA" or "FSK") if present
+ */
+void RadioParam::appendMode(ArgumentWriter& arguments) const
+{
+  if (fields_ & RADIO_PARAM_MODE)
+  {
+    arguments.append((mode_ == RADIO_FSK_MODE) ? "FSK" : "LORA");
+  }
+}
@@ -29,33 +29,53 @@
 #include <stdint.h>
 #include <Arduino.h>
 #include "AtCommand.h"
+#include "Utils/ArgumentWriter.h"
 
 
 /* ----- List of radio mode ----- */
-#define RADIO_LORA_MODE             "LORA"
-#define RADIO_FSK_MODE	            "FSK"
+enum RADIO_MODE
+{
+  RADIO_LORA_MODE = 0,
+  RADIO_FSK_MODE  = 1
+};
+
+/**
+ * Radio values present in a RadioParam (bitmask)
+ */
+enum RADIO_PARAM_FIELD
+{
+  RADIO_PARAM_MODE      = 0x01,
+  RADIO_PARAM_FREQUENCY = 0x02,
+  RADIO_PARAM_BANDWIDTH = 0x04,
+  RADIO_PARAM_DATA_RATE = 0x08,
+  RADIO_PARAM_CODE_RATE = 0x10,
+  RADIO_PARAM_TX_POWER  = 0x20
+};
 
+/**
+ * Common RF parameters (trivially copyable, pass it by reference)
+ */
 class RadioParam
 {
   public:
-    RadioParam();
-    virtual ~RadioParam();
-    void setMode(String mode);
+    constexpr RadioParam() : frequency_(0), bandwidth_(0), fields_(0), mode_(RADIO_LORA_MODE),
+                             dataRate_(0), codeRate_(0) {}
+    void setMode(RADIO_MODE mode);
     void setFrequency(uint32_t frequency);
     void setBandwidth(uint32_t bandwidth);
     void setDataRate(uint8_t dataRate);
     void setCodeRate(uint8_t codeRate);
+    /* RADIO_PARAM_FIELD bitmask of the values present */
+    uint8_t getFields() const;
   protected:
-    bool isModePresent_;
-    String mode_;
-    bool isFreqPresent_;
     uint32_t frequency_;
-    bool isBandwidthPresent_;
     uint32_t bandwidth_;
-    bool isDataRatePresent_;
+    uint8_t fields_;        // RADIO_PARAM_FIELD bitmask
+    uint8_t mode_;          // RADIO_MODE
     uint8_t dataRate_;
-    bool isCodeRatePresent_;
     uint8_t codeRate_;
+
+    void appendMode(ArgumentWriter& arguments) const;
 };
 
 #endif /* RADIOPARAM_H */
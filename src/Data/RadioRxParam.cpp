@@ -25,47 +25,38 @@
 #include "RadioRxParam.h"
 
 /**
- * Constructor
+ * Generate the AT+RFRX= SET argument with the parameters
+ * @param arguments  the writer to append to
+ * @return  false if the arguments don't fit
  */
-RadioRxParam::RadioRxParam() : RadioParam()
+boolean RadioRxParam::generateArguments(ArgumentWriter& arguments) const
 {
+  appendMode(arguments);
+  arguments.separator();
 
-}
-
-/**
- * Generate the AT+RFRX= SET argument withe the parameters
- */
-char* RadioRxParam::generateArguments(char* arguments)
-{
-  if (isModePresent_)
-  {
-    strncat(arguments, (char*)mode_.c_str(), mode_.length());
-  }
-  strncat(arguments, SEPARATOR, 1);
-
-  if(isFreqPresent_)
+  if (fields_ & RADIO_PARAM_FREQUENCY)
   {
-    strncat(arguments, (char*)String(frequency_, DEC).c_str(), 10);
+    arguments.appendDec(frequency_);
   }
-  strncat(arguments, SEPARATOR, 1);
+  arguments.separator();
 
-  if (isBandwidthPresent_)
+  if (fields_ & RADIO_PARAM_BANDWIDTH)
   {
-    strncat(arguments, (char*)String(bandwidth_, DEC).c_str(), 10);
+    arguments.appendDec(bandwidth_);
   }
-  strncat(arguments, SEPARATOR, 1);
+  arguments.separator();
 
-  if (isDataRatePresent_)
+  if (fields_ & RADIO_PARAM_DATA_RATE)
   {
-    strncat(arguments, (char*)String(dataRate_, DEC).c_str(), 10);
+    arguments.appendDec(dataRate_);
   }
-  strncat(arguments, SEPARATOR, 1);
+  arguments.separator();
 
-  if (isCodeRatePresent_)
+  if (fields_ & RADIO_PARAM_CODE_RATE)
   {
-    strncat(arguments, (char*)String(codeRate_, DEC).c_str(), 3);
+    arguments.appendDec(codeRate_);
   }
-  strncat(arguments, (char*)"\r\n", 2);
+  arguments.endOfLine();
 
-  return arguments;
+  return !arguments.hasOverflowed();
 }
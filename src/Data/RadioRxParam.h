@@ -35,8 +35,9 @@
 class RadioRxParam : public RadioParam
 {
   public:
-    RadioRxParam();
-    char* generateArguments(char* arguments);
+    constexpr RadioRxParam() : RadioParam() {}
+    /* Append the AT command arguments, false if they don't fit */
+    boolean generateArguments(ArgumentWriter& arguments) const;
 };
 
 #endif /* RADIORXPARAM_H */
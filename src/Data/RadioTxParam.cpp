@@ -25,54 +25,51 @@
 
 #include "RadioTxParam.h"
 
-RadioTxParam::RadioTxParam() : RadioParam(), isTxPowerPresent_(false)
-{
-
-}
-
 void RadioTxParam::setTxPower(uint8_t txPower)
 {
-  this->isTxPowerPresent_ = true;
+  this->fields_ |= RADIO_PARAM_TX_POWER;
   this->txPower_ = txPower;
 }
 
-char* RadioTxParam::generateArguments(char* arguments)
+/**
+ * Generate the AT+RFTX= SET argument with the parameters
+ * @param arguments  the writer to append to
+ * @return  false if the arguments don't fit
+ */
+boolean RadioTxParam::generateArguments(ArgumentWriter& arguments) const
 {
-  if (isModePresent_)
-  {
-    strncat(arguments, (char*)mode_.c_str(), mode_.length());
-  }
-  strncat(arguments, SEPARATOR, 1);
+  appendMode(arguments);
+  arguments.separator();
 
-  if(isFreqPresent_)
+  if (fields_ & RADIO_PARAM_FREQUENCY)
   {
-    strncat(arguments, (char*)String(frequency_, DEC).c_str(), 10);
+    arguments.appendDec(frequency_);
   }
-  strncat(arguments, SEPARATOR, 1);
+  arguments.separator();
 
-  if(isTxPowerPresent_)
+  if (fields_ & RADIO_PARAM_TX_POWER)
   {
-    strncat(arguments, (char*)String(txPower_, DEC).c_str(), 3);
+    arguments.appendDec(txPower_);
   }
-  strncat(arguments, SEPARATOR, 1);
+  arguments.separator();
 
-  if (isBandwidthPresent_)
+  if (fields_ & RADIO_PARAM_BANDWIDTH)
   {
-    strncat(arguments, (char*)String(bandwidth_, DEC).c_str(), 10);
+    arguments.appendDec(bandwidth_);
   }
-  strncat(arguments, SEPARATOR, 1);
+  arguments.separator();
 
-  if (isDataRatePresent_)
+  if (fields_ & RADIO_PARAM_DATA_RATE)
   {
-    strncat(arguments, (char*)String(dataRate_, DEC).c_str(), 10);
+    arguments.appendDec(dataRate_);
   }
-  strncat(arguments, SEPARATOR, 1);
+  arguments.separator();
 
-  if (isCodeRatePresent_)
+  if (fields_ & RADIO_PARAM_CODE_RATE)
   {
-    strncat(arguments, (char*)String(codeRate_, DEC).c_str(), 3);
+    arguments.appendDec(codeRate_);
   }
-  strncat(arguments, (char*)"\r\n", 2);
+  arguments.endOfLine();
 
-  return arguments;
+  return !arguments.hasOverflowed();
 }
@@ -35,11 +35,11 @@
 class RadioTxParam : public RadioParam
 {
   public:
-    RadioTxParam();
+    constexpr RadioTxParam() : RadioParam(), txPower_(0) {}
     void setTxPower(uint8_t txPower);
-    char* generateArguments(char* arguments);
+    /* Append the AT command arguments, false if they don't fit */
+    boolean generateArguments(ArgumentWriter& arguments) const;
   private:
-    bool isTxPowerPresent_;
     uint8_t txPower_;
 };
 
@@ -0,0 +1,130 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * EventBus.cpp - Deliver typed events, parsed once by the module owning
+ *                  them, to the handlers subscribed to them.
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "EventBus.h"
+#include "NemeusUART.h"
+
+/* Unique instance */
+template <> EventBus Singleton<EventBus>::_singleton {};
+
+/**
+ * Subscribe a handler to events
+ * @param onEvent  the handler
+ * @param eventMask  the events to deliver (NEMEUS_EVENT bitmask)
+ * @return  the error code
+ *               NEMEUS_SUCCESS if subscribed
+ *               NEMEUS_ARGUMENT_ERROR if the handler is NULL or the mask empty
+ *               NEMEUS_ERROR_QUEUE_FULL if EVENT_BUS_MAX_SUBSCRIBERS are subscribed
+ */
+uint8_t EventBus::subscribe(void (*onEvent)(const NemeusEvent_t* event), uint8_t eventMask)
+{
+  if ( (onEvent == NULL) || ((eventMask & EVENT_ALL) == 0) )
+  {
+    return NEMEUS_ARGUMENT_ERROR;
+  }
+
+  for (uint8_t i = 0; i < nbSubscribers_; i++)
+  {
+    if (subscribers_[i].handler == onEvent)
+    {
+      subscribers_[i].eventMask = eventMask & EVENT_ALL;
+      updateEventMask();
+      return NEMEUS_SUCCESS;
+    }
+  }
+
+  if (nbSubscribers_ >= EVENT_BUS_MAX_SUBSCRIBERS)
+  {
+    return NEMEUS_ERROR_QUEUE_FULL;
+  }
+
+  subscribers_[nbSubscribers_].handler = onEvent;
+  subscribers_[nbSubscribers_].eventMask = eventMask & EVENT_ALL;
+  nbSubscribers_++;
+  updateEventMask();
+
+  return NEMEUS_SUCCESS;
+}
+
+/**
+ * Unsubscribe a handler
+ * @param onEvent  the handler to remove
+ */
+void EventBus::unsubscribe(void (*onEvent)(const NemeusEvent_t* event))
+{
+  uint8_t nbKept = 0;
+
+  for (uint8_t i = 0; i < nbSubscribers_; i++)
+  {
+    if (subscribers_[i].handler != onEvent)
+    {
+      subscribers_[nbKept++] = subscribers_[i];
+    }
+  }
+  nbSubscribers_ = nbKept;
+  updateEventMask();
+}
+
+/**
+ * Check if an event is listened to, modules don't build unlistened events
+ * @param eventMask  the events (NEMEUS_EVENT bitmask)
+ * @return  true if a handler is subscribed to one of them
+ */
+boolean EventBus::hasSubscriber(uint8_t eventMask) const
+{
+  return ((eventMask_ & eventMask) != 0);
+}
+
+/**
+ * Deliver an event to its subscribers, in subscription order
+ * @param event  the event, type gives the member of the union
+ */
+void EventBus::publish(const NemeusEvent_t& event)
+{
+  if ((eventMask_ & event.type) == 0)
+  {
+    return;
+  }
+
+  for (uint8_t i = 0; i < nbSubscribers_; i++)
+  {
+    if (subscribers_[i].eventMask & event.type)
+    {
+      subscribers_[i].handler(&event);
+    }
+  }
+}
+
+/**
+ * Compute the events of all subscribers
+ */
+void EventBus::updateEventMask()
+{
+  eventMask_ = 0;
+  for (uint8_t i = 0; i < nbSubscribers_; i++)
+  {
+    eventMask_ |= subscribers_[i].eventMask;
+  }
+}
@@ -0,0 +1,145 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * EventBus.h - Event bus class definition
+ *                  Typed unsollicited events delivered to subscribers
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <stdint.h>
+
+#include "Arduino.h"
+#include "Singleton.h"
+#include "Data/MacDataRate.h"
+
+/**
+ * Events published by the modules (bitmask, used for subscriptions)
+ */
+enum NEMEUS_EVENT
+{
+  EVENT_SEND_SCHEDULED       = 0x01,   // LoRaWAN or Sigfox send delayed by the module
+  EVENT_DOWNLINK_RECEIVED    = 0x02,   // LoRaWAN downlink frame
+  EVENT_DEVADDR_ASSIGNED     = 0x04,   // Device address given by the network (join)
+  EVENT_DATA_RATE_CHANGED    = 0x08,   // MAC data rate read differs from the known one
+  EVENT_SIGFOX_SEND_DONE     = 0x10,   // Sigfox send completed (or failed)
+  EVENT_RADIO_FRAME_RECEIVED = 0x20,   // RF frame received in continuous Rx
+  EVENT_ALL                  = 0x3F
+};
+
+/* Handlers notified of events */
+#ifndef EVENT_BUS_MAX_SUBSCRIBERS
+#define EVENT_BUS_MAX_SUBSCRIBERS 4
+#endif
+
+typedef struct
+{
+  uint8_t technology;     // UPLINK_LORAWAN or UPLINK_SIGFOX
+  uint32_t delay;         // Delay in ms before the module sends
+}SendScheduledEvent_t;
+
+typedef struct
+{
+  uint8_t port;           // LoRaWAN MAC port
+  boolean more;           // More frames are pending in the network
+  boolean binary;         // payload is hexadecimal (RCVBIN) or text (RCVTXT)
+  const char* payload;
+  int rssi;
+  int snr;
+}DownlinkReceivedEvent_t;
+
+typedef struct
+{
+  const char* devAddr;    // Hexadecimal device address
+  const char* networkId;
+}DevAddrAssignedEvent_t;
+
+typedef struct
+{
+  const MacDataRate* dataRate;    // Data rate now known to be used by the module
+}DataRateChangedEvent_t;
+
+typedef struct
+{
+  uint8_t errorCode;      // Result of the send (NEMEUS_SUCCESS...)
+}SigfoxSendDoneEvent_t;
+
+typedef struct
+{
+  boolean binary;         // payload is hexadecimal (RCVBIN) or text (RCVTXT)
+  const char* payload;
+  int rssi;
+  int snr;
+}RadioFrameReceivedEvent_t;
+
+/**
+ * Event delivered to the handlers, the member of the union is given by type.
+ * Pointers are only valid during the handler call.
+ */
+typedef struct
+{
+  uint8_t type;           // NEMEUS_EVENT (a single bit)
+  union
+  {
+    SendScheduledEvent_t sendScheduled;
+    DownlinkReceivedEvent_t downlinkReceived;
+    DevAddrAssignedEvent_t devAddrAssigned;
+    DataRateChangedEvent_t dataRateChanged;
+    SigfoxSendDoneEvent_t sigfoxSendDone;
+    RadioFrameReceivedEvent_t radioFrameReceived;
+  };
+}NemeusEvent_t;
+
+class EventBus : public Singleton<EventBus>
+{
+  friend class Singleton<EventBus>;
+
+  typedef void (*onEvent)(const NemeusEvent_t* event);
+
+  public:
+    /* Deliver the events of a mask to a handler (mask replaced if already subscribed) */
+    uint8_t subscribe(void (*onEvent)(const NemeusEvent_t* event), uint8_t eventMask);
+    /* Stop delivering events to a handler */
+    void unsubscribe(void (*onEvent)(const NemeusEvent_t* event));
+    /* True if a handler listens to one of the events of the mask */
+    boolean hasSubscriber(uint8_t eventMask) const;
+    /* Deliver an event to the handlers subscribed to it (called by the modules) */
+    void publish(const NemeusEvent_t& event);
+  private:
+    constexpr EventBus() : subscribers_(), nbSubscribers_(0), eventMask_(0) {}
+
+    struct Subscriber {
+      onEvent handler;
+      uint8_t eventMask;
+    };
+
+    Subscriber subscribers_[EVENT_BUS_MAX_SUBSCRIBERS];
+    uint8_t nbSubscribers_;
+    uint8_t eventMask_;   // Events of all subscribers
+
+    /* Methods */
+    void updateEventMask();
+};
+
+template <> EventBus Singleton<EventBus>::_singleton;
+
+#endif /* EVENT_BUS_H */
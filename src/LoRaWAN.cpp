@@ -26,20 +26,33 @@
 #include "NemeusUART.h"
 #include "LoRaWAN.h"
 #include "Utils/Utils.h"
+#include "Utils/NemeusClock.h"
+#include "SpanTracer.h"
+
+/* Unique instance */
+template <> LoRaWAN Singleton<LoRaWAN>::_singleton {};
 
 /**
  * Constructor
  */
 LoRaWAN::LoRaWAN()
 {
-  devPerso_ = new DevPerso();
-  dataContext_ = new DataContext();
-  macDataRate_ = new MacDataRate();
-  macChannel_ = new MacChannel();
+  macStatus_[0] = '\0';
+  shadowFields_ = 0;
+  macClass_ = '\0';
+  macOtaa_ = false;
+  adr_ = false;
+  piggyback_ = false;
+  encryption_ = false;
   otaa_ = false;
   loraWANstate_ = false;
-  /* Automatic register LoRaWAN intern callback to filter some received at response */
-  NemeusUART::getInstance()->addCallback(onReceiveFromUART);
+  sendingDelay_ = 0;
+  joinState_ = JOIN_IDLE;
+  joinAttempt_ = 0;
+  joinDuration_ = 0;
+  onJoinProgress = NULL;
+  onJoinDone = NULL;
+  /* LoRaWAN intern callback is registered by NemeusUART */
   onReceiveDownlink = NULL;
 }
 /**
@@ -47,14 +60,12 @@ LoRaWAN::LoRaWAN()
  */
 LoRaWAN::~LoRaWAN()
 {
-  NemeusUART::getInstance()->delCallback(onReceiveFromUART);
 }
 
 boolean LoRaWAN::readMacStatus()
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
 
-  dataContext_->setOngoingAtCommand(MAC_STATUS);
   ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_STATUS, NULL, 2000);
 
   if (ErrorCode != NEMEUS_SUCCESS)
@@ -62,82 +73,249 @@ boolean LoRaWAN::readMacStatus()
     /* The MAC status has been read and stored in treatAtResponse() function */
     this->loraWANstate_ = false;
     this->otaa_ = false;
+    shadowFields_ &= ~SHADOW_CLASS;
   }
 
   return this->loraWANstate_;
 }
 
+/**
+ * Restore the configuration from the snapshot of a previous startup
+ * @return  true if the snapshot matches the module MAC status
+ */
+boolean LoRaWAN::restoreSnapshot()
+{
+  ConfigSnapshot_t* snapshot = configSnapshot_.getSnapshot();
+
+  if (!configSnapshot_.load())
+  {
+    return false;
+  }
+
+  /* One status query tells if the module is still the one of the snapshot */
+  macStatus_[0] = '\0';
+  readMacStatus();
+  if ( (macStatus_[0] == '\0') || (strcmp(macStatus_, snapshot->macStatus) != 0) )
+  {
+    return false;
+  }
+
+  this->encryption_ = snapshot->encryption;
+  this->adr_ = snapshot->adr;
+  this->piggyback_ = snapshot->piggyback;
+  macDataRate_.setDataRate(snapshot->dataRate);
+  macDataRate_.setTxPower(snapshot->txPower);
+  shadowFields_ |= (SHADOW_ADR | SHADOW_PIGGYBACK | SHADOW_ENCRYPTION);
+
+  return true;
+}
+
+/**
+ * Save the configuration for the next startup
+ */
+void LoRaWAN::saveSnapshot()
+{
+  ConfigSnapshot_t* snapshot = configSnapshot_.getSnapshot();
+  const char* dataRate = macDataRate_.getDataRateName();
+
+  if (macStatus_[0] == '\0')
+  {
+    readMacStatus();
+  }
+
+  if ( (macStatus_[0] == '\0') || (dataRate[0] == '\0')
+      || (strlen(dataRate) >= CONFIG_SNAPSHOT_DATA_RATE_SIZE) )
+  {
+    return;
+  }
+
+  memset(snapshot, 0, sizeof(ConfigSnapshot_t));
+  strcpy(snapshot->macStatus, macStatus_);
+  snapshot->encryption = this->encryption_;
+  snapshot->adr = this->adr_;
+  snapshot->piggyback = this->piggyback_;
+  snapshot->txPower = macDataRate_.getTxPower();
+  strcpy(snapshot->dataRate, dataRate);
+
+  configSnapshot_.save();
+}
+
+/**
+ * A setting changed: the snapshot follows in RAM, the stored one is erased
+ * only if it differs, it is written again by the next ON()
+ */
+void LoRaWAN::updateSnapshot()
+{
+  ConfigSnapshot_t* snapshot = configSnapshot_.getSnapshot();
+  const char* dataRate = macDataRate_.getDataRateName();
+
+  snapshot->encryption = this->encryption_;
+  snapshot->adr = this->adr_;
+  snapshot->piggyback = this->piggyback_;
+  snapshot->txPower = macDataRate_.getTxPower();
+  if (strlen(dataRate) < CONFIG_SNAPSHOT_DATA_RATE_SIZE)
+  {
+    memset(snapshot->dataRate, 0, CONFIG_SNAPSHOT_DATA_RATE_SIZE);
+    strcpy(snapshot->dataRate, dataRate);
+  }
+
+  configSnapshot_.invalidate();
+}
+
+/**
+ * Read device perso, only fields not cached are read from the module
+ * @return  the binary device perso
+ */
 DevPerso_t* LoRaWAN::readDevPerso()
 {
-  this->readMacStatus();
-  this->readDevUID();
-  this->readAppUID();
-  this->readAppKey();
+  TraceSpan span("LoRaWAN::readDevPerso");
+
+  /* MAC status tells which fields to read, known once fields are cached and
+     while the activation mode of the enabled MAC is */
+  if ( (!this->devPerso_.isCached(DEVPERSO_OTAA_FIELDS)) || ((shadowFields_ & SHADOW_CLASS) == 0) )
+  {
+    this->readMacStatus();
+  }
+  else
+  {
+    this->otaa_ = this->macOtaa_;
+  }
+  this->cachePerso(DEVPERSO_OTAA_FIELDS);
 
   if(!this->otaa_)
   {
-    this->readDevAddr();
-    this->readNwkSKey();
-    this->readAppSKey();
+    this->cachePerso(DEVPERSO_ABP_FIELDS);
   }
 
-  return this->devPerso_->getDevPerso();
+  return this->devPerso_.getDevPerso();
 }
 
 DevPerso_t* LoRaWAN::readAbpPerso()
 {
-  this->readDevAddr();
-  this->readNwkSKey();
-  this->readAppSKey();
+  this->cachePerso(DEVPERSO_ABP_FIELDS);
 
-  return this->devPerso_->getDevPerso();
+  return this->devPerso_.getDevPerso();
+}
+
+/**
+ * Read the personalization fields not cached yet, the values are stored
+ * by treatAtResponse()
+ * @param fields  bitmask of DEVPERSO_FIELD
+ */
+void LoRaWAN::cachePerso(uint8_t fields)
+{
+  static const struct
+  {
+    uint8_t field;
+    const AtCommand* command;
+  } PERSO_READS[] =
+  {
+    {DEVPERSO_DEVUID, &MAC_READ_DEVUID},
+    {DEVPERSO_APPUID, &MAC_READ_APPUID},
+    {DEVPERSO_APPKEY, &MAC_READ_APPKEY},
+    {DEVPERSO_DEVADDR, &MAC_READ_DEVADDR},
+    {DEVPERSO_NWKSKEY, &MAC_READ_NWKSKEY},
+    {DEVPERSO_APPSKEY, &MAC_READ_APPSKEY}
+  };
+
+  for (uint8_t i = 0; i < sizeof(PERSO_READS)/sizeof(PERSO_READS[0]); i++)
+  {
+    if ( ((fields & PERSO_READS[i].field) != 0) && (!this->devPerso_.isCached(PERSO_READS[i].field)) )
+    {
+      NemeusUART::getInstance()->sendATCommand(*PERSO_READS[i].command, NULL, 2000);
+    }
+  }
 }
 
 boolean LoRaWAN::isOtaa()
 {
   return this->otaa_;
 }
-#define MAXIMUM_MACON_SIZE 8
+
+/**
+ * Get the LoRaWAN state
+ * @return  true if MAC has been enabled with ON()
+ */
+boolean LoRaWAN::isOn()
+{
+  return this->loraWANstate_;
+}
+/* AT+MAC=ON,,<class>,<otaa> */
+const static AtCommandTemplate<AtEmpty, AtChar, AtFlag> MAC_ON_CMD(MAC_ON);
 /**
- * Enable MAC
+ * Enable MAC. In OTAA, block until the join is done (see startJoin())
  * @return  the error code
  *               NEMEUS_OK if response is OK
- *               NEMEUS_ERROR if response is ERROR
+ *               NEMEUS_ERROR if response is ERROR or join failed
  *               NEMEUS_NO_ANSWER if no response from module
  */
 uint8_t LoRaWAN::ON(char loraClass, boolean otaa)
 {
+  TraceSpan span("LoRaWAN::ON");
   uint8_t ErrorCode = NEMEUS_ERROR;
-  uint8_t MacStatus = NEMEUS_ERROR;
-  char arguments[MAXIMUM_MACON_SIZE];
-  char *pt_arguments; 
-  pt_arguments = &arguments[0];
 
-  char devAddr[8];
+  if (otaa == true)
+  {
+    ErrorCode = startJoin(loraClass);
 
-  this->otaa_ = otaa;
-  strcpy(pt_arguments, SEPARATOR);
-  pt_arguments++;
-  strncat(pt_arguments, &loraClass, 1);
-  pt_arguments++;
-  strncat(pt_arguments, SEPARATOR, 1);
-  pt_arguments++;
+    while ( (ErrorCode == NEMEUS_SUCCESS)
+        && (joinState_ != JOIN_JOINED) && (joinState_ != JOIN_FAILED) )
+    {
+      processJoin();
+    }
 
-  if (otaa == true)
+    if ( (ErrorCode == NEMEUS_SUCCESS) && (joinState_ != JOIN_JOINED) )
+    {
+      ErrorCode = NEMEUS_ERROR;
+    }
+
+    return ErrorCode;
+  }
+
+  this->otaa_ = false;
+  ErrorCode = prepareMac();
+
+  if (ErrorCode == NEMEUS_SUCCESS)
   {
-    strncat(pt_arguments, (char*)String(1, DEC).c_str(), 1);
-    pt_arguments++;
+    ErrorCode = enableMac(loraClass, false);
   }
-  else
+
+  if (ErrorCode == NEMEUS_SUCCESS)
   {
-    strncat(pt_arguments, (char*)String(0, DEC).c_str(), 1);
-    pt_arguments++;
+    loraWANstate_ = true;
+    saveSnapshot();
   }
-  strncat(pt_arguments, (char*)"\r\n", 2);
-  pt_arguments+= 2;
+
+  return ErrorCode;
+}
+
+/**
+ * Read the configuration needed before enabling MAC
+ * @return  the error code
+ *               NEMEUS_OK if response is OK
+ *               NEMEUS_ERROR if response is ERROR
+ *               NEMEUS_NO_ANSWER if no response from module
+ */
+uint8_t LoRaWAN::prepareMac()
+{
+  uint8_t ErrorCode = NEMEUS_ERROR;
+  boolean otaa = this->otaa_;
+  boolean isRestored;
+
+  /* Warm startup: configuration is known if the module matches the snapshot */
+  isRestored = restoreSnapshot();
+  /* MAC status read by the snapshot check gives the previous mode */
+  this->otaa_ = otaa;
 
   /* Read Encryption */
-  ErrorCode = readEncryption();
+  if ( (isRestored) || (shadowFields_ & SHADOW_ENCRYPTION) )
+  {
+    ErrorCode = NEMEUS_SUCCESS;
+  }
+  else
+  {
+    ErrorCode = readEncryption();
+  }
 
   /* Enable Unsollicited */
   if (ErrorCode == NEMEUS_SUCCESS)
@@ -146,128 +324,276 @@ uint8_t LoRaWAN::ON(char loraClass, boolean otaa)
   }
 
   /* Read ADR */
-  if (ErrorCode == NEMEUS_SUCCESS)
+  if ( (ErrorCode == NEMEUS_SUCCESS) && (!isRestored)
+      && ((shadowFields_ & (SHADOW_ADR | SHADOW_PIGGYBACK)) != (SHADOW_ADR | SHADOW_PIGGYBACK)) )
   {
     ErrorCode = readAdr();
   }
 
   /* Read Data Rate */
-  if (ErrorCode == NEMEUS_SUCCESS)
+  if ( (ErrorCode == NEMEUS_SUCCESS) && (!isRestored) && (macDataRate_.getDataRate() == MAC_DR_UNKNOWN) )
   {
     ErrorCode = readDataRate();
   }
 
+  return ErrorCode;
+}
+
+/**
+ * Send the MAC ON command
+ * @return  the error code
+ *               NEMEUS_OK if response is OK
+ *               NEMEUS_ERROR if response is ERROR
+ *               NEMEUS_NO_ANSWER if no response from module
+ */
+uint8_t LoRaWAN::enableMac(char loraClass, boolean otaa)
+{
+  uint8_t ErrorCode = NEMEUS_ERROR;
+
+  /* In ABP, MAC already enabled with this class: nothing to do */
+  if ( (otaa == false) && (shadowFields_ & SHADOW_CLASS)
+      && (macOtaa_ == false) && (macClass_ == loraClass) )
+  {
+    return NEMEUS_SUCCESS;
+  }
+
   /* Reset sending delay for Join request */
   this->sendingDelay_ = 0;
 
+  /* Enable MAC */
+  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_ON_CMD, 2000, loraClass, otaa);
+
   if (ErrorCode == NEMEUS_SUCCESS)
   {
-    dataContext_->setOngoingAtCommand(MAC_ON);
-
-    /* Enable MAC */
-    ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_ON, arguments, 2000);
+    macClass_ = loraClass;
+    macOtaa_ = otaa;
+    shadowFields_ |= SHADOW_CLASS;
     ErrorCode = readDataRate();
   }
 
-  /* Ask for MAC status */
-  //  MacStatus = NemeusUART:: getInstance()->sendATCommand(MAC_STATUS, NULL, 5000);
+  return ErrorCode;
+}
+
+/**
+ * Start an OTAA join. The join runs in processJoin(), to call from the
+ * sketch loop until the join callback is called (or getJoinState() is
+ * JOIN_JOINED or JOIN_FAILED).
+ * @param loraClass  the LoRaWAN class ('A' or 'C')
+ * @return  the error code
+ *               NEMEUS_OK if the join is started
+ *               NEMEUS_ERROR if a join is ongoing or on response ERROR
+ *               NEMEUS_NO_ANSWER if no response from module
+ */
+uint8_t LoRaWAN::startJoin(char loraClass)
+{
+  uint8_t ErrorCode = NEMEUS_ERROR;
 
-  /* if OTAA, wait for device Addr */
-  if ((ErrorCode == NEMEUS_SUCCESS) && (otaa == true))
+  if ( (joinState_ == JOIN_BACKOFF) || (joinState_ == JOIN_REQUESTED) )
   {
-    /* OTAA is finished when Device Address is not null */
-    boolean continueLoop = true;
-    const int COUNTER_MAX = 60;
-    uint32_t  delay;
+    return NEMEUS_ERROR;
+  }
+
+  this->otaa_ = true;
+  ErrorCode = prepareMac();
+
+  if (ErrorCode == NEMEUS_SUCCESS)
+  {
+    /* Device address and session keys are given by the join */
+    this->devPerso_.invalidate(DEVPERSO_ABP_FIELDS);
+
+    seedJoinJitter();
+
+    joinClass_ = loraClass;
+    joinAttempt_ = 0;
+    joinStartTime_ = NemeusClock::get()->now();
+    joinDuration_ = 0;
+    /* First attempt without delay */
+    joinTime_ = joinStartTime_;
+    joinState_ = JOIN_BACKOFF;
+  }
+
+  return ErrorCode;
+}
 
+/**
+ * Run the join state machine, returns after at most LORAWAN_JOIN_POLL_PERIOD ms
+ * (or the MAC ON command duration when an attempt starts)
+ * @return  the join state (JOIN_STATE)
+ */
+uint8_t LoRaWAN::processJoin()
+{
+  int32_t remaining = (int32_t)(joinTime_ - NemeusClock::get()->now());
+  uint32_t pollPeriod = LORAWAN_JOIN_POLL_PERIOD;
+
+  if (remaining < LORAWAN_JOIN_POLL_PERIOD)
+  {
+    pollPeriod = (remaining > 0) ? remaining : 1;
+  }
 
-    for (int i=0; (i<COUNTER_MAX) && (continueLoop == true); i++)
+  if (joinState_ == JOIN_BACKOFF)
+  {
+    if (remaining > 0)
     {
-      /* First, wait for Join request sending*/
-      while (this->sendingDelay_ != 0)
-      {
-        delay = this->sendingDelay_;
-        this->sendingDelay_ = 0;
-        /* Poll device for traces buffer evacuation */
-        NemeusUART::getInstance()->pollDevice(delay);
-      }
       /* Poll device for traces buffer evacuation */
-      NemeusUART::getInstance()->pollDevice(8000);
+      NemeusUART::getInstance()->pollDevice(pollPeriod);
+      return joinState_;
+    }
 
-      /* Test if deviceAddr has been received in unsollicited response */
-      long longDevAddr = deviceAddressToLong(this->devPerso_->getDevPerso()->devAddr);
+    if (joinAttempt_ != 0)
+    {
+      /* Restart the MAC for a new join request */
+      NemeusUART::getInstance()->sendATCommand(MAC_OFF, NULL, 2000);
+    }
 
-      if ( (sizeof(this->devPerso_->getDevPerso()->devAddr)!= 0) && (longDevAddr != 0) )
+    joinState_ = JOIN_REQUESTED;
+    if (enableMac(joinClass_, true) == NEMEUS_SUCCESS)
+    {
+      joinTime_ = NemeusClock::get()->now() + LORAWAN_JOIN_ATTEMPT_TIMEOUT;
+      notifyJoinProgress(0);
+    }
+    else
+    {
+      scheduleJoinRetry();
+    }
+  }
+  else if (joinState_ == JOIN_REQUESTED)
+  {
+    const uint8_t* devAddr = this->devPerso_.getDevPerso()->devAddr;
+
+    /* Complete as soon as the device address is received */
+    if ( (!this->devPerso_.isCached(DEVPERSO_DEVADDR))
+        || ((devAddr[0] | devAddr[1] | devAddr[2] | devAddr[3]) == 0) )
+    {
+      NemeusUART::getInstance()->pollDevice(pollPeriod);
+    }
+
+    if ( (this->devPerso_.isCached(DEVPERSO_DEVADDR))
+        && ((devAddr[0] | devAddr[1] | devAddr[2] | devAddr[3]) != 0) )
+    {
+      joinState_ = JOIN_JOINED;
+      joinDuration_ = NemeusClock::get()->now() - joinStartTime_;
+      loraWANstate_ = true;
+      saveSnapshot();
+
+      if (onJoinDone != NULL)
       {
-        /* Device Address is present */
-        continueLoop = false;
+        onJoinDone(NEMEUS_SUCCESS, joinDuration_);
       }
     }
-
-    /* Set the OTAA error code procedure */
-    if (continueLoop == true)
+    else if (this->sendingDelay_ != 0)
     {
-      ErrorCode = NEMEUS_ERROR;
+      /* Join request delayed by the module (duty cycle): extend the attempt */
+      joinTime_ = NemeusClock::get()->now() + this->sendingDelay_ + LORAWAN_JOIN_ATTEMPT_TIMEOUT;
+      notifyJoinProgress(this->sendingDelay_);
+      this->sendingDelay_ = 0;
     }
-    else
+    else if ((int32_t)(joinTime_ - NemeusClock::get()->now()) <= 0)
     {
-      ErrorCode = NEMEUS_SUCCESS;
+      scheduleJoinRetry();
     }
   }
 
-  if (ErrorCode == NEMEUS_SUCCESS)
+  return joinState_;
+}
+
+/**
+ * Get the join state
+ * @return  the join state (JOIN_STATE)
+ */
+uint8_t LoRaWAN::getJoinState()
+{
+  return joinState_;
+}
+
+/**
+ * Get the duration of the last join
+ * @return  the time in ms from startJoin() to the device address, 0 if not joined
+ */
+uint32_t LoRaWAN::getJoinDuration()
+{
+  return joinDuration_;
+}
+
+/**
+ * Schedule the next join attempt after an exponential backoff with jitter,
+ * or fail the join after LORAWAN_JOIN_MAX_ATTEMPTS
+ */
+void LoRaWAN::scheduleJoinRetry()
+{
+  uint32_t backoff;
+
+  joinAttempt_++;
+  if (joinAttempt_ >= LORAWAN_JOIN_MAX_ATTEMPTS)
   {
-    loraWANstate_ = true;
+    joinState_ = JOIN_FAILED;
+
+    if (onJoinDone != NULL)
+    {
+      onJoinDone(NEMEUS_ERROR, 0);
+    }
+    return;
   }
 
-  //macChannel_->isFrequencyPresent_  = true;
-  return ErrorCode;
-}
+  backoff = LORAWAN_JOIN_BACKOFF_BASE << (joinAttempt_ - 1);
+  if (backoff > LORAWAN_JOIN_BACKOFF_MAX)
+  {
+    backoff = LORAWAN_JOIN_BACKOFF_MAX;
+  }
+  /* Half fixed, half random: devices reset together don't join together */
+  backoff = backoff/2 + random(backoff/2 + 1);
 
-#define DEVICE_ADDRESS_SIZE 8
+  joinTime_ = NemeusClock::get()->now() + backoff;
+  joinState_ = JOIN_BACKOFF;
+  notifyJoinProgress(backoff);
+}
 
 /**
- * Convert device Address to long
- * @return  the device address in long
+ * Mix the DevEUI in the seed of random(): devices reset together draw
+ * different backoffs even if the sketch never calls randomSeed()
+ * (a seed it has set still counts)
  */
-long LoRaWAN::deviceAddressToLong(String deviceAddr)
+void LoRaWAN::seedJoinJitter()
 {
-  char buffer[DEVICE_ADDRESS_SIZE+1];
-  char *end;
-  long result;
+  uint32_t seed = (uint32_t)random(0x7FFFFFFF);
+  const uint8_t* devUID;
 
-  deviceAddr.toCharArray(buffer, DEVICE_ADDRESS_SIZE+1);
+  /* Read once, cached afterwards */
+  this->cachePerso(DEVPERSO_DEVUID);
+  devUID = this->devPerso_.getDevPerso()->devUID;
 
-  result = strtol(buffer, &end, 16);
+  for (uint8_t i = 0; i < DEVPERSO_EUI_SIZE; i++)
+  {
+    seed = seed * 31 + devUID[i];
+  }
+  randomSeed(seed);
+}
 
-  return result;
+void LoRaWAN::notifyJoinProgress(uint32_t delay)
+{
+  if (onJoinProgress != NULL)
+  {
+    onJoinProgress(joinState_, joinAttempt_, delay);
+  }
 }
 
 /**
  * Read Dev Addr
+ * @param devAddr  buffer of DEVPERSO_DEVADDR_HEX_SIZE characters
  * @return  the error code
  *               NEMEUS_OK if response is OK
  *               NEMEUS_ERROR if response is ERROR
  *               NEMEUS_NO_ANSWER if no response from module
  */
-char* LoRaWAN::readDevAddr()
+char* LoRaWAN::readDevAddr(char devAddr[DEVPERSO_DEVADDR_HEX_SIZE])
 {
-  uint8_t ErrorCode = NEMEUS_ERROR;
-
-  dataContext_->setOngoingAtCommand(MAC_READ_DEVADDR);
-
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_READ_DEVADDR, NULL, 2000);
+  this->cachePerso(DEVPERSO_DEVADDR);
 
-  if (ErrorCode != NEMEUS_SUCCESS)
-  {
-    /* The device UID has been read and stored in treatAtResponse() function */
-    this->devPerso_->setAbpPerso((char*)"", this->devPerso_->getDevPerso()->nwkSKey, this->devPerso_->getDevPerso()->appSKey);
-  }
-
-  return this->devPerso_->getDevPerso()->devAddr;
+  return this->devPerso_.getFieldAsHex(DEVPERSO_DEVADDR, devAddr);
 }
 
 #define DEVADDR_SIZE 8
+/* AT+MAC=SDEVADDR,<devAddr> */
+const static AtCommandTemplate<AtHex<DEVADDR_SIZE> > MAC_SET_DEVADDR_CMD(MAC_SET_DEVADDR);
 /**
  * Set the device address
  * @return  the error code
@@ -279,20 +605,13 @@ uint8_t LoRaWAN::setDevAddr(char DevADDR[DEVADDR_SIZE])
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
 
-  char arguments[10];
-  char* pt_arguments;
-  pt_arguments  = &arguments[0];
-  strcpy(pt_arguments, DevADDR);
-  pt_arguments+=8;
-  strncat(pt_arguments, CRLF, 2);
-
-  dataContext_->setOngoingAtCommand(MAC_SET_DEVADDR);
-
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SET_DEVADDR, arguments, 2000);
+  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SET_DEVADDR_CMD, 2000, DevADDR);
 
   if (ErrorCode == NEMEUS_SUCCESS)
   {
-    this->devPerso_->setAbpPerso(DevADDR,this->devPerso_->getDevPerso()->nwkSKey, this->devPerso_->getDevPerso()->appSKey);
+    this->devPerso_.setField(DEVPERSO_DEVADDR, DevADDR);
+    /* Next ON() enables MAC with the new personalization */
+    shadowFields_ &= ~SHADOW_CLASS;
   }
 
   return ErrorCode;
@@ -300,43 +619,24 @@ uint8_t LoRaWAN::setDevAddr(char DevADDR[DEVADDR_SIZE])
 
 /**
  * Read App Skey
+ * @param appSKey  buffer of DEVPERSO_KEY_HEX_SIZE characters
  * @return  the error code
  *               NEMEUS_OK if response is OK
  *               NEMEUS_ERROR if response is ERROR
  *               NEMEUS_NO_ANSWER if no response from module
  */
-char* LoRaWAN::readAppSKey()
+char* LoRaWAN::readAppSKey(char appSKey[DEVPERSO_KEY_HEX_SIZE])
 {
-  uint8_t ErrorCode = NEMEUS_ERROR;
-
-  dataContext_->setOngoingAtCommand(MAC_READ_APPSKEY);
+  this->cachePerso(DEVPERSO_APPSKEY);
 
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_READ_APPSKEY, NULL, 2000);
-
-  if (ErrorCode != NEMEUS_SUCCESS)
-  {
-    /* The device UID has been read and stored in treatAtResponse() function */
-    this->devPerso_->setAbpPerso(this->devPerso_->getDevPerso()->devAddr, this->devPerso_->getDevPerso()->nwkSKey, (char*)"");
-  }
-
-  return this->devPerso_->getDevPerso()->appSKey;
+  return this->devPerso_.getFieldAsHex(DEVPERSO_APPSKEY, appSKey);
 }
 
-char* LoRaWAN::readNwkSKey()
+char* LoRaWAN::readNwkSKey(char nwkSKey[DEVPERSO_KEY_HEX_SIZE])
 {
-  uint8_t ErrorCode = NEMEUS_ERROR;
+  this->cachePerso(DEVPERSO_NWKSKEY);
 
-  dataContext_->setOngoingAtCommand(MAC_READ_NWKSKEY);
-
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_READ_NWKSKEY, NULL, 2000);
-
-  if (ErrorCode != NEMEUS_SUCCESS)
-  {
-    /* The device UID has been read and stored in treatAtResponse() function */
-    this->devPerso_->setAbpPerso(this->devPerso_->getDevPerso()->devAddr, (char*)"", this->devPerso_->getDevPerso()->appSKey);
-  }
-
-  return this->devPerso_->getDevPerso()->nwkSKey;
+  return this->devPerso_.getFieldAsHex(DEVPERSO_NWKSKEY, nwkSKey);
 }
 
 /**
@@ -350,25 +650,28 @@ uint8_t LoRaWAN::OFF()
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
 
-  dataContext_->setOngoingAtCommand(MAC_OFF);
-
   ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_OFF, NULL, 2000);
 
   /* Reset internal state */
   if (ErrorCode == NEMEUS_SUCCESS)
   {
     loraWANstate_ = false;
+    shadowFields_ &= ~SHADOW_CLASS;
+    /* Cancel an ongoing join */
+    joinState_ = JOIN_IDLE;
     if(this->otaa_)
     {
-      this->devPerso_->setAbpPerso((char*)"", this->devPerso_->getDevPerso()->nwkSKey, this->devPerso_->getDevPerso()->appSKey);
+      /* Session is lost, a new join is needed */
+      this->devPerso_.invalidate(DEVPERSO_ABP_FIELDS);
     }
   }
 
   return ErrorCode;
 }
 
-#define MINIMUM_SND_SIZE 12
-#define MAXIMUM_ARGUMENT_SIZE 512
+/* AT+MAC=SND<BIN|TXT>,<payload>,<repetition>,<port>,<ack> */
+const static AtCommandTemplate<AtWord<3>, AtPayload<2*MAX_LORAWAN_PAYLOAD_3>, AtDec<99>, AtDec<99>, AtFlag>
+  MAC_SEND_CMD(MAC_SEND);
 /**
  * Send a frame through LoRaWAN layer
  * @param mode  0 for Binary mode or 1 for Text mode
@@ -384,136 +687,81 @@ uint8_t LoRaWAN::OFF()
  */
 uint8_t LoRaWAN::sendFrame(uint8_t mode, uint8_t repetition, uint8_t macPort, const char* payload, boolean ack, boolean encrypt)
 {
+  TraceSpan span("LoRaWAN::sendFrame");
   uint8_t ErrorCode = NEMEUS_SUCCESS;
-  static char arguments[MAXIMUM_ARGUMENT_SIZE];
-  char *pt_arguments; 
-  char *pt_arguments_end;
-  uint8_t size_command_argument;
-  int index = 0;
-  boolean sizeTooBig = false;
-  pt_arguments = &arguments[4];
-  pt_arguments_end = &arguments[511];
+  uint8_t FormatCode;
 
-  if (this->encryption_ != encrypt)
+  /* Nothing sent if encryption is unchanged */
+  ErrorCode = setEncryption(encrypt);
+  if (ErrorCode != NEMEUS_SUCCESS)
   {
-    ErrorCode = setEncryption(encrypt);
-    if (ErrorCode != NEMEUS_SUCCESS)
-    {
-      return ErrorCode;
-    }
+    return ErrorCode;
   }
 
-  /* Test limitation */
-  if ( (repetition>99) || (macPort>99) )
+  ArgumentWriter& arguments = NemeusUART::getInstance()->newArguments();
+  FormatCode = formatFrame(arguments, mode, repetition, macPort, payload, ack);
+  if (FormatCode == NEMEUS_ARGUMENT_ERROR)
   {
-    return NEMEUS_ARGUMENT_ERROR;
+    return FormatCode;
   }
 
-  if (mode == BINARY_MODE)
-  {
-    strcpy(arguments, "BIN");
-
-    /* Calculate the size of comamnd */
-    if (strlen(payload) > 2*getMaximumPayloadSize())
-    {
-      sizeTooBig = true;
-      size_command_argument = MINIMUM_SND_SIZE+(2*getMaximumPayloadSize());   
-    }
-    else
-    {
-      size_command_argument = MINIMUM_SND_SIZE+strlen(payload);
-    }
+  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SEND, arguments, 20000);
 
-  }
-  else if (mode == TEXT_MODE)
+  if ((ErrorCode == NEMEUS_SUCCESS) && (FormatCode == NEMEUS_WARNING_PAYLOAD_TRUNACTED))
   {
-    strcpy(arguments, "TXT");
-
-    /* Calculate the size of comamnd */
-    if (strlen(payload) > getMaximumPayloadSize())
-    {
-      sizeTooBig = true;
-      size_command_argument = MINIMUM_SND_SIZE+getMaximumPayloadSize();  
-    }
-    else
-    {
-      size_command_argument = MINIMUM_SND_SIZE+strlen(payload);
-    }
-  }
-  else
-  {
-    return NEMEUS_ARGUMENT_ERROR;
+    ErrorCode = NEMEUS_WARNING_PAYLOAD_TRUNACTED;
   }
-  index+=3;
 
+  return ErrorCode;
+}
 
-  if (repetition>=10)
-  {
-    size_command_argument++;
-  }
-  if (macPort>=10)
-  {
-    size_command_argument++;
-  }
+/**
+ * Format the arguments of a frame, the payload is cut to the maximum size of the data rate
+ * @param arguments  the writer to fill
+ * @param mode  0 for Binary mode or 1 for Text mode
+ * @param repetition  Number of repetition
+ * @param macPort  MAC port
+ * @param payload  null terminated payload buffer
+ * @param ack  Ask for Acknowledgement or not
+ * @return  the error code
+ *               NEMEUS_OK if the arguments are formatted
+ *               NEMEUS_WARNING_PAYLOAD_TRUNACTED if the payload is cut
+ *               NEMEUS_ARGUMENT_ERROR if argument format error
+ */
+uint8_t LoRaWAN::formatFrame(ArgumentWriter& arguments, uint8_t mode, uint8_t repetition, uint8_t macPort, const char* payload, boolean ack)
+{
+  AtSpan frame;
+  uint16_t maximumSize;
+  boolean sizeTooBig = false;
 
-  strcat(arguments, ",");
-  index++;
-  if (sizeTooBig)
+  if (mode == BINARY_MODE)
   {
-    if (mode == BINARY_MODE )
-    {
-      strncat(pt_arguments, payload, (2*getMaximumPayloadSize()));
-      pt_arguments += (2*getMaximumPayloadSize());
-      index+=(2*getMaximumPayloadSize());
-    }
-    else if (mode == TEXT_MODE)
-    {
-      strncat(pt_arguments, payload, (getMaximumPayloadSize()));
-      pt_arguments += (getMaximumPayloadSize());
-      index+=(getMaximumPayloadSize());
-    }
+    maximumSize = 2*getMaximumPayloadSize();
   }
-  else
+  else if (mode == TEXT_MODE)
   {
-    strncat(pt_arguments, payload, strlen(payload));
-    index+=strlen(payload);
-    pt_arguments += strlen(payload);
-  }
-  strncat(pt_arguments, ",", 1);
-  pt_arguments++;
-  index++;
-  index+=sprintf(arguments+index, "%d", repetition);
-  strncat(pt_arguments, ",", 1);
-  pt_arguments++;
-  index++;
-  index+=sprintf(arguments+index, "%d", macPort);
-  strncat(pt_arguments, ",", 1);
-  pt_arguments++;
-  index++;
-  if (ack == true)
-  {
-    strncat(pt_arguments, "1", 1);
+    maximumSize = getMaximumPayloadSize();
   }
   else
   {
-    strncat(pt_arguments, "0", 1);
+    return NEMEUS_ARGUMENT_ERROR;
   }
-  index++;
-  pt_arguments++;
-  strncat(pt_arguments, "\r\n", 2);
-  pt_arguments+=2;
-  index+=2;
 
-  dataContext_->setOngoingAtCommand(MAC_SEND);
-
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SEND, arguments, 20000);
+  frame.data = payload;
+  frame.length = strlen(payload);
+  if (frame.length > maximumSize)
+  {
+    sizeTooBig = true;
+    frame.length = maximumSize;
+  }
 
-  if ((ErrorCode == NEMEUS_SUCCESS) && (sizeTooBig == true))
+  /* Repetition and port above 99 are rejected */
+  if (!MAC_SEND_CMD.format(arguments, (mode == BINARY_MODE) ? "BIN" : "TXT", frame, repetition, macPort, ack))
   {
-    ErrorCode = NEMEUS_WARNING_PAYLOAD_TRUNACTED;
+    return NEMEUS_ARGUMENT_ERROR;
   }
 
-  return ErrorCode;
+  return (sizeTooBig == true) ? NEMEUS_WARNING_PAYLOAD_TRUNACTED : NEMEUS_SUCCESS;
 }
 
 /**
@@ -523,80 +771,130 @@ uint8_t LoRaWAN::sendFrame(uint8_t mode, uint8_t repetition, uint8_t macPort, co
  */
 uint8_t LoRaWAN::getMaximumPayloadSize()
 {
-  uint8_t maximumPayloadSize = 0;
-  char * buffer;
-  uint8_t ErrorCode = NEMEUS_SUCCESS;
-
-  if (macDataRate_->getDataRate().length() == 0)
+  if (macDataRate_.getDataRate() == MAC_DR_UNKNOWN)
   {
     /* Data Rate not present, read the Mac Data Rate */
-    ErrorCode = readDataRate();
+    readDataRate();
   }
 
-  if ( (ErrorCode == NEMEUS_SUCCESS) && (macDataRate_->getDataRate().length() != 0) )
-  {
+  return getKnownMaximumPayloadSize();
 
-    buffer = (char*) malloc(macDataRate_->getDataRate().length()+1);
-    macDataRate_->getDataRate().toCharArray(buffer, macDataRate_->getDataRate().length()+1);
+}
 
-    if (strcmp(buffer, "SF12BW125") == 0)
-    {
-      maximumPayloadSize = MAX_LORAWAN_PAYLOAD_1;
-    }
-    else if (strcmp(buffer, "SF11BW125") == 0)
-    {
-      maximumPayloadSize = MAX_LORAWAN_PAYLOAD_1;
-    }
-    else if (strcmp(buffer, "SF10BW125") == 0)
-    {
+/**
+ * Get the maximum payload size of the data rate known, the module isn't asked
+ * @return  the maximum payload size, 0 if the data rate isn't known
+ */
+uint8_t LoRaWAN::getKnownMaximumPayloadSize()
+{
+  uint8_t maximumPayloadSize = 0;
+
+  switch (macDataRate_.getDataRate())
+  {
+    case MAC_DR_SF12BW125:
+    case MAC_DR_SF11BW125:
+    case MAC_DR_SF10BW125:
       maximumPayloadSize = MAX_LORAWAN_PAYLOAD_1;
-    }
-    else if (strcmp(buffer, "SF9BW125") == 0)
-    {
-      maximumPayloadSize = MAX_LORAWAN_PAYLOAD_2;
-    }
-    else if (strcmp(buffer, "SF8BW125") == 0)
-    {
-      maximumPayloadSize = MAX_LORAWAN_PAYLOAD_3;
-    }
-    else if (strcmp(buffer, "SF7BW125") == 0)
-    {
+      break;
+    case MAC_DR_SF9BW125:
+      maximumPayloadSize = MAX_LORAWAN_PAYLOAD_2;
+      break;
+    case MAC_DR_SF8BW125:
+    case MAC_DR_SF7BW125:
+    case MAC_DR_SF7BW250:
+    case MAC_DR_FSK50KBPS:
       maximumPayloadSize = MAX_LORAWAN_PAYLOAD_3;
-    }
-    else if (strcmp(buffer, "SF7BW250") == 0)
+      break;
+    default:
+      break;
+  }
+
+  return maximumPayloadSize;
+}
+
+#define LORAWAN_MAC_OVERHEAD 13
+#define LORA_PREAMBLE_SYMBOLS 8
+/**
+ * Get the time on air of a frame (LoRaWAN MAC overhead included, no FOpt)
+ * @param  payloadSize  the application payload size in bytes
+ * @return  the time on air in ms. 0 if Data Rate is unknown
+ */
+uint32_t LoRaWAN::getTimeOnAir(uint8_t payloadSize)
+{
+  uint32_t timeOnAir = 0;
+  uint32_t phyPayloadSize = payloadSize + LORAWAN_MAC_OVERHEAD;
+  uint8_t dataRate = macDataRate_.getDataRate();
+
+  if (dataRate == MAC_DR_UNKNOWN)
+  {
+    /* Data Rate not present, read the Mac Data Rate */
+    if (readDataRate() == NEMEUS_SUCCESS)
     {
-      maximumPayloadSize = MAX_LORAWAN_PAYLOAD_3;
+      dataRate = macDataRate_.getDataRate();
     }
-    else if (strcmp(buffer, "FSK50KBPS") == 0)
+  }
+
+  if (dataRate <= MAC_DR_SF7BW250)
+  {
+    /* LoRa modulation, code rate 4/5, explicit header, CRC on */
+    int32_t spreadingFactor = (dataRate == MAC_DR_SF7BW250) ? 7 : 12 - dataRate;
+    int32_t bandwidth = (dataRate == MAC_DR_SF7BW250) ? 250 : 125;
+    int32_t lowDataRateOptimize = ((spreadingFactor >= 11) && (bandwidth == 125)) ? 1 : 0;
+    int32_t numerator;
+    int32_t denominator;
+    int32_t payloadSymbols = 8;
+    uint32_t symbolTimeUs;
+
+    symbolTimeUs = ((uint32_t)1000 << spreadingFactor) / bandwidth;
+    numerator = 8*phyPayloadSize - 4*spreadingFactor + 28 + 16;
+    denominator = 4*(spreadingFactor - 2*lowDataRateOptimize);
+    if (numerator > 0)
     {
-      maximumPayloadSize = MAX_LORAWAN_PAYLOAD_3;
+      payloadSymbols += ((numerator + denominator - 1) / denominator) * 5;
     }
 
-    free(buffer);
+    /* Preamble (n + 4.25 symbols) + payload symbols */
+    timeOnAir = ((LORA_PREAMBLE_SYMBOLS*4 + 17)*symbolTimeUs/4 + payloadSymbols*symbolTimeUs + 999) / 1000;
+  }
+  else if (dataRate == MAC_DR_FSK50KBPS)
+  {
+    /* Preamble (5) + sync word (3) + length (1) + payload + CRC (2) at 50 kbps */
+    timeOnAir = ((5 + 3 + 1 + phyPayloadSize + 2)*8 + 49) / 50;
   }
 
-  return maximumPayloadSize;
-
+  return timeOnAir;
 }
 
 /**
- * Set MAC data rate
+ * Set MAC data rate. Fields not present are left unchanged.
+ * Nothing is sent if the module already holds the values present.
  * @param  MacDataRate structure
  * @return  the error code
  *               NEMEUS_OK if response is OK
  *               NEMEUS_ERROR if response is ERROR
  *               NEMEUS_NO_ANSWER if no response from module
+ *               NEMEUS_ARGUMENT_ERROR if arguments don't fit
  */
-uint8_t LoRaWAN::setDataRate(MacDataRate_t* macDataRate)
+uint8_t LoRaWAN::setDataRate(const MacDataRate& macDataRate)
 {
-  static char buffer[512];
   uint8_t ErrorCode = NEMEUS_ERROR;
+  ArgumentWriter* arguments;
+
+  if (macDataRate.isIncludedIn(macDataRate_))
+  {
+    return NEMEUS_SUCCESS;
+  }
 
-  dataContext_->setOngoingAtCommand(MAC_SET_DATA_RATE);
-  SerialUSB.println("debug");
-  SerialUSB.println(this->macDataRate_->generateArguments(buffer));
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SET_DATA_RATE, this->macDataRate_->generateArguments(buffer), 2000);
+  arguments = &NemeusUART::getInstance()->newArguments();
+  macDataRate.generateArguments(*arguments);
 
+  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SET_DATA_RATE, *arguments, 2000);
+
+  if (ErrorCode == NEMEUS_SUCCESS)
+  {
+    macDataRate_.update(macDataRate);
+    updateSnapshot();
+  }
 
   return ErrorCode;
 }
@@ -613,33 +911,48 @@ uint8_t LoRaWAN::readDataRate()
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
 
-  dataContext_->setOngoingAtCommand(MAC_READ_DATA_RATE);
-
   ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_READ_DATA_RATE, NULL, 2000);
 
   return ErrorCode;
 }
 
 /**
- * Set MAC channel
+ * Set MAC channel. Nothing is sent if the module already holds the values present.
  * @param  MacChannel structure
  * @return  the error code
  *               NEMEUS_OK if response is OK
  *               NEMEUS_ERROR if response is ERROR
  *               NEMEUS_NO_ANSWER if no response from module
+ *               NEMEUS_ARGUMENT_ERROR if arguments don't fit
  */
-uint8_t LoRaWAN::setChannel(MacChannel macChannel)
+uint8_t LoRaWAN::setChannel(const MacChannel& macChannel)
 {
-  static char buffer[512];
   uint8_t ErrorCode = NEMEUS_ERROR;
+  ArgumentWriter* arguments;
+
+  if (channelShadow_.matches(macChannel))
+  {
+    return NEMEUS_SUCCESS;
+  }
 
-  dataContext_->setOngoingAtCommand(MAC_SET_CHANNEL);
+  arguments = &NemeusUART::getInstance()->newArguments();
+  macChannel.generateArguments(*arguments);
 
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SET_CHANNEL, macChannel.generateArguments(buffer), 2000);
+  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SET_CHANNEL, *arguments, 2000);
+
+  if (ErrorCode == NEMEUS_SUCCESS)
+  {
+    channelShadow_.update(macChannel);
+  }
 
   return ErrorCode;
 }
 
+/* AT+MAC=RCH,<channel>,<page>,<unsollicited> */
+const static AtCommandTemplate<AtDec<255>, AtDec<255>, AtFlag> MAC_READ_CHANNEL_CMD(MAC_READ_CHANNEL);
+/* AT+MAC=RCH,,,<unsollicited> */
+const static AtCommandTemplate<AtEmpty, AtEmpty, AtFlag> MAC_UNSOLLICITED_CMD(MAC_READ_CHANNEL);
+
 /**
  * Read MAC channel
  * @return  the error code
@@ -651,33 +964,7 @@ uint8_t LoRaWAN::readChannel(uint8_t channelNumber, uint8_t pageNumber, bool uns
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
 
-  char arguments[11];
-  char* pt_arguments;
-  pt_arguments  = &arguments[0];
-
-  strcpy(pt_arguments, (char*)String(channelNumber, DEC).c_str());
-  pt_arguments+= String(channelNumber, DEC).length();
-  strncat(pt_arguments, SEPARATOR, 1);
-  pt_arguments++;
-  strncat(pt_arguments, (char*)String(pageNumber, DEC).c_str(), 3);
-  pt_arguments+= String(pageNumber, DEC).length();
-  strncat(pt_arguments, SEPARATOR,1);
-  pt_arguments++;
-  if (unsolEvent == true)
-  {
-    strncat(pt_arguments, (char*)String(1, DEC).c_str(), 1);
-  }
-  else
-  {
-    strncat(pt_arguments, (char*)String(0, DEC).c_str(), 1);
-  }
-  pt_arguments++;
-  strncat(pt_arguments, CRLF, 2);
-  pt_arguments+=2;
-
-  dataContext_->setOngoingAtCommand(MAC_READ_CHANNEL);
-
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_READ_CHANNEL, arguments, 2000);
+  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_READ_CHANNEL_CMD, 2000, channelNumber, pageNumber, unsolEvent);
 
   return ErrorCode;
 }
@@ -693,22 +980,7 @@ uint8_t LoRaWAN::enableUnsollicited()
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
 
-  char arguments[10];
-  char* pt_arguments;
-  pt_arguments  = &arguments[0];
-
-  strcpy(pt_arguments, SEPARATOR);
-  pt_arguments++;
-  strncat(arguments, SEPARATOR, 1);
-  pt_arguments++;
-  strncat(arguments, (char*)String(1, DEC).c_str(), 1);
-  pt_arguments++;
-  strncat(arguments, CRLF, 2);
-  pt_arguments+=2;
-
-  dataContext_->setOngoingAtCommand(MAC_READ_CHANNEL);
-
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_READ_CHANNEL, arguments, 2000);
+  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_UNSOLLICITED_CMD, 2000, true);
 
   return ErrorCode;
 }
@@ -724,13 +996,24 @@ uint8_t LoRaWAN::readAdr()
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
 
-  dataContext_->setOngoingAtCommand(MAC_READ_ADR);
-
   ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_READ_ADR, NULL, 2000);
 
   return ErrorCode;
 }
 
+/* AT+MAC=SADR,<adr> */
+const static AtCommandTemplate<AtWord<5> > MAC_SET_ADR_CMD(MAC_SET_ADR);
+/* AT+MAC=SADR,<adr>,<piggyback> */
+const static AtCommandTemplate<AtWord<5>, AtWord<5> > MAC_SET_ADR_PIGGYBACK_CMD(MAC_SET_ADR);
+/* AT+MAC=SVAR,,,<encryption> */
+const static AtCommandTemplate<AtEmpty, AtEmpty, AtFlag> MAC_SET_ENCRYPTION_CMD(MAC_SET_VAR);
+
+/* Boolean argument of the ADR commands */
+static const char* boolToWord(bool value)
+{
+  return value ? "true" : "false";
+}
+
 /**
  * Set ADR value
  * @param  MacChannel structure
@@ -742,29 +1025,19 @@ uint8_t LoRaWAN::readAdr()
 uint8_t LoRaWAN::setAdr(bool adr)
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
-  char arguments[8];
-  char* pt_arguments;
-  pt_arguments  = &arguments[0];
 
-  strcpy(pt_arguments, (char*)boolToString(adr).c_str());
-  if (boolToString(adr) == "true")
-  {
-    pt_arguments+=4;
-  }
-  else 
+  if ( (shadowFields_ & SHADOW_ADR) && (this->adr_ == adr) )
   {
-    pt_arguments+=5;
+    return NEMEUS_SUCCESS;
   }
-  strncat(pt_arguments, CRLF, 2);
-  pt_arguments++;
-
-  dataContext_->setOngoingAtCommand(MAC_SET_ADR);
 
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SET_ADR, arguments, 2000);
+  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SET_ADR_CMD, 2000, boolToWord(adr));
 
   if (ErrorCode == NEMEUS_SUCCESS)
   {
     this->adr_ = adr;
+    shadowFields_ |= SHADOW_ADR;
+    updateSnapshot();
   }
 
   return ErrorCode;
@@ -781,42 +1054,21 @@ uint8_t LoRaWAN::setAdr(bool adr)
 uint8_t LoRaWAN::setAdr(bool adr, bool piggyback)
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
-  char arguments[14];
-  char* pt_arguments;
-  pt_arguments  = &arguments[0];
-
-  strcpy(pt_arguments, (char*)boolToString(adr).c_str());
-  if (boolToString(adr) == "true")
-  {
-    pt_arguments+=4;
-  }
-  else 
-  {
-    pt_arguments+=5;
-  }
 
-  strncat(pt_arguments, SEPARATOR, 1);
-  pt_arguments++;
-  strncat(pt_arguments, (char*)boolToString(piggyback).c_str(), 5);
-  if (boolToString(adr) == "true")
-  {
-    pt_arguments+=4;
-  }
-  else 
+  if ( ((shadowFields_ & (SHADOW_ADR | SHADOW_PIGGYBACK)) == (SHADOW_ADR | SHADOW_PIGGYBACK))
+      && (this->adr_ == adr) && (this->piggyback_ == piggyback) )
   {
-    pt_arguments+=5;
+    return NEMEUS_SUCCESS;
   }
-  strncat(arguments, CRLF,2);
-  pt_arguments+=2;
-
-  dataContext_->setOngoingAtCommand(MAC_SET_ADR);
 
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SET_ADR, arguments, 2000);
+  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SET_ADR_PIGGYBACK_CMD, 2000, boolToWord(adr), boolToWord(piggyback));
 
   if (ErrorCode == NEMEUS_SUCCESS)
   {
     this->adr_ = adr;
     this->piggyback_ = piggyback;
+    shadowFields_ |= (SHADOW_ADR | SHADOW_PIGGYBACK);
+    updateSnapshot();
   }
 
   return ErrorCode;
@@ -834,32 +1086,19 @@ uint8_t LoRaWAN::setAdr(bool adr, bool piggyback)
 uint8_t LoRaWAN::setEncryption(boolean encrypt)
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
-  char arguments[6];
-  char* pt_arguments;
-  pt_arguments  = &arguments[0];
-  strcpy(pt_arguments, SEPARATOR);
-  pt_arguments++;
-  strncat(pt_arguments, SEPARATOR, 1);
-  pt_arguments++;
-  if (encrypt == true)
-  {
-    strncat(pt_arguments, (char*)String(1).c_str(), 1);
-  }
-  else
+
+  if ( (shadowFields_ & SHADOW_ENCRYPTION) && (this->encryption_ == encrypt) )
   {
-    strncat(pt_arguments, (char*)String(0).c_str(), 1);
+    return NEMEUS_SUCCESS;
   }
-  pt_arguments++;
-  strncat(pt_arguments, CRLF, 2);
-  pt_arguments+=2;
 
-  dataContext_->setOngoingAtCommand(MAC_SET_VAR);
-
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SET_VAR, arguments, 2000);
+  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SET_ENCRYPTION_CMD, 2000, encrypt);
 
   if (ErrorCode == NEMEUS_SUCCESS)
   {
     this->encryption_ = encrypt;
+    shadowFields_ |= SHADOW_ENCRYPTION;
+    updateSnapshot();
   }
 
   return ErrorCode;
@@ -876,8 +1115,6 @@ uint8_t LoRaWAN::readEncryption()
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
 
-  dataContext_->setOngoingAtCommand(MAC_READ_VAR);
-
   ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_READ_VAR, NULL, 2000);
 
   return ErrorCode;
@@ -885,48 +1122,33 @@ uint8_t LoRaWAN::readEncryption()
 
 /**
  * Read device UID
+ * @param devUID  buffer of DEVPERSO_EUI_HEX_SIZE characters
  * @return  the device UID as a string
  *         the string is empty if error occured
  */
-char* LoRaWAN::readDevUID()
+char* LoRaWAN::readDevUID(char devUID[DEVPERSO_EUI_HEX_SIZE])
 {
-  uint8_t ErrorCode = NEMEUS_ERROR;
-
-  dataContext_->setOngoingAtCommand(MAC_READ_DEVUID);
-
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_READ_DEVUID, NULL, 2000);
-
-  if (ErrorCode != NEMEUS_SUCCESS)
-  {
-    /* The device UID has been read and stored in treatAtResponse() function */
-    this->devPerso_->setOtaaPerso((char*)"", this->devPerso_->getDevPerso()->appUID, this->devPerso_->getDevPerso()->appKey);
-  }
-  return this->devPerso_->getDevPerso()->devUID;
+  this->cachePerso(DEVPERSO_DEVUID);
 
+  return this->devPerso_.getFieldAsHex(DEVPERSO_DEVUID, devUID);
 }
 
 /**
  * Read app UID
+ * @param appUID  buffer of DEVPERSO_EUI_HEX_SIZE characters
  * @return  the app UID as a string
  *         the string is empty if error occured
  */
-char* LoRaWAN::readAppUID()
+char* LoRaWAN::readAppUID(char appUID[DEVPERSO_EUI_HEX_SIZE])
 {
-  uint8_t ErrorCode = NEMEUS_ERROR;
-
-  dataContext_->setOngoingAtCommand(MAC_READ_APPUID);
-
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_READ_APPUID, NULL, 2000);
+  this->cachePerso(DEVPERSO_APPUID);
 
-  if (ErrorCode != NEMEUS_SUCCESS)
-  {
-    /* The app UID has been read and stored in treatAtResponse() function */
-    this->devPerso_->setOtaaPerso(this->devPerso_->getDevPerso()->devUID, (char*)"", this->devPerso_->getDevPerso()->appKey);
-  }
-  return this->devPerso_->getDevPerso()->appUID;
+  return this->devPerso_.getFieldAsHex(DEVPERSO_APPUID, appUID);
 }
 
 #define APPUID_SIZE 16
+/* AT+MAC=SAPPUID,<appUID> */
+const static AtCommandTemplate<AtHex<APPUID_SIZE> > MAC_SET_APPUID_CMD(MAC_SET_APPUID);
 /**
  * Set the app UID value
  * @return  the error code
@@ -938,21 +1160,13 @@ uint8_t LoRaWAN::setAppUID(char appUID[APPUID_SIZE])
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
 
-  char arguments[18];
-  char* pt_arguments;
-  pt_arguments  = &arguments[0];
-
-  strcpy(pt_arguments, (char*)appUID);
-  pt_arguments+=8;
-  strncat(pt_arguments, CRLF, 2);
-
-  dataContext_->setOngoingAtCommand(MAC_SET_APPUID);
-
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SET_APPUID, arguments, 2000);
+  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SET_APPUID_CMD, 2000, appUID);
 
   if (ErrorCode == NEMEUS_SUCCESS)
   {
-    this->devPerso_->setOtaaPerso(this->devPerso_->getDevPerso()->devUID, appUID, this->devPerso_->getDevPerso()->appKey);
+    this->devPerso_.setField(DEVPERSO_APPUID, appUID);
+    /* Next ON() enables MAC with the new personalization */
+    shadowFields_ &= ~SHADOW_CLASS;
   }
 
   return ErrorCode;
@@ -960,27 +1174,20 @@ uint8_t LoRaWAN::setAppUID(char appUID[APPUID_SIZE])
 
 /**
  * Read app Key
+ * @param appKey  buffer of DEVPERSO_KEY_HEX_SIZE characters
  * @return  the app Key as a string
  *         the string is empty if error occured
  */
-char* LoRaWAN::readAppKey()
+char* LoRaWAN::readAppKey(char appKey[DEVPERSO_KEY_HEX_SIZE])
 {
-  uint8_t ErrorCode = NEMEUS_ERROR;
-
-  dataContext_->setOngoingAtCommand(MAC_READ_APPKEY);
-
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_READ_APPKEY, NULL, 2000);
-
-  if (ErrorCode != NEMEUS_SUCCESS)
-  {
-    /* The app key has been read and stored in treatAtResponse() function */
-    this->devPerso_->setOtaaPerso(this->devPerso_->getDevPerso()->devUID, this->devPerso_->getDevPerso()->appUID, (char*)"");
-  }
+  this->cachePerso(DEVPERSO_APPKEY);
 
-  return this->devPerso_->getDevPerso()->appKey;
+  return this->devPerso_.getFieldAsHex(DEVPERSO_APPKEY, appKey);
 }
 
 #define APPKEY_SIZE 32
+/* AT+MAC=SAPPKEY,<appKey> */
+const static AtCommandTemplate<AtHex<APPKEY_SIZE> > MAC_SET_APPKEY_CMD(MAC_SET_APPKEY);
 /**
  * Set the app Key value
  * @return  the error code
@@ -992,20 +1199,13 @@ uint8_t LoRaWAN::setAppKey(char appKey[APPKEY_SIZE])
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
 
-  char arguments[34];
-  char* pt_arguments;
-  pt_arguments  = &arguments[0];
-  strcpy(pt_arguments, appKey);
-  pt_arguments+=32;
-  strncat(pt_arguments, CRLF, 2);
-
-  dataContext_->setOngoingAtCommand(MAC_SET_APPKEY);
-
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SET_APPKEY, arguments, 2000);
+  ErrorCode = NemeusUART::getInstance()->sendATCommand(MAC_SET_APPKEY_CMD, 2000, appKey);
 
   if (ErrorCode == NEMEUS_SUCCESS)
   {
-    this->devPerso_->setOtaaPerso(this->devPerso_->getDevPerso()->devUID, this->devPerso_->getDevPerso()->appUID, appKey);
+    this->devPerso_.setField(DEVPERSO_APPKEY, appKey);
+    /* Next ON() enables MAC with the new personalization */
+    shadowFields_ &= ~SHADOW_CLASS;
   }
 
   return ErrorCode;
@@ -1028,194 +1228,149 @@ void LoRaWAN::onReceiveFromUART(const char * buffer)
 void LoRaWAN::treatAtResponse(const char * buffer)
 {
   uint8_t index;
+  uint8_t statusIndex;
   String stringBuffer = String(buffer);
-
+  const AtRequest* request = NemeusUART::getInstance()->getRespondedRequest();
 
   /* Filter AT response to get some parameters before forwarding to sketch */
   if (strncmp(buffer,  PREFIX_MAC_RESPONSE, strlen(PREFIX_MAC_RESPONSE)) == 0)
   {
-
-    if (!unsollicitedResponse(buffer))
+    if (request == NULL)
     {
-      /* Do some work */
-      if (dataContext_->getOngoingAtCommand() == MAC_ON)
-      {
-
-      }
-      else if (dataContext_->getOngoingAtCommand() == MAC_OFF)
-      {
-
-      }
-      else if (dataContext_->getOngoingAtCommand() == MAC_READ_ADR)
-      {
-        index = stringBuffer.indexOf(COLON)+2;
-        this->adr_ = stringToBoolean(getParameterAsString(stringBuffer, index));
-
-        index = stringBuffer.indexOf(SEPARATOR, index)+1;
-        this->piggyback_ = stringToBoolean(getParameterAsString(stringBuffer, index));
-      }
-      else if (dataContext_->getOngoingAtCommand() == MAC_READ_CHANNEL)
-      {
-
-      }
-      else if (dataContext_->getOngoingAtCommand() == MAC_READ_DATA_RATE)
-      {
-        parseMacReadDataRate(stringBuffer);
-      }
-      else if (dataContext_->getOngoingAtCommand() == MAC_SEND)
-      {
-
-      }
-      else if (dataContext_->getOngoingAtCommand() == MAC_SET_ADR)
-      {
-
-      }
-      else if (dataContext_->getOngoingAtCommand() == MAC_SET_CHANNEL)
-      {
-
-      }
-      else if (dataContext_->getOngoingAtCommand() == MAC_SET_DATA_RATE)
-      {
-
-      }
-      else if (dataContext_->getOngoingAtCommand() == MAC_STATUS)
-      {
-        /* Position index at begin of parameters */
-        index = stringBuffer.indexOf(COLON)+2;
-        if ((getParameterAsString(stringBuffer, index).equals("ON") )
-            || (getParameterAsString(stringBuffer, index).equals("DUAL") ))
-        {
-          loraWANstate_ = true;
-        }
-        else
-        {
-          loraWANstate_ = false;
-        }
-        index = stringBuffer.indexOf(SEPARATOR, index)+1;
-        /* skip version */
-        index = stringBuffer.indexOf(SEPARATOR, index)+1;
-        /* skip class */
-        index = stringBuffer.indexOf(SEPARATOR, index)+1;
-        /* skip nb pages */
-        index = stringBuffer.indexOf(SEPARATOR, index)+1;
-        /* skip ISM band */
-        index = stringBuffer.indexOf(SEPARATOR, index)+1;
-        if (getParameterAsString(stringBuffer, index).toInt() == 1)
-        {
-          this->otaa_ = true;
-        }
-        else
-        {
-          this->otaa_ = false;
-        }
-      }
-      else if (dataContext_->getOngoingAtCommand() == MAC_READ_VAR)
-      {
-        /* Position index at begin of parameters */
-        index = stringBuffer.indexOf(COLON)+2;
-        /* Skip the first 3 parameters */
-        /* txcounter */
-        /* Read tx counter */
-        index = stringBuffer.indexOf(SEPARATOR, index)+1;
-        /* rxcounter */
-        /* Read rx counter */
-        index = stringBuffer.indexOf(SEPARATOR, index)+1;
-        /* aggregateddc */
-        /* Read aggr */
-        index = stringBuffer.indexOf(SEPARATOR, index)+1;
-        /* encryption */
-        if (getParameterAsString(stringBuffer, index).toInt() == 1)
-        {
-          this->encryption_ = true;
-        } 
-        else
-        {
-          this->encryption_ = false;
-        }
-
-      }
-      else if (dataContext_->getOngoingAtCommand() == MAC_READ_DEVUID)
-      {
-        static char parameterDEVUID[17];
-
-        /* Position index at begin of parameters */
-        index = stringBuffer.indexOf(COLON)+2;
-
-        strcpy(parameterDEVUID , (char*)getParameterAsString(stringBuffer, index).c_str());  
-
-        this->devPerso_->setOtaaPerso(parameterDEVUID, this->devPerso_->getDevPerso()->appUID, this->devPerso_->getDevPerso()->appKey);
-
-      }
-
-      else if (dataContext_->getOngoingAtCommand() == MAC_READ_APPUID)
-      {
-        static char parameterAPPUID[17];
-
-        /* Position index at begin of parameters */
-        index = stringBuffer.indexOf(COLON)+2;
-
-        strcpy(parameterAPPUID, (char*)getParameterAsString(stringBuffer, index).c_str());
-
-        this->devPerso_->setOtaaPerso(this->devPerso_->getDevPerso()->devUID,parameterAPPUID, this->devPerso_->getDevPerso()->appKey);
-
-      }
-      else if (dataContext_->getOngoingAtCommand() == MAC_READ_APPKEY)
-      {
-        static char parameterAPPKEY[33];
-
-        /* Position index at begin of parameters */
-        index = stringBuffer.indexOf(COLON)+2;
-
-        strcpy(parameterAPPKEY,(char*)getParameterAsString(stringBuffer, index).c_str());
-
-        this->devPerso_->setOtaaPerso(this->devPerso_->getDevPerso()->devUID, this->devPerso_->getDevPerso()->appUID, parameterAPPKEY);
-      }
-      else if (dataContext_->getOngoingAtCommand() == MAC_READ_DEVADDR)
-      {
-        static char parameterDEVADDR[9];
-        /* Position index at begin of parameters */
-        index = stringBuffer.indexOf(COLON)+2;
-
-        strcpy(parameterDEVADDR, (char*)getParameterAsString(stringBuffer, index).c_str());
-
-        this->devPerso_->setAbpPerso(parameterDEVADDR, this->devPerso_->getDevPerso()->nwkSKey, this->devPerso_->getDevPerso()->appSKey);
-        index = stringBuffer.indexOf(SEPARATOR, index)+1;
-        /* Network ID */
-        getParameterAsString(stringBuffer, index);
-      }
-      else if (dataContext_->getOngoingAtCommand() == MAC_READ_APPSKEY)
-      {
-        static char parameterAPPSKEY[33];
-        /* Position index at begin of parameters */
-        index = stringBuffer.indexOf(COLON)+2;
-
-        strcpy(parameterAPPSKEY, (char*)getParameterAsString(stringBuffer, index).c_str());
-
-        this->devPerso_->setAbpPerso(this->devPerso_->getDevPerso()->devAddr, this->devPerso_->getDevPerso()->nwkSKey, parameterAPPSKEY);
-      }
-      else if (dataContext_->getOngoingAtCommand() == MAC_READ_NWKSKEY)
+      /* Unsollicited, never taken as the response of the command in flight */
+      unsollicitedResponse(buffer);
+    }
+    else
+    {
+      /* Response matched to the request in flight */
+      switch (request->getCommand().getCode())
       {
-        static char parameterNWKSKEY[33];
-        /* Position index at begin of parameters */
-        index = stringBuffer.indexOf(COLON)+2;
-
-        strcpy(parameterNWKSKEY, (char*)getParameterAsString(stringBuffer, index).c_str());
-
-        this->devPerso_->setAbpPerso(this->devPerso_->getDevPerso()->devAddr, parameterNWKSKEY, this->devPerso_->getDevPerso()->appSKey);
+        case AT_CMD_MAC_READ_ADR:
+          index = stringBuffer.indexOf(COLON)+2;
+          this->adr_ = stringToBoolean(getParameterAsString(stringBuffer, index));
+
+          index = stringBuffer.indexOf(SEPARATOR, index)+1;
+          this->piggyback_ = stringToBoolean(getParameterAsString(stringBuffer, index));
+          shadowFields_ |= (SHADOW_ADR | SHADOW_PIGGYBACK);
+          break;
+        case AT_CMD_MAC_READ_CHANNEL:
+          parseMacChannel(stringBuffer);
+          break;
+        case AT_CMD_MAC_READ_DATA_RATE:
+          parseMacReadDataRate(stringBuffer);
+          break;
+        case AT_CMD_MAC_STATUS:
+          /* Position index at begin of parameters */
+          index = stringBuffer.indexOf(COLON)+2;
+          if ((getParameterAsString(stringBuffer, index).equals("ON") )
+              || (getParameterAsString(stringBuffer, index).equals("DUAL") ))
+          {
+            loraWANstate_ = true;
+          }
+          else
+          {
+            loraWANstate_ = false;
+          }
+          index = stringBuffer.indexOf(SEPARATOR, index)+1;
+          statusIndex = index;
+          /* skip version */
+          index = stringBuffer.indexOf(SEPARATOR, index)+1;
+          /* class */
+          this->macClass_ = stringBuffer.charAt(index);
+          index = stringBuffer.indexOf(SEPARATOR, index)+1;
+          /* skip nb pages */
+          index = stringBuffer.indexOf(SEPARATOR, index)+1;
+          /* skip ISM band */
+          index = stringBuffer.indexOf(SEPARATOR, index)+1;
+          /* Version, class, nb pages and ISM band identify the configuration */
+          stringBuffer.substring(statusIndex, index-1).toCharArray(macStatus_, CONFIG_SNAPSHOT_STATUS_SIZE);
+          if (getParameterAsString(stringBuffer, index).toInt() == 1)
+          {
+            this->otaa_ = true;
+          }
+          else
+          {
+            this->otaa_ = false;
+          }
+          /* Class and activation mode of the enabled MAC */
+          this->macOtaa_ = this->otaa_;
+          if (loraWANstate_)
+          {
+            shadowFields_ |= SHADOW_CLASS;
+          }
+          else
+          {
+            shadowFields_ &= ~SHADOW_CLASS;
+          }
+          break;
+        case AT_CMD_MAC_READ_VAR:
+          /* Position index at begin of parameters */
+          index = stringBuffer.indexOf(COLON)+2;
+          /* Skip the first 3 parameters */
+          /* txcounter */
+          /* Read tx counter */
+          index = stringBuffer.indexOf(SEPARATOR, index)+1;
+          /* rxcounter */
+          /* Read rx counter */
+          index = stringBuffer.indexOf(SEPARATOR, index)+1;
+          /* aggregateddc */
+          /* Read aggr */
+          index = stringBuffer.indexOf(SEPARATOR, index)+1;
+          /* encryption */
+          if (getParameterAsString(stringBuffer, index).toInt() == 1)
+          {
+            this->encryption_ = true;
+          } 
+          else
+          {
+            this->encryption_ = false;
+          }
+          shadowFields_ |= SHADOW_ENCRYPTION;
+          break;
+        case AT_CMD_MAC_READ_DEVUID:
+          /* Position index at begin of parameters */
+          index = stringBuffer.indexOf(COLON)+2;
+
+          this->devPerso_.setField(DEVPERSO_DEVUID, getParameterAsString(stringBuffer, index).c_str());
+          break;
+        case AT_CMD_MAC_READ_APPUID:
+          /* Position index at begin of parameters */
+          index = stringBuffer.indexOf(COLON)+2;
+
+          this->devPerso_.setField(DEVPERSO_APPUID, getParameterAsString(stringBuffer, index).c_str());
+          break;
+        case AT_CMD_MAC_READ_APPKEY:
+          /* Position index at begin of parameters */
+          index = stringBuffer.indexOf(COLON)+2;
+
+          this->devPerso_.setField(DEVPERSO_APPKEY, getParameterAsString(stringBuffer, index).c_str());
+          break;
+        case AT_CMD_MAC_READ_DEVADDR:
+          /* Position index at begin of parameters */
+          index = stringBuffer.indexOf(COLON)+2;
+
+          this->devPerso_.setField(DEVPERSO_DEVADDR, getParameterAsString(stringBuffer, index).c_str());
+          index = stringBuffer.indexOf(SEPARATOR, index)+1;
+          /* Network ID */
+          getParameterAsString(stringBuffer, index);
+          break;
+        case AT_CMD_MAC_READ_APPSKEY:
+          /* Position index at begin of parameters */
+          index = stringBuffer.indexOf(COLON)+2;
+
+          this->devPerso_.setField(DEVPERSO_APPSKEY, getParameterAsString(stringBuffer, index).c_str());
+          break;
+        case AT_CMD_MAC_READ_NWKSKEY:
+          /* Position index at begin of parameters */
+          index = stringBuffer.indexOf(COLON)+2;
+
+          this->devPerso_.setField(DEVPERSO_NWKSKEY, getParameterAsString(stringBuffer, index).c_str());
+          break;
+        default:
+          break;
       }
-
     }
   }
-  else if (strncmp(buffer, RSP_AT_OK, strlen(RSP_AT_OK)) == 0)
-  {
-    /* OK */
-    dataContext_->resetOngoingAtCommand();
-  }
-  else if (strncmp(buffer, RSP_AT_ERR, strlen(RSP_AT_ERR)) == 0)
-  {
-    dataContext_->resetOngoingAtCommand();
-  }  
-
 }
 
 /**
@@ -1224,11 +1379,11 @@ void LoRaWAN::treatAtResponse(const char * buffer)
  */
 boolean LoRaWAN::unsollicitedResponse(const char * buffer)
 {
-  int index = 0, i;
+  int index = 0;
   boolean unsollicitedReturn = false;
   String stringBuffer = String(buffer);
 
-  for (i=0; i< sizeof(table_LORAWAN_UNSOLLICITED)/sizeof(table_LORAWAN_UNSOLLICITED[0]); i++)
+  for (uint8_t i = 0; i < sizeof(table_LORAWAN_UNSOLLICITED)/sizeof(table_LORAWAN_UNSOLLICITED[0]); i++)
   {
     if (strncmp(buffer, table_LORAWAN_UNSOLLICITED[i], strlen(table_LORAWAN_UNSOLLICITED[i])) == 0 )
     {
@@ -1240,26 +1395,60 @@ boolean LoRaWAN::unsollicitedResponse(const char * buffer)
   if (strncmp(buffer, LORAWAN_RDEVADDR_UNSOL, strlen(LORAWAN_RDEVADDR_UNSOL)) == 0 )
   {
     /* +MAC: RDEVADDR,0870C367,010203 */
+    String devAddr;
+    String networkId;
+
     /* Position index at begin of parameters */
     index = stringBuffer.indexOf(SEPARATOR)+1;
-    static char parameterDEVADDR_UNSOL[9];
-    strcpy(parameterDEVADDR_UNSOL, getParameterAsString(stringBuffer, index).c_str());
-    this->devPerso_->setAbpPerso(parameterDEVADDR_UNSOL, this->devPerso_->getDevPerso()->nwkSKey, this->devPerso_->getDevPerso()->appSKey);
+    devAddr = getParameterAsString(stringBuffer, index);
+    this->devPerso_.setField(DEVPERSO_DEVADDR, devAddr.c_str());
     index = stringBuffer.indexOf(SEPARATOR, index)+1;
     /* Network ID */
-    getParameterAsString(stringBuffer, index);
+    networkId = getParameterAsString(stringBuffer, index);
+
+    if (EventBus::getInstance()->hasSubscriber(EVENT_DEVADDR_ASSIGNED))
+    {
+      NemeusEvent_t event;
+
+      event.type = EVENT_DEVADDR_ASSIGNED;
+      event.devAddrAssigned.devAddr = devAddr.c_str();
+      event.devAddrAssigned.networkId = networkId.c_str();
+      EventBus::getInstance()->publish(event);
+    }
   }
   else if (strncmp(buffer, LORAWAN_RDR_UNSOL, strlen(LORAWAN_RDR_UNSOL)) == 0 )
   {
     parseMacReadDataRate(stringBuffer);
   }
+  else if ( (strncmp(buffer, LORAWAN_RCH_UNSOL, strlen(LORAWAN_RCH_UNSOL)) == 0 )
+      || (strncmp(buffer, LORAWAN_SCH_UNSOL, strlen(LORAWAN_SCH_UNSOL)) == 0 ) )
+  {
+    /* Channel read, or changed by the network */
+    parseMacChannel(stringBuffer);
+  }
   else if (strncmp(buffer, LORAWAN_SEND_UNSOL, strlen(LORAWAN_SEND_UNSOL)) == 0 )
   {
-    if (dataContext_->getOngoingAtCommand() == MAC_ON)
+    const AtRequest* request = NemeusUART::getInstance()->getRequest();
+    uint32_t delay;
+
+    /* +MAC: SND,<delay> */
+    index = stringBuffer.indexOf(SEPARATOR)+1;
+    delay = getParameterAsString(stringBuffer, index).toInt();
+
+    if (EventBus::getInstance()->hasSubscriber(EVENT_SEND_SCHEDULED))
+    {
+      NemeusEvent_t event;
+
+      event.type = EVENT_SEND_SCHEDULED;
+      event.sendScheduled.technology = UPLINK_LORAWAN;
+      event.sendScheduled.delay = delay;
+      EventBus::getInstance()->publish(event);
+    }
+
+    if ( ((request != NULL) && (request->getCommand() == MAC_ON)) || (joinState_ == JOIN_REQUESTED) )
     {
       /* Manage extra time for send */
-      index = stringBuffer.indexOf(SEPARATOR)+1;
-      this->sendingDelay_ = getParameterAsString(stringBuffer, index).toInt();
+      this->sendingDelay_ = delay;
 
       if (SerialUSB)
       {
@@ -1268,44 +1457,43 @@ boolean LoRaWAN::unsollicitedResponse(const char * buffer)
       }
     }
   }
-  else if (strncmp(buffer, LORAWAN_RCVBIN_UNSOL, strlen(LORAWAN_RCVBIN_UNSOL)) ==0)
+  else if ( (strncmp(buffer, LORAWAN_RCVBIN_UNSOL, strlen(LORAWAN_RCVBIN_UNSOL)) == 0)
+      || (strncmp(buffer, LORAWAN_RCVTXT_UNSOL, strlen(LORAWAN_RCVTXT_UNSOL)) == 0) )
   {
-	/* +MAC: RCVBIN,<port>,<more>,<hex_payload>,<rssi>,<snr> */
-	/* Position index at begin of parameters */
-	index = stringBuffer.indexOf(SEPARATOR)+1;
-	static uint8_t parameterPORT_UNSOL;
-	static  bool parameterMORE_UNSOL;
-	static char parameterHEXPAYLOAD_UNSOL[512];
-	static int parameterRSSI_UNSOL;
-	static int parameterSNR_UNSOL;
+    /* +MAC: RCVBIN,<port>,<more>,<hex_payload>,<rssi>,<snr> (RCVTXT: text payload) */
+    static char payload[512];
+    NemeusEvent_t event;
+    boolean binary = (strncmp(buffer, LORAWAN_RCVBIN_UNSOL, strlen(LORAWAN_RCVBIN_UNSOL)) == 0);
+
+    /* Position index at begin of parameters */
+    index = stringBuffer.indexOf(SEPARATOR)+1;
 
-	parameterPORT_UNSOL = getParameterAsString(stringBuffer, index).toInt();
+    event.type = EVENT_DOWNLINK_RECEIVED;
+    event.downlinkReceived.port = getParameterAsString(stringBuffer, index).toInt();
     index = stringBuffer.indexOf(SEPARATOR, index)+1;
 
-	if (getParameterAsString(stringBuffer, index) == "false")
-	{
-		parameterMORE_UNSOL = 1;
-	}
-	else if (getParameterAsString(stringBuffer, index) == "true")
-	{
-		parameterMORE_UNSOL = 0;
-	}
+    event.downlinkReceived.more = (getParameterAsString(stringBuffer, index) == "true");
     index = stringBuffer.indexOf(SEPARATOR, index)+1;
 
-	strncpy(parameterHEXPAYLOAD_UNSOL, getParameterAsString(stringBuffer, index).c_str(), 512);
-	index = stringBuffer.indexOf(SEPARATOR, index)+1;
+    strncpy(payload, getParameterAsString(stringBuffer, index).c_str(), sizeof(payload) - 1);
+    payload[sizeof(payload) - 1] = '\0';
+    event.downlinkReceived.payload = payload;
+    event.downlinkReceived.binary = binary;
+    index = stringBuffer.indexOf(SEPARATOR, index)+1;
 
-	parameterRSSI_UNSOL = getParameterAsString(stringBuffer, index).toInt();
-	index = stringBuffer.indexOf(SEPARATOR, index)+1;
+    event.downlinkReceived.rssi = getParameterAsString(stringBuffer, index).toInt();
+    index = stringBuffer.indexOf(SEPARATOR, index)+1;
 
-	parameterSNR_UNSOL = getParameterAsString(stringBuffer, index).toInt();
+    event.downlinkReceived.snr = getParameterAsString(stringBuffer, index).toInt();
 
-	if(onReceiveDownlink != NULL)
-	{
-		onReceiveDownlink(parameterPORT_UNSOL, parameterMORE_UNSOL, parameterHEXPAYLOAD_UNSOL, parameterRSSI_UNSOL, parameterSNR_UNSOL);
+    /* Parsed once, given to the downlink callback (binary only) and to the subscribers */
+    if ( (binary) && (onReceiveDownlink != NULL) )
+    {
+      onReceiveDownlink(event.downlinkReceived.port, event.downlinkReceived.more, payload,
+                        event.downlinkReceived.rssi, event.downlinkReceived.snr);
     }
-
-}
+    EventBus::getInstance()->publish(event);
+  }
 
   return unsollicitedReturn;
 }
@@ -1318,7 +1506,8 @@ boolean LoRaWAN::unsollicitedResponse(const char * buffer)
 void LoRaWAN::parseMacReadDataRate(String stringBuffer)
 {
   int index = 0;
-  uint8_t ErrorCode = NEMEUS_ERROR;
+  String parameter;
+  MacDataRate macDataRate;
 
   /* Get index (first parameter) */
   if (stringBuffer.startsWith(LORAWAN_RDR_UNSOL)) 
@@ -1330,24 +1519,154 @@ void LoRaWAN::parseMacReadDataRate(String stringBuffer)
     index = stringBuffer.indexOf(COLON)+2;
   }
 
-  macDataRate_->setDataRate(getParameterAsString(stringBuffer, index));
+  parameter = getParameterAsString(stringBuffer, index);
+  macDataRate.setDataRate(parameter.c_str());
+
   /* Power */
   index = stringBuffer.indexOf(SEPARATOR, index)+1;
-  macDataRate_->setTxPower((uint8_t)getParameterAsString(stringBuffer, index).toInt());
+  parameter = getParameterAsString(stringBuffer, index);
+  if (parameter.length() != 0)
+  {
+    macDataRate.setTxPower((uint8_t)parameter.toInt());
+  }
 
-  /* Channel Mask */
+  /* Channel Mask (hexadecimal) */
   index = stringBuffer.indexOf(SEPARATOR, index)+1;
-  macDataRate_->setChannelMask(getParameterAsString(stringBuffer, index));
+  parameter = getParameterAsString(stringBuffer, index);
+  if (parameter.length() != 0)
+  {
+    macDataRate.setChannelMask((uint16_t)strtoul(parameter.c_str(), NULL, 16));
+  }
 
   /* Channel Mask Ctrl */
   index = stringBuffer.indexOf(SEPARATOR, index)+1;
-  macDataRate_->setChannelMaskCtrl(getParameterAsString(stringBuffer, index));
+  parameter = getParameterAsString(stringBuffer, index);
+  if (parameter.length() != 0)
+  {
+    macDataRate.setChannelMaskCtrl((uint8_t)parameter.toInt());
+  }
 
   /* Nb Repetition */
   index = stringBuffer.indexOf(SEPARATOR, index)+1;
-  macDataRate_->setNbRepetition((uint8_t)getParameterAsString(stringBuffer, index).toInt());
+  parameter = getParameterAsString(stringBuffer, index);
+  if (parameter.length() != 0)
+  {
+    macDataRate.setNbRepetition((uint8_t)parameter.toInt());
+  }
+
+  if (!macDataRate.isIncludedIn(macDataRate_))
+  {
+    macDataRate_.update(macDataRate);
+
+    if (EventBus::getInstance()->hasSubscriber(EVENT_DATA_RATE_CHANGED))
+    {
+      NemeusEvent_t event;
+
+      event.type = EVENT_DATA_RATE_CHANGED;
+      event.dataRateChanged.dataRate = &macDataRate_;
+      EventBus::getInstance()->publish(event);
+    }
+  }
+}
+
+/**
+ * Parse a channel definition (AT+MAC= RCH response, RCH and SCH unsollicited)
+ * +MAC: <channel>,<frequency>,<min DR>,<max DR>,<duty cycle>,<page>
+ * @param  buffer  the response
+ */
+void LoRaWAN::parseMacChannel(String stringBuffer)
+{
+  int index = 0;
+  String parameter;
+  MacChannel macChannel;
+  uint8_t channelNumber;
+
+  /* Get index (first parameter) */
+  if ( (stringBuffer.startsWith(LORAWAN_RCH_UNSOL)) || (stringBuffer.startsWith(LORAWAN_SCH_UNSOL)) )
+  {
+    index = stringBuffer.indexOf(SEPARATOR)+1;
+  }
+  else
+  {
+    index = stringBuffer.indexOf(COLON)+2;
+  }
 
+  parameter = getParameterAsString(stringBuffer, index);
+  if ( (parameter.length() == 0) || (!isDigit(parameter.charAt(0))) )
+  {
+    return;
+  }
+  channelNumber = (uint8_t)parameter.toInt();
+
+  /* Frequency */
+  index = stringBuffer.indexOf(SEPARATOR, index);
+  parameter = getParameterAsString(stringBuffer, (index == -1) ? -1 : index+1);
+  if (parameter.length() != 0)
+  {
+    macChannel.setFrequency((uint32_t)parameter.toInt());
+  }
+
+  /* Min Data Rate */
+  index = (index == -1) ? -1 : stringBuffer.indexOf(SEPARATOR, index+1);
+  parameter = getParameterAsString(stringBuffer, (index == -1) ? -1 : index+1);
+  if (parameter.length() != 0)
+  {
+    macChannel.setMinDataRate(parameter.c_str());
+  }
+
+  /* Max Data Rate */
+  index = (index == -1) ? -1 : stringBuffer.indexOf(SEPARATOR, index+1);
+  parameter = getParameterAsString(stringBuffer, (index == -1) ? -1 : index+1);
+  if (parameter.length() != 0)
+  {
+    macChannel.setMaxDataRate(parameter.c_str());
+  }
+
+  /* Duty cycle */
+  index = (index == -1) ? -1 : stringBuffer.indexOf(SEPARATOR, index+1);
+  parameter = getParameterAsString(stringBuffer, (index == -1) ? -1 : index+1);
+  if (parameter.length() != 0)
+  {
+    macChannel.setDutyCycle((uint8_t)parameter.toInt());
+  }
+
+  /* Page, the definition is useless without it */
+  index = (index == -1) ? -1 : stringBuffer.indexOf(SEPARATOR, index+1);
+  parameter = getParameterAsString(stringBuffer, (index == -1) ? -1 : index+1);
+  if (parameter.length() == 0)
+  {
+    return;
+  }
+  macChannel.setChannelNumber(channelNumber, (uint8_t)parameter.toInt());
+
+  channelShadow_.update(macChannel);
+}
+
+/**
+ * Forget the MAC settings held by the module. To call when the module is reset
+ * or configured without this library, the next setters send their commands.
+ */
+void LoRaWAN::invalidateShadow()
+{
+  shadowFields_ = 0;
+  macDataRate_.clear();
+  channelShadow_.invalidate();
+}
 
+/**
+ * Register a callback for join progress (join request sent or delayed, retry scheduled)
+ */
+void LoRaWAN::register_join_progress_callback(void (*onJoinProgress)(uint8_t state, uint8_t attempt, uint32_t delay))
+{
+  this->onJoinProgress = onJoinProgress;
+}
+
+/**
+ * Register a callback for join completion (joined or failed)
+ */
+void LoRaWAN::register_join_callback(void (*onJoinDone)(uint8_t errorCode, uint32_t duration))
+{
+  this->onJoinDone = onJoinDone;
 }
 
 /**
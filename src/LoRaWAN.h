@@ -30,8 +30,10 @@
 #include "Arduino.h"
 #include "Singleton.h"
 #include "Data/DevPerso.h"
+#include "Data/ConfigSnapshot.h"
 #include "Data/MacDataRate.h"
 #include "Data/MacChannel.h"
+#include "Data/MacChannelShadow.h"
 
 /**
  * Enumeration for send Mode (Binary or Text)
@@ -68,6 +70,40 @@ const char LORAWAN_RRX_UNSOL[] = 			"+MAC: RRX,";
 const char LORAWAN_RVAR_UNSOL[] = 			"+MAC: RVAR,";
 const char LORAWAN_RDEVADDR_UNSOL[] =	 	"+MAC: RDEVADDR,";
 
+/**
+ * OTAA join state
+ */
+enum JOIN_STATE
+{
+  JOIN_IDLE      = 0,
+  JOIN_BACKOFF   = 1,   // Waiting before the next join request
+  JOIN_REQUESTED = 2,   // Join request sent, waiting for the device address
+  JOIN_JOINED    = 3,
+  JOIN_FAILED    = 4
+};
+
+/**
+ * MAC settings known to be held by the module (bitmask). Setters don't send
+ * anything when the module already holds the value.
+ */
+enum LORAWAN_SHADOW_FIELD
+{
+  SHADOW_ADR        = 0x01,
+  SHADOW_PIGGYBACK  = 0x02,
+  SHADOW_ENCRYPTION = 0x04,
+  SHADOW_CLASS      = 0x08    // MAC enabled, class and activation mode known
+};
+
+/* Time for the join accept after the join request (RX2 window at 6 s) */
+#define LORAWAN_JOIN_ATTEMPT_TIMEOUT 8000
+/* Join requests before the join fails */
+#define LORAWAN_JOIN_MAX_ATTEMPTS 8
+/* Backoff before the second attempt, doubled on each failure */
+#define LORAWAN_JOIN_BACKOFF_BASE 5000
+#define LORAWAN_JOIN_BACKOFF_MAX 300000
+/* Maximum time spent in processJoin() waiting for the module */
+#define LORAWAN_JOIN_POLL_PERIOD 50
+
 /**
  * Table of unsollicited for LoRaWAN
  */
@@ -94,6 +130,7 @@ const char* const table_LORAWAN_UNSOLLICITED[] =
 class LoRaWAN : public Singleton<LoRaWAN>
 {
   friend class Singleton<LoRaWAN>;
+  friend class NemeusUART;
 
   public:
   /* Start LoRaWAN */
@@ -104,30 +141,63 @@ class LoRaWAN : public Singleton<LoRaWAN>
   uint8_t sendFrame(uint8_t mode, uint8_t repetition, uint8_t macPort, const char* payload, boolean ack, boolean encrypt);
   /* Get the maximum payload size according to Data Rate */
   uint8_t getMaximumPayloadSize();
+  /* Maximum payload size of the data rate known, no command sent (0 if unknown) */
+  uint8_t getKnownMaximumPayloadSize();
+  /* Start an OTAA join, run by processJoin() */
+  uint8_t startJoin(char loraClass);
+  /* Run the join state machine, to be called from the sketch loop */
+  uint8_t processJoin();
+  /* Get the join state */
+  uint8_t getJoinState();
+  /* Get the time in ms of the last join */
+  uint32_t getJoinDuration();
+  /* Set ADR (and piggyback), no command sent if unchanged */
+  uint8_t setAdr(bool adr);
+  uint8_t setAdr(bool adr, bool piggyback);
+  /* Set the data rate fields present, no command sent if unchanged */
+  uint8_t setDataRate(const MacDataRate& macDataRate);
+  /* Set a channel definition, no command sent if unchanged */
+  uint8_t setChannel(const MacChannel& macChannel);
+  /* Read a channel definition */
+  uint8_t readChannel(uint8_t channelNumber, uint8_t pageNumber, bool unsolEvent);
+  /* Set payload encryption, no command sent if unchanged */
+  uint8_t setEncryption(boolean encrypt);
+  /* Forget the MAC settings held by the module (module reset) */
+  void invalidateShadow();
   /* Read OTAA status */
   boolean isOtaa();
+  /* Read LoRaWAN state (MAC enabled) */
+  boolean isOn();
+  /* Get the time on air in ms of a frame according to Data Rate */
+  uint32_t getTimeOnAir(uint8_t payloadSize);
+  /* Read functions write the hexadecimal value in the buffer given
+     (DEVPERSO_*_HEX_SIZE) and return it, values are cached in binary and
+     read from the module only once */
   /* Read the device UID */
-  char* readDevUID();
+  char* readDevUID(char devUID[DEVPERSO_EUI_HEX_SIZE]);
   /* Read the App UID */
-  char* readAppUID();
+  char* readAppUID(char appUID[DEVPERSO_EUI_HEX_SIZE]);
   /* Set the App UID */
   uint8_t setAppUID(char appUID[16]);
   /* Read the App Key */
-  char* readAppKey();
+  char* readAppKey(char appKey[DEVPERSO_KEY_HEX_SIZE]);
   /* Set the App Key */
   uint8_t setAppKey(char appKey[32]);
   /* Read the App Security Key */
-  char* readAppSKey();
+  char* readAppSKey(char appSKey[DEVPERSO_KEY_HEX_SIZE]);
   /* Read the Network Security Key */
-  char* readNwkSKey();
+  char* readNwkSKey(char nwkSKey[DEVPERSO_KEY_HEX_SIZE]);
   /* Read the device address*/
-  char* readDevAddr();
+  char* readDevAddr(char devAddr[DEVPERSO_DEVADDR_HEX_SIZE]);
   /* Set the device Address*/
   uint8_t setDevAddr(char DevADDR[8]);
-  /* Read device perso */
+  /* Read device perso (binary values) */
   DevPerso_t* readDevPerso();
   /* Get ABP perso */
   DevPerso_t* readAbpPerso();
+  // Register callbacks for join progress and completion
+  void register_join_progress_callback(void (*onJoinProgress)(uint8_t state, uint8_t attempt, uint32_t delay));
+  void register_join_callback(void (*onJoinDone)(uint8_t errorCode, uint32_t duration));
   // Register a callback for downlink frame
   void register_downlink_callback(void (*onReceiveDownlink)(uint8_t port , boolean more, const char * hexaPayload, int rssi, int snr));
   protected:
@@ -138,36 +208,55 @@ class LoRaWAN : public Singleton<LoRaWAN>
   /* Destructor */
   ~LoRaWAN();
   /* Data context */
-  DataContext * dataContext_;
   boolean otaa_;
   boolean adr_;
   boolean piggyback_;
   boolean encryption_;
   uint8_t macPort_;
   boolean loraWANstate_;
-  MacDataRate* macDataRate_;
-  DevPerso* devPerso_;
-  MacChannel* macChannel_;
-  NemeusTimer* otaaTimer_;
+  MacDataRate macDataRate_;
+  DevPerso devPerso_;
+  ConfigSnapshot configSnapshot_;
+  /* MAC status fields identifying the module configuration */
+  char macStatus_[CONFIG_SNAPSHOT_STATUS_SIZE];
+  /* Shadow of the module settings: LORAWAN_SHADOW_FIELD bitmask of known
+     values, macDataRate_ fields present and channel definitions */
+  uint8_t shadowFields_;
+  char macClass_;
+  boolean macOtaa_;
+  MacChannelShadow channelShadow_;
   uint32_t sendingDelay_;
+  uint8_t joinState_;
+  char joinClass_;
+  uint8_t joinAttempt_;
+  uint32_t joinTime_;
+  uint32_t joinStartTime_;
+  uint32_t joinDuration_;
   static void onReceiveFromUART(const char * buffer);
   boolean readMacStatus();
+  void cachePerso(uint8_t fields);
+  boolean restoreSnapshot();
+  uint8_t prepareMac();
+  uint8_t enableMac(char loraClass, boolean otaa);
+  void scheduleJoinRetry();
+  void seedJoinJitter();
+  void notifyJoinProgress(uint32_t delay);
+  void saveSnapshot();
+  void updateSnapshot();
   uint8_t readAdr();
-  uint8_t setAdr(bool adr);
-  uint8_t setAdr(bool adr, bool piggyback);
   uint8_t readDataRate();
-  uint8_t setDataRate(MacDataRate_t* macDataRate);
-  uint8_t readChannel();
-  uint8_t readChannel(uint8_t channelNumber, uint8_t pageNumber, bool unsolEvent);
   uint8_t enableUnsollicited();
-  uint8_t setChannel(MacChannel macChannel);
-  uint8_t setEncryption(boolean encrypt);
   uint8_t readEncryption();
+  uint8_t formatFrame(ArgumentWriter& arguments, uint8_t mode, uint8_t repetition, uint8_t macPort, const char* payload, boolean ack);
   void parseMacReadDataRate(String buffer);
-  long deviceAddressToLong(String deviceAddr);
+  void parseMacChannel(String buffer);
   boolean unsollicitedResponse(const char * buffer);
   void (*onReceiveDownlink)(uint8_t port , boolean more, const char * hexaPayload, int rssi, int snr);
+  void (*onJoinProgress)(uint8_t state, uint8_t attempt, uint32_t delay);
+  void (*onJoinDone)(uint8_t errorCode, uint32_t duration);
 
 };
 
+template <> LoRaWAN Singleton<LoRaWAN>::_singleton;
+
 #endif // LORAWAN_H
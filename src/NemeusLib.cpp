@@ -24,14 +24,6 @@
  
 #include "NemeusLib.h"
 
-/**
- * Constructor NemeusLib
- */
-NemeusLib::NemeusLib()
-{
-  onReceiveSketchCbk = NULL;
-}
-
 /**
  * Get access to LoRaWAN instance
  * @return  LoRaWAN object unique instance
@@ -59,6 +51,51 @@ Radio* NemeusLib::radio()
   return Radio::getInstance();
 }
 
+/**
+ * Get access to uplink scheduler instance
+ * @return  UplinkScheduler object unique instance
+ */
+UplinkScheduler* NemeusLib::scheduler()
+{
+  return UplinkScheduler::getInstance();
+}
+
+/**
+ * Get access to event bus instance
+ * @return  EventBus object unique instance
+ */
+EventBus* NemeusLib::events()
+{
+  return EventBus::getInstance();
+}
+
+/**
+ * Get access to UART recorder instance
+ * @return  UartRecorder object unique instance
+ */
+UartRecorder* NemeusLib::recorder()
+{
+  return UartRecorder::getInstance();
+}
+
+/**
+ * Get access to AT command statistics instance
+ * @return  AtStats object unique instance
+ */
+AtStats* NemeusLib::atStats()
+{
+  return AtStats::getInstance();
+}
+
+/**
+ * Get access to span tracer instance
+ * @return  SpanTracer object unique instance
+ */
+SpanTracer* NemeusLib::spans()
+{
+  return SpanTracer::getInstance();
+}
+
 /**
  * Init the UART port
  */
@@ -88,17 +125,24 @@ void NemeusLib::close()
  */
 void NemeusLib::printTraces()
 {
-  const int BUFFER_SIZE = 256;
+  /* Length fits in the uint8_t returned by readLine() */
+  const int BUFFER_SIZE = 255;
   char buffer[BUFFER_SIZE];
   int nb_bytes;
+  boolean lineStart = true;
 
   if (SerialUSB)
   {
     while (availableTraces() >0)
     {
-      SerialUSB.print("mm002 >> .");
+      /* Lines longer than the buffer (i.e records) are not cut by the prefix */
+      if (lineStart)
+      {
+        SerialUSB.print("mm002 >> .");
+      }
       nb_bytes = nemeusLib.readLine(buffer, BUFFER_SIZE);
       SerialUSB.write(buffer, nb_bytes);
+      lineStart = (nb_bytes == 0) || (buffer[nb_bytes-1] == '\n');
     }
   }
 }
@@ -182,6 +226,9 @@ uint8_t NemeusLib::resetDevice()
 
   ErrorCode = NemeusUART::getInstance()->sendATCommand(RESET_COLD, NULL, 5000);
 
+  /* Module settings are back to their defaults */
+  LoRaWAN::getInstance()->invalidateShadow();
+
   return ErrorCode;
 }
 
@@ -201,6 +248,18 @@ uint8_t NemeusLib::debugMver()
   return ErrorCode;
 }
 
+/**
+ * Send the shortest AT command (RF status), to time a round trip
+ * @return  the error code
+ *               NEMEUS_OK if response is OK
+ *               NEMEUS_ERROR if response is ERROR
+ *               NEMEUS_NO_ANSWER if no response from module
+ */
+uint8_t NemeusLib::ping()
+{
+  return NemeusUART::getInstance()->sendATCommand(RF_STATUS, NULL, 2000);
+}
+
 /**
  * Check if traces are available on UART
  * @return  the number of bytes available
@@ -265,4 +324,14 @@ uint8_t NemeusLib::pollDevice(uint32_t timeout)
   return NemeusUART::getInstance()->pollDevice(timeout);
 }
 
+/**
+ * Time each line received from the device, from its first bytes in the RX
+ * buffer to the end of its handling
+ * @param  measurement  where samples are added (bytes as units), NULL to stop
+ */
+void NemeusLib::measureLines(Measurement* measurement)
+{
+  NemeusUART::getInstance()->setLineMeasurement(measurement);
+}
+
 NemeusLib nemeusLib = NemeusLib();
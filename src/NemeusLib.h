@@ -32,28 +32,43 @@
 #include "LoRaWAN.h"
 #include "Sigfox.h"
 #include "Radio.h"
+#include "UplinkScheduler.h"
+#include "EventBus.h"
+#include "UartRecorder.h"
+#include "AtStats.h"
+#include "SpanTracer.h"
+#include "SampleAggregator.h"
 #include <Data/RadioTxParam.h>
 #include <Data/RadioRxParam.h>
 #include <Data/MacDataRate.h>
 #include <Data/MacDataRate.h>
 #include <Data/MacChannel.h>
 #include <Data/DevPerso.h>
+#include <Utils/SeriesCodec.h>
+#include <Utils/PayloadSchema.h>
+#include <Utils/Measurement.h>
 
 
 class NemeusLib
 {
   public:
     /* Constructor */
-    NemeusLib();
+    constexpr NemeusLib() : onReceiveSketchCbk(NULL) {}
     Sigfox* sigfox();     // Access to sigfox object (& methods)
     LoRaWAN* loraWan();   // Access to loraWan object (& methods)
     Radio* radio();     // Access to radio RF object (& methods)
+    UplinkScheduler* scheduler();   // Access to uplink scheduler object (& methods)
+    EventBus* events();   // Access to event bus object (subscriptions)
+    UartRecorder* recorder();   // Access to UART recorder object (field logs)
+    AtStats* atStats();   // Access to AT command statistics (NEMEUS_AT_STATS builds)
+    SpanTracer* spans();   // Access to span tracer (NEMEUS_SPANS builds)
     uint8_t init();     // Init the (UART)
     uint8_t resetModem();     // Init the (UART)
     void close();     // Close UART
     uint8_t setPowersaving(bool isOn);  // Enable/disable powersaving from device
     uint8_t setVerbose(bool isOn);  // Enable/disable verbose traces from device
     uint8_t debugMver();  // Get the version
+    uint8_t ping();       // Shortest AT round trip (RF status)
     void printTraces();       // Print traces buffer on SerialUSB
     uint8_t resetDevice();      // Reset the nemeus device
     // Register a callback for unsollicited and AT response
@@ -64,6 +79,8 @@ class NemeusLib
     uint8_t readLine(char* buffer, int size); // Read a line (ends with '\n') in buffer
     // Poll device during a period to read UART and store in internal library buffer
     uint8_t pollDevice(uint32_t timeout);
+    // Time the handling of each line received in measurement (NULL to stop)
+    void measureLines(Measurement* measurement);
   private:
     typedef void (*onReceive)(const char *);
     onReceive onReceiveSketchCbk;
@@ -24,8 +24,13 @@
  
 #include "NemeusUART.h"
 #include "Utils/Utils.h"
+#include "Utils/NemeusClock.h"
 #include "LoRaWAN.h"
 #include "Sigfox.h"
+#include "Radio.h"
+#include "UartRecorder.h"
+#include "AtStats.h"
+#include "SpanTracer.h"
 
 // Instantiate the Serial2 class
 Uart Serial2(&sercom1, PIN_SERIAL2_RX, PIN_SERIAL2_TX, PAD_SERIAL2_RX, PAD_SERIAL2_TX);
@@ -45,28 +50,26 @@ void SERCOM1_Handler()
   }
 }
 
+/* Unique instance */
+template <> NemeusUART Singleton<NemeusUART>::_singleton {};
+
 /**
  * Private constructor (Singleton concept)
  */
-NemeusUART::NemeusUART() {
-  dataContext_ = new DataContext();
-  atTimer_ = new NemeusTimer();
-  m_onReceiveFunctionList_ = NULL;
+NemeusUART::NemeusUART()
+  : request_(NULL), respondedRequest_(NULL), nextRequestId_(0), argumentWriter_(txArguments_, NEMEUS_UART_TX_ARGUMENTS_SIZE),
+    lineMeasurement_(NULL), isLineMeasured_(false) {
+  nbCallbacks_ = 0;
+  /* Intern callbacks filter AT responses before the sketch ones */
+  addCallback(LoRaWAN::onReceiveFromUART);
+  addCallback(Sigfox::onReceiveFromUART);
+  addCallback(Radio::onReceiveFromUART);
 }
 
 /**
  * Private destructor (probably never called)
  */
 NemeusUART::~NemeusUART() {
-  end();
-
-  /* Remove all calbacks */
-  while (m_onReceiveFunctionList_ != NULL)
-  {
-    CallbackElement* temp = m_onReceiveFunctionList_;
-    m_onReceiveFunctionList_ = m_onReceiveFunctionList_->next;
-    free(temp);
-  }
 }
 
 /**
@@ -90,7 +93,7 @@ uint8_t NemeusUART::begin()
   Serial2.setTimeout(1000);
 
   Serial2.write("\r\n", 2);
-  delay(2); 
+  NemeusClock::get()->delay(2); 
 
   /* Test modem response to a status AT Command */
   return sendATCommand(RF_STATUS, NULL, 5000);
@@ -120,12 +123,16 @@ uint8_t NemeusUART::reset()
   Serial2.setTimeout(1000);
 
   Serial2.write("\r\n", 2);
-  delay(2); 
+  NemeusClock::get()->delay(2); 
 
   /* Send AT command for cold reset then wait some delay (minimum ~ 500)
      to prevent others commands before reset*/
   ret = sendATCommand(RESET_COLD, NULL, 5000);
-  delay(1000);
+  NemeusClock::get()->delay(1000);
+
+  /* Module settings are back to their defaults */
+  LoRaWAN::getInstance()->invalidateShadow();
+
   return (ret);
 }
 
@@ -143,28 +150,11 @@ void NemeusUART::end()
  */
 void NemeusUART::addCallback(onReceive onReceiveFunction)
 {
-  CallbackElement* element = (CallbackElement*) malloc(sizeof(CallbackElement));
-
-  /* Create element */
-  element->callbackPtr = onReceiveFunction;
-  element->next = NULL;
-
-  /* If list doesn't exist */
-  if (m_onReceiveFunctionList_ == NULL)
+  /* Ignored if NEMEUS_UART_MAX_CALLBACKS are registered */
+  if ( (onReceiveFunction != NULL) && (nbCallbacks_ < NEMEUS_UART_MAX_CALLBACKS) )
   {
-    /* First element */
-    m_onReceiveFunctionList_ = element;
+    callbacks_[nbCallbacks_++] = onReceiveFunction;
   }
-  else
-  {
-    CallbackElement* temp = m_onReceiveFunctionList_;
-    while (temp->next != NULL)
-    {
-      temp = temp->next;
-    }
-    temp->next = element;
-  }
-
 }
 
 /**
@@ -173,31 +163,16 @@ void NemeusUART::addCallback(onReceive onReceiveFunction)
  */
 void NemeusUART::delCallback(onReceive onReceiveFunction)
 {
+  uint8_t nbKept = 0;
 
-  if (m_onReceiveFunctionList_ == NULL)
-    return;
-
-  CallbackElement* temp = m_onReceiveFunctionList_;
-  if (temp->callbackPtr == onReceiveFunction)
-  {
-    m_onReceiveFunctionList_ = temp->next;
-    free(temp);
-    return;
-  }
-
-  CallbackElement* previousElement = NULL;
-  while ( (temp->next != NULL) )
+  for (uint8_t i = 0; i < nbCallbacks_; i++)
   {
-    previousElement = temp;
-    temp = temp->next;
-    if (temp->callbackPtr == onReceiveFunction)
+    if (callbacks_[i] != onReceiveFunction)
     {
-      previousElement->next = temp->next;
-      free(temp);
-      temp = previousElement;
+      callbacks_[nbKept++] = callbacks_[i];
     }
   }
-
+  nbCallbacks_ = nbKept;
 }
 
 
@@ -206,15 +181,17 @@ void NemeusUART::delCallback(onReceive onReceiveFunction)
  */
 void NemeusUART::wakeUp()
 {
+  TraceSpan span("wake");
+
 #ifdef NEMEUS_LIB_DEBUG
   SerialUSB.println("mm002 >>>> WAKE UP!");
 #endif
   pinMode(WAKEUP_PIN, OUTPUT);
   digitalWrite(WAKEUP_PIN, HIGH);
-  delay(10);
+  NemeusClock::get()->delay(10);
   digitalWrite(WAKEUP_PIN, LOW);
   pinMode(WAKEUP_PIN, INPUT);
-  delay(100);
+  NemeusClock::get()->delay(100);
 }
 
 /**
@@ -222,17 +199,7 @@ void NemeusUART::wakeUp()
  * @return  the number of callbacks function
  */
 uint8_t NemeusUART::nbCallbacks() {
-  uint8_t nbElement =0;
-
-  CallbackElement* temp = m_onReceiveFunctionList_;
-
-  while(temp!=NULL)
-  {
-    nbElement++;
-    temp = temp->next;
-  }
-
-  return nbElement;
+  return nbCallbacks_;
 }
 
 /**
@@ -241,11 +208,11 @@ uint8_t NemeusUART::nbCallbacks() {
  */
 void NemeusUART::notifyCallbacks(const char* traces)
 {
-  CallbackElement* element = m_onReceiveFunctionList_;
-  while(element != NULL)
+  TraceSpan span("callbacks");
+
+  for (uint8_t i = 0; i < nbCallbacks_; i++)
   {
-    element->callbackPtr(traces);
-    element = element->next;
+    callbacks_[i](traces);
   }
 }
 
@@ -258,7 +225,13 @@ int NemeusUART::readLineInCircularBuffer(char* serial_buffer, int serial_buffer_
 
   if (circularBuffer.available() > 0)
   {
-    nbBytesRead = circularBuffer.readLine(serial_buffer, serial_buffer_length);
+    /* A lone CR ends the line too, a lost LF doesn't merge two lines */
+    nbBytesRead = circularBuffer.readLine(serial_buffer, serial_buffer_length, true);
+  }
+
+  if ( (nbBytesRead > 0) && (UartRecorder::getInstance()->isRecording()) )
+  {
+    UartRecorder::getInstance()->recordRx(serial_buffer, nbBytesRead);
   }
 
   return nbBytesRead;
@@ -266,15 +239,34 @@ int NemeusUART::readLineInCircularBuffer(char* serial_buffer, int serial_buffer_
 }
 
 /**
- * Decode AT response to the ongoing AT command
+ * Check if a line is an unsollicited one (may come during any command)
+ * @param line  the line received
+ * @return  true if the line begins with a known unsollicited prefix
+ */
+static boolean isUnsollicited(const char* line)
+{
+  for (uint8_t i = 0; i < sizeof(table_LORAWAN_UNSOLLICITED)/sizeof(table_LORAWAN_UNSOLLICITED[0]); i++)
+  {
+    if (strncmp(line, table_LORAWAN_UNSOLLICITED[i], strlen(table_LORAWAN_UNSOLLICITED[i])) == 0)
+    {
+      return true;
+    }
+  }
+
+  return ( (strncmp(line, SF_SEND_UNSOL, strlen(SF_SEND_UNSOL)) == 0)
+          || (strncmp(line, RADIO_RCVBIN_UNSOL, strlen(RADIO_RCVBIN_UNSOL)) == 0)
+          || (strncmp(line, RADIO_RCVTXT_UNSOL, strlen(RADIO_RCVTXT_UNSOL)) == 0) );
+}
+
+/**
+ * Decode AT response to the request in flight
  * @param traceBuffer  pointer on data
- * @param nbCharacterRead  number of read character
  * @return  the error code
  *               NEMEUS_OK if response is OK
  *               NEMEUS_ERROR if response is ERROR
  *               NEMEUS_NO_ANSWER if no response from module
  */
-uint8_t NemeusUART::manageAtCommandResponse(char* traceBuffer, uint8_t nbCharacterRead)
+uint8_t NemeusUART::manageAtCommandResponse(char* traceBuffer)
 {
   uint8_t ret = NEMEUS_NO_ANSWER;
   int index;
@@ -282,28 +274,31 @@ uint8_t NemeusUART::manageAtCommandResponse(char* traceBuffer, uint8_t nbCharact
   String stringBuffer;
 
   /* Response received */
-  if (dataContext_->getOngoingAtCommand() != NO_CMD)
+  if (request_ != NULL)
   {
     if (strncmp(traceBuffer, RSP_AT_OK, strlen(RSP_AT_OK)) == 0)
     {
       /* OK */
-      dataContext_->resetOngoingAtCommand();
+      request_->complete(NEMEUS_SUCCESS);
       ret = NEMEUS_SUCCESS;
 
+      respondedRequest_ = request_;
       notifyCallbacks("OK");
     }
     else if (strncmp(traceBuffer, RSP_AT_ERR_NOACK, strlen(RSP_AT_ERR_NOACK)) == 0)
     {
       /* ERROR NO ACK */
-      dataContext_->resetOngoingAtCommand();
+      request_->complete(NEMEUS_ERROR_NOACK);
       ret = NEMEUS_ERROR_NOACK;
+      respondedRequest_ = request_;
       notifyCallbacks("ERROR NOT ACK");
     }
     else if (strncmp(traceBuffer, RSP_AT_ERR, strlen(RSP_AT_ERR)) == 0)
     {
       /* ERROR */
-      dataContext_->resetOngoingAtCommand();
+      request_->complete(NEMEUS_ERROR);
       ret = NEMEUS_ERROR;
+      respondedRequest_ = request_;
       notifyCallbacks("ERROR");
     }
     else if (traceBuffer[0] == '+')
@@ -317,21 +312,46 @@ uint8_t NemeusUART::manageAtCommandResponse(char* traceBuffer, uint8_t nbCharact
         index = stringBuffer.indexOf(SEPARATOR)+1;
         extraTime = getParameterAsString(stringBuffer, index).toInt();
 
-        /* New Timeout with 4000 ms of margin */
+        /* New deadline with 4000 ms of margin */
         if (extraTime != 0)
         {
-          atTimer_->setTimeout(extraTime+4000);
+          request_->setDeadline(extraTime+4000);
         }
       }
 
+      /* Response only if the request expects it, an unsollicited line is never attributed */
+      if ( (!isUnsollicited(traceBuffer)) && (request_->isResponse(traceBuffer)) )
+      {
+        request_->addResponse();
+        respondedRequest_ = request_;
+      }
       notifyCallbacks(traceBuffer);
     }
+    respondedRequest_ = NULL;
   }
 
   return ret;
 
 }
 
+/**
+ * Get the request in flight
+ * @return  the request waiting for its response, NULL if none
+ */
+const AtRequest* NemeusUART::getRequest() const
+{
+  return request_;
+}
+
+/**
+ * Get the request answered by the line being notified (valid in callbacks only)
+ * @return  the request, NULL if the line is unsollicited
+ */
+const AtRequest* NemeusUART::getRespondedRequest() const
+{
+  return respondedRequest_;
+}
+
 /**
  * Send AT response and wait for response during a specified time
  * @param atCommand  At command
@@ -342,14 +362,16 @@ uint8_t NemeusUART::manageAtCommandResponse(char* traceBuffer, uint8_t nbCharact
  *               NEMEUS_ERROR if response is ERROR
  *               NEMEUS_NO_ANSWER if no response from module
  */
-uint8_t NemeusUART::sendATCommand(AtCommand atCommand, const char* arguments, uint32_t timeout)
+uint8_t NemeusUART::sendATCommand(const AtCommand& atCommand, const char* arguments, uint32_t timeout)
 {
-  char* formattedCommand;
   uint8_t returnValue = NEMEUS_NO_ANSWER;
   int commandSize = 0;
+  int argumentsSize = 0;
+  AtRequest request(atCommand, nextRequestId_++, timeout);
+  TraceSpan span(atCommand.getStringCommand());
 
-  /* Register command */
-  dataContext_->setOngoingAtCommand(atCommand);
+  /* Register the request, lines are matched against it */
+  request_ = &request;
 
   if (atCommand.getStringCommand() != NULL)
   {
@@ -362,51 +384,62 @@ uint8_t NemeusUART::sendATCommand(AtCommand atCommand, const char* arguments, ui
 
   if (arguments != NULL)
   {
-    commandSize += strlen(arguments);
+    argumentsSize = strlen(arguments);
   }
 
-  if (commandSize != 0)
+  if ( (commandSize + argumentsSize) != 0)
   {
-    formattedCommand = (char*)malloc(commandSize);
-    strcpy(formattedCommand, atCommand.getStringCommand());
-
-    if (arguments != NULL)
+    if (UartRecorder::getInstance()->isRecording())
     {
-      strcat(formattedCommand, arguments);
+      UartRecorder::getInstance()->recordTx(atCommand.getStringCommand(), commandSize, arguments, argumentsSize);
     }
 
     /* wakeup MM002 if powersaving is enabled */
+    AtStats::getInstance()->commandStarted(atCommand.getCode());
     wakeUp();
+    AtStats::getInstance()->phaseEnded(AT_STATS_WAKE);
 
-    /* Send AT command */
+    /* Send AT command then its arguments, no copy needed */
     {
+      TraceSpan txSpan("tx");
+      const char* idx = atCommand.getStringCommand();
       int remaining = commandSize;
-      char* idx = formattedCommand;
       while(remaining--)
       {
         /* add delay between chars when traces are enabled */
         Serial2.write(idx++, 1);
-        delay(1);
+        NemeusClock::get()->delay(1);
+      }
+      idx = arguments;
+      remaining = argumentsSize;
+      while(remaining--)
+      {
+        Serial2.write(idx++, 1);
+        NemeusClock::get()->delay(1);
       }
     }
+    AtStats::getInstance()->phaseEnded(AT_STATS_TX);
 
     if (SerialUSB)
     {
 #ifdef NEMEUSLIB_DEBUG
       SerialUSB.print("NemeusLib(UART)>>>> Send AT command (size = ");
-      SerialUSB.print(commandSize);
+      SerialUSB.print(commandSize + argumentsSize);
       SerialUSB.print("): ");
-      SerialUSB.print(formattedCommand);
+      SerialUSB.print(atCommand.getStringCommand());
 #else
       SerialUSB.println("");
       SerialUSB.print("mm002 << ");
-      SerialUSB.print(formattedCommand);
+      SerialUSB.print(atCommand.getStringCommand());
 #endif
+      if (arguments != NULL)
+      {
+        SerialUSB.print(arguments);
+      }
     }
 
-    returnValue = waitForAtResponse(timeout);
-
-    free(formattedCommand);
+    returnValue = waitForAtResponse(request);
+    AtStats::getInstance()->commandEnded(returnValue);
   }
   else
   {
@@ -415,39 +448,82 @@ uint8_t NemeusUART::sendATCommand(AtCommand atCommand, const char* arguments, ui
   }
 
 error_send:
-  dataContext_->resetOngoingAtCommand();
+  request_ = NULL;
 
   return returnValue;
 
 }
 
 /**
- * Wait for AT response during timeout ms
+ * Send AT command with the arguments formatted in the TX arguments buffer
+ * @param atCommand  At command
+ * @param arguments  the writer returned by newArguments()
  * @param timeout  timeout in ms to consider module doesn't answer
  * @return  the error code
  *               NEMEUS_OK if response is OK
  *               NEMEUS_ERROR if response is ERROR
  *               NEMEUS_NO_ANSWER if no response from module
+ *               NEMEUS_ARGUMENT_ERROR if arguments don't fit (nothing sent)
+ */
+uint8_t NemeusUART::sendATCommand(const AtCommand& atCommand, const ArgumentWriter& arguments, uint32_t timeout)
+{
+  if (arguments.hasOverflowed())
+  {
+    return NEMEUS_ARGUMENT_ERROR;
+  }
+
+  return sendATCommand(atCommand, arguments.c_str(), timeout);
+}
+
+/**
+ * Get the writer of the TX arguments buffer, emptied
+ * (valid until the next command is sent)
+ */
+ArgumentWriter& NemeusUART::newArguments()
+{
+  argumentWriter_.clear();
+
+  return argumentWriter_;
+}
+
+/**
+ * Wait for the response of a request until it completes or its deadline
+ * @param request  the request in flight
+ * @return  the error code
+ *               NEMEUS_OK if response is OK
+ *               NEMEUS_ERROR if response is ERROR
+ *               NEMEUS_NO_ANSWER if no response from module
  */
-uint8_t NemeusUART::waitForAtResponse(uint32_t timeout)
+uint8_t NemeusUART::waitForAtResponse(AtRequest& request)
 {
+  TraceSpan span("wait");
   char serial_buffer[TRACE_BUF_SZ];
   int serial_buffer_length;
-  bool stop = false;
-  int returnValue = NEMEUS_NO_ANSWER;
 
   memset(serial_buffer, 0, TRACE_BUF_SZ);
 
-  /* Set the timer */
-  atTimer_->setTimeout(timeout);
-
-  while( (atTimer_->isTimeout() == false) && (stop == false) )
+  while( (request.isExpired() == false) && (request.isComplete() == false) )
   {
+    /* Bytes of the answer arrived, even if its line isn't complete yet */
+    if (circularBuffer.available() > 0)
+    {
+      AtStats::getInstance()->byteReceived();
+    }
+
+    /* A line is timed from its first bytes in the RX buffer */
+    if ( (lineMeasurement_ != NULL) && (!isLineMeasured_) && (circularBuffer.available() > 0) )
+    {
+      lineMeasurement_->start();
+      isLineMeasured_ = true;
+    }
+
     /* Read a Serial line */
     serial_buffer_length = readLineInCircularBuffer(serial_buffer, TRACE_BUF_SZ);
 
     if ( (serial_buffer_length > 0) && (serial_buffer[serial_buffer_length-1] == '\n') )
     {
+      int lineLength = serial_buffer_length;
+
       /* End of line */
       if ( (serial_buffer[0] == '+')
           || ( (serial_buffer[0] == 'O') && (serial_buffer[1] == 'K') )
@@ -465,13 +541,8 @@ uint8_t NemeusUART::waitForAtResponse(uint32_t timeout)
           serial_buffer[serial_buffer_length-1] = '\0'; 
           serial_buffer_length= serial_buffer_length -1;
         }
-        returnValue = manageAtCommandResponse(serial_buffer, serial_buffer_length);
-        /* Break on OK & ERROR */
-        if (( (serial_buffer[0] == 'O') && (serial_buffer[1] == 'K') )
-            || ( (serial_buffer[0] == 'E') && (serial_buffer[1] == 'R') ) )
-        {
-          stop = true;
-        }
+        /* Completes the request on OK & ERROR */
+        manageAtCommandResponse(serial_buffer);
       }
       else
       {
@@ -481,10 +552,25 @@ uint8_t NemeusUART::waitForAtResponse(uint32_t timeout)
       /* Reset buffer */
       memset(serial_buffer, 0, serial_buffer_length);
       serial_buffer_length = 0;
+      if ( (lineMeasurement_ != NULL) && (isLineMeasured_) )
+      {
+        lineMeasurement_->stop(lineLength);
+      }
+      isLineMeasured_ = false;
+    }
+    else if (serial_buffer_length == 0)
+    {
+      /* Nothing received, the clock may skip ahead */
+      NemeusClock::get()->idle(request.getRemaining());
     }
   }
 
-  return returnValue;
+  if (request.isComplete())
+  {
+    return request.getResult();
+  }
+
+  return NEMEUS_NO_ANSWER;
 }
 
 /**
@@ -499,21 +585,30 @@ uint8_t NemeusUART::pollDevice(uint32_t timeout)
 {
   char serial_buffer[TRACE_BUF_SZ];
   int serial_buffer_length;
-  bool stop = false;
   int returnValue = NEMEUS_SUCCESS;
+  TraceSpan span("poll");
 
   memset(serial_buffer, 0, TRACE_BUF_SZ);
 
   /* This is on 32 bits. The overflow is correctly managed? No!! */
-  atTimer_->setTimeout(timeout);
+  atTimer_.setTimeout(timeout);
 
-  while(atTimer_->isTimeout() == false)
+  while(atTimer_.isTimeout() == false)
   {
+    /* A line is timed from its first bytes in the RX buffer */
+    if ( (lineMeasurement_ != NULL) && (!isLineMeasured_) && (circularBuffer.available() > 0) )
+    {
+      lineMeasurement_->start();
+      isLineMeasured_ = true;
+    }
+
     /* Read a Serial line */
     serial_buffer_length = readLineInCircularBuffer(serial_buffer, TRACE_BUF_SZ);
 
     if ( (serial_buffer_length > 0) && (serial_buffer[serial_buffer_length-1] == '\n') )
     {
+      int lineLength = serial_buffer_length;
+
       /* End of line */
       if ( (serial_buffer[0] == '+')
           || ( (serial_buffer[0] == 'O') && (serial_buffer[1] == 'K') )
@@ -540,8 +635,32 @@ uint8_t NemeusUART::pollDevice(uint32_t timeout)
       /* Reset buffer */
       memset(serial_buffer, 0, serial_buffer_length);
       serial_buffer_length = 0;
+      if ( (lineMeasurement_ != NULL) && (isLineMeasured_) )
+      {
+        lineMeasurement_->stop(lineLength);
+      }
+      isLineMeasured_ = false;
+    }
+    else if (serial_buffer_length == 0)
+    {
+      /* Nothing received, the clock may skip ahead */
+      NemeusClock::get()->idle(atTimer_.getRemaining());
     }
   }
+
+  return returnValue;
+}
+
+/**
+ * Time the lines received: from their first bytes seen in the RX buffer to
+ * the end of their handling (callbacks, trace buffer), their bytes counted
+ * as units
+ * @param measurement  where samples are added, NULL to stop
+ */
+void NemeusUART::setLineMeasurement(Measurement* measurement)
+{
+  lineMeasurement_ = measurement;
+  isLineMeasured_ = false;
 }
 
 /**
@@ -30,9 +30,12 @@
 #include "Arduino.h"
 #include "Singleton.h"
 #include "AtCommand.h"
-#include "Data/DataContext.h"
+#include "AtCommandTemplate.h"
+#include "Data/AtRequest.h"
 #include "Utils/CircBuffer.h"
 #include "Utils/NemeusTimer.h"
+#include "Utils/ArgumentWriter.h"
+#include "Utils/Measurement.h"
 
 //------------------------------------------
 // Use Serial2 for MM002
@@ -53,44 +56,86 @@ enum ERROR_CODE
   NEMEUS_ERROR_NOACK = 3,
   NEMEUS_ARGUMENT_ERROR = 4,
   NEMEUS_WARNING_PAYLOAD_TRUNACTED = 5,
+  NEMEUS_ERROR_EXPIRED = 6,
+  NEMEUS_ERROR_QUEUE_FULL = 7,
   NEMEUS_ERROR   = 255
 };
 
 #define TRACE_BUF_SZ 256
 
+/* Callbacks notified of AT responses (LoRaWAN, Sigfox, Radio and sketch ones) */
+#define NEMEUS_UART_MAX_CALLBACKS 8
+
+/* Arguments formatted in place, longest is a binary RF frame (checked at compile time) */
+#ifndef NEMEUS_UART_TX_ARGUMENTS_SIZE
+#define NEMEUS_UART_TX_ARGUMENTS_SIZE 512
+#endif
+
 
 class NemeusUART : public Singleton<NemeusUART>
 {
   friend class Singleton<NemeusUART>;
 
   typedef void (*onReceive)(const char *);
-  struct CallbackElement {
-    onReceive callbackPtr;
-    CallbackElement* next;
-  };
 
   public:
   //static NemeusUART& getInstance();
   uint8_t begin();
   uint8_t reset();
   void end();
-  uint8_t sendATCommand(AtCommand atCommand, const char* arguments, uint32_t timeout);
-  uint8_t manageAtCommandResponse(char* traceBuffer, uint8_t nbCharacterRead);
+  uint8_t sendATCommand(const AtCommand& atCommand, const char* arguments, uint32_t timeout);
+  /* Send the arguments of newArguments(), NEMEUS_ARGUMENT_ERROR if they overflowed */
+  uint8_t sendATCommand(const AtCommand& atCommand, const ArgumentWriter& arguments, uint32_t timeout);
+  /* Empty writer on the TX arguments buffer */
+  ArgumentWriter& newArguments();
+
+  /**
+   * Format the arguments of a command template in the TX arguments buffer and send it
+   * @return  the error code (NEMEUS_ARGUMENT_ERROR if a value is invalid, nothing sent)
+   */
+  template <typename... Args, typename... Values>
+  uint8_t sendATCommand(const AtCommandTemplate<Args...>& command, uint32_t timeout, Values... values)
+  {
+    static_assert(AtCommandTemplate<Args...>::MAX_LENGTH < NEMEUS_UART_TX_ARGUMENTS_SIZE,
+                  "Command arguments don't fit in the TX arguments buffer");
+    ArgumentWriter& arguments = newArguments();
+
+    if (!command.format(arguments, values...))
+    {
+      return NEMEUS_ARGUMENT_ERROR;
+    }
+
+    return sendATCommand(command.getCommand(), arguments.c_str(), timeout);
+  }
+  uint8_t manageAtCommandResponse(char* traceBuffer);
+  /* Request in flight, NULL if none */
+  const AtRequest* getRequest() const;
+  /* Request answered by the line notified to callbacks, NULL if unsolicited */
+  const AtRequest* getRespondedRequest() const;
   int availableTraces();
   int readTracesByte();
   int readTracesBuffer(char* buffer, int size);
   int readLine(char* buffer, int size);
   void addCallback(onReceive onReceiveFunction);
   void delCallback(onReceive onReceiveFunction);
-  uint8_t waitForAtResponse(uint32_t timeout);
+  uint8_t waitForAtResponse(AtRequest& request);
   uint8_t pollDevice(uint32_t timeout);
+  /* Time the reception and handling of each line received (bytes as units), NULL to stop */
+  void setLineMeasurement(Measurement* measurement);
   private:
   //static NemeusUART m_instance;
   NemeusUART();
   ~NemeusUART();
-  DataContext * dataContext_;
-  CallbackElement* m_onReceiveFunctionList_;
-  NemeusTimer* atTimer_;
+  AtRequest* request_;
+  const AtRequest* respondedRequest_;
+  uint16_t nextRequestId_;
+  onReceive callbacks_[NEMEUS_UART_MAX_CALLBACKS];
+  uint8_t nbCallbacks_;
+  NemeusTimer atTimer_;
+  char txArguments_[NEMEUS_UART_TX_ARGUMENTS_SIZE];
+  ArgumentWriter argumentWriter_;
+  Measurement* lineMeasurement_;
+  boolean isLineMeasured_;    // a line is being timed
 
   /* Methods */
   uint8_t nbCallbacks();
@@ -100,5 +145,7 @@ class NemeusUART : public Singleton<NemeusUART>
 
 };
 
+template <> NemeusUART Singleton<NemeusUART>::_singleton;
+
 #endif // NEMEUS_UART_H
 
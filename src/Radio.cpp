@@ -24,18 +24,22 @@
  
 #include "NemeusUART.h"
 #include "Radio.h"
+#include "EventBus.h"
+#include "Utils/Utils.h"
 
 
+/* Unique instance */
+template <> Radio Singleton<Radio>::_singleton {};
+
 /**
  * Constructor
  */
 Radio::Radio()
 {
-  dataContext_ = new DataContext();
+  radioState_ = false;
   isContinuousRx_ = false;
   isContinuousTx_ = false;
-  /* register LoRaWAN intern callback to filter some received at response */
-  NemeusUART::getInstance()->addCallback(onReceiveFromUART);
+  /* Radio intern callback is registered by NemeusUART */
 }
 
 /**
@@ -59,6 +63,11 @@ uint8_t Radio::ON()
 
   ErrorCode = NemeusUART::getInstance()->sendATCommand(RADIO_ON, NULL, 2000);
 
+  if (ErrorCode == NEMEUS_SUCCESS)
+  {
+    radioState_ = true;
+  }
+
   return ErrorCode;
 }
 
@@ -75,9 +84,23 @@ uint8_t Radio::OFF()
 
   ErrorCode = NemeusUART::getInstance()->sendATCommand(RADIO_OFF, NULL, 2000);
 
+  if (ErrorCode == NEMEUS_SUCCESS)
+  {
+    radioState_ = false;
+  }
+
   return ErrorCode;
 }
 
+/**
+ * Get the Radio state
+ * @return  true if Radio has been enabled with ON()
+ */
+boolean Radio::isOn()
+{
+  return radioState_;
+}
+
 /**
  * Get size of maximum payload in Sigfox
  * @return  the maximum payload size
@@ -87,8 +110,9 @@ uint8_t Radio::getMaximumPayloadSize()
   return MAXIMUM_RADIO_PAYLOAD;
 }
 
-#define RADIO_SEND_SIZE 14
-#define MAXIMUM_ARGUMENT_SIZE 512
+/* AT+RFTX=SND<BIN|TXT>,<payload>,<repetition> */
+const static AtCommandTemplate<AtWord<3>, AtPayload<2*MAXIMUM_RADIO_PAYLOAD>, AtDec<0xFFFF> >
+  RADIO_SEND_FRAME_CMD(RADIO_SEND_FRAME);
 /**
  * Send a Radio frame
  * @param payload  null terminated payload buffer
@@ -102,90 +126,34 @@ uint8_t Radio::getMaximumPayloadSize()
 uint8_t Radio::sendFrame(uint8_t mode,char* payload, int nbRepeat)
 {
   uint8_t ErrorCode = NEMEUS_SUCCESS;
-  static char arguments[MAXIMUM_ARGUMENT_SIZE];
-  char *pt_arguments; 
-  char *pt_arguments_end;
-  int index = 0;
-  int size_command_argument = 0;
+  AtSpan frame;
+  uint16_t maximumSize;
   boolean sizeTooBig = false;
-  pt_arguments = &arguments[4];
-  pt_arguments_end = &arguments[511];
 
   if (mode == RADIO_BINARY_MODE)
   {
-    strcpy(arguments, "BIN");
-
-    /* Calculate the size of comamnd */
-    if (strlen(payload) > 2*getMaximumPayloadSize())
-    {
-      sizeTooBig = true;
-      size_command_argument = String(nbRepeat, DEC).length() + 3 + 2*getMaximumPayloadSize();
-    }
-    else
-    {
-      size_command_argument = String(nbRepeat, DEC).length() + 3 + strlen(payload);
-    }
-
+    maximumSize = 2*getMaximumPayloadSize();
   }
   else if (mode == RADIO_TEXT_MODE)
   {
-    strcpy(arguments, "TXT");
-
-    /* Calculate the size of comamnd */
-    if (strlen(payload) > getMaximumPayloadSize())
-    {
-      sizeTooBig = true;
-      size_command_argument = String(nbRepeat, DEC).length() + 3 + getMaximumPayloadSize();
-    }
-    else
-    {
-      size_command_argument = String(nbRepeat, DEC).length() + 3 + strlen(payload);
-    }
+    maximumSize = getMaximumPayloadSize();
   }
   else
   {
     return NEMEUS_ARGUMENT_ERROR;
   }
-  index+=3;
-
-  strcat(arguments, ",");
-  index++;    
-
-  if (sizeTooBig)
-  {
-    if (mode == RADIO_BINARY_MODE )
-    {
-      strncat(pt_arguments, payload, (2*getMaximumPayloadSize()));
-      pt_arguments += (2*getMaximumPayloadSize());
-      index+=(2*getMaximumPayloadSize());
-    }
-    else if (mode == RADIO_TEXT_MODE)
-    {
-      strncat(pt_arguments, payload, (getMaximumPayloadSize()));
-      pt_arguments += (getMaximumPayloadSize());
-      index+=(getMaximumPayloadSize());
-    }
 
-  } 
-  else
+  frame.data = payload;
+  frame.length = strlen(payload);
+  if (frame.length > maximumSize)
   {
-    strncat(pt_arguments, payload, strlen(payload));
-    index+=strlen(payload);
-    pt_arguments += strlen(payload);
+    sizeTooBig = true;
+    frame.length = maximumSize;
   }
-  strncat(pt_arguments, ",", 1);
-  pt_arguments++;
-  index++;
-
-  index+=sprintf(arguments+index, "%d", nbRepeat);
-
-  strncat(pt_arguments, "\r\n", 2);
-  pt_arguments+=2;
-  index+=2;
 
-  dataContext_->setOngoingAtCommand(RADIO_SEND_FRAME);
-
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(RADIO_SEND_FRAME, arguments, 20000);
+  /* A negative repetition is rejected */
+  ErrorCode = NemeusUART::getInstance()->sendATCommand(RADIO_SEND_FRAME_CMD, 20000, (mode == RADIO_BINARY_MODE) ? "BIN" : "TXT",
+                                                       frame, (uint32_t)nbRepeat);
 
   if ( (ErrorCode == NEMEUS_SUCCESS) && (sizeTooBig == true))
   {
@@ -208,8 +176,6 @@ uint8_t Radio::continuousRx()
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
 
-  dataContext_->setOngoingAtCommand(RADIO_CONTINUOUS_RX);
-
   ErrorCode = NemeusUART::getInstance()->sendATCommand(RADIO_CONTINUOUS_RX, NULL, 2000);
 
   if (ErrorCode == NEMEUS_SUCCESS)
@@ -232,8 +198,6 @@ uint8_t Radio::stopRx()
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
 
-  dataContext_->setOngoingAtCommand(RADIO_STOP_RX);
-
   ErrorCode = NemeusUART::getInstance()->sendATCommand(RADIO_STOP_RX, NULL, 2000);
 
   if (ErrorCode == NEMEUS_SUCCESS)
@@ -256,8 +220,6 @@ uint8_t Radio::continuousTx()
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
 
-  dataContext_->setOngoingAtCommand(RADIO_CONTINUOUS_TX);
-
   ErrorCode = NemeusUART::getInstance()->sendATCommand(RADIO_CONTINUOUS_TX, NULL, 2000);
 
   if (ErrorCode == NEMEUS_SUCCESS)
@@ -280,8 +242,6 @@ uint8_t Radio::stopTx()
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
 
-  dataContext_->setOngoingAtCommand(RADIO_STOP_TX);
-
   ErrorCode = NemeusUART::getInstance()->sendATCommand(RADIO_STOP_TX, NULL, 2000);
 
   if (ErrorCode == NEMEUS_SUCCESS)
@@ -299,17 +259,16 @@ uint8_t Radio::stopTx()
  *               NEMEUS_OK if response is OK
  *               NEMEUS_ERROR if response is ERROR
  *               NEMEUS_NO_ANSWER if no response from module
- *               NEMEUS_ARGUMENT_ERROR if argument format error
+ *               NEMEUS_ARGUMENT_ERROR if arguments don't fit
  */
-uint8_t Radio::setRadioTxParam(RadioTxParam radioTxParams)
+uint8_t Radio::setRadioTxParam(const RadioTxParam& radioTxParams)
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
+  ArgumentWriter* arguments = &NemeusUART::getInstance()->newArguments();
 
-  char buffer[512];
+  radioTxParams.generateArguments(*arguments);
 
-  dataContext_->setOngoingAtCommand(RADIO_SET_TX_PARAM);
-
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(RADIO_SET_TX_PARAM, radioTxParams.generateArguments(buffer), 2000);
+  ErrorCode = NemeusUART::getInstance()->sendATCommand(RADIO_SET_TX_PARAM, *arguments, 2000);
 
   return ErrorCode;
 }
@@ -321,16 +280,16 @@ uint8_t Radio::setRadioTxParam(RadioTxParam radioTxParams)
  *               NEMEUS_OK if response is OK
  *               NEMEUS_ERROR if response is ERROR
  *               NEMEUS_NO_ANSWER if no response from module
- *               NEMEUS_ARGUMENT_ERROR if argument format error
+ *               NEMEUS_ARGUMENT_ERROR if arguments don't fit
  */
-uint8_t Radio::setRadioRxParam(RadioRxParam radioRxParams)
+uint8_t Radio::setRadioRxParam(const RadioRxParam& radioRxParams)
 {
   uint8_t ErrorCode = NEMEUS_ERROR;
-  char buffer[512];
+  ArgumentWriter* arguments = &NemeusUART::getInstance()->newArguments();
 
-  dataContext_->setOngoingAtCommand(RADIO_SET_RX_PARAM);
+  radioRxParams.generateArguments(*arguments);
 
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(RADIO_SET_RX_PARAM, radioRxParams.generateArguments(buffer), 2000);
+  ErrorCode = NemeusUART::getInstance()->sendATCommand(RADIO_SET_RX_PARAM, *arguments, 2000);
 
   return ErrorCode;
 }
@@ -352,24 +311,38 @@ void Radio::onReceiveFromUART(const char * buffer)
  */
 void Radio::treatAtResponse(const char * buffer)
 {
-  uint8_t index;
-  String stringBuffer = String(buffer);
+  int index;
 
   /* Filter AT response to get some parameters before forwarding to sketch */
-  if (strncmp(buffer,  PREFIX_RFTX_RESPONSE, sizeof(PREFIX_RFTX_RESPONSE)) == 0)
+  if (strncmp(buffer, PREFIX_RFTX_RESPONSE, strlen(PREFIX_RFTX_RESPONSE)) == 0)
   {
     if (isContinuousRx_ == true)
     {
       // Add some code if needed
     }
   }
-  else if (strncmp(buffer,  PREFIX_RFRX_RESPONSE, sizeof(PREFIX_RFRX_RESPONSE)) == 0)
+  else if ( (strncmp(buffer, RADIO_RCVBIN_UNSOL, strlen(RADIO_RCVBIN_UNSOL)) == 0)
+      || (strncmp(buffer, RADIO_RCVTXT_UNSOL, strlen(RADIO_RCVTXT_UNSOL)) == 0) )
   {
-    if (isContinuousRx_ == true)
+    /* +RFRX: RCVBIN,<hex_payload>,<rssi>,<snr> (RCVTXT: text payload) */
+    if (EventBus::getInstance()->hasSubscriber(EVENT_RADIO_FRAME_RECEIVED))
     {
-      // Add some code if needed
+      String stringBuffer = String(buffer);
+      String payload;
+      NemeusEvent_t event;
+
+      index = stringBuffer.indexOf(SEPARATOR)+1;
+      payload = getParameterAsString(stringBuffer, index);
+      index = stringBuffer.indexOf(SEPARATOR, index)+1;
+
+      event.type = EVENT_RADIO_FRAME_RECEIVED;
+      event.radioFrameReceived.binary = (strncmp(buffer, RADIO_RCVBIN_UNSOL, strlen(RADIO_RCVBIN_UNSOL)) == 0);
+      event.radioFrameReceived.payload = payload.c_str();
+      event.radioFrameReceived.rssi = getParameterAsString(stringBuffer, index).toInt();
+      index = stringBuffer.indexOf(SEPARATOR, index)+1;
+      event.radioFrameReceived.snr = getParameterAsString(stringBuffer, index).toInt();
+      EventBus::getInstance()->publish(event);
     }
-
   }
 
 }
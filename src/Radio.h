@@ -32,6 +32,9 @@
 #include "Data/RadioRxParam.h"
 
 #define MAXIMUM_RADIO_PAYLOAD 248
+/* Frame received in continuous Rx */
+#define RADIO_RCVBIN_UNSOL "+RFRX: RCVBIN,"
+#define RADIO_RCVTXT_UNSOL "+RFRX: RCVTXT,"
 //#define SF_SEND_RESPONSE "+SF: SND,"
 
 /**
@@ -47,6 +50,7 @@ enum RADIO_SEND_MODE
 class Radio : public Singleton<Radio>
 {
   friend class Singleton<Radio>;
+  friend class NemeusUART;
 
   public:
     /* Start RF */
@@ -65,20 +69,24 @@ class Radio : public Singleton<Radio>
     uint8_t stopTx();
     /* Get the maximum payload size for RF frame */
     uint8_t getMaximumPayloadSize();
+    /* Read Radio state */
+    boolean isOn();
     /* Set Tx radio parameters */
-    uint8_t setRadioTxParam(RadioTxParam params);
+    uint8_t setRadioTxParam(const RadioTxParam& params);
     /* Set Rx radio parameters */
-    uint8_t setRadioRxParam(RadioRxParam params);
+    uint8_t setRadioRxParam(const RadioRxParam& params);
   protected:
     void treatAtResponse(const char * buffer);
   private:
     //static Sigfox m_instance;
     Radio();
     ~Radio();
-    DataContext * dataContext_;
+    boolean radioState_;
     boolean isContinuousRx_;
     boolean isContinuousTx_;
     static void onReceiveFromUART(const char * buffer);
 };
 
+template <> Radio Singleton<Radio>::_singleton;
+
 #endif // RADIO_H
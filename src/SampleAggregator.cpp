@@ -0,0 +1,313 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * SampleAggregator.cpp - Sample aggregator. Collect timestamped records and
+ *                  send them in LoRaWAN frames filled up to the maximum
+ *                  payload size of the current data rate.
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "NemeusUART.h"
+#include "LoRaWAN.h"
+#include "SampleAggregator.h"
+#include "Utils/NemeusClock.h"
+
+#define MAXIMUM_RECORD_OFFSET 0xFFFF
+
+/**
+ * Constructor
+ * @param macPort  MAC port of the frames
+ * @param recordSize  size of every record, 0 if records have variable size
+ * @param maxAge  maximum age in ms of the first record before sending
+ */
+SampleAggregator::SampleAggregator(uint8_t macPort, uint8_t recordSize, uint32_t maxAge)
+{
+  macPort_ = macPort;
+  recordSize_ = recordSize;
+  maxAge_ = maxAge;
+  ack_ = false;
+  encrypt_ = true;
+  size_ = AGGREGATOR_FRAME_HEADER_SIZE;
+  nbRecords_ = 0;
+  firstRecordTime_ = 0;
+}
+
+/**
+ * Add a record. Pending records are sent first if the new one doesn't fit
+ * in the frame, and the frame is sent once no other record fits.
+ * @param data  the record data
+ * @param size  the record size in bytes
+ * @return  the error code
+ *               NEMEUS_SUCCESS if record is added (and frame sent if full)
+ *               NEMEUS_ARGUMENT_ERROR if record can't fit in a frame
+ *               other codes as returned by sendFrame()
+ */
+uint8_t SampleAggregator::add(const uint8_t* data, uint8_t size)
+{
+  uint8_t ErrorCode = NEMEUS_SUCCESS;
+  uint8_t maximumPayloadSize;
+  uint8_t recordLength;
+  uint32_t now = NemeusClock::get()->now();
+  uint32_t offset;
+
+  if ( (data == NULL) || (size == 0) || ((recordSize_ != 0) && (size != recordSize_)) )
+  {
+    return NEMEUS_ARGUMENT_ERROR;
+  }
+
+  maximumPayloadSize = LoRaWAN::getInstance()->getMaximumPayloadSize();
+  if (maximumPayloadSize == 0)
+  {
+    return NEMEUS_ERROR;
+  }
+
+  recordLength = getRecordSize(size);
+  if ((AGGREGATOR_FRAME_HEADER_SIZE + recordLength) > maximumPayloadSize)
+  {
+    return NEMEUS_ARGUMENT_ERROR;
+  }
+
+  /* Make room: record doesn't fit or its time offset can't be encoded */
+  if ( (nbRecords_ != 0)
+      && (((size_ + recordLength) > maximumPayloadSize)
+        || (((now - firstRecordTime_) / 1000) > MAXIMUM_RECORD_OFFSET)) )
+  {
+    ErrorCode = send(maximumPayloadSize);
+  }
+
+  if ((size_ + recordLength) > AGGREGATOR_BUFFER_SIZE)
+  {
+    /* Previous records couldn't be sent */
+    return ErrorCode;
+  }
+
+  if (nbRecords_ == 0)
+  {
+    firstRecordTime_ = now;
+  }
+  offset = (now - firstRecordTime_) / 1000;
+
+  buffer_[size_++] = (offset >> 8) & 0xFF;
+  buffer_[size_++] = offset & 0xFF;
+  if (recordSize_ == 0)
+  {
+    buffer_[size_++] = size;
+  }
+  memcpy(&buffer_[size_], data, size);
+  size_ += size;
+  nbRecords_++;
+
+  /* Frame is full when another record of this size doesn't fit */
+  if ((size_ + recordLength) > maximumPayloadSize)
+  {
+    ErrorCode = send(maximumPayloadSize);
+  }
+
+  return ErrorCode;
+}
+
+/**
+ * Send the frame if the first record reached the maximum age
+ * @return  the error code
+ *               NEMEUS_SUCCESS if nothing to send or frame sent
+ *               other codes as returned by sendFrame()
+ */
+uint8_t SampleAggregator::process()
+{
+  uint8_t ErrorCode = NEMEUS_SUCCESS;
+
+  if ( (nbRecords_ != 0) && ((NemeusClock::get()->now() - firstRecordTime_) >= maxAge_) )
+  {
+    ErrorCode = send(LoRaWAN::getInstance()->getMaximumPayloadSize());
+  }
+
+  return ErrorCode;
+}
+
+/**
+ * Send all pending records (in several frames if the data rate decreased)
+ * @return  the error code
+ *               NEMEUS_SUCCESS if nothing to send or frames sent
+ *               other codes as returned by sendFrame()
+ */
+uint8_t SampleAggregator::flush()
+{
+  uint8_t ErrorCode = NEMEUS_SUCCESS;
+  uint8_t previousNbRecords;
+
+  do
+  {
+    previousNbRecords = nbRecords_;
+    ErrorCode = send(LoRaWAN::getInstance()->getMaximumPayloadSize());
+  }
+  while ( (ErrorCode == NEMEUS_SUCCESS) && (nbRecords_ != 0) && (nbRecords_ != previousNbRecords) );
+
+  return ErrorCode;
+}
+
+/**
+ * Number of pending records
+ */
+uint8_t SampleAggregator::pendingRecords()
+{
+  return nbRecords_;
+}
+
+/**
+ * Size of the frame if sent now
+ * @return  the frame size in bytes (0 if no record)
+ */
+uint8_t SampleAggregator::pendingSize()
+{
+  return (nbRecords_ != 0) ? size_ : 0;
+}
+
+/**
+ * Set the maximum age in ms of the first record before the frame is sent
+ */
+void SampleAggregator::setMaxAge(uint32_t maxAge)
+{
+  maxAge_ = maxAge;
+}
+
+/**
+ * Ask for acknowledgement of frames
+ */
+void SampleAggregator::setAck(boolean ack)
+{
+  ack_ = ack;
+}
+
+/**
+ * Encrypt frames
+ */
+void SampleAggregator::setEncryption(boolean encrypt)
+{
+  encrypt_ = encrypt;
+}
+
+/**
+ * Size of a record in the frame
+ * @param dataSize  size of the record data
+ */
+uint8_t SampleAggregator::getRecordSize(uint8_t dataSize)
+{
+  return AGGREGATOR_RECORD_HEADER_SIZE + ((recordSize_ == 0) ? 1 : 0) + dataSize;
+}
+
+/**
+ * Frame size holding the most complete records in a maximum size
+ * @param maximumSize  maximum payload size
+ * @param nbRecords  filled with the number of records held
+ * @return  the frame size in bytes
+ */
+uint8_t SampleAggregator::getFittingSize(uint8_t maximumSize, uint8_t* nbRecords)
+{
+  uint8_t index = AGGREGATOR_FRAME_HEADER_SIZE;
+  uint8_t recordLength;
+
+  *nbRecords = 0;
+  while (index < size_)
+  {
+    if (recordSize_ == 0)
+    {
+      recordLength = getRecordSize(buffer_[index+AGGREGATOR_RECORD_HEADER_SIZE]);
+    }
+    else
+    {
+      recordLength = getRecordSize(recordSize_);
+    }
+
+    if ((index + recordLength) > maximumSize)
+    {
+      break;
+    }
+    index += recordLength;
+    (*nbRecords)++;
+  }
+
+  return index;
+}
+
+/**
+ * Send the records fitting in one frame and keep the others
+ * @param maximumPayloadSize  the current maximum payload size
+ * @return  the sendFrame() error code
+ */
+uint8_t SampleAggregator::send(uint8_t maximumPayloadSize)
+{
+  static const char hexDigits[] = "0123456789ABCDEF";
+  static char hexPayload[2*AGGREGATOR_BUFFER_SIZE+1];
+  uint8_t ErrorCode = NEMEUS_SUCCESS;
+  uint8_t nbSentRecords;
+  uint8_t frameSize;
+  uint32_t age;
+
+  frameSize = getFittingSize(maximumPayloadSize, &nbSentRecords);
+  if (nbSentRecords == 0)
+  {
+    return ErrorCode;
+  }
+
+  age = (NemeusClock::get()->now() - firstRecordTime_) / 1000;
+  if (age > MAXIMUM_RECORD_OFFSET)
+  {
+    age = MAXIMUM_RECORD_OFFSET;
+  }
+  buffer_[0] = (age >> 8) & 0xFF;
+  buffer_[1] = age & 0xFF;
+
+  for (int i = 0; i < frameSize; i++)
+  {
+    hexPayload[2*i] = hexDigits[buffer_[i] >> 4];
+    hexPayload[2*i+1] = hexDigits[buffer_[i] & 0x0F];
+  }
+  hexPayload[2*frameSize] = '\0';
+
+  ErrorCode = LoRaWAN::getInstance()->sendFrame(BINARY_MODE, 1, macPort_, hexPayload, ack_, encrypt_);
+
+  if ( (ErrorCode == NEMEUS_SUCCESS) || (ErrorCode == NEMEUS_ERROR_NOACK) )
+  {
+    /* Keep the records that didn't fit, time offsets from the new first one */
+    uint8_t remainingSize = size_ - frameSize;
+    uint16_t firstOffset = 0;
+
+    memmove(&buffer_[AGGREGATOR_FRAME_HEADER_SIZE], &buffer_[frameSize], remainingSize);
+    size_ = AGGREGATOR_FRAME_HEADER_SIZE + remainingSize;
+    nbRecords_ -= nbSentRecords;
+
+    if (nbRecords_ != 0)
+    {
+      uint8_t index = AGGREGATOR_FRAME_HEADER_SIZE;
+
+      firstOffset = (buffer_[index] << 8) | buffer_[index+1];
+      while (index < size_)
+      {
+        uint16_t offset = ((buffer_[index] << 8) | buffer_[index+1]) - firstOffset;
+        buffer_[index] = (offset >> 8) & 0xFF;
+        buffer_[index+1] = offset & 0xFF;
+        index += getRecordSize((recordSize_ == 0) ? buffer_[index+AGGREGATOR_RECORD_HEADER_SIZE] : recordSize_);
+      }
+      firstRecordTime_ += (uint32_t)firstOffset * 1000;
+    }
+  }
+
+  return ErrorCode;
+}
@@ -0,0 +1,84 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * SampleAggregator.h - Sample aggregator class definition
+ *                  Pack timestamped records in LoRaWAN frames
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef SAMPLE_AGGREGATOR_H
+#define SAMPLE_AGGREGATOR_H
+
+#include <stdint.h>
+
+#include "Arduino.h"
+#include "LoRaWAN.h"
+
+/**
+ * Frame layout (binary, big endian):
+ *   <age:2>                          age in s of the first record at sending
+ *   { <offset:2> [<size:1>] <data> } one per record, offset in s from the first
+ *                                    record, size only for variable size records
+ */
+#define AGGREGATOR_FRAME_HEADER_SIZE 2
+#define AGGREGATOR_RECORD_HEADER_SIZE 2
+#define AGGREGATOR_BUFFER_SIZE MAX_LORAWAN_PAYLOAD_3
+
+/* Default maximum age of the first record before the frame is sent */
+#define AGGREGATOR_DEFAULT_MAX_AGE 900000
+
+class SampleAggregator
+{
+  public:
+    /* Constructor (recordSize = 0 for variable size records) */
+    SampleAggregator(uint8_t macPort, uint8_t recordSize = 0, uint32_t maxAge = AGGREGATOR_DEFAULT_MAX_AGE);
+    /* Add a record, sends the frame first if the record doesn't fit */
+    uint8_t add(const uint8_t* data, uint8_t size);
+    /* Send the frame when the maximum age is reached, to call from the sketch loop */
+    uint8_t process();
+    /* Send pending records now */
+    uint8_t flush();
+    /* Number of pending records */
+    uint8_t pendingRecords();
+    /* Size of the frame that would be sent now */
+    uint8_t pendingSize();
+    /* Set the maximum age in ms of the first record */
+    void setMaxAge(uint32_t maxAge);
+    /* Set the acknowledgement and encryption of frames */
+    void setAck(boolean ack);
+    void setEncryption(boolean encrypt);
+  private:
+    uint8_t macPort_;
+    uint8_t recordSize_;
+    uint32_t maxAge_;
+    boolean ack_;
+    boolean encrypt_;
+    uint8_t buffer_[AGGREGATOR_BUFFER_SIZE];
+    uint8_t size_;
+    uint8_t nbRecords_;
+    uint32_t firstRecordTime_;
+
+    /* Methods */
+    uint8_t getRecordSize(uint8_t dataSize);
+    uint8_t getFittingSize(uint8_t maximumSize, uint8_t* nbRecords);
+    uint8_t send(uint8_t maximumPayloadSize);
+};
+
+#endif /* SAMPLE_AGGREGATOR_H */
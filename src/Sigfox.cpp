@@ -24,16 +24,21 @@
 
 #include "NemeusUART.h"
 #include "Sigfox.h"
+#include "EventBus.h"
+#include "UplinkScheduler.h"
+#include "Utils/Utils.h"
 
 
+/* Unique instance */
+template <> Sigfox Singleton<Sigfox>::_singleton {};
+
 /**
  * Constructor
  */
 Sigfox::Sigfox()
 {
-  dataContext_ = new DataContext();
-  /* register LoRaWAN intern callback to filter some received at response */
-  NemeusUART::getInstance()->addCallback(onReceiveFromUART);
+  sigfoxState_ = false;
+  /* Sigfox intern callback is registered by NemeusUART */
 }
 
 /**
@@ -65,6 +70,11 @@ uint8_t Sigfox::ON(char * disDutyCycle)
     ErrorCode = NemeusUART::getInstance()->sendATCommand(SIGFOX_ON, (char*)"\r\n", 2000);
   }
 
+  if (ErrorCode == NEMEUS_SUCCESS)
+  {
+    sigfoxState_ = true;
+  }
+
   return ErrorCode;
 }
 
@@ -81,9 +91,23 @@ uint8_t Sigfox::OFF()
 
   ErrorCode = NemeusUART::getInstance()->sendATCommand(SIGFOX_OFF, NULL, 2000);
 
+  if (ErrorCode == NEMEUS_SUCCESS)
+  {
+    sigfoxState_ = false;
+  }
+
   return ErrorCode;
 }
 
+/**
+ * Get the Sigfox state
+ * @return  true if Sigfox has been enabled with ON()
+ */
+boolean Sigfox::isOn()
+{
+  return sigfoxState_;
+}
+
 /**
  * Get size of maximum payload in Sigfox
  * @return  the maximum payload size
@@ -93,8 +117,10 @@ uint8_t Sigfox::getMaximumPayloadSize()
   return MAXIMUM_SIGFOX_PAYLOAD;
 }
 
-#define SIGFOX_SEND_SIZE 14
-#define MAXIMUM_ARGUMENT_SIZE 512
+/* AT+SF=SND<BIN|BIT>,<payload>,<ack> */
+const static AtCommandTemplate<AtWord<3>, AtPayload<2*MAXIMUM_SIGFOX_PAYLOAD>, AtFlag> SIGFOX_SEND_CMD(SIGFOX_SEND_BINARY);
+/* AT+SF=SNDOOB */
+const static AtCommandTemplate<AtWord<3> > SIGFOX_SEND_OOB_CMD(SIGFOX_SEND_BINARY);
 /**
  * Send a SIGFOX frame
  * @param payload  null terminated payload buffer
@@ -108,107 +134,59 @@ uint8_t Sigfox::getMaximumPayloadSize()
 uint8_t Sigfox::sendFrame(uint8_t mode, char* payload, boolean ack)
 {
   uint8_t ErrorCode = NEMEUS_SUCCESS;
-  static char arguments[MAXIMUM_ARGUMENT_SIZE];
-  char *pt_arguments; 
-  char *pt_arguments_end;
-  int index = 0;
+  AtSpan frame;
+  uint16_t maximumSize;
   boolean sizeTooBig = false;
-  pt_arguments = &arguments[3];
-  pt_arguments_end = &arguments[511];
 
   if (mode == SIGFOX_BINARY_MODE)
   {
-    strcpy(arguments, "BIN");
-    /* Calculate the size of comamnd */
-    if (strlen(payload) > (2*getMaximumPayloadSize()))
-    {
-      sizeTooBig = true;
-    }
+    maximumSize = 2*getMaximumPayloadSize();
   }
   else if (mode == SIGFOX_BIT_MODE)
   {
-    strcpy(arguments, "BIT");
-    if (strlen(payload) > 1)
-    {
-      sizeTooBig = true;
-    }
+    maximumSize = 1;
   }
-  else if ( mode == SIGFOX_OOB_MODE)
+  else if (mode == SIGFOX_OOB_MODE)
   {
-    strcpy(arguments, "OOB");
-    strncat(pt_arguments, "\r\n", 2);
-    index+=2;
+    maximumSize = 0;
   }
   else
   {
     return NEMEUS_ARGUMENT_ERROR;
   }
-  index+=3;
-  pt_arguments++;
-
 
-  if (sizeTooBig)
+  frame.data = payload;
+  frame.length = (mode == SIGFOX_OOB_MODE) ? 0 : strlen(payload);
+  if (frame.length > maximumSize)
   {
+    sizeTooBig = true;
+    frame.length = maximumSize;
+  }
 
-    if (mode == SIGFOX_BINARY_MODE )
-    {
-      strcat(arguments, ",");
-      index++;
-      strncat(pt_arguments, payload, (2*getMaximumPayloadSize()));
-      pt_arguments += (2*getMaximumPayloadSize());
-      index+=(2*getMaximumPayloadSize());
-    }
-    else if (mode == SIGFOX_BIT_MODE)
-    {
-      strcat(arguments, ",");
-      index++;
-      strncat(pt_arguments, payload, 1);
-      pt_arguments++;
-      index++;
-    }
-  } 
-  else
+  if (mode == SIGFOX_OOB_MODE)
   {
-    if (mode == SIGFOX_BINARY_MODE ||  mode == SIGFOX_BIT_MODE)
-    {
-      strcat(arguments, ",");
-      index++;
-      strncat(pt_arguments, payload, strlen(payload));
-      index+=strlen(payload);
-      pt_arguments += strlen(payload);
-    }
+    ErrorCode = NemeusUART::getInstance()->sendATCommand(SIGFOX_SEND_OOB_CMD, 20000, "OOB");
   }
-
-  if (mode == SIGFOX_BINARY_MODE ||  mode == SIGFOX_BIT_MODE)
+  else
   {
-    strncat(pt_arguments, ",", 1);
-    pt_arguments++;
-    index++;
-    if (ack == true)
-    {
-      strncat(pt_arguments, "1", 1);
-    }
-    else
-    {
-      strncat(pt_arguments, "0", 1);
-    }
-    index++;
-    pt_arguments++;
-    strncat(pt_arguments, "\r\n", 2);
-    index+=2;
-    pt_arguments+=2;
+    ErrorCode = NemeusUART::getInstance()->sendATCommand(SIGFOX_SEND_CMD, 20000, (mode == SIGFOX_BINARY_MODE) ? "BIN" : "BIT",
+                                                         frame, ack);
   }
 
-
-  dataContext_->setOngoingAtCommand(SIGFOX_SEND_BINARY);
-
-  ErrorCode = NemeusUART::getInstance()->sendATCommand(SIGFOX_SEND_BINARY, arguments, 20000);
-
   if ( (ErrorCode == NEMEUS_SUCCESS) && (sizeTooBig == true))
   {
     ErrorCode = NEMEUS_WARNING_PAYLOAD_TRUNACTED;
   }
 
+  if (EventBus::getInstance()->hasSubscriber(EVENT_SIGFOX_SEND_DONE))
+  {
+    NemeusEvent_t event;
+
+    event.type = EVENT_SIGFOX_SEND_DONE;
+    event.sigfoxSendDone.errorCode = ErrorCode;
+    EventBus::getInstance()->publish(event);
+  }
+
   return ErrorCode;
 
 }
@@ -230,13 +208,29 @@ void Sigfox::onReceiveFromUART(const char * buffer)
 void Sigfox::treatAtResponse(const char * buffer)
 {
   uint8_t index;
-  String stringBuffer = String(buffer);
 
   /* Filter AT response to get some parameters before forwarding to sketch */
-  if (strncmp(buffer,  PREFIX_SIGFOX_RESPONSE, sizeof(PREFIX_SIGFOX_RESPONSE)) == 0)
+  if (strncmp(buffer, SF_SEND_UNSOL, strlen(SF_SEND_UNSOL)) == 0)
+  {
+    /* +SF: SND,<delay> */
+    if (EventBus::getInstance()->hasSubscriber(EVENT_SEND_SCHEDULED))
+    {
+      String stringBuffer = String(buffer);
+      NemeusEvent_t event;
+
+      index = stringBuffer.indexOf(SEPARATOR)+1;
+      event.type = EVENT_SEND_SCHEDULED;
+      event.sendScheduled.technology = UPLINK_SIGFOX;
+      event.sendScheduled.delay = getParameterAsString(stringBuffer, index).toInt();
+      EventBus::getInstance()->publish(event);
+    }
+  }
+  else if (strncmp(buffer, PREFIX_SIGFOX_RESPONSE, strlen(PREFIX_SIGFOX_RESPONSE)) == 0)
   {
     /* Do some work */
-    if (dataContext_->getOngoingAtCommand() == SIGFOX_ON)
+    const AtRequest* request = NemeusUART::getInstance()->getRespondedRequest();
+
+    if ( (request != NULL) && (request->getCommand() == SIGFOX_ON) )
     {
 
     }
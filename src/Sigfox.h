@@ -46,6 +46,7 @@ enum SIGFOX_SEND_MODE
 class Sigfox : public Singleton<Sigfox>
 {
   friend class Singleton<Sigfox>;
+  friend class NemeusUART;
 
   public:
     /* Start sigfox */
@@ -56,14 +57,18 @@ class Sigfox : public Singleton<Sigfox>
     uint8_t sendFrame(uint8_t mode, char* payload, boolean ack);
     /* Get the maximum payload size for sigfox frame */
     uint8_t getMaximumPayloadSize();
+    /* Read Sigfox state */
+    boolean isOn();
   protected:
     void treatAtResponse(const char * buffer);
   private:
     //static Sigfox m_instance;
     Sigfox();
     ~Sigfox();
-    DataContext * dataContext_;
+    boolean sigfoxState_;
     static void onReceiveFromUART(const char * buffer);
 };
 
+template <> Sigfox Singleton<Sigfox>::_singleton;
+
 #endif // SIGFOX_H
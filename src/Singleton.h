@@ -2,6 +2,13 @@
 //
 // Singleton - Template for Singleton applicable on any class (code from internet)
 //
+// The unique instance lives in static storage: every class declares it after
+// its definition and defines it in its source file:
+//   template <> LoRaWAN Singleton<LoRaWAN>::_singleton;     (header)
+//   template <> LoRaWAN Singleton<LoRaWAN>::_singleton {};  (source)
+// Constructors must not use other singletons, the initialization order
+// between source files is not defined.
+//
 /////////////////////////////////////////////////////////////////////////////
 #ifndef SINGLETON_H
 #define SINGLETON_H
@@ -11,40 +18,19 @@ class Singleton
 {
   protected:
     // Constructeur/destructeur
-    Singleton () { }
+    constexpr Singleton () { }
     ~Singleton () {  }
 
   public:
     // Interface publique
     static T *getInstance ()
     {
-      if (NULL == _singleton)
-      {
-        _singleton = new T;
-      }
-      else
-      {
-        
-      }
-
-      return (static_cast<T*> (_singleton));
-    }
-
-    static void kill ()
-    {
-      if (NULL != _singleton)
-      {
-        delete _singleton;
-        _singleton = NULL;
-      }
+      return &_singleton;
     }
 
   private:
     // Unique instance
-    static T *_singleton;
+    static T _singleton;
 };
 
-template <typename T>
-T *Singleton<T>::_singleton = NULL;
-
 #endif
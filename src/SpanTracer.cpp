@@ -0,0 +1,147 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * SpanTracer.cpp - Ring of span begin and end events
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "SpanTracer.h"
+
+/* Unique instance */
+template <> SpanTracer Singleton<SpanTracer>::_singleton {};
+
+/**
+ * Get the number of events not read
+ * @return  the number of events in the ring
+ */
+uint16_t SpanTracer::available() const
+{
+#ifdef NEMEUS_SPANS
+  return count_;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * Read the oldest event of the ring
+ * @param event  filled with the event
+ * @return  false if the ring is empty
+ */
+boolean SpanTracer::read(SpanEvent_t& event)
+{
+#ifdef NEMEUS_SPANS
+  if (count_ == 0)
+  {
+    return false;
+  }
+  event = ring_[first_];
+  first_ = (first_ + 1) % SPAN_RING_SIZE;
+  count_--;
+
+  return true;
+#else
+  (void)event;
+  return false;
+#endif
+}
+
+/**
+ * Get the number of events overwritten before being read
+ * @return  the events lost since the start
+ */
+uint32_t SpanTracer::getNbLost() const
+{
+#ifdef NEMEUS_SPANS
+  return nbLost_;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * Empty the ring
+ */
+void SpanTracer::clear()
+{
+#ifdef NEMEUS_SPANS
+  first_ = 0;
+  count_ = 0;
+#endif
+}
+
+/**
+ * Begin a span
+ * @param name  the span name, a literal (kept as is)
+ * @return  the span id, to give to end()
+ */
+uint16_t SpanTracer::begin(const char* name)
+{
+#ifdef NEMEUS_SPANS
+  uint16_t id = nextId_++;
+
+  push(SPAN_BEGIN, id, name);
+
+  return id;
+#else
+  (void)name;
+  return 0;
+#endif
+}
+
+/**
+ * End a span
+ * @param id  the id returned by begin()
+ * @param name  the span name
+ */
+void SpanTracer::end(uint16_t id, const char* name)
+{
+#ifdef NEMEUS_SPANS
+  push(SPAN_END, id, name);
+#else
+  (void)id;
+  (void)name;
+#endif
+}
+
+#ifdef NEMEUS_SPANS
+/**
+ * Add an event to the ring, over the oldest one if full
+ */
+void SpanTracer::push(uint8_t phase, uint16_t id, const char* name)
+{
+  SpanEvent_t& event = ring_[(first_ + count_) % SPAN_RING_SIZE];
+
+  event.time = NemeusClock::get()->now();
+  event.name = name;
+  event.id = id;
+  event.phase = phase;
+
+  if (count_ < SPAN_RING_SIZE)
+  {
+    count_++;
+  }
+  else
+  {
+    first_ = (first_ + 1) % SPAN_RING_SIZE;
+    nbLost_++;
+  }
+}
+#endif
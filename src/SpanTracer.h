@@ -0,0 +1,129 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * SpanTracer.h - Span tracer class definition
+ *                Begin and end of API calls, AT commands and waits in a ring
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef SPAN_TRACER_H
+#define SPAN_TRACER_H
+
+#include <stdint.h>
+
+#include "Arduino.h"
+#include "Singleton.h"
+#include "Utils/NemeusClock.h"
+
+/*
+ * Compiled out unless NEMEUS_SPANS is defined (build flag): spans are then
+ * empty objects and the ring doesn't exist. Enabled, the ring takes
+ * SPAN_RING_SIZE * 12 bytes of RAM, the oldest events are overwritten.
+ */
+#ifndef SPAN_RING_SIZE
+#define SPAN_RING_SIZE 64
+#endif
+
+enum SPAN_PHASE
+{
+  SPAN_BEGIN = 'B',
+  SPAN_END   = 'E'
+};
+
+/**
+ * Begin or end of a span, both carry the span id and name
+ */
+struct SpanEvent_t
+{
+  uint32_t time;          // ms
+  const char* name;       // literal (API call, AT command string...)
+  uint16_t id;
+  uint8_t phase;          // SPAN_PHASE
+};
+
+class SpanTracer : public Singleton<SpanTracer>
+{
+  friend class Singleton<SpanTracer>;
+
+  public:
+    /* True if built with NEMEUS_SPANS */
+    static constexpr boolean isEnabled()
+    {
+#ifdef NEMEUS_SPANS
+      return true;
+#else
+      return false;
+#endif
+    }
+    /* Events in the ring */
+    uint16_t available() const;
+    /* Read the oldest event, false if none */
+    boolean read(SpanEvent_t& event);
+    /* Events overwritten before being read */
+    uint32_t getNbLost() const;
+    /* Empty the ring */
+    void clear();
+
+    /* Begin a span, its id is given to end() (use TraceSpan) */
+    uint16_t begin(const char* name);
+    void end(uint16_t id, const char* name);
+  private:
+#ifdef NEMEUS_SPANS
+    constexpr SpanTracer() : ring_(), first_(0), count_(0), nextId_(1), nbLost_(0) {}
+
+    SpanEvent_t ring_[SPAN_RING_SIZE];
+    uint16_t first_;
+    uint16_t count_;
+    uint16_t nextId_;
+    uint32_t nbLost_;
+
+    /* Methods */
+    void push(uint8_t phase, uint16_t id, const char* name);
+#else
+    constexpr SpanTracer() {}
+#endif
+};
+
+template <> SpanTracer Singleton<SpanTracer>::_singleton;
+
+/**
+ * Span of a scope: begins at construction, ends at destruction
+ *
+ * Usage:
+ *   uint8_t LoRaWAN::ON(char loraClass, boolean otaa)
+ *   {
+ *     TraceSpan span("LoRaWAN::ON");
+ *     ...
+ */
+class TraceSpan
+{
+  public:
+#ifdef NEMEUS_SPANS
+    explicit TraceSpan(const char* name) : name_(name), id_(SpanTracer::getInstance()->begin(name)) {}
+    ~TraceSpan() { SpanTracer::getInstance()->end(id_, name_); }
+  private:
+    const char* name_;
+    uint16_t id_;
+#else
+    explicit TraceSpan(const char* name) { (void)name; }
+#endif
+};
+
+#endif /* SPAN_TRACER_H */
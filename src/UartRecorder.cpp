@@ -0,0 +1,324 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * UartRecorder.cpp - Records the MM002 UART traffic and the events in a
+ *                  compact log, replayed on the host (extras/host/replay).
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "UartRecorder.h"
+#include "NemeusUART.h"
+#include "Utils/NemeusClock.h"
+
+/* Traces received from the module (NemeusUART.cpp) */
+extern CircBuffer circularTraceBuffer;
+
+/* Unique instance */
+template <> UartRecorder Singleton<UartRecorder>::_singleton {};
+
+/* Longest record without its data: RS, type and time delta escaped, LF */
+#define UART_RECORD_OVERHEAD 14
+
+/**
+ * Start recording, a start record gives the current time
+ * @param sink  where records are written (UART_RECORD_SINK)
+ * @return  the error code
+ *               NEMEUS_SUCCESS if recording
+ *               NEMEUS_ARGUMENT_ERROR if the sink is unknown
+ *               NEMEUS_ERROR_QUEUE_FULL if events can't be subscribed
+ */
+uint8_t UartRecorder::start(uint8_t sink)
+{
+  uint8_t ErrorCode = NEMEUS_ERROR;
+
+  if (sink > UART_RECORD_SERIAL_USB)
+  {
+    return NEMEUS_ARGUMENT_ERROR;
+  }
+
+  ErrorCode = EventBus::getInstance()->subscribe(onEvent, EVENT_ALL);
+  if (ErrorCode != NEMEUS_SUCCESS)
+  {
+    return ErrorCode;
+  }
+
+  sink_ = sink;
+  nbLost_ = 0;
+  nbPendingLost_ = 0;
+  chunkLength_ = 0;
+  lastTime_ = NemeusClock::get()->now();
+  recording_ = true;
+
+  if (begin(UART_RECORD_START, 6))
+  {
+    emit((uint8_t)UART_RECORD_VERSION);
+    emitVarint(lastTime_);
+    end();
+  }
+
+  return NEMEUS_SUCCESS;
+}
+
+/**
+ * Stop recording
+ */
+void UartRecorder::stop()
+{
+  if (recording_)
+  {
+    EventBus::getInstance()->unsubscribe(onEvent);
+    recording_ = false;
+  }
+}
+
+/**
+ * Record a command sent to the module
+ * @param command  the command string
+ * @param commandLength  its length
+ * @param arguments  the arguments sent after the command (NULL if none)
+ * @param argumentsLength  their length
+ */
+void UartRecorder::recordTx(const char* command, uint16_t commandLength, const char* arguments, uint16_t argumentsLength)
+{
+  if ( (recording_) && (begin(UART_RECORD_TX, commandLength + argumentsLength)) )
+  {
+    emit(command, commandLength);
+    emit(arguments, argumentsLength);
+    end();
+  }
+}
+
+/**
+ * Record bytes received from the module, as read by the library
+ * @param data  the bytes
+ * @param length  their number
+ */
+void UartRecorder::recordRx(const char* data, uint16_t length)
+{
+  if ( (recording_) && (begin(UART_RECORD_RX, length)) )
+  {
+    emit(data, length);
+    end();
+  }
+}
+
+/**
+ * Record an event published on the bus
+ */
+void UartRecorder::onEvent(const NemeusEvent_t* event)
+{
+  UartRecorder* recorder = getInstance();
+  uint32_t digest = eventDigest(*event);
+
+  if (recorder->begin(UART_RECORD_EVENT, 5))
+  {
+    recorder->emit(event->type);
+    for (uint8_t i = 0; i < 4; i++)
+    {
+      recorder->emit((uint8_t)(digest >> (8*i)));
+    }
+    recorder->end();
+  }
+}
+
+/* FNV-1a */
+static uint32_t digestBytes(uint32_t digest, const void* data, uint16_t length)
+{
+  const uint8_t* bytes = (const uint8_t*)data;
+
+  for (uint16_t i = 0; i < length; i++)
+  {
+    digest = (digest ^ bytes[i]) * 16777619UL;
+  }
+
+  return digest;
+}
+
+static uint32_t digestString(uint32_t digest, const char* string)
+{
+  if (string == NULL)
+  {
+    string = "";
+  }
+
+  /* Terminating NUL separates the strings */
+  return digestBytes(digest, string, strlen(string) + 1);
+}
+
+static uint32_t digestValue(uint32_t digest, int32_t value)
+{
+  uint8_t bytes[4] = { (uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24) };
+
+  return digestBytes(digest, bytes, sizeof(bytes));
+}
+
+/**
+ * Get the digest of an event, from its type and values
+ * @param event  the event
+ * @return  the digest, equal for events of same values
+ */
+uint32_t UartRecorder::eventDigest(const NemeusEvent_t& event)
+{
+  uint32_t digest = digestValue(2166136261UL, event.type);
+
+  switch (event.type)
+  {
+    case EVENT_SEND_SCHEDULED:
+      digest = digestValue(digest, event.sendScheduled.technology);
+      digest = digestValue(digest, event.sendScheduled.delay);
+      break;
+    case EVENT_DOWNLINK_RECEIVED:
+      digest = digestValue(digest, event.downlinkReceived.port);
+      digest = digestValue(digest, event.downlinkReceived.more);
+      digest = digestValue(digest, event.downlinkReceived.binary);
+      digest = digestString(digest, event.downlinkReceived.payload);
+      digest = digestValue(digest, event.downlinkReceived.rssi);
+      digest = digestValue(digest, event.downlinkReceived.snr);
+      break;
+    case EVENT_DEVADDR_ASSIGNED:
+      digest = digestString(digest, event.devAddrAssigned.devAddr);
+      digest = digestString(digest, event.devAddrAssigned.networkId);
+      break;
+    case EVENT_DATA_RATE_CHANGED:
+      digest = digestValue(digest, event.dataRateChanged.dataRate->getFields());
+      digest = digestValue(digest, event.dataRateChanged.dataRate->getDataRate());
+      digest = digestValue(digest, event.dataRateChanged.dataRate->getTxPower());
+      digest = digestValue(digest, event.dataRateChanged.dataRate->getChannelMask());
+      break;
+    case EVENT_SIGFOX_SEND_DONE:
+      digest = digestValue(digest, event.sigfoxSendDone.errorCode);
+      break;
+    case EVENT_RADIO_FRAME_RECEIVED:
+      digest = digestValue(digest, event.radioFrameReceived.binary);
+      digest = digestString(digest, event.radioFrameReceived.payload);
+      digest = digestValue(digest, event.radioFrameReceived.rssi);
+      digest = digestValue(digest, event.radioFrameReceived.snr);
+      break;
+    default:
+      break;
+  }
+
+  return digest;
+}
+
+/**
+ * Start a record, preceded by a lost record if some were dropped
+ * @param type  the record type (UART_RECORD_TYPE)
+ * @param length  the number of data bytes
+ * @return  false if the trace ring can't hold it (the record is dropped)
+ */
+boolean UartRecorder::begin(uint8_t type, uint16_t length)
+{
+  uint32_t now = NemeusClock::get()->now();
+  uint32_t needed = UART_RECORD_OVERHEAD + 2*(uint32_t)length;
+
+  if (nbPendingLost_ != 0)
+  {
+    needed += 2*UART_RECORD_OVERHEAD;
+  }
+
+  if ( (sink_ == UART_RECORD_TRACE_RING) && ((uint32_t)circularTraceBuffer.getSizeRemaining() < needed) )
+  {
+    nbLost_++;
+    nbPendingLost_++;
+    return false;
+  }
+
+  if (nbPendingLost_ != 0)
+  {
+    chunk_[chunkLength_++] = UART_RECORD_MARKER;
+    emit((uint8_t)UART_RECORD_LOST);
+    emitVarint(now - lastTime_);
+    emitVarint(nbPendingLost_);
+    end();
+    nbPendingLost_ = 0;
+    lastTime_ = now;
+  }
+
+  chunk_[chunkLength_++] = UART_RECORD_MARKER;
+  emit(type);
+  emitVarint(now - lastTime_);
+  lastTime_ = now;
+
+  return true;
+}
+
+void UartRecorder::emitVarint(uint32_t value)
+{
+  while (value >= 0x80)
+  {
+    emit((uint8_t)(value | 0x80));
+    value >>= 7;
+  }
+  emit((uint8_t)value);
+}
+
+void UartRecorder::emit(const char* data, uint16_t length)
+{
+  for (uint16_t i = 0; i < length; i++)
+  {
+    emit((uint8_t)data[i]);
+  }
+}
+
+/**
+ * Append a byte to the record, escaped
+ */
+void UartRecorder::emit(uint8_t byte)
+{
+  /* Room for an escaped byte */
+  if (chunkLength_ > sizeof(chunk_) - 2)
+  {
+    flush();
+  }
+
+  if ( (byte == '\n') || (byte == UART_RECORD_ESCAPE) || (byte == UART_RECORD_MARKER) )
+  {
+    chunk_[chunkLength_++] = UART_RECORD_ESCAPE;
+    byte ^= 0x40;
+  }
+  chunk_[chunkLength_++] = byte;
+}
+
+/**
+ * End the record and write it
+ */
+void UartRecorder::end()
+{
+  if (chunkLength_ >= sizeof(chunk_))
+  {
+    flush();
+  }
+  chunk_[chunkLength_++] = '\n';
+  flush();
+}
+
+void UartRecorder::flush()
+{
+  if (sink_ == UART_RECORD_TRACE_RING)
+  {
+    circularTraceBuffer.write(chunk_, chunkLength_);
+  }
+  else if (SerialUSB)
+  {
+    SerialUSB.write((const uint8_t*)chunk_, chunkLength_);
+  }
+  chunkLength_ = 0;
+}
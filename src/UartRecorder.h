@@ -0,0 +1,106 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * UartRecorder.h - UART recorder class definition
+ *                  Timestamped log of the MM002 traffic and events
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UART_RECORDER_H
+#define UART_RECORDER_H
+
+#include <stdint.h>
+
+#include "Arduino.h"
+#include "Singleton.h"
+#include "EventBus.h"
+
+/**
+ * Log format, one record per line so that traces can be interleaved:
+ *   RS <type> <time delta> <data> LF
+ * RS is 0x1E, the time delta is the ms since the previous record as a
+ * varint (7 bits per byte, low bits first, bit 7 set if more bytes).
+ * After RS, bytes LF, ESC (0x1B) and RS are written ESC, byte ^ 0x40.
+ */
+#define UART_RECORD_MARKER 0x1E
+#define UART_RECORD_ESCAPE 0x1B
+#define UART_RECORD_VERSION 1
+
+enum UART_RECORD_TYPE
+{
+  UART_RECORD_START = 'S',    // version, absolute time in ms (varint)
+  UART_RECORD_TX    = 'T',    // bytes sent to the module
+  UART_RECORD_RX    = 'R',    // bytes received from the module
+  UART_RECORD_EVENT = 'E',    // event type, digest (4 bytes, little endian)
+  UART_RECORD_LOST  = 'L'     // records dropped before this one (varint)
+};
+
+/**
+ * Where records are written
+ */
+enum UART_RECORD_SINK
+{
+  UART_RECORD_TRACE_RING = 0,   // trace buffer, read with the traces
+  UART_RECORD_SERIAL_USB = 1    // SerialUSB, as recorded
+};
+
+class UartRecorder : public Singleton<UartRecorder>
+{
+  friend class Singleton<UartRecorder>;
+
+  public:
+    /* Start recording the UART traffic and the events */
+    uint8_t start(uint8_t sink);
+    /* Stop recording */
+    void stop();
+    boolean isRecording() const { return recording_; }
+    /* Records dropped because the trace ring was full */
+    uint32_t getNbLost() const { return nbLost_; }
+    /* Command sent (called by NemeusUART) */
+    void recordTx(const char* command, uint16_t commandLength, const char* arguments, uint16_t argumentsLength);
+    /* Bytes received (called by NemeusUART) */
+    void recordRx(const char* data, uint16_t length);
+    /* Digest of an event, compared on replay */
+    static uint32_t eventDigest(const NemeusEvent_t& event);
+  private:
+    constexpr UartRecorder() : recording_(false), sink_(UART_RECORD_TRACE_RING), lastTime_(0),
+                               nbLost_(0), nbPendingLost_(0), chunk_(), chunkLength_(0) {}
+
+    boolean recording_;
+    uint8_t sink_;
+    uint32_t lastTime_;
+    uint32_t nbLost_;
+    uint32_t nbPendingLost_;    // Dropped, not yet told by a UART_RECORD_LOST record
+    char chunk_[64];            // Escaped bytes not yet written to the sink
+    uint8_t chunkLength_;
+
+    /* Methods */
+    static void onEvent(const NemeusEvent_t* event);
+    boolean begin(uint8_t type, uint16_t length);
+    void emitVarint(uint32_t value);
+    void emit(const char* data, uint16_t length);
+    void emit(uint8_t byte);
+    void end();
+    void flush();
+};
+
+template <> UartRecorder Singleton<UartRecorder>::_singleton;
+
+#endif /* UART_RECORDER_H */
@@ -0,0 +1,544 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * UplinkScheduler.cpp - Uplink scheduler singleton. Queue uplink jobs and
+ *                  dispatch them on LoRaWAN, Sigfox or Radio according to
+ *                  priority, deadline, duty cycle and link state.
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "NemeusUART.h"
+#include "LoRaWAN.h"
+#include "Sigfox.h"
+#include "Radio.h"
+#include "UplinkScheduler.h"
+#include "Utils/NemeusClock.h"
+
+#define NB_TECHNOLOGIES 3
+
+/* Technologies in order of preference when several are ready */
+static const uint8_t technologyOrder[NB_TECHNOLOGIES] =
+{
+  UPLINK_LORAWAN,
+  UPLINK_SIGFOX,
+  UPLINK_RADIO
+};
+
+/* Unique instance */
+template <> UplinkScheduler Singleton<UplinkScheduler>::_singleton {};
+
+/**
+ * Constructor
+ */
+UplinkScheduler::UplinkScheduler()
+{
+  for (int i = 0; i < UPLINK_QUEUE_SIZE; i++)
+  {
+    queue_[i].isUsed = false;
+  }
+  for (int i = 0; i < NB_TECHNOLOGIES; i++)
+  {
+    nextAvailable_[i] = 0;
+    minimumInterval_[i] = 0;
+  }
+  minimumInterval_[technologyIndex(UPLINK_SIGFOX)] = UPLINK_SIGFOX_MIN_INTERVAL;
+  nextJobId_ = 1;
+  sequence_ = 0;
+  isStarted_ = false;
+  onJobDoneCbk_ = NULL;
+}
+
+/**
+ * Destructor
+ */
+UplinkScheduler::~UplinkScheduler()
+{
+}
+
+/**
+ * Queue an uplink job. If the queue is full, the lowest priority job is
+ * dropped when the new one has a higher priority.
+ * @param job  the job to queue (copied)
+ * @param jobId  filled with the job identifier (may be NULL)
+ * @return  the error code
+ *               NEMEUS_SUCCESS if job is queued
+ *               NEMEUS_ARGUMENT_ERROR if job format error
+ *               NEMEUS_ERROR_QUEUE_FULL if no room for the job
+ */
+uint8_t UplinkScheduler::submit(const UplinkJob_t* job, uint8_t* jobId)
+{
+  JobEntry* entry = NULL;
+  uint8_t droppedJobId = 0;
+
+  if ( (job == NULL) || ((job->technologies & UPLINK_ANY) == 0)
+      || (job->size == 0) || (job->size > UPLINK_MAX_PAYLOAD) )
+  {
+    return NEMEUS_ARGUMENT_ERROR;
+  }
+
+  /* Find a free entry */
+  for (int i = 0; (i < UPLINK_QUEUE_SIZE) && (entry == NULL); i++)
+  {
+    if (queue_[i].isUsed == false)
+    {
+      entry = &queue_[i];
+    }
+  }
+
+  /* Queue full: preempt the last job to be dispatched if less important */
+  if (entry == NULL)
+  {
+    JobEntry* lastEntry = &queue_[0];
+
+    for (int i = 1; i < UPLINK_QUEUE_SIZE; i++)
+    {
+      if (isBefore(lastEntry, &queue_[i]))
+      {
+        lastEntry = &queue_[i];
+      }
+    }
+
+    if (lastEntry->job.priority >= job->priority)
+    {
+      return NEMEUS_ERROR_QUEUE_FULL;
+    }
+
+    droppedJobId = lastEntry->id;
+    entry = lastEntry;
+  }
+
+  /* Technologies available from the first job, the clock isn't read at
+     static initialization */
+  if (isStarted_ == false)
+  {
+    uint32_t now = NemeusClock::get()->now();
+
+    for (int i = 0; i < NB_TECHNOLOGIES; i++)
+    {
+      nextAvailable_[i] = now;
+    }
+    isStarted_ = true;
+  }
+
+  memcpy(&entry->job, job, sizeof(UplinkJob_t));
+  entry->isUsed = true;
+  entry->id = nextJobId_;
+  entry->attempts = 0;
+  entry->sequence = sequence_++;
+  entry->submitTime = NemeusClock::get()->now();
+  entry->retryTime = entry->submitTime;
+
+  /* Job identifier 0 is never used */
+  nextJobId_++;
+  if (nextJobId_ == 0)
+  {
+    nextJobId_ = 1;
+  }
+
+  if (jobId != NULL)
+  {
+    *jobId = entry->id;
+  }
+
+  /* Notify the preempted job once the new one is queued */
+  if ( (droppedJobId != 0) && (onJobDoneCbk_ != NULL) )
+  {
+    onJobDoneCbk_(droppedJobId, 0, NEMEUS_ERROR_QUEUE_FULL);
+  }
+
+  return NEMEUS_SUCCESS;
+}
+
+/**
+ * Remove a queued job (no callback is called)
+ * @param jobId  the job identifier returned by submit()
+ * @return  NEMEUS_SUCCESS if the job was queued, NEMEUS_ARGUMENT_ERROR otherwise
+ */
+uint8_t UplinkScheduler::cancel(uint8_t jobId)
+{
+  for (int i = 0; i < UPLINK_QUEUE_SIZE; i++)
+  {
+    if ( (queue_[i].isUsed == true) && (queue_[i].id == jobId) )
+    {
+      queue_[i].isUsed = false;
+      return NEMEUS_SUCCESS;
+    }
+  }
+
+  return NEMEUS_ARGUMENT_ERROR;
+}
+
+/**
+ * Drop expired jobs then dispatch the most important job having a ready
+ * technology. Sending is blocking as for sendFrame() methods.
+ * @return  the error code of the dispatched frame
+ *               NEMEUS_SUCCESS if nothing to dispatch or frame sent
+ *               other codes as returned by sendFrame()
+ */
+uint8_t UplinkScheduler::process()
+{
+  uint32_t now;
+  JobEntry* bestEntry = NULL;
+  uint8_t bestTechnology = 0;
+
+  /* Data rate read from the module here only, if unknown (i.e. after a
+     reset), the other queries use the known one */
+  if (LoRaWAN::getInstance()->isOn() == true)
+  {
+    LoRaWAN::getInstance()->getMaximumPayloadSize();
+  }
+  now = NemeusClock::get()->now();
+
+  /* Expired jobs */
+  for (int i = 0; i < UPLINK_QUEUE_SIZE; i++)
+  {
+    JobEntry* entry = &queue_[i];
+
+    if ( (entry->isUsed == true) && (entry->job.deadline != 0)
+        && isElapsed(now, entry->submitTime + entry->job.deadline) )
+    {
+      complete(entry, 0, NEMEUS_ERROR_EXPIRED);
+    }
+  }
+
+  /* Most important ready job */
+  for (int i = 0; i < UPLINK_QUEUE_SIZE; i++)
+  {
+    JobEntry* entry = &queue_[i];
+    uint8_t technology;
+
+    if ( (entry->isUsed == false) || (isElapsed(now, entry->retryTime) == false) )
+    {
+      continue;
+    }
+
+    if ( (bestEntry != NULL) && (isBefore(bestEntry, entry)) )
+    {
+      continue;
+    }
+
+    technology = selectTechnology(entry, now);
+    if (technology != 0)
+    {
+      bestEntry = entry;
+      bestTechnology = technology;
+    }
+  }
+
+  if (bestEntry == NULL)
+  {
+    return NEMEUS_SUCCESS;
+  }
+
+  return dispatch(bestEntry, bestTechnology);
+}
+
+/**
+ * Delay before the next call to process() may dispatch or expire a job,
+ * from the known states only: no command is sent to the module
+ * @return  the delay in ms (0 if a job is ready, 0xFFFFFFFF if queue is empty)
+ */
+uint32_t UplinkScheduler::nextDispatchDelay()
+{
+  uint32_t now = NemeusClock::get()->now();
+  uint32_t minimumDelay = 0xFFFFFFFF;
+
+  for (int i = 0; i < UPLINK_QUEUE_SIZE; i++)
+  {
+    JobEntry* entry = &queue_[i];
+
+    if (entry->isUsed == false)
+    {
+      continue;
+    }
+
+    if (entry->job.deadline != 0)
+    {
+      uint32_t expiry = entry->submitTime + entry->job.deadline;
+      uint32_t delay = isElapsed(now, expiry) ? 0 : expiry - now;
+
+      if (delay < minimumDelay)
+      {
+        minimumDelay = delay;
+      }
+    }
+
+    for (int t = 0; t < NB_TECHNOLOGIES; t++)
+    {
+      uint8_t technology = technologyOrder[t];
+      uint32_t readyTime;
+      uint32_t delay;
+
+      if ((entry->job.technologies & technology) == 0)
+      {
+        continue;
+      }
+
+      if ( (technology == UPLINK_LORAWAN) && (LoRaWAN::getInstance()->isOn() == true)
+          && (LoRaWAN::getInstance()->getKnownMaximumPayloadSize() == 0) )
+      {
+        /* process() reads the data rate first */
+        minimumDelay = 0;
+        continue;
+      }
+
+      if (isLinkAvailable(technology, entry->job.size) == false)
+      {
+        continue;
+      }
+
+      readyTime = nextAvailable_[technologyIndex(technology)];
+      if (isElapsed(entry->retryTime, readyTime))
+      {
+        readyTime = entry->retryTime;
+      }
+      delay = isElapsed(now, readyTime) ? 0 : readyTime - now;
+
+      if (delay < minimumDelay)
+      {
+        minimumDelay = delay;
+      }
+    }
+  }
+
+  return minimumDelay;
+}
+
+/**
+ * Number of queued jobs
+ * @return  the number of jobs waiting for dispatch
+ */
+uint8_t UplinkScheduler::pendingJobs()
+{
+  uint8_t nbJobs = 0;
+
+  for (int i = 0; i < UPLINK_QUEUE_SIZE; i++)
+  {
+    if (queue_[i].isUsed == true)
+    {
+      nbJobs++;
+    }
+  }
+
+  return nbJobs;
+}
+
+/**
+ * Set the minimum interval between the end of an uplink and the next one
+ * (LoRaWAN also applies its 1% duty cycle from the frame time on air)
+ * @param technology  UPLINK_LORAWAN, UPLINK_SIGFOX or UPLINK_RADIO
+ * @param interval  interval in ms
+ */
+void UplinkScheduler::setMinimumInterval(uint8_t technology, uint32_t interval)
+{
+  uint8_t index = technologyIndex(technology);
+
+  if (index < NB_TECHNOLOGIES)
+  {
+    minimumInterval_[index] = interval;
+  }
+}
+
+/**
+ * Register a callback for job completion
+ */
+void UplinkScheduler::register_job_callback(void (*onJobDone)(uint8_t jobId, uint8_t technology, uint8_t errorCode))
+{
+  this->onJobDoneCbk_ = onJobDone;
+}
+
+/**
+ * Index of a technology in duty cycle tables
+ * @param technology  one UPLINK_TECHNOLOGY bit
+ * @return  the index (NB_TECHNOLOGIES if unknown)
+ */
+uint8_t UplinkScheduler::technologyIndex(uint8_t technology)
+{
+  for (uint8_t i = 0; i < NB_TECHNOLOGIES; i++)
+  {
+    if (technologyOrder[i] == technology)
+    {
+      return i;
+    }
+  }
+
+  return NB_TECHNOLOGIES;
+}
+
+/**
+ * Has a time been reached (clock overflow safe)
+ */
+bool UplinkScheduler::isElapsed(uint32_t now, uint32_t time)
+{
+  return ((int32_t)(now - time) >= 0);
+}
+
+/**
+ * Dispatch order: priority, then earliest deadline, then submission order
+ * @return  true if entry1 must be dispatched before entry2
+ */
+bool UplinkScheduler::isBefore(const JobEntry* entry1, const JobEntry* entry2)
+{
+  if (entry1->job.priority != entry2->job.priority)
+  {
+    return (entry1->job.priority > entry2->job.priority);
+  }
+
+  if ( (entry1->job.deadline != 0) && (entry2->job.deadline != 0) )
+  {
+    uint32_t expiry1 = entry1->submitTime + entry1->job.deadline;
+    uint32_t expiry2 = entry2->submitTime + entry2->job.deadline;
+
+    if (expiry1 != expiry2)
+    {
+      return ((int32_t)(expiry1 - expiry2) < 0);
+    }
+  }
+  else if (entry1->job.deadline != entry2->job.deadline)
+  {
+    /* A job with a deadline goes first */
+    return (entry1->job.deadline != 0);
+  }
+
+  return ((int32_t)(entry1->sequence - entry2->sequence) < 0);
+}
+
+/**
+ * Check if a technology is enabled and accepts the payload size, the LoRaWAN
+ * one at the data rate known (no command sent)
+ */
+bool UplinkScheduler::isLinkAvailable(uint8_t technology, uint8_t size)
+{
+  bool isAvailable = false;
+
+  if (technology == UPLINK_LORAWAN)
+  {
+    LoRaWAN* loraWan = LoRaWAN::getInstance();
+    isAvailable = (loraWan->isOn() == true) && (size <= loraWan->getKnownMaximumPayloadSize());
+  }
+  else if (technology == UPLINK_SIGFOX)
+  {
+    isAvailable = (Sigfox::getInstance()->isOn() == true) && (size <= MAXIMUM_SIGFOX_PAYLOAD);
+  }
+  else if (technology == UPLINK_RADIO)
+  {
+    isAvailable = (Radio::getInstance()->isOn() == true) && (size <= MAXIMUM_RADIO_PAYLOAD);
+  }
+
+  return isAvailable;
+}
+
+/**
+ * Select the technology to use now for a job
+ * @return  the technology or 0 if none is ready
+ */
+uint8_t UplinkScheduler::selectTechnology(const JobEntry* entry, uint32_t now)
+{
+  for (int t = 0; t < NB_TECHNOLOGIES; t++)
+  {
+    uint8_t technology = technologyOrder[t];
+
+    if ( ((entry->job.technologies & technology) != 0)
+        && isElapsed(now, nextAvailable_[t])
+        && isLinkAvailable(technology, entry->job.size) )
+    {
+      return technology;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * Send a job through the sendFrame() method of the technology
+ * @return  the sendFrame() error code
+ */
+uint8_t UplinkScheduler::dispatch(JobEntry* entry, uint8_t technology)
+{
+  static const char hexDigits[] = "0123456789ABCDEF";
+  static char hexPayload[2*UPLINK_MAX_PAYLOAD+1];
+  uint8_t ErrorCode = NEMEUS_ERROR;
+  uint8_t index = technologyIndex(technology);
+  uint32_t offTime = minimumInterval_[index];
+
+  for (int i = 0; i < entry->job.size; i++)
+  {
+    hexPayload[2*i] = hexDigits[entry->job.payload[i] >> 4];
+    hexPayload[2*i+1] = hexDigits[entry->job.payload[i] & 0x0F];
+  }
+  hexPayload[2*entry->job.size] = '\0';
+
+  if (technology == UPLINK_LORAWAN)
+  {
+    ErrorCode = LoRaWAN::getInstance()->sendFrame(BINARY_MODE, 1, entry->job.macPort, hexPayload, entry->job.ack, entry->job.encrypt);
+
+    uint32_t dutyCycleOffTime = LoRaWAN::getInstance()->getTimeOnAir(entry->job.size) * (UPLINK_LORAWAN_DUTY_CYCLE_FACTOR - 1);
+    if (dutyCycleOffTime > offTime)
+    {
+      offTime = dutyCycleOffTime;
+    }
+  }
+  else if (technology == UPLINK_SIGFOX)
+  {
+    ErrorCode = Sigfox::getInstance()->sendFrame(SIGFOX_BINARY_MODE, hexPayload, entry->job.ack);
+  }
+  else if (technology == UPLINK_RADIO)
+  {
+    ErrorCode = Radio::getInstance()->sendFrame(RADIO_BINARY_MODE, hexPayload, 0);
+  }
+
+  if ( (ErrorCode == NEMEUS_SUCCESS) || (ErrorCode == NEMEUS_ERROR_NOACK)
+      || (ErrorCode == NEMEUS_WARNING_PAYLOAD_TRUNACTED) )
+  {
+    /* Frame is on air: apply duty cycle from end of transmission */
+    nextAvailable_[index] = NemeusClock::get()->now() + offTime;
+    complete(entry, technology, ErrorCode);
+  }
+  else
+  {
+    entry->attempts++;
+    if (entry->attempts >= UPLINK_MAX_ATTEMPTS)
+    {
+      complete(entry, technology, ErrorCode);
+    }
+    else
+    {
+      entry->retryTime = NemeusClock::get()->now() + UPLINK_RETRY_DELAY;
+    }
+  }
+
+  return ErrorCode;
+}
+
+/**
+ * Release a job entry and notify the sketch
+ */
+void UplinkScheduler::complete(JobEntry* entry, uint8_t technology, uint8_t errorCode)
+{
+  uint8_t jobId = entry->id;
+
+  /* Release before callback so that the sketch may submit a new job */
+  entry->isUsed = false;
+
+  if (onJobDoneCbk_ != NULL)
+  {
+    onJobDoneCbk_(jobId, technology, errorCode);
+  }
+}
@@ -0,0 +1,149 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * UplinkScheduler.h - Uplink scheduler class definition
+ *                  Arbitrate uplinks between LoRaWAN, Sigfox and Radio
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UPLINK_SCHEDULER_H
+#define UPLINK_SCHEDULER_H
+
+#include <stdint.h>
+
+#include "Arduino.h"
+#include "Singleton.h"
+
+/**
+ * Technologies allowed for an uplink job (bitmask)
+ */
+enum UPLINK_TECHNOLOGY
+{
+  UPLINK_LORAWAN = 0x01,
+  UPLINK_SIGFOX  = 0x02,
+  UPLINK_RADIO   = 0x04,
+  UPLINK_ANY     = 0x07
+};
+
+/**
+ * Priority of an uplink job. Higher priority jobs are dispatched first.
+ */
+enum UPLINK_PRIORITY
+{
+  UPLINK_PRIORITY_LOW    = 0,
+  UPLINK_PRIORITY_NORMAL = 1,
+  UPLINK_PRIORITY_HIGH   = 2,
+  UPLINK_PRIORITY_URGENT = 3
+};
+
+/* Number of jobs waiting in the scheduler queue */
+#ifndef UPLINK_QUEUE_SIZE
+#define UPLINK_QUEUE_SIZE 8
+#endif
+
+/* Maximum binary payload of a job: the smallest EU868 LoRaWAN maximum
+   (DR0 to DR2). Not a guarantee that it can be sent: other regions (US915
+   DR0: 11 bytes) and dwell time limits allow less, a job waits until a
+   technology accepts its size at the current data rate */
+#ifndef UPLINK_MAX_PAYLOAD
+#define UPLINK_MAX_PAYLOAD 51
+#endif
+
+/* Number of dispatch attempts before a job is reported as failed */
+#define UPLINK_MAX_ATTEMPTS 3
+/* Delay before retrying a job after a dispatch error */
+#define UPLINK_RETRY_DELAY 10000
+/* LoRaWAN ETSI duty cycle (1%): off time = time on air * (factor - 1) */
+#define UPLINK_LORAWAN_DUTY_CYCLE_FACTOR 100
+/* Sigfox: 140 uplink messages per day */
+#define UPLINK_SIGFOX_MIN_INTERVAL 617143
+
+/**
+ * Uplink job description, filled by the sketch and copied by submit()
+ */
+typedef struct
+{
+  uint8_t technologies;   // UPLINK_TECHNOLOGY bitmask
+  uint8_t priority;       // UPLINK_PRIORITY
+  uint32_t deadline;      // Maximum delay in ms before sending (0: no deadline)
+  uint8_t macPort;        // LoRaWAN MAC port
+  boolean ack;            // Ask for acknowledgement (LoRaWAN & Sigfox)
+  boolean encrypt;        // LoRaWAN encryption
+  uint8_t size;           // Payload size in bytes
+  uint8_t payload[UPLINK_MAX_PAYLOAD];
+}UplinkJob_t;
+
+class UplinkScheduler : public Singleton<UplinkScheduler>
+{
+  friend class Singleton<UplinkScheduler>;
+
+  typedef void (*onJobDone)(uint8_t jobId, uint8_t technology, uint8_t errorCode);
+
+  public:
+    /* Queue an uplink job */
+    uint8_t submit(const UplinkJob_t* job, uint8_t* jobId);
+    /* Remove a queued job */
+    uint8_t cancel(uint8_t jobId);
+    /* Dispatch at most one ready job, to be called from the sketch loop */
+    uint8_t process();
+    /* Delay in ms before process() has something to dispatch, no command sent */
+    uint32_t nextDispatchDelay();
+    /* Number of queued jobs */
+    uint8_t pendingJobs();
+    /* Set the minimum interval between two uplinks on a technology */
+    void setMinimumInterval(uint8_t technology, uint32_t interval);
+    // Register a callback for job completion (sent, failed or expired)
+    void register_job_callback(void (*onJobDone)(uint8_t jobId, uint8_t technology, uint8_t errorCode));
+  private:
+    UplinkScheduler();
+    ~UplinkScheduler();
+
+    struct JobEntry {
+      UplinkJob_t job;
+      boolean isUsed;
+      uint8_t id;
+      uint8_t attempts;
+      uint32_t sequence;
+      uint32_t submitTime;
+      uint32_t retryTime;
+    };
+
+    JobEntry queue_[UPLINK_QUEUE_SIZE];
+    uint8_t nextJobId_;
+    uint32_t sequence_;
+    uint32_t nextAvailable_[3];
+    uint32_t minimumInterval_[3];
+    /* nextAvailable_ set, from the first job */
+    boolean isStarted_;
+    onJobDone onJobDoneCbk_;
+
+    /* Methods */
+    static uint8_t technologyIndex(uint8_t technology);
+    static bool isElapsed(uint32_t now, uint32_t time);
+    bool isBefore(const JobEntry* entry1, const JobEntry* entry2);
+    bool isLinkAvailable(uint8_t technology, uint8_t size);
+    uint8_t selectTechnology(const JobEntry* entry, uint32_t now);
+    uint8_t dispatch(JobEntry* entry, uint8_t technology);
+    void complete(JobEntry* entry, uint8_t technology, uint8_t errorCode);
+};
+
+template <> UplinkScheduler Singleton<UplinkScheduler>::_singleton;
+
+#endif /* UPLINK_SCHEDULER_H */
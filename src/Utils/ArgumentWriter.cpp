@@ -0,0 +1,95 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * ArgumentWriter.cpp - Bounded append cursor to format AT command arguments
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string.h>
+#include "ArgumentWriter.h"
+
+/**
+ * Constructor
+ * @param buffer  the buffer to fill
+ * @param size  the buffer size, terminating NUL included (at least 1)
+ */
+ArgumentWriter::ArgumentWriter(char* buffer, uint16_t size) : buffer_(buffer), size_(size)
+{
+  clear();
+}
+
+void ArgumentWriter::clear()
+{
+  length_ = 0;
+  overflow_ = false;
+  buffer_[0] = '\0';
+}
+
+/**
+ * Append a string, nothing if it doesn't fit
+ */
+ArgumentWriter& ArgumentWriter::append(const char* string)
+{
+  uint16_t length = length_;
+
+  if (overflow_)
+  {
+    return *this;
+  }
+
+  while (*string != '\0')
+  {
+    if (length + 1 >= size_)
+    {
+      /* Keep the arguments as they were */
+      overflow_ = true;
+      buffer_[length_] = '\0';
+      return *this;
+    }
+    buffer_[length++] = *string++;
+  }
+  buffer_[length] = '\0';
+  length_ = length;
+
+  return *this;
+}
+
+/**
+ * Append characters, nothing if they don't fit
+ */
+ArgumentWriter& ArgumentWriter::append(const char* data, uint16_t length)
+{
+  if (overflow_)
+  {
+    return *this;
+  }
+
+  if (length_ + length >= size_)
+  {
+    overflow_ = true;
+    return *this;
+  }
+
+  memcpy(&buffer_[length_], data, length);
+  length_ += length;
+  buffer_[length_] = '\0';
+
+  return *this;
+}
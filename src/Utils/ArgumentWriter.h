@@ -0,0 +1,158 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * ArgumentWriter.h - Bounded append cursor to format AT command arguments
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef ARGUMENT_WRITER_H
+#define ARGUMENT_WRITER_H
+
+#include <stdint.h>
+
+/**
+ * Appends characters at the end of a buffer, always NUL terminated.
+ * Nothing is written past the buffer: once a value doesn't fit, the writer
+ * is in overflow and the arguments must not be sent.
+ *
+ * Usage:
+ *   ArgumentWriter writer(buffer, sizeof(buffer));
+ *   writer.appendDec(channel).separator().appendHex(mask, 4).endOfLine();
+ *   if (writer.hasOverflowed()) ...
+ */
+class ArgumentWriter
+{
+  public:
+    ArgumentWriter(char* buffer, uint16_t size);
+    /* Restart at the beginning of the buffer */
+    void clear();
+    ArgumentWriter& append(const char* string);
+    /* The first length characters of data */
+    ArgumentWriter& append(const char* data, uint16_t length);
+    inline ArgumentWriter& append(char character);
+    /* Unsigned integer in decimal */
+    inline ArgumentWriter& appendDec(uint32_t value);
+    /* Unsigned integer in upper case hexadecimal, left padded with 0 to digits */
+    inline ArgumentWriter& appendHex(uint32_t value, uint8_t digits);
+    /* COMMA */
+    ArgumentWriter& separator() { return append(','); }
+    /* CRLF */
+    ArgumentWriter& endOfLine() { return append("\r\n"); }
+
+    bool hasOverflowed() const { return overflow_; }
+    uint16_t length() const { return length_; }
+    const char* c_str() const { return buffer_; }
+  private:
+    char* buffer_;
+    uint16_t size_;
+    uint16_t length_;
+    bool overflow_;
+
+    inline ArgumentWriter& appendDigits(const char* digits, uint8_t count);
+};
+
+/* Formatting of the values, inline: called once per argument */
+
+inline ArgumentWriter& ArgumentWriter::append(char character)
+{
+  if (overflow_)
+  {
+    return *this;
+  }
+
+  if (length_ + 1 >= size_)
+  {
+    overflow_ = true;
+    return *this;
+  }
+
+  buffer_[length_++] = character;
+  buffer_[length_] = '\0';
+
+  return *this;
+}
+
+inline ArgumentWriter& ArgumentWriter::appendDec(uint32_t value)
+{
+  char digits[10];
+  uint8_t count = 0;
+
+  /* Least significant digit first */
+  do
+  {
+    digits[count++] = '0' + (value % 10);
+    value /= 10;
+  } while (value != 0);
+
+  return appendDigits(digits, count);
+}
+
+inline ArgumentWriter& ArgumentWriter::appendHex(uint32_t value, uint8_t digits)
+{
+  static const char hexDigits[] = "0123456789ABCDEF";
+  char reversed[8];
+  uint8_t count = 0;
+
+  if (digits > sizeof(reversed))
+  {
+    digits = sizeof(reversed);
+  }
+
+  /* Least significant digit first */
+  do
+  {
+    reversed[count++] = hexDigits[value & 0x0F];
+    value >>= 4;
+  } while ( (value != 0) && (count < sizeof(reversed)) );
+
+  while (count < digits)
+  {
+    reversed[count++] = '0';
+  }
+
+  return appendDigits(reversed, count);
+}
+
+/**
+ * Append digits stored least significant first
+ */
+inline ArgumentWriter& ArgumentWriter::appendDigits(const char* digits, uint8_t count)
+{
+  if (overflow_)
+  {
+    return *this;
+  }
+
+  if (length_ + count >= size_)
+  {
+    overflow_ = true;
+    return *this;
+  }
+
+  while (count != 0)
+  {
+    buffer_[length_++] = digits[--count];
+  }
+  buffer_[length_] = '\0';
+
+  return *this;
+}
+
+#endif /* ARGUMENT_WRITER_H */
@@ -28,7 +28,6 @@
 
 CircBuffer::CircBuffer()
 {
-  buffer_ = (char*) malloc(CIRCULAR_BUFFER_SIZE*sizeof(char));
   bufferLen_ = CIRCULAR_BUFFER_SIZE;
   writePtr_ = buffer_;
   readPtr_ = buffer_;
@@ -98,6 +97,13 @@ int CircBuffer::read(char* dest, int destLen)
 }
 
 int CircBuffer::readLine(char* dest, int destLen)
+{
+  return readLine(dest, destLen, false);
+}
+
+// @param crEndsLine  a CR followed by another byte than LF also ends the
+//                    line (LF lost), it is returned as LF
+int CircBuffer::readLine(char* dest, int destLen, bool crEndsLine)
 {
   int i = 0;
   char *p = readPtr_;
@@ -120,6 +126,11 @@ int CircBuffer::readLine(char* dest, int destLen)
       i++;
       if (readPtr_ >= getEndOfBuffer())
         readPtr_ = buffer_;
+      if ( (crEndsLine) && (byteRead == '\r') && (i < size_) && (*readPtr_ != '\n') )
+      {
+        byteRead = '\n';
+        dest[-1] = byteRead;
+      }
     } 
     while ( (byteRead != '\n') && (i<tempLength) );
 
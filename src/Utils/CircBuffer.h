@@ -52,6 +52,7 @@ class CircBuffer {
     // @return number of bytes actually read
     int read(char* dest, int destLen);
     int readLine(char* dest, int destLen);
+    int readLine(char* dest, int destLen, bool crEndsLine);
     int read();
 
     // @return number of bytes copied
@@ -65,7 +66,7 @@ class CircBuffer {
 #endif
 
   private:
-    char* buffer_;
+    char buffer_[CIRCULAR_BUFFER_SIZE];
     int bufferLen_;
     char*  writePtr_;
     char* readPtr_;
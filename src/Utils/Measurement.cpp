@@ -0,0 +1,185 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * Measurement.cpp - Timing of repeated operations (benchmarks)
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ */
+ 
+#include "Measurement.h"
+#include "NemeusClock.h"
+
+/* Width of the columns of printRow() */
+#define MEASUREMENT_NAME_WIDTH 24
+#define MEASUREMENT_COLUMN_WIDTH 10
+
+/**
+ * Print a column, right aligned
+ */
+static void printColumn(Print& out, const char* text)
+{
+  for (size_t i = strlen(text); i < MEASUREMENT_COLUMN_WIDTH; i++)
+  {
+    out.print(' ');
+  }
+  out.print(text);
+}
+
+static void printColumn(Print& out, uint32_t value)
+{
+  char text[11];
+  uint8_t index = sizeof(text) - 1;
+
+  text[index] = '\0';
+  do
+  {
+    text[--index] = '0' + (value % 10);
+    value /= 10;
+  } while (value != 0);
+
+  printColumn(out, &text[index]);
+}
+
+/**
+ * Forget the samples
+ */
+void Measurement::clear()
+{
+  nbSamples_ = 0;
+  nbUnits_ = 0;
+  total_ = 0;
+  min_ = UINT32_MAX;
+  max_ = 0;
+}
+
+/**
+ * Start a sample, now
+ */
+void Measurement::start()
+{
+  start_ = NemeusClock::get()->nowMicros();
+}
+
+/**
+ * End the sample started
+ * @param nbUnits  the units processed by the sample (bytes, frames...)
+ * @return  the duration of the sample in us
+ */
+uint32_t Measurement::stop(uint32_t nbUnits)
+{
+  uint32_t duration = NemeusClock::get()->nowMicros() - start_;
+
+  add(duration, nbUnits);
+
+  return duration;
+}
+
+/**
+ * Add a sample
+ * @param duration  its duration in us
+ * @param nbUnits  the units it processed
+ */
+void Measurement::add(uint32_t duration, uint32_t nbUnits)
+{
+  nbSamples_++;
+  nbUnits_ += nbUnits;
+  total_ += duration;
+  if (duration < min_)
+  {
+    min_ = duration;
+  }
+  if (duration > max_)
+  {
+    max_ = duration;
+  }
+}
+
+/**
+ * Get the mean duration
+ * @return  the mean in us, 0 without samples
+ */
+uint32_t Measurement::getMean() const
+{
+  if (nbSamples_ == 0)
+  {
+    return 0;
+  }
+
+  return (uint32_t)(total_ / nbSamples_);
+}
+
+/**
+ * Get the throughput
+ * @return  the units processed per second of the samples, 0 if none
+ */
+uint32_t Measurement::getThroughput() const
+{
+  if (total_ == 0)
+  {
+    return 0;
+  }
+
+  return (uint32_t)(((uint64_t)nbUnits_ * 1000000ull) / total_);
+}
+
+/**
+ * Print the header of the table of printRow()
+ * @param out  where to print (SerialUSB)
+ */
+void Measurement::printHeader(Print& out)
+{
+  char name[MEASUREMENT_NAME_WIDTH + 1];
+
+  memset(name, ' ', MEASUREMENT_NAME_WIDTH);
+  name[MEASUREMENT_NAME_WIDTH] = '\0';
+  memcpy(name, "operation", 9);
+  out.print(name);
+  printColumn(out, "samples");
+  printColumn(out, "min us");
+  printColumn(out, "mean us");
+  printColumn(out, "max us");
+  printColumn(out, "units/s");
+  out.print("\r\n");
+}
+
+/**
+ * Print the samples as a row of a table
+ * @param out  where to print (SerialUSB)
+ * @param name  the operation, cut to 24 characters
+ */
+void Measurement::printRow(Print& out, const char* name) const
+{
+  size_t length = strlen(name);
+
+  if (length > MEASUREMENT_NAME_WIDTH)
+  {
+    length = MEASUREMENT_NAME_WIDTH;
+  }
+  out.write(name, length);
+  for (; length < MEASUREMENT_NAME_WIDTH; length++)
+  {
+    out.print(' ');
+  }
+  printColumn(out, nbSamples_);
+  printColumn(out, getMin());
+  printColumn(out, getMean());
+  printColumn(out, max_);
+  printColumn(out, getThroughput());
+  out.print("\r\n");
+}
@@ -0,0 +1,83 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * Measurement.h - Timing of repeated operations (benchmarks)
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ */
+ 
+#ifndef MEASUREMENT_H
+#define MEASUREMENT_H
+
+#include <stdint.h>
+
+#include "Arduino.h"
+
+/**
+ * Samples of an operation timed with the library clock (us): count,
+ * minimum, mean, maximum and the units processed (bytes, frames) for a
+ * throughput.
+ *
+ * Usage:
+ *   Measurement roundTrip;
+ *   for (uint8_t i = 0; i < 20; i++)
+ *   {
+ *     roundTrip.start();
+ *     nemeusLib.debugMver();
+ *     roundTrip.stop();
+ *   }
+ *   Measurement::printHeader(SerialUSB);
+ *   roundTrip.printRow(SerialUSB, "DEBUG_MVER");
+ */
+class Measurement
+{
+  public:
+    constexpr Measurement() : nbSamples_(0), nbUnits_(0), total_(0), min_(UINT32_MAX), max_(0), start_(0) {}
+    /* Forget the samples */
+    void clear();
+    /* Start a sample */
+    void start();
+    /* End the sample started, with the units it processed, return its duration in us */
+    uint32_t stop(uint32_t nbUnits = 1);
+    /* Add a sample measured elsewhere */
+    void add(uint32_t duration, uint32_t nbUnits = 1);
+
+    uint32_t getNbSamples() const { return nbSamples_; }
+    uint32_t getNbUnits() const { return nbUnits_; }
+    /* Durations in us, 0 without samples */
+    uint32_t getMin() const { return (nbSamples_ != 0) ? min_ : 0; }
+    uint32_t getMax() const { return max_; }
+    uint32_t getMean() const;
+    uint64_t getTotal() const { return total_; }
+    /* Units per second over the samples */
+    uint32_t getThroughput() const;
+
+    /* Table header and row: name, samples, min, mean and max in us, units/s */
+    static void printHeader(Print& out);
+    void printRow(Print& out, const char* name) const;
+  private:
+    uint32_t nbSamples_;
+    uint32_t nbUnits_;
+    uint64_t total_;
+    uint32_t min_;
+    uint32_t max_;
+    uint32_t start_;
+};
+
+#endif /* MEASUREMENT_H */
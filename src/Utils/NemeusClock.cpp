@@ -0,0 +1,83 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * NemeusClock.cpp - Time source of the library
+ * 
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ */
+ 
+#include "NemeusClock.h"
+
+/* Default clock (Arduino core) and clock in use */
+static NemeusClock arduinoClock;
+static NemeusClock* currentClock = &arduinoClock;
+
+/**
+ * Get the time
+ * @return  the time in ms (wraps after 49 days)
+ */
+uint32_t NemeusClock::now()
+{
+  return millis();
+}
+
+/**
+ * Get the time with a finer resolution
+ * @return  the time in us (wraps after 71 minutes)
+ */
+uint32_t NemeusClock::nowMicros()
+{
+  return micros();
+}
+
+/**
+ * Wait
+ * @param ms  the delay in ms
+ */
+void NemeusClock::delay(uint32_t ms)
+{
+  ::delay(ms);
+}
+
+/**
+ * Nothing to do until some data is received or ms have elapsed
+ * @param ms  the maximum time in ms, the caller polls again
+ */
+void NemeusClock::idle(uint32_t ms)
+{
+  (void)ms;
+}
+
+/**
+ * Set the clock used by the library
+ * @param clock  the clock (not copied), NULL for millis() and delay()
+ */
+void NemeusClock::set(NemeusClock* clock)
+{
+  currentClock = (clock != NULL) ? clock : &arduinoClock;
+}
+
+/**
+ * Get the clock used by the library
+ * @return  the clock set, the default one if none
+ */
+NemeusClock* NemeusClock::get()
+{
+  return currentClock;
+}
@@ -0,0 +1,58 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * NemeusClock.h - Time source of the library
+ * 
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ */
+ 
+#ifndef NEMEUS_CLOCK_H
+#define NEMEUS_CLOCK_H
+
+#include <stdint.h>
+
+#include "Arduino.h"
+
+/**
+ * Time source of the library, millis() and delay() of the core by default.
+ * A host build replaces it with a simulated clock (extras/host) so that
+ * timeouts and delays take no real time.
+ *
+ * Waiting loops call idle() when nothing is received: the default returns at
+ * once (busy polling), a simulated clock moves to the next byte of the module
+ * or to the end of the wait.
+ */
+class NemeusClock
+{
+  public:
+    constexpr NemeusClock() {}
+    /* Time in ms */
+    virtual uint32_t now();
+    /* Time in us (wraps after 71 minutes), for measurements */
+    virtual uint32_t nowMicros();
+    /* Wait ms */
+    virtual void delay(uint32_t ms);
+    /* Nothing to do for up to ms, unless the module sends data */
+    virtual void idle(uint32_t ms);
+    /* Clock used by the library (NULL for the default one) */
+    static void set(NemeusClock* clock);
+    static NemeusClock* get();
+};
+
+#endif /* NEMEUS_CLOCK_H */
@@ -25,11 +25,6 @@
 #include "NemeusTimer.h"
 
 
-NemeusTimer::NemeusTimer() {
-
-  timerOverflow_ = false;
-}
-
 /**
  * Set a timeout value
  * @param timeout  timeout in ms to
@@ -38,7 +33,7 @@ void NemeusTimer::setTimeout(uint32_t timeout)
 {
   uint32_t currentTime;
 
-  currentTime = millis();
+  currentTime = NemeusClock::get()->now();
   timeoutValue_ = currentTime+timeout;
 
   if (timeoutValue_>=currentTime)
@@ -61,7 +56,7 @@ bool NemeusTimer::isTimeout()
   bool returnTimeout;
   uint32_t currentTime;
 
-  currentTime = millis();
+  currentTime = NemeusClock::get()->now();
   if (timerOverflow_)
   {
     if (currentTime < timeoutValue_)
@@ -82,3 +77,17 @@ bool NemeusTimer::isTimeout()
 
   return returnTimeout;
 }
+
+/**
+ * Time left before the timeout
+ * @return  the time in ms, 0 if timer has elapsed
+ */
+uint32_t NemeusTimer::getRemaining()
+{
+  if (isTimeout())
+  {
+    return 0;
+  }
+
+  return timeoutValue_ - NemeusClock::get()->now();
+}
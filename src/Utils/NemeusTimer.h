@@ -28,13 +28,16 @@
 #include <stdint.h>
 
 #include "Arduino.h"
+#include "NemeusClock.h"
 
 class NemeusTimer
 {
   public:
-    NemeusTimer();
+    constexpr NemeusTimer() : timeoutValue_(0), timerOverflow_(false) {}
     void setTimeout(uint32_t timeout);
     bool isTimeout();
+    /* Time left in ms, 0 once elapsed */
+    uint32_t getRemaining();
   private:
     uint32_t timeoutValue_;
     boolean timerOverflow_;
@@ -0,0 +1,229 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * NvmStorage.cpp - Non volatile storage of library data
+ *                  SAMD21 flash row, or a file on host builds
+ * 
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ */
+
+#include <Arduino.h>
+#include "NemeusUART.h"
+#include "NvmStorage.h"
+
+#if defined(NEMEUS_HOST_BUILD)
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Storage of the process, unless a file is given (NEMEUS_NVM_FILE) */
+static uint8_t hostRow[NVM_STORAGE_SIZE];
+static bool isHostRowWritten = false;
+
+/**
+ * Read the storage
+ * @param data  filled with the data
+ * @param size  the size to read
+ * @return  the error code
+ *               NEMEUS_SUCCESS if data is read
+ *               NEMEUS_ARGUMENT_ERROR if size is too big
+ *               NEMEUS_ERROR if storage is empty
+ */
+uint8_t nvmStorageRead(void* data, uint16_t size)
+{
+  uint8_t ErrorCode = NEMEUS_ERROR;
+  const char* path = getenv(NVM_STORAGE_HOST_ENV);
+  FILE* file;
+
+  if (size > NVM_STORAGE_SIZE)
+  {
+    return NEMEUS_ARGUMENT_ERROR;
+  }
+
+  /* Erased flash reads as 0xFF */
+  memset(data, 0xFF, size);
+
+  if (path == NULL)
+  {
+    if (isHostRowWritten)
+    {
+      memcpy(data, hostRow, size);
+      ErrorCode = NEMEUS_SUCCESS;
+    }
+    return ErrorCode;
+  }
+
+  file = fopen(path, "rb");
+  if (file != NULL)
+  {
+    if (fread(data, 1, size, file) == size)
+    {
+      ErrorCode = NEMEUS_SUCCESS;
+    }
+    fclose(file);
+  }
+
+  return ErrorCode;
+}
+
+/**
+ * Write the storage
+ * @param data  the data
+ * @param size  the size to write
+ * @return  the error code
+ *               NEMEUS_SUCCESS if data is written
+ *               NEMEUS_ARGUMENT_ERROR if size is too big
+ *               NEMEUS_ERROR if writing failed
+ */
+uint8_t nvmStorageWrite(const void* data, uint16_t size)
+{
+  uint8_t ErrorCode = NEMEUS_ERROR;
+  const char* path = getenv(NVM_STORAGE_HOST_ENV);
+  FILE* file;
+
+  if (size > NVM_STORAGE_SIZE)
+  {
+    return NEMEUS_ARGUMENT_ERROR;
+  }
+
+  if (path == NULL)
+  {
+    memset(hostRow, 0xFF, sizeof(hostRow));
+    memcpy(hostRow, data, size);
+    isHostRowWritten = true;
+    return NEMEUS_SUCCESS;
+  }
+
+  file = fopen(path, "wb");
+  if (file != NULL)
+  {
+    if (fwrite(data, 1, size, file) == size)
+    {
+      ErrorCode = NEMEUS_SUCCESS;
+    }
+    fclose(file);
+  }
+
+  return ErrorCode;
+}
+
+#elif defined(ARDUINO_ARCH_SAMD)
+
+#define NVM_PAGE_SIZE 64
+
+/* Row reserved in program flash, erased by the first write. Volatile: the
+   content changes behind the compiler, reads must not be folded. */
+__attribute__((__aligned__(NVM_STORAGE_SIZE))) static const volatile uint8_t nvmRow[NVM_STORAGE_SIZE] = { 0 };
+
+static void nvmCommand(uint32_t command)
+{
+  NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | command;
+  while (NVMCTRL->INTFLAG.bit.READY == 0)
+  {
+  }
+}
+
+/**
+ * Read the storage
+ * @param data  filled with the data
+ * @param size  the size to read
+ * @return  the error code
+ *               NEMEUS_SUCCESS if data is read
+ *               NEMEUS_ARGUMENT_ERROR if size is too big
+ */
+uint8_t nvmStorageRead(void* data, uint16_t size)
+{
+  if (size > NVM_STORAGE_SIZE)
+  {
+    return NEMEUS_ARGUMENT_ERROR;
+  }
+
+  for (uint16_t i = 0; i < size; i++)
+  {
+    ((uint8_t*)data)[i] = nvmRow[i];
+  }
+
+  return NEMEUS_SUCCESS;
+}
+
+/**
+ * Write the storage (the row is erased, then written page by page)
+ * @param data  the data
+ * @param size  the size to write
+ * @return  the error code
+ *               NEMEUS_SUCCESS if data is written
+ *               NEMEUS_ARGUMENT_ERROR if size is too big
+ */
+uint8_t nvmStorageWrite(const void* data, uint16_t size)
+{
+  const uint8_t* source = (const uint8_t*)data;
+  volatile uint32_t* destination = (volatile uint32_t*)nvmRow;
+
+  if (size > NVM_STORAGE_SIZE)
+  {
+    return NEMEUS_ARGUMENT_ERROR;
+  }
+
+  /* Erase the row (address in 16 bits words) */
+  NVMCTRL->ADDR.reg = ((uint32_t)nvmRow) / 2;
+  nvmCommand(NVMCTRL_CTRLA_CMD_ER);
+
+  /* Manual page write */
+  NVMCTRL->CTRLB.bit.MANW = 1;
+
+  for (uint16_t page = 0; page < size; page += NVM_PAGE_SIZE)
+  {
+    nvmCommand(NVMCTRL_CTRLA_CMD_PBC);
+
+    /* Page buffer is written by 32 bits words, unused bytes stay erased */
+    for (uint16_t i = page; i < (page + NVM_PAGE_SIZE); i += 4)
+    {
+      uint32_t word = 0;
+
+      for (uint8_t j = 0; j < 4; j++)
+      {
+        uint8_t byte = ((i + j) < size) ? source[i + j] : 0xFF;
+        word |= (uint32_t)byte << (8*j);
+      }
+      *destination++ = word;
+    }
+
+    nvmCommand(NVMCTRL_CTRLA_CMD_WP);
+  }
+
+  return NEMEUS_SUCCESS;
+}
+
+#else
+
+uint8_t nvmStorageRead(void* data, uint16_t size)
+{
+  (void)data;
+  (void)size;
+  return NEMEUS_ERROR;
+}
+
+uint8_t nvmStorageWrite(const void* data, uint16_t size)
+{
+  (void)data;
+  (void)size;
+  return NEMEUS_ERROR;
+}
+
+#endif
@@ -2,7 +2,8 @@
  * |\ |  |_   |\/|  |_   |  |  (_
  * | \|  |__  |  |  |__  |__|  __)
  *
- * DataContext.cpp - Data Context for library
+ * NvmStorage.h - Non volatile storage of library data
+ *                  SAMD21 flash row, or a file on host builds
  * 
  * Copyright (C) 2017 Nemeus - All Rights Reserved
  *
@@ -21,41 +22,22 @@
  * limitations under the License.
  * 
  */
- 
-#include "DataContext.h"
-#include "AtCommand.h"
 
-/**
- * Constructor
- */
-DataContext::DataContext()
-{
-  resetOngoingAtCommand();
-}
+#ifndef NVM_STORAGE_H
+#define NVM_STORAGE_H
 
-/**
- * Reset the on going AT command
- */
-void DataContext::resetOngoingAtCommand()
-{
-  this->ongoingAtCommand_ = NO_CMD;
-}
-
-/**
- * Set the on going AT command to the specified one
- * @param newValue  at command to set
- */
-void DataContext::setOngoingAtCommand(AtCommand newValue)
-{
-  this->ongoingAtCommand_ = newValue;
-}
-
-/**
- * Get the on going AT command
- * @return  the at command on process (waiting for response)
- */
-AtCommand DataContext::getOngoingAtCommand()
-{
-  return this->ongoingAtCommand_;
-}
+#include <stdint.h>
+
+/* One SAMD21 flash row (4 pages of 64 bytes), erased as a whole */
+#define NVM_STORAGE_SIZE 256
+
+/* Host builds keep the storage in memory (lost at exit, every run starts
+   erased) unless this environment variable names a file to keep it in */
+#define NVM_STORAGE_HOST_ENV "NEMEUS_NVM_FILE"
+
+/* Read size bytes from the start of the storage */
+uint8_t nvmStorageRead(void* data, uint16_t size);
+/* Erase the storage and write size bytes at its start */
+uint8_t nvmStorageWrite(const void* data, uint16_t size);
 
+#endif /* NVM_STORAGE_H */
@@ -0,0 +1,256 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * PayloadSchema.h - Compile-time bit-level payload schema
+ *
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef PAYLOAD_SCHEMA_H
+#define PAYLOAD_SCHEMA_H
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Usage:
+ *   // Temperature -40..85 °C by 0.1 °C, pressure 300..1100 hPa by 0.5 hPa, battery flag
+ *   typedef PayloadSchema< PayloadField<11, -40, 85, 10>,
+ *                          PayloadField<11, 300, 1100, 2>,
+ *                          PayloadField<1, 0, 1> > SensorFrame;
+ *
+ *   uint8_t frame[MAXIMUM_SIGFOX_PAYLOAD];            // size checked at compile time
+ *   SensorFrame::encode(frame, temperature, pressure, lowBattery);
+ *   SensorFrame::decode(frame, sizeof(frame), &temperature, &pressure, &lowBattery);
+ *
+ * Fields are packed MSB first in declaration order, the payload size is
+ * SensorFrame::SIZE bytes. Values out of range are saturated.
+ */
+
+/**
+ * Field of a payload schema
+ * @param Bits  field width (1 to 32)
+ * @param Min  minimum value in physical unit
+ * @param Max  maximum value in physical unit
+ * @param Scale  number of steps per physical unit (resolution is 1/Scale)
+ */
+template <uint8_t Bits, int32_t Min, int32_t Max, uint32_t Scale = 1>
+struct PayloadField
+{
+  static_assert((Bits >= 1) && (Bits <= 32), "Field width must be 1 to 32 bits");
+  static_assert(Max > Min, "Field range is empty");
+  static_assert(Scale >= 1, "Field scale must be at least 1");
+  static_assert(((uint64_t)((int64_t)Max - Min) * Scale) <= ((1ULL << Bits) - 1), "Field range doesn't fit in its bits");
+
+  enum : uint32_t
+  {
+    BITS = Bits,
+    RAW_MAX = (uint32_t)(((int64_t)Max - Min) * Scale)
+  };
+
+  /* Raw value of an integer value */
+  template <typename V>
+  static uint32_t toRaw(V value)
+  {
+    if ((int64_t)value <= Min)
+    {
+      return 0;
+    }
+    if ((int64_t)value >= Max)
+    {
+      return RAW_MAX;
+    }
+    return (uint32_t)((int64_t)value - Min) * Scale;
+  }
+
+  /* Raw value of a floating point value, rounded to the nearest step */
+  static uint32_t toRaw(float value)
+  {
+    if (!(value > Min))
+    {
+      return 0;
+    }
+    if (value >= Max)
+    {
+      return RAW_MAX;
+    }
+    return (uint32_t)((value - Min) * Scale + 0.5f);
+  }
+
+  static uint32_t toRaw(double value)
+  {
+    return toRaw((float)value);
+  }
+
+  /* Physical value of a raw value */
+  template <typename V>
+  static V fromRaw(uint32_t raw)
+  {
+    if (Scale == 1)
+    {
+      return (V)((int64_t)Min + raw);
+    }
+    return (V)(Min + (double)raw / Scale);
+  }
+};
+
+/**
+ * Write the bits lowest bits of raw at a bit offset, MSB first
+ * (buffer must be zeroed)
+ */
+static inline void payloadWriteBits(uint8_t* buffer, uint16_t offset, uint8_t bits, uint32_t raw)
+{
+  while (bits != 0)
+  {
+    uint8_t available = 8 - (offset & 7);
+    uint8_t count = (bits < available) ? bits : available;
+    uint8_t chunk = (raw >> (bits - count)) & ((1U << count) - 1);
+
+    buffer[offset >> 3] |= chunk << (available - count);
+    offset += count;
+    bits -= count;
+  }
+}
+
+/**
+ * Read bits at a bit offset, MSB first
+ */
+static inline uint32_t payloadReadBits(const uint8_t* buffer, uint16_t offset, uint8_t bits)
+{
+  uint32_t raw = 0;
+
+  while (bits != 0)
+  {
+    uint8_t available = 8 - (offset & 7);
+    uint8_t count = (bits < available) ? bits : available;
+
+    raw = (raw << count) | ((buffer[offset >> 3] >> (available - count)) & ((1U << count) - 1));
+    offset += count;
+    bits -= count;
+  }
+
+  return raw;
+}
+
+/**
+ * Hexadecimal string of a payload, as expected by sendFrame() in binary mode
+ * @param hex  filled with 2*size characters and the terminating NUL
+ */
+static inline void payloadToHex(const uint8_t* payload, uint8_t size, char* hex)
+{
+  static const char hexDigits[] = "0123456789ABCDEF";
+
+  for (uint8_t i = 0; i < size; i++)
+  {
+    hex[2*i] = hexDigits[payload[i] >> 4];
+    hex[2*i+1] = hexDigits[payload[i] & 0x0F];
+  }
+  hex[2*size] = '\0';
+}
+
+template <typename... Fields>
+struct PayloadSchema;
+
+template <>
+struct PayloadSchema<>
+{
+  enum : uint16_t
+  {
+    BITS = 0,
+    FIELDS = 0
+  };
+
+  static void pack(uint8_t* buffer, uint16_t offset)
+  {
+    (void)buffer;
+    (void)offset;
+  }
+
+  static void unpack(const uint8_t* buffer, uint16_t offset)
+  {
+    (void)buffer;
+    (void)offset;
+  }
+};
+
+template <typename Field, typename... Fields>
+struct PayloadSchema<Field, Fields...>
+{
+  typedef PayloadSchema<Fields...> Next;
+
+  enum : uint16_t
+  {
+    BITS = Field::BITS + Next::BITS,
+    FIELDS = 1 + Next::FIELDS,
+    SIZE = (BITS + 7) / 8
+  };
+
+  /* Largest LoRaWAN payload (MAX_LORAWAN_PAYLOAD_3) */
+  static_assert(SIZE <= 242, "Payload doesn't fit in a LoRaWAN frame");
+
+  /**
+   * Encode values, one per field in declaration order
+   * @param buffer  the payload, at least SIZE bytes (checked at compile time)
+   */
+  template <uint16_t N, typename... Values>
+  static void encode(uint8_t (&buffer)[N], Values... values)
+  {
+    static_assert(N >= SIZE, "Buffer is smaller than the payload");
+    static_assert(sizeof...(Values) == FIELDS, "One value per field is expected");
+
+    memset(buffer, 0, SIZE);
+    pack(buffer, 0, values...);
+  }
+
+  /**
+   * Decode values, one pointer per field in declaration order
+   * @param buffer  the payload
+   * @param size  the payload size
+   * @return  false if the payload is too short
+   */
+  template <typename... Values>
+  static bool decode(const uint8_t* buffer, uint16_t size, Values*... values)
+  {
+    static_assert(sizeof...(Values) == FIELDS, "One value per field is expected");
+
+    if (size < SIZE)
+    {
+      return false;
+    }
+    unpack(buffer, 0, values...);
+
+    return true;
+  }
+
+  template <typename Value, typename... Values>
+  static void pack(uint8_t* buffer, uint16_t offset, Value value, Values... values)
+  {
+    payloadWriteBits(buffer, offset, Field::BITS, Field::toRaw(value));
+    Next::pack(buffer, offset + Field::BITS, values...);
+  }
+
+  template <typename Value, typename... Values>
+  static void unpack(const uint8_t* buffer, uint16_t offset, Value* value, Values*... values)
+  {
+    *value = Field::template fromRaw<Value>(payloadReadBits(buffer, offset, Field::BITS));
+    Next::unpack(buffer, offset + Field::BITS, values...);
+  }
+};
+
+#endif /* PAYLOAD_SCHEMA_H */
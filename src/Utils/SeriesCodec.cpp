@@ -0,0 +1,262 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * SeriesCodec.cpp - Compact codec for timestamped scalar series
+ * 
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ */
+
+#include <stddef.h>
+
+#include "SeriesCodec.h"
+
+static uint32_t zigzagEncode(uint32_t value)
+{
+  /* Signed value in two's complement, small magnitudes give small results */
+  return (value << 1) ^ ((value & 0x80000000UL) ? 0xFFFFFFFFUL : 0);
+}
+
+static uint32_t zigzagDecode(uint32_t value)
+{
+  return (value >> 1) ^ ((value & 1) ? 0xFFFFFFFFUL : 0);
+}
+
+static uint8_t varintSize(uint32_t value)
+{
+  uint8_t size = 1;
+
+  while (value >= 0x80)
+  {
+    value >>= 7;
+    size++;
+  }
+
+  return size;
+}
+
+static uint8_t varintWrite(uint8_t* buffer, uint32_t value)
+{
+  uint8_t size = 0;
+
+  while (value >= 0x80)
+  {
+    buffer[size++] = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  buffer[size++] = value;
+
+  return size;
+}
+
+/**
+ * Read a varint
+ * @return  the number of bytes read, 0 if truncated or too long
+ */
+static uint8_t varintRead(const uint8_t* buffer, uint8_t size, uint32_t* value)
+{
+  uint8_t index = 0;
+  uint8_t shift = 0;
+
+  *value = 0;
+  while ( (index < size) && (index < SERIES_VARINT_MAX_SIZE) )
+  {
+    *value |= (uint32_t)(buffer[index] & 0x7F) << shift;
+    if ((buffer[index++] & 0x80) == 0)
+    {
+      return index;
+    }
+    shift += 7;
+  }
+
+  return 0;
+}
+
+/**
+ * Constructor
+ * @param buffer  the output buffer, at least budget bytes (NULL to only compute sizes)
+ * @param budget  the maximum encoded size (LoRaWAN maximum payload, MAXIMUM_SIGFOX_PAYLOAD...)
+ */
+SeriesEncoder::SeriesEncoder(uint8_t* buffer, uint8_t budget)
+{
+  buffer_ = buffer;
+  reset(budget);
+}
+
+void SeriesEncoder::reset(uint8_t budget)
+{
+  budget_ = budget;
+  size_ = 0;
+  count_ = 0;
+  lastTime_ = 0;
+  lastTimeDelta_ = 0;
+  lastValue_ = 0;
+}
+
+/**
+ * Append a sample
+ * @param time  the sample timestamp
+ * @param value  the sample value
+ * @return  true if the sample is encoded, false if it doesn't fit in the budget
+ */
+bool SeriesEncoder::add(uint32_t time, int32_t value)
+{
+  uint32_t timeField;
+  uint32_t valueField;
+
+  getDeltas(time, value, &timeField, &valueField);
+  if ((size_ + varintSize(timeField) + varintSize(valueField)) > budget_)
+  {
+    return false;
+  }
+
+  if (buffer_ != NULL)
+  {
+    varintWrite(&buffer_[size_], timeField);
+    varintWrite(&buffer_[size_ + varintSize(timeField)], valueField);
+  }
+  size_ += varintSize(timeField) + varintSize(valueField);
+
+  if (count_ != 0)
+  {
+    lastTimeDelta_ = time - lastTime_;
+  }
+  lastTime_ = time;
+  lastValue_ = value;
+  count_++;
+
+  return true;
+}
+
+uint8_t SeriesEncoder::getSampleSize(uint32_t time, int32_t value) const
+{
+  uint32_t timeField;
+  uint32_t valueField;
+
+  getDeltas(time, value, &timeField, &valueField);
+
+  return varintSize(timeField) + varintSize(valueField);
+}
+
+uint8_t SeriesEncoder::getSize() const
+{
+  return size_;
+}
+
+uint8_t SeriesEncoder::getCount() const
+{
+  return count_;
+}
+
+/**
+ * Fields to encode for a sample
+ * @param timeField  filled with the time (first sample) or zigzag delta of delta
+ * @param valueField  filled with the zigzag value (first sample) or value delta
+ */
+void SeriesEncoder::getDeltas(uint32_t time, int32_t value, uint32_t* timeField, uint32_t* valueField) const
+{
+  if (count_ == 0)
+  {
+    *timeField = time;
+    *valueField = zigzagEncode((uint32_t)value);
+  }
+  else
+  {
+    /* Modulo 2^32 arithmetic, no overflow for any input */
+    *timeField = zigzagEncode((time - lastTime_) - lastTimeDelta_);
+    *valueField = zigzagEncode((uint32_t)value - (uint32_t)lastValue_);
+  }
+}
+
+/**
+ * Number of samples of a series fitting in a byte budget
+ * @param samples  the series
+ * @param nbSamples  the number of samples
+ * @param budget  the maximum encoded size
+ * @return  the number of samples encoded from the start of the series
+ */
+uint8_t seriesFittingSamples(const SeriesSample_t* samples, uint8_t nbSamples, uint8_t budget)
+{
+  /* No output buffer: only sizes are computed */
+  SeriesEncoder encoder(NULL, budget);
+
+  for (uint8_t i = 0; i < nbSamples; i++)
+  {
+    if (!encoder.add(samples[i].time, samples[i].value))
+    {
+      return i;
+    }
+  }
+
+  return nbSamples;
+}
+
+/**
+ * Decode a payload encoded by SeriesEncoder
+ * @param buffer  the payload
+ * @param size  the payload size
+ * @param samples  filled with the decoded samples
+ * @param maxSamples  the capacity of samples
+ * @return  the number of decoded samples (decoding stops on a truncated sample)
+ */
+uint8_t seriesDecode(const uint8_t* buffer, uint8_t size, SeriesSample_t* samples, uint8_t maxSamples)
+{
+  uint8_t index = 0;
+  uint8_t count = 0;
+  uint8_t length;
+  uint32_t timeField;
+  uint32_t valueField;
+  uint32_t time = 0;
+  uint32_t timeDelta = 0;
+  uint32_t value = 0;
+
+  while ( (index < size) && (count < maxSamples) )
+  {
+    length = varintRead(&buffer[index], size - index, &timeField);
+    if (length == 0)
+    {
+      break;
+    }
+    index += length;
+
+    length = varintRead(&buffer[index], size - index, &valueField);
+    if (length == 0)
+    {
+      break;
+    }
+    index += length;
+
+    if (count == 0)
+    {
+      time = timeField;
+      value = zigzagDecode(valueField);
+    }
+    else
+    {
+      timeDelta += zigzagDecode(timeField);
+      time += timeDelta;
+      value += zigzagDecode(valueField);
+    }
+
+    samples[count].time = time;
+    samples[count].value = (int32_t)value;
+    count++;
+  }
+
+  return count;
+}
@@ -0,0 +1,80 @@
+/**       __         __         __
+ * |\ |  |_   |\/|  |_   |  |  (_
+ * | \|  |__  |  |  |__  |__|  __)
+ *
+ * SeriesCodec.h - Compact codec for timestamped scalar series
+ * 
+ * Copyright (C) 2017 Nemeus - All Rights Reserved
+ *
+ * This file is part of Nemeus Smart IoT Sensor (Tm) SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ * http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ */
+
+#ifndef SERIES_CODEC_H
+#define SERIES_CODEC_H
+
+#include <stdint.h>
+
+/**
+ * Encoding (no header, samples are read until the end of the payload):
+ *   first sample: <time> <value>         time as varint, value as zigzag varint
+ *   next samples: <time dd> <value d>    zigzag varints of the time delta of
+ *                                        delta and of the value delta
+ * Regular sampling of a slowly changing value takes 2 bytes per sample.
+ * Varints hold 7 bits per byte, the MSB is set when another byte follows.
+ */
+
+/* Maximum size of an encoded 32 bits integer */
+#define SERIES_VARINT_MAX_SIZE 5
+
+typedef struct
+{
+  uint32_t time;    // Timestamp, any unit (s since boot, epoch...)
+  int32_t value;    // Scaled value (deci°C, Pa...)
+}SeriesSample_t;
+
+class SeriesEncoder
+{
+  public:
+    SeriesEncoder(uint8_t* buffer, uint8_t budget);
+    /* Restart the series with a new byte budget */
+    void reset(uint8_t budget);
+    /* Append a sample, false if it doesn't fit in the budget */
+    bool add(uint32_t time, int32_t value);
+    /* Encoded size of a sample appended now */
+    uint8_t getSampleSize(uint32_t time, int32_t value) const;
+    /* Encoded size in bytes */
+    uint8_t getSize() const;
+    /* Number of samples encoded */
+    uint8_t getCount() const;
+  private:
+    uint8_t* buffer_;
+    uint8_t budget_;
+    uint8_t size_;
+    uint8_t count_;
+    uint32_t lastTime_;
+    uint32_t lastTimeDelta_;
+    int32_t lastValue_;
+
+    /* Methods */
+    void getDeltas(uint32_t time, int32_t value, uint32_t* timeField, uint32_t* valueField) const;
+};
+
+/* Number of samples of a series fitting in a byte budget */
+uint8_t seriesFittingSamples(const SeriesSample_t* samples, uint8_t nbSamples, uint8_t budget);
+/* Decode a payload, returns the number of decoded samples */
+uint8_t seriesDecode(const uint8_t* buffer, uint8_t size, SeriesSample_t* samples, uint8_t maxSamples);
+
+#endif /* SERIES_CODEC_H */